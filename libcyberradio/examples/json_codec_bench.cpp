@@ -0,0 +1,252 @@
+/************************************************************************
+ * \file json_codec_bench.cpp
+ * \brief Compares the JSON command encoder and response decoder against
+ *    jsoncpp for the command shapes used by the NDR551 and NDR358, and
+ *    times the full command path (encode, send over UDP, receive, decode)
+ *    against a responder on the loopback interface.
+ * \author DA
+ * \copyright Copyright (c) 2015-2021 CyberRadio Solutions, Inc.  All rights
+ *    reserved.
+ */
+
+#include "LibCyberRadio/Driver/JsonCodec.h"
+#include "LibCyberRadio/Driver/RadioTransport.h"
+#include <json/json.h>
+#include <boost/atomic.hpp>
+#include <boost/chrono.hpp>
+#include <boost/thread.hpp>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+using LibCyberRadio::BasicStringList;
+using LibCyberRadio::Driver::JsonCommandEncoder;
+using LibCyberRadio::Driver::JsonResponseDecoder;
+using LibCyberRadio::Driver::RadioTransport;
+
+// A qwbddc response, as returned by an NDR551
+static const std::string wbddcResponse =
+    "{\"msg\":1234,\"success\":true,\"result\":{\"id\":1,\"enable\":true,"
+    "\"offset\":0.0,\"rfch\":\"1\",\"link\":1,\"dest\":0,\"filter\":40,"
+    "\"vita\":4096,\"ovs\":1,\"decimation\":1,\"type\":\"wideband\","
+    "\"mode\":\"auto\",\"dgv\":0,\"dul\":0,\"dll\":0,\"dtl\":0,\"dal\":0,"
+    "\"ddl\":0,\"dao\":0,\"ddo\":0,\"datc\":0,\"ddtc\":0,\"dat\":0,\"ddt\":0}}\n";
+
+typedef boost::chrono::steady_clock Clock;
+
+static double nsPerOp(Clock::time_point start, int iterations)
+{
+    return (double)boost::chrono::duration_cast<boost::chrono::nanoseconds>(
+            Clock::now() - start).count() / iterations;
+}
+
+// Answers every command with the qwbddc response, carrying the command's
+// message ID, until told to stop
+static void respond(int sock, boost::atomic<bool>* stop)
+{
+    const std::string body = wbddcResponse.substr(wbddcResponse.find(',') + 1);
+    char buf[65536];
+    char rsp[1024];
+    while ( !*stop )
+    {
+        struct sockaddr_in peer;
+        socklen_t peerLen = sizeof(peer);
+        ssize_t bytes = recvfrom(sock, buf, sizeof(buf), 0, (struct sockaddr*)&peer, &peerLen);
+        if ( bytes <= 0 )
+            continue;
+        std::string cmd(buf, bytes);
+        int len = snprintf(rsp, sizeof(rsp), "{\"msg\":%u,%s",
+                JsonResponseDecoder(cmd).getUInt("msg"), body.c_str());
+        sendto(sock, rsp, len, 0, (struct sockaddr*)&peer, peerLen);
+    }
+}
+
+// Starts the responder on a loopback port, returning its socket (or -1)
+static int openResponder(int& port)
+{
+    int sock = socket(AF_INET, SOCK_DGRAM, 0);
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t addrLen = sizeof(addr);
+    // A receive timeout lets the responder notice when to stop
+    struct timeval tv = { 0, 100000 };
+    if ( (sock < 0) ||
+         (setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv)) < 0) ||
+         (bind(sock, (struct sockaddr*)&addr, sizeof(addr)) < 0) ||
+         (getsockname(sock, (struct sockaddr*)&addr, &addrLen) < 0) )
+    {
+        if ( sock >= 0 )
+            close(sock);
+        return -1;
+    }
+    port = ntohs(addr.sin_port);
+    return sock;
+}
+
+int main(int argc, char* argv[])
+{
+    int iterations = ( argc > 1 ) ? atoi(argv[1]) : 200000;
+    size_t sink = 0;
+
+    // Encoding: a "tuner" frequency command
+    Clock::time_point start = Clock::now();
+    for (int i = 0; i < iterations; i++)
+    {
+        Json::Value command;
+        command["cmd"] = "tuner";
+        command["msg"] = i;
+        command["params"] = Json::objectValue;
+        command["params"]["id"] = 1;
+        command["params"]["freq"] = 900e6 + i;
+        Json::FastWriter fastWriter;
+        std::string output = fastWriter.write(command);
+        sink += output.length();
+    }
+    double jsoncppEncode = nsPerOp(start, iterations);
+    start = Clock::now();
+    for (int i = 0; i < iterations; i++)
+    {
+        JsonCommandEncoder& command = JsonCommandEncoder::local();
+        command.begin("tuner", i)
+               .param("id", 1)
+               .param("freq", 900e6 + i);
+        sink += command.str().length();
+    }
+    double codecEncode = nsPerOp(start, iterations);
+
+    // Both encoders must produce the same command
+    Json::Value command;
+    command["cmd"] = "tuner";
+    command["msg"] = 42;
+    command["params"] = Json::objectValue;
+    command["params"]["id"] = 1;
+    command["params"]["freq"] = 915.5e6;
+    JsonCommandEncoder& encoder = JsonCommandEncoder::local();
+    encoder.begin("tuner", 42).param("id", 1).param("freq", 915.5e6);
+    Json::Reader reader;
+    Json::Value reparsed;
+    bool encodeMatch = reader.parse(encoder.str(), reparsed) && (reparsed == command);
+
+    // Decoding: the fields WbddcComponent::queryConfiguration() reads
+    start = Clock::now();
+    for (int i = 0; i < iterations; i++)
+    {
+        Json::Reader reader;
+        Json::Value returnVal;
+        reader.parse(wbddcResponse.c_str(), returnVal);
+        sink += returnVal["success"].asBool();
+        sink += returnVal["result"]["enable"].asBool();
+        sink += (size_t)returnVal["result"]["offset"].asDouble();
+        sink += returnVal["result"]["filter"].asInt();
+        sink += returnVal["result"]["vita"].asUInt();
+        sink += returnVal["result"]["mode"].asString().length();
+        sink += returnVal["result"]["ddt"].asInt();
+    }
+    double jsoncppDecode = nsPerOp(start, iterations);
+    start = Clock::now();
+    for (int i = 0; i < iterations; i++)
+    {
+        JsonResponseDecoder returnVal(wbddcResponse);
+        sink += returnVal.getBool("success");
+        sink += returnVal.getBool("result.enable");
+        sink += (size_t)returnVal.getDouble("result.offset");
+        sink += returnVal.getInt("result.filter");
+        sink += returnVal.getUInt("result.vita");
+        sink += returnVal.getString("result.mode").length();
+        sink += returnVal.getInt("result.ddt");
+    }
+    double codecDecode = nsPerOp(start, iterations);
+
+    // Both decoders must read the same values
+    Json::Value returnVal;
+    reader.parse(wbddcResponse, returnVal);
+    JsonResponseDecoder decoder(wbddcResponse);
+    bool decodeMatch = decoder.isValid() &&
+            (decoder.getInt("result.filter") == returnVal["result"]["filter"].asInt()) &&
+            (decoder.getUInt("result.vita") == returnVal["result"]["vita"].asUInt()) &&
+            (decoder.getString("result.rfch") == returnVal["result"]["rfch"].asString()) &&
+            (decoder.getString("result.type") == returnVal["result"]["type"].asString()) &&
+            (decoder.getBool("success") == returnVal["success"].asBool());
+
+    // Full command path: encode, send, receive the matching response, and
+    // read the fields back, one command at a time and then pipelined
+    int roundTrips = std::max(iterations / 20, 1);
+    double singleTrip = 0.0;
+    double batchTrip = 0.0;
+    int tripsOk = 0;
+    int port = 0;
+    int responder = openResponder(port);
+    boost::atomic<bool> stop(false);
+    boost::thread responderThread;
+    RadioTransport transport(true, false);
+    if ( (responder >= 0) && transport.connect("udp", "127.0.0.1", port) )
+    {
+        responderThread = boost::thread(respond, responder, &stop);
+        start = Clock::now();
+        for (int i = 0; i < roundTrips; i++)
+        {
+            JsonCommandEncoder& command = JsonCommandEncoder::local();
+            command.begin("qwbddc", i).param("id", 1);
+            if ( !transport.sendCommand(command.str(), true, command.msgId()) )
+                continue;
+            BasicStringList rsp = transport.receive(1.0);
+            if ( rsp.empty() )
+                continue;
+            JsonResponseDecoder returnVal(rsp.front());
+            if ( returnVal.getBool("success") &&
+                 (returnVal.getUInt("msg") == (unsigned int)i) )
+                tripsOk++;
+            sink += returnVal.getUInt("result.vita");
+        }
+        singleTrip = nsPerOp(start, roundTrips);
+        BasicStringList cmds;
+        std::vector<int64_t> ids;
+        for (int i = 0; i < roundTrips; i++)
+        {
+            JsonCommandEncoder& command = JsonCommandEncoder::local();
+            command.begin("qwbddc", roundTrips + i).param("id", 1);
+            cmds.push_back(command.str());
+            ids.push_back(command.msgId());
+        }
+        start = Clock::now();
+        std::vector<BasicStringList> rsps = transport.sendCommandBatch(cmds, 1.0, ids);
+        for (size_t i = 0; i < rsps.size(); i++)
+        {
+            if ( rsps[i].empty() )
+                continue;
+            JsonResponseDecoder returnVal(rsps[i].front());
+            if ( returnVal.getBool("success") &&
+                 (returnVal.getUInt("msg") == (unsigned int)ids[i]) )
+                tripsOk++;
+            sink += returnVal.getUInt("result.vita");
+        }
+        batchTrip = nsPerOp(start, roundTrips);
+        transport.disconnect();
+        stop = true;
+        responderThread.join();
+    }
+    if ( responder >= 0 )
+        close(responder);
+    bool tripsMatch = ( tripsOk == 2 * roundTrips );
+
+    printf("%d iterations\n", iterations);
+    printf("encode: jsoncpp %8.1f ns  codec %8.1f ns  (%.1fx)  %s\n",
+            jsoncppEncode, codecEncode, jsoncppEncode / codecEncode,
+            encodeMatch ? "match" : "MISMATCH");
+    printf("decode: jsoncpp %8.1f ns  codec %8.1f ns  (%.1fx)  %s\n",
+            jsoncppDecode, codecDecode, jsoncppDecode / codecDecode,
+            decodeMatch ? "match" : "MISMATCH");
+    printf("round trip (%d commands): single %8.1f us  batched %8.1f us  %s\n",
+            roundTrips, singleTrip / 1000.0, batchTrip / 1000.0,
+            tripsMatch ? "match" : "MISMATCH");
+    return ( encodeMatch && decodeMatch && tripsMatch && (sink != 0) ) ? 0 : 1;
+}
@@ -0,0 +1,165 @@
+/************************************************************************
+ * \file ndr651_credit_stress.cpp
+ * \brief Stress test for UdpStatusReceiver flow-control credit: several
+ *    sender threads reserve and settle credit concurrently on two
+ *    receivers while a status thread per receiver plays the radio,
+ *    draining a simulated DUC and reporting its free space.  Credit must
+ *    never go negative, and once the DUCs drain it must return in full.
+ * \author DA
+ * \copyright Copyright (c) 2015-2021 CyberRadio Solutions, Inc.  All rights
+ *    reserved.
+ */
+
+#include "LibCyberRadio/NDR651/UdpStatusReceiver.h"
+#include "LibCyberRadio/NDR651/PacketTypes.h"
+#include <boost/atomic.hpp>
+#include <boost/thread.hpp>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+using LibCyberRadio::NDR651::UdpStatusReceiver;
+
+// Feeds a receiver a periodic (DUCHS) status frame
+static void reportSpace(UdpStatusReceiver& rx, long long spaceAvailable)
+{
+    struct LibCyberRadio::NDR651::TxStatusFrame status;
+    memset(&status, 0, sizeof(status));
+    status.status.spaceAvailable = spaceAvailable;
+    status.status.PP = 1;
+    rx.processStatusFrame(&status);
+}
+
+// One DUC as the status thread sees it: what the senders have put on the
+// wire, and the lowest credit seen while they ran
+struct DucSim
+{
+    UdpStatusReceiver* rx;
+    boost::atomic<long long> sent;
+    boost::atomic<long int> minCredit;
+};
+
+// Records the receiver's credit if it is the lowest seen so far
+static void noteCredit(DucSim* duc)
+{
+    long int credit = duc->rx->getFreeSpace();
+    long int lowest = duc->minCredit.load();
+    while ((credit < lowest) && !duc->minCredit.compare_exchange_weak(lowest, credit))
+    {
+    }
+}
+
+// Each sender reserves a frame's credit on the first receiver, then on
+// the second, before settling either, so a reservation recorded against
+// the wrong receiver shows up in the final counts.  A frame counts as
+// sent once it is on the wire, before it is settled.
+static void sender(DucSim* ducA, DucSim* ducB, long int samplesPerFrame,
+        long long samplesEach)
+{
+    long long leftA = samplesEach, leftB = samplesEach;
+    while ((leftA > 0) || (leftB > 0))
+    {
+        bool haveA = (leftA > 0) && ducA->rx->okToSend(samplesPerFrame, true);
+        bool haveB = (leftB > 0) && ducB->rx->okToSend(samplesPerFrame, true);
+        if (haveA)
+        {
+            ducA->sent.fetch_add(samplesPerFrame);
+            ducA->rx->sentNSamples(samplesPerFrame);
+            noteCredit(ducA);
+            leftA -= samplesPerFrame;
+        }
+        if (haveB)
+        {
+            ducB->sent.fetch_add(samplesPerFrame);
+            ducB->rx->sentNSamples(samplesPerFrame);
+            noteCredit(ducB);
+            leftB -= samplesPerFrame;
+        }
+        if (!haveA && !haveB)
+        {
+            boost::this_thread::yield();
+        }
+    }
+}
+
+// Plays the radio for one DUC: drains drainPerUpdate samples between
+// status frames and reports the space left, while the senders run
+static void statusUpdater(DucSim* duc, long long drainPerUpdate,
+        boost::atomic<bool>* running)
+{
+    long long drained = 0;
+    while (*running)
+    {
+        drained = std::min(duc->sent.load(), drained + drainPerUpdate);
+        reportSpace(*duc->rx, MAX_RADIO_BUFFSIZE - (duc->sent.load() - drained));
+        noteCredit(duc);
+        boost::this_thread::sleep_for(boost::chrono::microseconds(100));
+    }
+}
+
+// After the senders stop, the DUC plays out: a status frame for an empty
+// DUC must restore all of the credit, with no reservation left behind.
+static bool checkReceiver(const char* name, DucSim& duc, long int initial,
+        long long expected)
+{
+    reportSpace(*duc.rx, MAX_RADIO_BUFFSIZE);
+    long int remaining = duc.rx->getFreeSpace();
+    bool ok = (duc.minCredit.load() >= 0) && (duc.sent.load() == expected) &&
+            (remaining == initial);
+    printf("  %s: sent %lld of %lld, lowest credit %ld, credit after drain %ld of %ld -- %s\n",
+            name, duc.sent.load(), expected, duc.minCredit.load(),
+            remaining, initial, ok ? "OK" : "MISMATCH");
+    return ok;
+}
+
+int main(int argc, char* argv[])
+{
+    int numThreads = ( argc > 1 ) ? atoi(argv[1]) : 8;
+    int rounds = ( argc > 2 ) ? atoi(argv[2]) : 10;
+    long int samplesPerFrame = ( argc > 3 ) ? atol(argv[3]) : 1024;
+    // Each sender pushes this many frames to each DUC per round
+    long long framesEach = ( argc > 4 ) ? atoll(argv[4]) : 2000;
+
+    // Port 0: no socket, credit comes from processStatusFrame()
+    UdpStatusReceiver rxA("lo", 0, false, false);
+    UdpStatusReceiver rxB("lo", 0, false, false);
+    // A shallow target occupancy keeps the senders up against the credit
+    // limit, where status frames race with reservations
+    rxA.setTargetOccupancy(64 * samplesPerFrame);
+    rxB.setTargetOccupancy(64 * samplesPerFrame);
+    bool ok = true;
+    for (int round = 0; round < rounds; round++)
+    {
+        reportSpace(rxA, MAX_RADIO_BUFFSIZE);
+        reportSpace(rxB, MAX_RADIO_BUFFSIZE);
+        long int initialA = rxA.getFreeSpace();
+        long int initialB = rxB.getFreeSpace();
+        DucSim ducA, ducB;
+        ducA.rx = &rxA;
+        ducB.rx = &rxB;
+        ducA.sent = ducB.sent = 0;
+        ducA.minCredit = initialA;
+        ducB.minCredit = initialB;
+        boost::atomic<bool> running(true);
+        boost::thread_group updaters, senders;
+        // The two DUCs drain at different rates
+        updaters.create_thread(boost::bind(&statusUpdater, &ducA, 8 * samplesPerFrame, &running));
+        updaters.create_thread(boost::bind(&statusUpdater, &ducB, 3 * samplesPerFrame, &running));
+        for (int i = 0; i < numThreads; i++)
+        {
+            senders.create_thread(boost::bind(&sender, &ducA, &ducB,
+                    samplesPerFrame, framesEach * samplesPerFrame));
+        }
+        senders.join_all();
+        running = false;
+        updaters.join_all();
+        long long expected = numThreads * framesEach * samplesPerFrame;
+        printf("Round %d (%d senders):\n", round + 1, numThreads);
+        ok = checkReceiver("receiver A", ducA, initialA, expected) && ok;
+        ok = checkReceiver("receiver B", ducB, initialB, expected) && ok;
+    }
+    printf("%s\n", ok ? "PASSED" : "FAILED");
+    return ok ? 0 : 1;
+}
@@ -126,14 +126,24 @@ int main(int argc, char **argv) {
     //~ tx->setDucTxinvMode(txinvMode);
     tx->start(); // start flow control thread
     std::cout << "Started transmitter!" << std::endl;
-    while (keep_looping && tx->isReadyToReceive()) {
-        while (keep_looping && (tx->sendFrame(sampleBuffer[row])>0)) {
-            // if the # of samples sent is greater than 0, move to the next row
-            row = (row+1)%period;
+    // Register the precomputed frames once; the packetizer loops them
+    // without copying sample data again.
+    if (tx->setCyclicWaveform(&sampleBuffer[0][0], period*SAMPLES_PER_FRAME) &&
+            tx->startCyclicTransmit()) {
+        while (keep_looping && tx->isReadyToReceive()) {
+            usleep(1e4);
+        }
+        tx->stopCyclicTransmit();
+    } else {
+        while (keep_looping && tx->isReadyToReceive()) {
+            while (keep_looping && (tx->sendFrame(sampleBuffer[row])>0)) {
+                // if the # of samples sent is greater than 0, move to the next row
+                row = (row+1)%period;
+            }
+            // If no samples have been sent, then the DUC's buffer is full
+            // Let's wait a while...
+            usleep(1e4);
         }
-        // If no samples have been sent, then the DUC's buffer is full
-        // Let's wait a while...
-        usleep(1e4);
     }
     std::cout << "tx->stop();..." << std::endl;
     //~ tx->setDuchsParameters(0, 0, 0, false);
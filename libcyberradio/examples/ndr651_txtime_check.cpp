@@ -0,0 +1,88 @@
+/************************************************************************
+ * \file ndr651_txtime_check.cpp
+ * \brief Checks launch-time (SO_TXTIME) scheduling on a transmit
+ *    interface: sends frames through a TransmitSocket with launch-time
+ *    scheduling enabled, half of them with launch times already in the
+ *    past, and reports the drops the qdisc returns on the socket's error
+ *    queue.
+ *
+ * The interface needs the etf qdisc (for example, under mqprio) for drops
+ * to be reported.  Without it, frames go out immediately and no drops
+ * are reported.  Run as root to send raw Ethernet frames, as the NDR651
+ * transmit path does; otherwise frames go out as UDP broadcasts.
+ * \author DA
+ * \copyright Copyright (c) 2015-2021 CyberRadio Solutions, Inc.  All rights
+ *    reserved.
+ */
+
+#include "LibCyberRadio/NDR651/TransmitSocket.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <unistd.h>
+
+using LibCyberRadio::NDR651::TransmitSocket;
+
+int main(int argc, char* argv[])
+{
+    if ( argc < 2 )
+    {
+        printf("Usage: %s <interface> [frames] [offset (us)] [tai|mono]\n", argv[0]);
+        return 2;
+    }
+    std::string ifname = argv[1];
+    int frames = ( argc > 2 ) ? atoi(argv[2]) : 1000;
+    long long offsetNs = 1000LL * (( argc > 3 ) ? atoll(argv[3]) : 1000);
+    clockid_t clockId = ( (argc > 4) && (strcmp(argv[4], "mono") == 0) ) ?
+            CLOCK_MONOTONIC : CLOCK_TAI;
+
+    TransmitSocket sock(ifname, 4991);
+    if ( !sock.setTxTime(true, clockId) )
+    {
+        printf("Could not enable SO_TXTIME on %s\n", ifname.c_str());
+        return 1;
+    }
+    // A broadcast frame with a local experimental EtherType, so that
+    // nothing on the segment acts on it
+    std::vector<unsigned char> frame(256, 0);
+    unsigned char* payload = &frame[0];
+    int frameLen = (int)frame.size();
+    if ( sock.isUsingRawSocket() )
+    {
+        memset(&frame[0], 0xff, 6);
+        frame[12] = 0x88;
+        frame[13] = 0xb5;
+    }
+    else
+    {
+        payload += 14;
+        frameLen -= 14;
+    }
+    int sent = 0, late = 0;
+    for (int i = 0; i < frames; i++)
+    {
+        // Every other frame has already missed its launch time
+        bool missed = ( (i % 2) == 1 );
+        uint64_t launch = sock.getTxTimeNow() + offsetNs;
+        if ( missed )
+            launch -= 1000000000ULL;
+        if ( sock.sendFrame(payload, frameLen, launch) )
+        {
+            sent++;
+            if ( missed )
+                late++;
+        }
+    }
+    // Let the qdisc release or drop what it is holding before collecting
+    // the errors it reported
+    usleep(100000 + offsetNs / 1000);
+    unsigned long dropped = sock.getTxTimeDropCount();
+    printf("Sent %d frames on %s (%s socket), %d with missed launch times\n",
+            sent, ifname.c_str(), sock.isUsingRawSocket() ? "raw" : "UDP", late);
+    printf("Launch-time drops reported: %lu\n", dropped);
+    if ( dropped == 0 )
+        printf("No drops reported: is the etf qdisc set up on %s?\n", ifname.c_str());
+    return 0;
+}
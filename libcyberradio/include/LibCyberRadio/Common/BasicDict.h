@@ -27,6 +27,8 @@ namespace LibCyberRadio
     typedef BASIC_DICT_CONTAINER<std::string, std::string> BasicStringStringDict;
     /*! \brief Type representing a dictionary of integers, keyed by string values. */
     typedef BASIC_DICT_CONTAINER<std::string, int> BasicStringIntDict;
+    /*! \brief Type representing a dictionary of doubles, keyed by string values. */
+    typedef BASIC_DICT_CONTAINER<std::string, double> BasicStringDoubleDict;
     /*! \brief Type representing a dictionary of strings, keyed by integer values. */
     typedef BASIC_DICT_CONTAINER<int, std::string> BasicIntStringDict;
     /*! \brief Type representing a dictionary of integers, keyed by integer values. */
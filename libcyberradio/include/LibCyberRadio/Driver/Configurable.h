@@ -13,8 +13,10 @@
 #define INCLUDED_LIBCYBERRADIO_DRIVER_CONFIGURABLE_H
 
 #include "LibCyberRadio/Common/BasicDict.h"
+#include "LibCyberRadio/Common/BasicList.h"
 #include "LibCyberRadio/Common/Debuggable.h"
 #include "LibCyberRadio/Driver/ConfigString.h"
+#include <boost/chrono.hpp>
 #include <string>
 #include <ostream>
 
@@ -166,6 +168,19 @@ namespace LibCyberRadio
                  * \returns True if successful, false otherwise.
                  */
                 virtual bool setConfiguration(ConfigurationDict& cfg);
+                /**
+                 * \brief Checks an incoming configuration dictionary against
+                 *    the settings this object supports, without applying it.
+                 *
+                 * The default behavior rejects keys that are not in the
+                 * configuration dictionary.  Derived classes should override
+                 * this to check values against their known ranges.
+                 *
+                 * \param cfg The configuration dictionary.
+                 * \returns An empty string if the dictionary is valid;
+                 *    otherwise, a description of the first problem found.
+                 */
+                virtual std::string validateConfiguration(const ConfigurationDict& cfg) const;
                 /**
                  * \brief Sets a named configuration value to a string.
                  * \note The default behavior of this method is to normalize the
@@ -221,8 +236,100 @@ namespace LibCyberRadio
                  * hardware commands to determine initial configuration.
                  */
                 virtual void queryConfiguration();
+                /**
+                 * \brief Queries the object's configuration from the hardware now,
+                 *    and marks the cached state as current.
+                 */
+                virtual void refresh();
+                /**
+                 * \brief Marks the cached state as out of date.
+                 *
+                 * For an object in lazy query mode, the next read of its state
+                 * queries the hardware.
+                 */
+                virtual void invalidate();
+                /**
+                 * \brief Sets whether the object queries its state on demand.
+                 *
+                 * In lazy query mode, reading the object's configuration (or one of
+                 * its state values) queries the hardware if the cached state has
+                 * never been queried, has been invalidated, or is older than the
+                 * time-to-live.
+                 * \param lazy Whether to query state on demand.
+                 * \param ttl Time-to-live for cached state, in seconds.  If this is
+                 *    zero or less, cached state does not expire.
+                 */
+                virtual void setLazyQuery(bool lazy, double ttl = 0.0);
+                /**
+                 * \brief Gets whether the object queries its state on demand.
+                 * \returns True if in lazy query mode, false otherwise.
+                 */
+                virtual bool isLazyQuery() const;
+                /**
+                 * \brief Gets whether the cached state is current.
+                 * \returns True if the state has been queried, has not been
+                 *    invalidated, and has not expired; false otherwise.
+                 */
+                virtual bool isStateCurrent() const;
 
             protected:
+                /**
+                 * \brief Queries the object's state if it is in lazy query mode
+                 *    and its cached state is not current.
+                 *
+                 * Derived classes should call this at the start of methods that
+                 * report hardware state, and of setters whose command resends
+                 * other settings from the cached state.
+                 */
+                virtual void ensureState() const;
+                /**
+                 * \brief Gets the part of an incoming configuration dictionary
+                 *    that differs from the object's current state.
+                 *
+                 * Derived classes should call this in setConfiguration() before
+                 * the base-class version updates the state, and apply only the
+                 * returned keys, so that settings that do not change cost no
+                 * hardware commands.  If the cached state is not current,
+                 * every key is returned; call invalidate() to force a full
+                 * apply.
+                 *
+                 * \param cfg The incoming configuration dictionary.
+                 * \returns The normalized dictionary of changed keys.
+                 */
+                virtual ConfigurationDict changedConfiguration(
+                        const ConfigurationDict& cfg);
+                /**
+                 * \brief Checks that a numeric setting in an incoming
+                 *    configuration dictionary lies within a range.
+                 *
+                 * Settings that are absent or unchanged from the current state
+                 * always pass, as do all settings if the range is empty
+                 * (minimum not below maximum).
+                 *
+                 * \param cfg The configuration dictionary.
+                 * \param key The key of the setting to check.
+                 * \param min The minimum allowed value.
+                 * \param max The maximum allowed value.
+                 * \returns An empty string if the setting is valid; otherwise,
+                 *    a description of the problem.
+                 */
+                std::string validateRange(const ConfigurationDict& cfg,
+                        const std::string& key, double min, double max) const;
+                /**
+                 * \brief Checks that an integer setting in an incoming
+                 *    configuration dictionary is one of a set of choices.
+                 *
+                 * Settings that are absent or unchanged from the current state
+                 * always pass, as do all settings if there are no choices.
+                 *
+                 * \param cfg The configuration dictionary.
+                 * \param key The key of the setting to check.
+                 * \param choices The allowed values.
+                 * \returns An empty string if the setting is valid; otherwise,
+                 *    a description of the problem.
+                 */
+                std::string validateChoice(const ConfigurationDict& cfg,
+                        const std::string& key, const BasicIntList& choices) const;
                 /**
                  * \brief Initializes the configuration dictionary, defining the allowed
                  *    keys.
@@ -272,6 +379,12 @@ namespace LibCyberRadio
                 std::string _name;
                 // Configuration dictionary
                 ConfigurationDict _config;
+                // Cached state tracking
+                bool _lazyQuery;
+                double _stateTtl;
+                bool _stateValid;
+                bool _refreshing;
+                boost::chrono::steady_clock::time_point _stateTime;
 
         }; // class Configurable
 
@@ -42,9 +42,19 @@ namespace LibCyberRadio
          * This method supports automatically connecting to the specified
          * radio device.  Setting \c device to the device name (network
          * host name/IP address or serial device) -- and \c devicePort
-         * if necessary -- activates this functionality.
+         * if necessary -- activates this functionality.  Connecting gives
+         * up after \c connectTimeout, so a radio that is powered off does
+         * not hold up the caller for the system's TCP timeout.  If the
+         * radio supports more than one connection mode, all of them are
+         * probed at once, and the first one that answers is used.
          *
-         * \param nameString A name string identifying the radio type.
+         * Setting \c nameString to "auto" detects the radio type.  The
+         * device is probed for every supported radio type at once, and
+         * the first radio type named in an identity response ("*IDN?" for
+         * command-line radios, "qstatus" for JSON radios) is used.
+         *
+         * \param nameString A name string identifying the radio type, or
+         *     "auto" to detect the radio type.
          * \param device Device name [string].  This is either a host name/
          *     IP address (for network devices) or a serial device name (for
          *     USB-connected radios).
@@ -54,6 +64,9 @@ namespace LibCyberRadio
          *     default for the radio handler.
          * \param debug Whether or not the radio handler creates debug output
          *     [Boolean].
+         * \param connectTimeout Deadline for connecting to the radio, in
+         *     seconds.  If this is negative, connecting blocks until the
+         *     system gives up.
          *
          * \returns A shared pointer referring to the radio handler object.
          *    Returns NULL if an appropriate radio handler cannot be
@@ -63,7 +76,8 @@ namespace LibCyberRadio
                     const std::string& nameString,
                     const std::string& device = "",
                     int devicePort = -1,
-                    bool debug = false
+                    bool debug = false,
+                    double connectTimeout = 5.0
                 );
         std::vector<std::string> getSupportedDevices( void );
 
@@ -138,6 +138,14 @@ namespace LibCyberRadio
                  * \returns True if successful, false otherwise.
                  */
                 virtual bool setConfiguration(ConfigurationDict& cfg);
+                /**
+                 * \brief Checks a configuration dictionary for this component
+                 *    against its supported settings and ranges.
+                 * \param cfg The component configuration dictionary.
+                 * \returns An empty string if valid; otherwise, a description
+                 *    of the first problem found.
+                 */
+                virtual std::string validateConfiguration(const ConfigurationDict& cfg) const;
                 /**
                  * \brief Tells the component to query its hardware configuration in
                  *    order to create its configuration dictionary.
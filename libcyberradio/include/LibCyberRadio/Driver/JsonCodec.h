@@ -0,0 +1,271 @@
+/***************************************************************************
+ * \file JsonCodec.h
+ * \brief Defines a lightweight encoder for JSON radio commands and a
+ *    decoder for JSON radio responses.
+ * \author DA
+ * \copyright (c) 2018 CyberRadio Solutions, Inc.  All rights reserved.
+ *
+ * \note Requires C++11 compiler support.
+ *
+ ***************************************************************************/
+
+#ifndef INCLUDED_LIBCYBERRADIO_DRIVER_JSONCODEC_H
+#define INCLUDED_LIBCYBERRADIO_DRIVER_JSONCODEC_H
+
+#include <cstdint>
+#include <string>
+
+
+/**
+ * \brief Provides programming elements for controlling CyberRadio Solutions products.
+ */
+namespace LibCyberRadio
+{
+    /**
+     * \brief Provides programming elements for driving CRS NDR-class radios.
+     */
+    namespace Driver
+    {
+        /**
+         * \brief Writes JSON radio commands into a reusable buffer.
+         *
+         * JSON radio commands all share one shape:
+         * <pre>
+         * {"cmd":"tuner","msg":1234,"params":{"id":1,"freq":1000000000.0}}
+         * </pre>
+         * The encoder writes that text directly, without building a
+         * Json::Value tree, and keeps its buffer between commands, so
+         * encoding a command does not allocate once the buffer has grown
+         * to fit.
+         *
+         * Usage:
+         * <pre>
+         * JsonCommandEncoder& enc = JsonCommandEncoder::local();
+         * enc.begin("tuner", msgId).param("id", index).param("freq", freq);
+         * BasicStringList rsp = parent->sendCommand(enc.str());
+         * </pre>
+         *
+         * The text returned by str() ends in a newline, as Json::FastWriter
+         * output does.
+         */
+        class JsonCommandEncoder
+        {
+            public:
+                /**
+                 * \brief Constructs a JsonCommandEncoder object.
+                 */
+                JsonCommandEncoder();
+                /**
+                 * \brief Gets the encoder for the calling thread.
+                 *
+                 * Each thread has its own encoder, so components can encode
+                 * commands from any thread without sharing a buffer.
+                 * \returns A reference to the calling thread's encoder.
+                 */
+                static JsonCommandEncoder& local();
+                /**
+                 * \brief Starts a new command, discarding the previous one.
+                 * \param cmd The command name.  If NULL, the command has no
+                 *    "cmd" member.
+                 * \param msg The message ID.
+                 * \returns A reference to this encoder.
+                 */
+                JsonCommandEncoder& begin(const char* cmd, uint32_t msg);
+                /**
+                 * \brief Adds a top-level member to the command.
+                 *
+                 * Top-level members must be added before any parameters.
+                 * \param key The member name.
+                 * \param value The member value.
+                 * \returns A reference to this encoder.
+                 */
+                JsonCommandEncoder& field(const char* key, int value);
+                /**
+                 * \brief Adds a top-level member to the command.
+                 * \param key The member name.
+                 * \param value The member value.
+                 * \returns A reference to this encoder.
+                 */
+                JsonCommandEncoder& field(const char* key, unsigned int value);
+                /**
+                 * \brief Adds a top-level member to the command.
+                 * \param key The member name.
+                 * \param value The member value.
+                 * \returns A reference to this encoder.
+                 */
+                JsonCommandEncoder& field(const char* key, const std::string& value);
+                /**
+                 * \brief Adds an integer parameter to the command.
+                 * \param key The parameter name.
+                 * \param value The parameter value.
+                 * \returns A reference to this encoder.
+                 */
+                JsonCommandEncoder& param(const char* key, int value);
+                /**
+                 * \brief Adds an unsigned integer parameter to the command.
+                 * \param key The parameter name.
+                 * \param value The parameter value.
+                 * \returns A reference to this encoder.
+                 */
+                JsonCommandEncoder& param(const char* key, unsigned int value);
+                /**
+                 * \brief Adds a floating-point parameter to the command.
+                 * \param key The parameter name.
+                 * \param value The parameter value.
+                 * \returns A reference to this encoder.
+                 */
+                JsonCommandEncoder& param(const char* key, double value);
+                /**
+                 * \brief Adds a Boolean parameter to the command.
+                 * \param key The parameter name.
+                 * \param value The parameter value.
+                 * \returns A reference to this encoder.
+                 */
+                JsonCommandEncoder& param(const char* key, bool value);
+                /**
+                 * \brief Adds a string parameter to the command.
+                 * \param key The parameter name.
+                 * \param value The parameter value.
+                 * \returns A reference to this encoder.
+                 */
+                JsonCommandEncoder& param(const char* key, const char* value);
+                /**
+                 * \brief Adds a string parameter to the command.
+                 * \param key The parameter name.
+                 * \param value The parameter value.
+                 * \returns A reference to this encoder.
+                 */
+                JsonCommandEncoder& param(const char* key, const std::string& value);
+                /**
+                 * \brief Gets the message ID of the current command.
+                 * \returns The message ID passed to begin().
+                 */
+                uint32_t msgId() const;
+                /**
+                 * \brief Finishes the command.
+                 * \returns The command text.  It remains valid until the next
+                 *    call to begin().
+                 */
+                const std::string& str();
+
+            protected:
+                // Writes a member name (with its leading comma, if needed)
+                void writeKey(const char* key, bool first);
+                // Opens the parameter object, if it is not already open
+                void openParams();
+                // Writes a JSON string literal
+                void writeString(const char* value, size_t len);
+                // Writes an integer
+                void writeInt(long long value);
+
+            protected:
+                // Command text
+                std::string _buf;
+                // Message ID of the current command
+                uint32_t _msg;
+                // Whether the parameter object has been opened
+                bool _inParams;
+                // Whether the parameter object has any members yet
+                bool _hasParams;
+                // Whether str() has closed the command
+                bool _closed;
+        };
+
+        /**
+         * \brief Extracts values from a JSON radio response in place.
+         *
+         * The decoder scans the response text for the requested member
+         * each time a value is asked for, rather than parsing the whole
+         * response into a Json::Value tree.  Members are named by dotted
+         * paths, such as "result.freq".  Missing members yield the default
+         * value passed in, and numeric accessors accept numbers written as
+         * strings (and vice versa), so the decoder does not throw.
+         *
+         * The decoder refers to the response text; the text must outlive
+         * the decoder.
+         */
+        class JsonResponseDecoder
+        {
+            public:
+                /**
+                 * \brief Constructs a JsonResponseDecoder object.
+                 * \param text The response text.
+                 */
+                JsonResponseDecoder(const std::string& text);
+                /**
+                 * \brief Gets whether the response is a well-formed JSON object.
+                 * \returns True if the response is valid, false otherwise.
+                 */
+                bool isValid() const;
+                /**
+                 * \brief Gets whether the response has a given member.
+                 * \param path Dotted path to the member.
+                 * \returns True if the member exists, false otherwise.
+                 */
+                bool has(const char* path) const;
+                /**
+                 * \brief Gets whether a member of the response is a string.
+                 * \param path Dotted path to the member.
+                 * \returns True if the member exists and is a string, false
+                 *    otherwise.
+                 */
+                bool isString(const char* path) const;
+                /**
+                 * \brief Gets a Boolean member.
+                 * \param path Dotted path to the member.
+                 * \param defVal Value to return if the member is missing.
+                 * \returns The member value.
+                 */
+                bool getBool(const char* path, bool defVal = false) const;
+                /**
+                 * \brief Gets an integer member.
+                 * \param path Dotted path to the member.
+                 * \param defVal Value to return if the member is missing.
+                 * \returns The member value.
+                 */
+                int getInt(const char* path, int defVal = 0) const;
+                /**
+                 * \brief Gets an unsigned integer member.
+                 * \param path Dotted path to the member.
+                 * \param defVal Value to return if the member is missing.
+                 * \returns The member value.
+                 */
+                unsigned int getUInt(const char* path, unsigned int defVal = 0) const;
+                /**
+                 * \brief Gets a floating-point member.
+                 * \param path Dotted path to the member.
+                 * \param defVal Value to return if the member is missing.
+                 * \returns The member value.
+                 */
+                double getDouble(const char* path, double defVal = 0.0) const;
+                /**
+                 * \brief Gets a string member.
+                 *
+                 * A member that is not a string yields its JSON text, so
+                 * numbers come back in their written form.
+                 * \param path Dotted path to the member.
+                 * \param defVal Value to return if the member is missing.
+                 * \returns The member value.
+                 */
+                std::string getString(const char* path,
+                        const std::string& defVal = "") const;
+
+            protected:
+                // Finds the start of a member's value, or NULL
+                const char* find(const char* path) const;
+                // Finds the start of a member's value, or NULL.  Copies the
+                // text of a string value (less its quotes and escapes) into
+                // buf, so numbers written as strings can be converted.
+                const char* findScalar(const char* path, char* buf, size_t len) const;
+
+            protected:
+                // Response text
+                const char* _begin;
+                const char* _end;
+        };
+
+    } /* namespace Driver */
+
+} /* namespace LibCyberRadio */
+
+#endif /* INCLUDED_LIBCYBERRADIO_DRIVER_JSONCODEC_H */
@@ -184,10 +184,6 @@ namespace LibCyberRadio
                     virtual RadioHandler& operator=(const RadioHandler& other);
                     // OVERRIDE
                     virtual void queryConfiguration();
-                    /**
-                     * \brief Returns a Time for the msg parameter
-                     */
-                    uint32_t getMessageId( void );
 
                 protected:
                     // OVERRIDE
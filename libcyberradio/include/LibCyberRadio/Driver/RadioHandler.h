@@ -25,8 +25,22 @@
 #include "LibCyberRadio/Driver/VitaIfSpec.h"
 #include "LibCyberRadio/Driver/WbddcComponent.h"
 #include "LibCyberRadio/Driver/WbddcGroupComponent.h"
+#include <boost/atomic.hpp>
+#include <boost/chrono.hpp>
+#include <boost/function.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/future.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/thread/tss.hpp>
 #include <cstdint>
+#include <deque>
+#include <map>
+#include <set>
 #include <string>
+#include <utility>
+#include <vector>
 
 
 /**
@@ -39,6 +53,37 @@ namespace LibCyberRadio
      */
     namespace Driver
     {
+        /**
+         * \brief Result of a command sent asynchronously.
+         */
+        struct AsyncCommandResult
+        {
+            /**
+             * \brief Response strings from the radio, without the command echo.
+             */
+            BasicStringList response;
+            /**
+             * \brief Error info for the command; empty if it succeeded.
+             */
+            std::string errorInfo;
+        };
+
+        /**
+         * \brief Future for the result of a command sent asynchronously.
+         */
+        typedef boost::shared_future<AsyncCommandResult> AsyncCommandFuture;
+
+        /**
+         * \brief Callback invoked with the result of a command sent
+         *    asynchronously.
+         */
+        typedef boost::function<void (const AsyncCommandResult&)> AsyncCommandCallback;
+
+        /**
+         * \brief Future for the success of a setter run asynchronously.
+         */
+        typedef boost::shared_future<bool> AsyncSetterFuture;
+
         /**
          * \brief Generic radio handler class.
          *
@@ -160,16 +205,123 @@ namespace LibCyberRadio
                  * \brief Disconnects from the radio.
                  */
                 virtual void disconnect();
+                /**
+                 * \brief Sets the deadline for connecting to the radio.
+                 *
+                 * Connecting to a radio that does not answer fails once the
+                 * deadline passes, rather than waiting for the system's TCP
+                 * timeout.  The deadline applies to the primary connection
+                 * and to any extra query connections.
+                 * \param timeout Deadline in seconds.  If this is negative,
+                 *    connecting blocks until the system gives up.
+                 */
+                virtual void setConnectTimeout(double timeout);
+                /**
+                 * \brief Gets the deadline for connecting to the radio.
+                 * \returns Deadline in seconds.
+                 */
+                virtual double getConnectTimeout() const;
+                /**
+                 * \brief Checks whether a radio of this type answers on a
+                 *    given connection.
+                 *
+                 * The probe opens its own connection, so it does not disturb
+                 * the handler's connection, and several probes may run at
+                 * once from different threads.  It asks the radio for its
+                 * identity ("*IDN?" for command-line radios, "qstatus" for
+                 * JSON radios) and succeeds if the radio answers before the
+                 * deadline.
+                 * \param mode Connection mode. One of "tcp", "udp", or "tty".
+                 * \param host_or_dev Either the host name or IP address (TCP/UDP) or
+                 *    the serial device name (TTY).
+                 * \param port_or_baudrate Either the port number (TCP/UDP) or the
+                 *    serial baud rate (TTY).
+                 * \param timeout Deadline for the whole probe, in seconds.
+                 * \param identity Set to the radio's identity response: the
+                 *    lines of the "*IDN?" response, or the model reported by
+                 *    "qstatus".
+                 * \returns True if the radio answered, false otherwise.
+                 */
+                virtual bool probeConnection(
+                        const std::string& mode,
+                        const std::string& host_or_dev,
+                        int port_or_baudrate,
+                        double timeout,
+                        std::string& identity
+                );
                 /**
                  * \brief Sends a command to the radio.
                  * \param cmdString The command string.
                  * \param timeout Timeout value (seconds). If this is -1, use the transport's
                  *    default timeout.
+                 * \param msgId The message ID carried by a JSON command, which the
+                 *    response is matched against.  If this is -1, the command has
+                 *    no message ID.
                  * \returns A list of response strings from the radio.
                  */
                 virtual BasicStringList sendCommand(
                         const std::string& cmdString,
-                        double timeout = -1
+                        double timeout = -1,
+                        int64_t msgId = -1
+                );
+                /**
+                 * \brief Sends a batch of commands to the radio.
+                 *
+                 * Where the transport supports it (command-line protocol over
+                 * TCP), the commands are pipelined: written in one send, with
+                 * responses split on the prompt boundaries.  Otherwise they are
+                 * sent one at a time.  The last command error info is set to the
+                 * first error encountered in the batch.
+                 * \param cmds The command strings.
+                 * \param timeout Timeout value (seconds) for each response. If
+                 *    this is -1, use the transport's default timeout.
+                 * \param msgIds The message ID carried by each JSON command, as
+                 *    for sendCommand().
+                 * \returns One list of response strings per command, in command
+                 *    order.
+                 */
+                virtual std::vector<BasicStringList> sendCommands(
+                        const BasicStringList& cmds,
+                        double timeout = -1,
+                        const std::vector<int64_t>& msgIds = std::vector<int64_t>()
+                );
+                /**
+                 * \brief Sends a command to the radio without waiting for the
+                 *    response.
+                 *
+                 * The command is queued for the radio handler's I/O thread,
+                 * which is started on first use.  Where the transport supports
+                 * it, commands queued together are pipelined in one batch.
+                 * \param cmdString The command string.
+                 * \param timeout Timeout value (seconds). If this is -1, use the
+                 *    transport's default timeout.
+                 * \param msgId The message ID carried by a JSON command, as for
+                 *    sendCommand().
+                 * \returns A future for the command result.
+                 */
+                virtual AsyncCommandFuture sendCommandAsync(
+                        const std::string& cmdString,
+                        double timeout = -1,
+                        int64_t msgId = -1
+                );
+                /**
+                 * \brief Sends a command to the radio without waiting for the
+                 *    response, invoking a callback with the result.
+                 *
+                 * The callback runs on the I/O thread, so it should return
+                 * quickly and must not wait on other asynchronous results.
+                 * \param cmdString The command string.
+                 * \param callback Callback invoked with the command result.
+                 * \param timeout Timeout value (seconds). If this is -1, use the
+                 *    transport's default timeout.
+                 * \param msgId The message ID carried by a JSON command, as for
+                 *    sendCommand().
+                 */
+                virtual void sendCommandAsync(
+                        const std::string& cmdString,
+                        const AsyncCommandCallback& callback,
+                        double timeout = -1,
+                        int64_t msgId = -1
                 );
                 /**
                  * \brief Sets the configuration dictionary for this object.
@@ -1792,8 +1944,283 @@ namespace LibCyberRadio
                 virtual int getDefaultDeviceInfo() const;
                 /**
                  * \brief Get a json Message ID
+                 *
+                 * IDs are unique across all handlers in the process, so
+                 * responses can be matched to commands even when many
+                 * commands are outstanding at once.
+                 * \returns The message ID for the next command.
                  */
                 virtual uint32_t getMessageId( void );
+                /**
+                 * \brief Sets the maximum number of commands pipelined in one
+                 *    batch when querying the radio configuration.
+                 * \param size Maximum commands per batch.  Zero or one disables
+                 *    batching, so queries are sent one command at a time.
+                 */
+                virtual void setCommandBatchSize(int size);
+                /**
+                 * \brief Gets the maximum number of commands pipelined in one
+                 *    batch when querying the radio configuration.
+                 * \returns Maximum commands per batch.
+                 */
+                virtual int getCommandBatchSize() const;
+                /**
+                 * \brief Sets the number of connections used to query component
+                 *    configuration concurrently.
+                 *
+                 * When this is greater than one and the connection mode accepts
+                 * several sessions (TCP for command-line radios, UDP for JSON
+                 * radios), queryConfiguration() opens additional connections to
+                 * the radio and queries components over all of them in parallel.
+                 * Each component is queried over exactly one connection, so it
+                 * updates its own configuration dictionary as usual.
+                 * \param connections Number of connections, including the primary
+                 *    connection.  One (the default) queries components one after
+                 *    another.
+                 */
+                virtual void setQueryConnections(int connections);
+                /**
+                 * \brief Gets the number of connections used to query component
+                 *    configuration concurrently.
+                 * \returns Number of connections, including the primary connection.
+                 */
+                virtual int getQueryConnections() const;
+                /**
+                 * \brief Gets the time spent in each phase of the last connection
+                 *    and configuration query.
+                 * \returns A dictionary of elapsed times in seconds, keyed by phase
+                 *    name ("connect", "version", "radio", "batch", "components",
+                 *    "total").  Phases that did not run are absent.
+                 */
+                virtual BasicStringDoubleDict getStartupTiming() const;
+                /**
+                 * \brief Sets whether the radio's components query their state on
+                 *    demand.
+                 *
+                 * In lazy query mode, queryConfiguration() (and so connect())
+                 * queries the radio's identity, version and radio-wide settings,
+                 * but not the state of its components.  Each component queries
+                 * its state the first time it is read, and again once the cached
+                 * state is older than the time-to-live.  Calling refresh() on the
+                 * radio handler marks all component state as out of date.
+                 *
+                 * The setting takes effect at the next queryConfiguration().
+                 * \param lazy Whether components query their state on demand.
+                 * \param ttl Time-to-live for cached component state, in seconds.
+                 *    If this is zero or less, cached state does not expire.
+                 */
+                virtual void setLazyQuery(bool lazy, double ttl = 0.0);
+                /**
+                 * \brief Gets whether the radio's components query their state on
+                 *    demand.
+                 * \returns True if in lazy query mode, false otherwise.
+                 */
+                virtual bool isLazyQuery() const;
+                /**
+                 * \brief Sets the file used to cache queried configuration.
+                 *
+                 * When a cache file is set, queryConfiguration() saves the radio's
+                 * responses to its configuration queries, keyed by the radio's
+                 * identity (model, serial number and firmware version).  The
+                 * next time a radio with the same identity is queried, a few of
+                 * the cached queries are re-sent as a spot-check.  If they still
+                 * get the same responses, the rest of the configuration comes
+                 * from the cache instead of the radio.  One file can hold the
+                 * cache for many radios.
+                 *
+                 * The cache is not used in lazy query mode.
+                 * \param path Cache file path.  An empty string disables caching.
+                 */
+                virtual void setConfigCacheFile(const std::string& path);
+                /**
+                 * \brief Gets the file used to cache queried configuration.
+                 * \returns The cache file path, or an empty string if caching is
+                 *    disabled.
+                 */
+                virtual std::string getConfigCacheFile() const;
+                /**
+                 * \brief Sets the number of cached queries re-sent to verify the
+                 *    cache.
+                 * \param checks Number of queries.  Zero trusts the cache
+                 *    without checking it.
+                 */
+                virtual void setConfigCacheSpotChecks(int checks);
+                /**
+                 * \brief Gets the number of cached queries re-sent to verify the
+                 *    cache.
+                 * \returns Number of queries.
+                 */
+                virtual int getConfigCacheSpotChecks() const;
+                /**
+                 * \brief Gets whether the last configuration query was answered
+                 *    from the cache.
+                 * \returns True if the cache was used, false otherwise.
+                 */
+                virtual bool isConfigFromCache() const;
+                /**
+                 * \brief Starts a configuration transaction.
+                 *
+                 * While a transaction is open, the component configuration
+                 * methods (setTunerConfiguration(), setWbddcConfiguration(),
+                 * setNbddcConfiguration(), setDataPortConfiguration(), and so
+                 * on) check each dictionary against the component's supported
+                 * settings and ranges, then stage the resulting commands
+                 * instead of sending them.  Components report the staged
+                 * settings as their state until the transaction ends.
+                 *
+                 * Other methods that send commands are not part of the
+                 * transaction, and should not be called while one is open.
+                 *
+                 * \returns True if successful, false if a transaction is
+                 *    already open.
+                 */
+                virtual bool beginTransaction();
+                /**
+                 * \brief Sends the commands staged by the open transaction.
+                 *
+                 * The commands are pipelined as one batch where the connection
+                 * allows it.  If any change failed validation, nothing is sent.
+                 * If any command fails, the previous settings of every changed
+                 * component are restored, also as one batch.  In either case,
+                 * the last command error info describes the failure.
+                 *
+                 * \returns True if every change was applied, false otherwise.
+                 */
+                virtual bool commitTransaction();
+                /**
+                 * \brief Discards the changes staged by the open transaction
+                 *    without sending them.
+                 */
+                virtual void abortTransaction();
+                /**
+                 * \brief Gets whether a configuration transaction is open.
+                 * \returns True if a transaction is open, false otherwise.
+                 */
+                virtual bool isTransactionOpen() const;
+                /**
+                 * \brief Sets the number of threads that run asynchronous
+                 *    setters.
+                 *
+                 * This limits how many asynchronous setters can have commands in
+                 * flight at once.  Changing it takes effect the next time the
+                 * threads are started, after a disconnect.
+                 * \param workers Number of threads.
+                 */
+                virtual void setAsyncWorkers(int workers);
+                /**
+                 * \brief Gets the number of threads that run asynchronous
+                 *    setters.
+                 * \returns Number of threads.
+                 */
+                virtual int getAsyncWorkers() const;
+                /**
+                 * \brief Runs a setter on an asynchronous worker thread.
+                 *
+                 * Commands the setter sends go through the I/O thread, so setters
+                 * running at the same time share pipelined batches.  Setters
+                 * that name the same component run one at a time, in the order
+                 * they were queued.
+                 * \param setter The setter, bound to its arguments.
+                 * \param component Name of the component the setter changes,
+                 *    or an empty string if it need not wait for other setters.
+                 * \returns A future for the setter's result.
+                 */
+                virtual AsyncSetterFuture runAsync(const boost::function<bool ()>& setter,
+                        const std::string& component = "");
+                /**
+                 * \brief Stops the asynchronous I/O and setter threads.
+                 *
+                 * Setters and commands still queued fail.  Derived handlers
+                 * call this from their destructors, so that the threads stop
+                 * before the derived parts they use are destroyed.
+                 */
+                virtual void stopAsync();
+                /**
+                 * \brief Sets the tuned frequency for a given tuner,
+                 *    asynchronously.
+                 * \see setTunerFrequency()
+                 */
+                virtual AsyncSetterFuture setTunerFrequencyAsync(int index, double freq);
+                /**
+                 * \brief Sets the attenuation for a given tuner, asynchronously.
+                 * \see setTunerAttenuation()
+                 */
+                virtual AsyncSetterFuture setTunerAttenuationAsync(int index, double atten);
+                /**
+                 * \brief Sets the configuration for a given tuner, asynchronously.
+                 * \see setTunerConfiguration()
+                 */
+                virtual AsyncSetterFuture setTunerConfigurationAsync(int index,
+                        const ConfigurationDict& cfg);
+                /**
+                 * \brief Sets the tuned frequency for a given WBDDC,
+                 *    asynchronously.
+                 * \see setWbddcFrequency()
+                 */
+                virtual AsyncSetterFuture setWbddcFrequencyAsync(int index, double freq);
+                /**
+                 * \brief Sets the rate index for a given WBDDC, asynchronously.
+                 * \see setWbddcRateIndex()
+                 */
+                virtual AsyncSetterFuture setWbddcRateIndexAsync(int index, int rateIndex);
+                /**
+                 * \brief Sets the configuration for a given WBDDC, asynchronously.
+                 * \see setWbddcConfiguration()
+                 */
+                virtual AsyncSetterFuture setWbddcConfigurationAsync(int index,
+                        const ConfigurationDict& cfg);
+                /**
+                 * \brief Sets the tuned frequency for a given NBDDC,
+                 *    asynchronously.
+                 * \see setNbddcFrequency()
+                 */
+                virtual AsyncSetterFuture setNbddcFrequencyAsync(int index, double freq);
+                /**
+                 * \brief Sets the rate index for a given NBDDC, asynchronously.
+                 * \see setNbddcRateIndex()
+                 */
+                virtual AsyncSetterFuture setNbddcRateIndexAsync(int index, int rateIndex);
+                /**
+                 * \brief Sets the configuration for a given NBDDC, asynchronously.
+                 * \see setNbddcConfiguration()
+                 */
+                virtual AsyncSetterFuture setNbddcConfigurationAsync(int index,
+                        const ConfigurationDict& cfg);
+                /**
+                 * \brief Sets the tuned frequency for a given transmitter,
+                 *    asynchronously.
+                 * \see setTransmitterFrequency()
+                 */
+                virtual AsyncSetterFuture setTransmitterFrequencyAsync(int index, double freq);
+                /**
+                 * \brief Sets the attenuation for a given transmitter,
+                 *    asynchronously.
+                 * \see setTransmitterAttenuation()
+                 */
+                virtual AsyncSetterFuture setTransmitterAttenuationAsync(int index, double atten);
+                /**
+                 * \brief Sets the tuned frequency for a given DUC, asynchronously.
+                 * \see setDucFrequency()
+                 */
+                virtual AsyncSetterFuture setDucFrequencyAsync(int index, double freq);
+                /**
+                 * \brief Sets the attenuation for a given DUC, asynchronously.
+                 * \see setDucAttenuation()
+                 */
+                virtual AsyncSetterFuture setDucAttenuationAsync(int index, double atten);
+                /**
+                 * \brief Sets the configuration for a given DUC, asynchronously.
+                 * \see setDucConfiguration()
+                 */
+                virtual AsyncSetterFuture setDucConfigurationAsync(int index,
+                        const ConfigurationDict& cfg);
+                /**
+                 * \brief Sets the configuration for a given data port,
+                 *    asynchronously.
+                 * \see setDataPortConfiguration()
+                 */
+                virtual AsyncSetterFuture setDataPortConfigurationAsync(int index,
+                        const ConfigurationDict& cfg);
 
             protected:
                 /**
@@ -1819,6 +2246,89 @@ namespace LibCyberRadio
                 // Queries the radio for its specific configuration information.
                 // Individual radios should override this as necessary.
                 virtual bool queryRadioConfiguration();
+                // Queries the configuration of every component managed by the
+                // radio.
+                virtual void queryComponentConfiguration();
+                // Queries the radio and component configuration with the
+                // command queries pipelined in batches.  Returns false (having
+                // sent nothing) if the transport cannot pipeline commands.
+                virtual bool queryConfigurationBatched();
+                // Post-processes a command response: records any error message
+                // into the last command error info, and strips the command echo.
+                virtual std::string processCommandResponse(const std::string& cmdString,
+                        BasicStringList& rsp);
+                // Queries the configuration of the given components, over a pool
+                // of connections if one is configured.
+                virtual void queryComponents(const std::vector<Configurable*>& components);
+                // Queries components from a shared list until none remain.  Used
+                // by each thread of a concurrent query; a NULL transport means the
+                // primary connection.
+                virtual void queryComponentsWorker(RadioTransport* transport,
+                        const std::vector<Configurable*>* components,
+                        boost::atomic<size_t>* next);
+                // Gets whether the connection mode accepts more than one session.
+                virtual bool supportsQueryPool() const;
+                // Queries the radio and component configuration from the cache
+                // file, if it holds a cache for this radio that passes the
+                // spot-check.  Returns false (having changed nothing) otherwise.
+                virtual bool queryConfigurationCached();
+                // Gets the key identifying this radio in the cache file, or an
+                // empty string if the cache cannot be used.
+                virtual std::string getConfigCacheKey();
+                // Loads the cached responses for a radio from the cache file.
+                virtual bool loadConfigCache(const std::string& key,
+                        std::map<std::string, std::deque<std::pair<BasicStringList, std::string> > >& rsps);
+                // Saves the cached responses for a radio into the cache file,
+                // keeping the entries for other radios.
+                virtual bool saveConfigCache(const std::string& key,
+                        const std::map<std::string, std::deque<std::pair<BasicStringList, std::string> > >& rsps);
+                // Gets whether a command only queries the radio.
+                virtual bool isQueryCommand(const std::string& cmdString) const;
+                // Drops this radio's entry from the cache file once a command
+                // that changes the radio configuration has succeeded, so that
+                // the next connection queries the radio in full.
+                virtual void dropConfigCacheOnSet(const std::string& cmdString);
+                // Applies a configuration dictionary to a component (NULL if
+                // there is no such component).  While a transaction is open,
+                // validates it and stages the commands instead.
+                virtual bool applyComponentConfiguration(Configurable* component,
+                        ConfigurationDict& cfg);
+                // Applies the settings saved when the open transaction first
+                // changed each component, newest first, staging the commands.
+                virtual void restoreTransactionState();
+                // Sends commands as pipelined batches if the connection allows
+                // it, or one at a time otherwise.  Stops after the batch holding
+                // the first failure.
+                virtual bool sendCommandSequence(const BasicStringList& cmds,
+                        const std::vector<int64_t>& msgIds);
+                // Starts the I/O thread and the asynchronous setter threads, if
+                // they are not running.  Called with the async mutex held.
+                virtual void startAsync();
+                // Completes every queued command with an error.
+                virtual void failAsyncRequests(const std::string& error);
+                // Main loop for the I/O thread: sends queued commands, pipelined
+                // where the transport allows it, and completes their results.
+                virtual void asyncIoLoop();
+                // Main loop for an asynchronous setter thread.
+                virtual void asyncWorkerLoop();
+                // Gets the name that serializes asynchronous setters for a
+                // component.
+                virtual std::string asyncComponent(const char* type, int index) const;
+                // Runs a setter and records its result.
+                virtual void runAsyncSetter(const boost::function<bool ()>& setter,
+                        boost::shared_ptr<boost::promise<bool> > result);
+                // Applies a copy of a configuration dictionary through one of
+                // the set*Configuration() methods, for the asynchronous variants.
+                virtual bool applyConfigurationCopy(
+                        bool (RadioHandler::*setter)(int, ConfigurationDict&),
+                        int index, ConfigurationDict cfg);
+                // Records the time elapsed in a startup phase and restarts the
+                // phase timer.
+                virtual void recordStartupPhase(const std::string& phase,
+                        boost::chrono::steady_clock::time_point& start);
+                // Gets the time left before a probe deadline, in seconds.
+                virtual double getProbeTimeRemaining(
+                        const boost::chrono::steady_clock::time_point& deadline) const;
                 // Executes the *IDN? query on the radio.
                 virtual bool executeQueryIDN(std::string& model,
                         std::string& serialNumber);
@@ -2005,6 +2515,91 @@ namespace LibCyberRadio
                 BasicStringStringDict _connectionInfo;
                 double _defaultTimeout;
                 int _defaultDeviceInfo;
+                // Command batching
+                // -- Prefetch modes: while recording, sendCommand() collects
+                //    commands without sending them; while replaying, it answers
+                //    from the responses to the batched commands.
+                enum
+                {
+                    PREFETCH_OFF = 0,
+                    PREFETCH_RECORD,
+                    PREFETCH_REPLAY
+                };
+                int _cmdBatchSize;
+                int _prefetchMode;
+                BasicStringList _prefetchCmds;
+                std::vector<int64_t> _prefetchIds;
+                // -- Responses (and error info) by command, in the order sent
+                std::map<std::string, std::deque<std::pair<BasicStringList, std::string> > > _prefetchRsp;
+                // Concurrent queries
+                // -- Connection used by a query worker thread, and the error info
+                //    for the last command it sent.  Threads without a session use
+                //    the primary connection.  Asynchronous setter threads have a
+                //    queued session, which sends through the I/O thread.
+                struct QuerySession
+                {
+                    RadioTransport* transport;
+                    std::string lastCmdErrorInfo;
+                    bool queued;
+                };
+                int _queryConnections;
+                // Lazy component queries
+                bool _lazyComponents;
+                double _componentTtl;
+                boost::thread_specific_ptr<QuerySession> _querySession;
+                BasicStringDoubleDict _startupTiming;
+                // Configuration cache
+                std::string _configCacheFile;
+                int _configCacheSpotChecks;
+                bool _configFromCache;
+                // -- Whether the cache file may hold an entry for this radio
+                boost::atomic<bool> _configCacheHeld;
+                // -- Responses collected while querying, for saving to the cache
+                bool _captureRsp;
+                std::map<std::string, std::deque<std::pair<BasicStringList, std::string> > > _capturedRsp;
+                boost::mutex _captureMutex;
+                // Configuration transactions
+                // -- While staging, sendCommand() collects commands without
+                //    sending them, and reports success.
+                bool _transactionOpen;
+                bool _transactionStaging;
+                BasicStringList _transactionCmds;
+                std::vector<int64_t> _transactionIds;
+                std::string _transactionError;
+                // -- Previous settings of each changed component, in the order
+                //    the components were first changed
+                std::vector<std::pair<Configurable*, ConfigurationDict> > _transactionUndo;
+                // Asynchronous commands
+                // -- Serializes use of the primary connection between the I/O
+                //    thread and callers sending synchronously
+                boost::mutex _transportMutex;
+                // -- A command waiting for the I/O thread
+                struct AsyncRequest
+                {
+                    std::string cmdString;
+                    int64_t msgId;
+                    double timeout;
+                    boost::shared_ptr<boost::promise<AsyncCommandResult> > result;
+                    AsyncCommandCallback callback;
+                };
+                boost::mutex _asyncMutex;
+                boost::condition_variable _asyncIoCond;
+                boost::condition_variable _asyncTaskCond;
+                bool _asyncStop;
+                std::deque<AsyncRequest> _asyncRequests;
+                boost::thread* _asyncIoThread;
+                // -- An asynchronous setter waiting for a thread, with its result
+                struct AsyncTask
+                {
+                    std::string component;
+                    boost::function<bool ()> setter;
+                    boost::shared_ptr<boost::promise<bool> > result;
+                };
+                int _asyncWorkerCount;
+                std::deque<AsyncTask> _asyncTasks;
+                // -- Components that a setter thread is changing
+                std::set<std::string> _asyncBusyComponents;
+                boost::thread_group* _asyncWorkers;
 
         }; /* class RadioHandler */
 
@@ -15,7 +15,12 @@
 #include "LibCyberRadio/Common/Debuggable.h"
 #include "LibCyberRadio/Common/HttpsSession.h"
 #include "LibCyberRadio/Common/SerialPort.h"
+#include <boost/chrono.hpp>
+#include <cstdint>
+#include <map>
+#include <netinet/in.h>
 #include <string>
+#include <vector>
 
 
 /**
@@ -54,11 +59,17 @@ namespace LibCyberRadio
                 virtual ~RadioTransport();
                 /**
                  * \brief Copies a RadioTransport object.
+                 *
+                 * The copy takes the settings of the other object, but not its
+                 * connection, so it starts out disconnected.
                  * \param other The RadioTransport object to copy.
                  */
                 RadioTransport(const RadioTransport& other);
                 /**
                  * \brief Assignment operator for RadioTransport objects.
+                 *
+                 * The assigned object closes its own connection and takes the
+                 * settings of the other object, but not its connection.
                  * \param other The RadioTransport object to copy.
                  * \returns A reference to the assigned object.
                  */
@@ -92,16 +103,26 @@ namespace LibCyberRadio
                  * \param json True if Radio Uses JSON
                  */
                 void setJson( bool json );
+                /**
+                 * \brief Gets whether the transport uses JSON.
+                 * \returns True if the radio uses JSON, false otherwise.
+                 */
+                bool isJson() const;
                 /**
                  * \brief Sends a command to the radio over the transport.
                  * \param cmdString The command to send.
                  * \param clearRx Whether or not to clear the receive buffer before
                  *    sending the command.
+                 * \param msgId The message ID carried by a JSON command, which
+                 *    the response to it is matched against.  If negative, the
+                 *    command has no message ID, and the next response received
+                 *    is taken as its response.
                  * \returns True if the command was sent successfully, false otherwise.
                  */
                 virtual bool sendCommand(
                         const std::string& cmdString,
-                        bool clearRx = true
+                        bool clearRx = true,
+                        int64_t msgId = -1
                 );
                 /**
                  * \brief Receives a command response from the radio.
@@ -113,6 +134,85 @@ namespace LibCyberRadio
                 virtual BasicStringList receive(
                         double timeout = -1
                 );
+                /**
+                 * \brief Sends a batch of commands and receives their responses.
+                 *
+                 * Over a TCP connection using the command-line (non-JSON)
+                 * protocol, all commands are written in one send, and the
+                 * response stream is split on the prompt that ends each
+                 * response, so the batch costs about one round trip.  Over
+                 * a UDP connection using JSON, up to the in-flight window of
+                 * commands is outstanding at once, and responses are matched
+                 * to commands by their message ID in whatever order they
+                 * arrive.  Other transports send the commands one at a time.
+                 * \param cmds The commands to send, each ending in a newline.
+                 * \param timeout The timeout value to use while waiting for each
+                 *    response.  If -1, use the default timeout value for the
+                 *    transport.
+                 * \param msgIds The message ID carried by each JSON command, as
+                 *    for sendCommand().  JSON commands are only pipelined over
+                 *    UDP when every command has a distinct message ID.
+                 * \returns One list of received data strings per command, in
+                 *    command order.  Responses that were not received are empty.
+                 */
+                virtual std::vector<BasicStringList> sendCommandBatch(
+                        const BasicStringList& cmds,
+                        double timeout = -1,
+                        const std::vector<int64_t>& msgIds = std::vector<int64_t>()
+                );
+                /**
+                 * \brief Gets whether sendCommandBatch() can pipeline commands
+                 *    on this transport.
+                 * \returns True if batches are sent in a single write, false if
+                 *    they are sent one command at a time.
+                 */
+                virtual bool supportsCommandBatch() const;
+                /**
+                 * \brief Sets the number of times a JSON command sent over UDP
+                 *    is resent when its response does not arrive.
+                 *
+                 * The receive timeout is shared evenly between the original
+                 * send and its retries.  A response to any attempt completes
+                 * the command, so a slow response is not lost when the command
+                 * is resent.
+                 * \param retries Number of retries (0 disables retries).
+                 */
+                void setJsonUdpRetries(int retries);
+                /**
+                 * \brief Gets the number of times a JSON command sent over UDP
+                 *    is resent when its response does not arrive.
+                 * \returns The number of retries.
+                 */
+                int getJsonUdpRetries() const;
+                /**
+                 * \brief Sets the maximum number of JSON commands that may be
+                 *    awaiting responses at once over UDP.
+                 * \param window Maximum number of outstanding commands.
+                 */
+                void setJsonUdpWindow(int window);
+                /**
+                 * \brief Gets the maximum number of JSON commands that may be
+                 *    awaiting responses at once over UDP.
+                 * \returns The maximum number of outstanding commands.
+                 */
+                int getJsonUdpWindow() const;
+                /**
+                 * \brief Sets the deadline for connecting to the radio.
+                 *
+                 * The TCP connection handshake must complete within the
+                 * deadline, so connecting to a radio that is powered off fails
+                 * after the deadline rather than after the system's TCP
+                 * timeout.
+                 * \param timeout Deadline in seconds.  If this is negative,
+                 *    connecting blocks until the system gives up.
+                 */
+                void setConnectTimeout(double timeout);
+                /**
+                 * \brief Gets the deadline for connecting to the radio.
+                 * \returns Deadline in seconds, or a negative value if
+                 *    connecting blocks until the system gives up.
+                 */
+                double getConnectTimeout() const;
                 /**
                  * \brief Gets the error information for the last command.
                  * \returns A string containing the error message.
@@ -160,6 +260,18 @@ namespace LibCyberRadio
                         const std::string& dev,
                         int baudrate
                 );
+                /**
+                 * \brief Looks up the IPv4 address of a host.
+                 * \param host The host name or IP address.
+                 * \param port The port number.
+                 * \param addr Socket address to fill in.
+                 * \returns True if the lookup succeeds, false otherwise.
+                 */
+                virtual bool resolveHost(
+                        const std::string& host,
+                        int port,
+                        struct sockaddr_in& addr
+                );
                 /**
                  * \brief Sends a command to the radio over TCP.
                  * \param cmdString The command to send.
@@ -176,11 +288,14 @@ namespace LibCyberRadio
                  * \param cmdString The command to send.
                  * \param clearRx Whether or not to clear the receive buffer before
                  *    sending the command.
+                 * \param msgId The message ID carried by a JSON command.  If
+                 *    negative, the command has no message ID.
                  * \returns True if the command was sent successfully, false otherwise.
                  */
                 virtual bool sendCommandUdp(
                         const std::string& cmdString,
-                        bool clearRx = true
+                        bool clearRx = true,
+                        int64_t msgId = -1
                 );
                 /**
                  * \brief Sends a command to the radio over HTTPS.
@@ -226,7 +341,17 @@ namespace LibCyberRadio
                 virtual BasicStringList receiveJsonHttps(
                         double timeout = -1
                 );
-
+                /**
+                 * \brief Receives a JSON-formatted command response from the radio
+                 *    using UDP.
+                 *
+                 * Waits for the response whose message ID matches the last
+                 * command sent, discarding late responses to earlier commands
+                 * and resending the command if configured to do so.
+                 * \param timeout The timeout value to use for receiving data.  If -1,
+                 *    wait indefinitely.
+                 * \returns A list of received data strings.
+                 */
                 virtual BasicStringList receiveJsonUdp(
                         double timeout = -1
                 );
@@ -267,6 +392,85 @@ namespace LibCyberRadio
                 virtual BasicStringList receiveCliTty(
                         double timeout = -1
                 );
+                /**
+                 * \brief Sends a batch of commands over TCP and splits the
+                 *    response stream on prompt boundaries.
+                 * \param cmds The commands to send.
+                 * \param timeout The timeout value to use while waiting for each
+                 *    response.
+                 * \returns One list of received data strings per command.
+                 */
+                virtual std::vector<BasicStringList> sendCommandBatchTcp(
+                        const BasicStringList& cmds,
+                        double timeout = -1
+                );
+                /**
+                 * \brief Discards the responses still owed for a TCP batch
+                 *    that gave up early.
+                 *
+                 * If they do not all arrive, the connection is dropped and
+                 * made again, so they cannot be taken for the responses to
+                 * later commands.
+                 * \param outstanding The number of responses still owed.
+                 * \param timeout The timeout value to use while waiting for
+                 *    each response.
+                 * \returns True if the connection is usable afterwards, false
+                 *    otherwise.
+                 */
+                virtual bool recoverCliTcp(
+                        size_t outstanding,
+                        double timeout = -1
+                );
+                /**
+                 * \brief Drops the TCP connection and connects again to the
+                 *    same peer.
+                 * \returns True if the new connection succeeds, false otherwise.
+                 */
+                virtual bool reconnectTcp();
+                /**
+                 * \brief Sends a batch of JSON commands over UDP and matches
+                 *    responses to commands by message ID.
+                 * \param cmds The commands to send.
+                 * \param msgIds The message ID carried by each command.
+                 * \param timeout The timeout value to use while waiting for each
+                 *    response.
+                 * \returns One list of received data strings per command.
+                 */
+                virtual std::vector<BasicStringList> sendCommandBatchJsonUdp(
+                        const BasicStringList& cmds,
+                        const std::vector<int64_t>& msgIds,
+                        double timeout = -1
+                );
+                /**
+                 * \brief Sends JSON commands over UDP and collects their responses.
+                 *
+                 * Keeps up to the in-flight window of commands outstanding,
+                 * resends commands whose responses are overdue, and gives up
+                 * on a command once its retries are exhausted.
+                 * \param cmds The commands, each carrying a unique message ID.
+                 * \param ids The message ID of each command.
+                 * \param numSent The number of leading commands that have
+                 *    already been sent once.
+                 * \param timeout The timeout value to use while waiting for each
+                 *    response.  If negative, wait indefinitely without retries.
+                 * \returns One list of received data strings per command.
+                 */
+                std::vector<BasicStringList> exchangeJsonUdp(
+                        const BasicStringList& cmds,
+                        const std::vector<uint32_t>& ids,
+                        size_t numSent,
+                        double timeout
+                );
+                /**
+                 * \brief Splits a client (AT-command-style) response into a list
+                 *    of non-empty strings.
+                 * \param rsp The raw response text.
+                 * \returns A list of response lines, without carriage returns or
+                 *    the prompt character.
+                 */
+                virtual BasicStringList splitCliResponse(
+                        const std::string& rsp
+                );
                 /**
                  * \brief Translates an errno value into an error message.
                  */
@@ -288,6 +492,17 @@ namespace LibCyberRadio
                 std::string _httpsApiCmdUrl;
                 // Error message from the last command executed
                 std::string _lastCmdErrInfo;
+                // Retries for an unanswered JSON command over UDP
+                int _jsonUdpRetries;
+                // Maximum JSON commands outstanding at once over UDP
+                int _jsonUdpWindow;
+                // Last JSON command sent over UDP, and whether it carries a
+                // message ID, so receiveJsonUdp() knows what it is waiting for
+                std::string _jsonUdpLastCmd;
+                bool _jsonUdpLastHasId;
+                uint32_t _jsonUdpLastId;
+                // Deadline for connecting, in seconds (negative = none)
+                double _connectTimeout;
 
         };
 
@@ -0,0 +1,184 @@
+/***************************************************************************
+ * \file FileSink.h
+ *
+ * \brief NDR651 memory-mapped waveform file transmit sink.
+ *
+ * \author JVM
+ * \copyright Copyright (c) 2015-2021 CyberRadio Solutions, Inc.
+ *
+ */
+
+#ifndef INCLUDED_LIBCYBERRADIO_NDR651_FILESINK_H
+#define INCLUDED_LIBCYBERRADIO_NDR651_FILESINK_H
+
+#include "LibCyberRadio/Common/Debuggable.h"
+#include "LibCyberRadio/Common/Thread.h"
+#include "LibCyberRadio/NDR651/TXClient.h"
+#include <boost/atomic.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
+#include <string>
+#include <vector>
+
+/*!
+ * \brief Provides programming elements for controlling CyberRadio Solutions products.
+ */
+namespace LibCyberRadio
+{
+    /*!
+     * \brief Provides programming elements for controlling the CyberRadio Solutions
+     *    NDR651 radio.
+     */
+    namespace NDR651
+    {
+
+        /*!
+         * \brief Streams a recorded waveform file to a DUC.
+         *
+         * The file holds interleaved 16-bit I/Q samples in host byte order.
+         * It is memory-mapped with sequential readahead, and frames are sent
+         * directly from the mapping -- the only copies made are for a frame
+         * that wraps around the end of the file, and for I/Q swapping when
+         * it is enabled.  The radio expects Q before I within each sample
+         * (see DUCSink), so files recorded I-first need setSwapIQ(true).
+         *
+         * Sending honors DUC flow control.  Playback stops at the end of
+         * the file unless looping is enabled, and seek() may be called at
+         * any time to move the playback position.
+         *
+         * The TXClient must be configured and in synchronous (non-async)
+         * mode.  The sink starts and stops the client, and does not take
+         * ownership of it.
+         */
+        class FileSink : public Thread, public Debuggable
+        {
+            public:
+                /*!
+                 * \brief Constructs a FileSink object.
+                 * \param txClient Configured transmit client
+                 * \param filename Waveform file to open (empty = none)
+                 * \param samplesPerFrame Number of samples sent per frame
+                 * \param loop Whether or not to loop at the end of the file
+                 * \param debug Whether or not to produce debug output
+                 */
+                FileSink(TXClient * txClient,
+                        const std::string& filename = "",
+                        unsigned int samplesPerFrame = SAMPLES_PER_FRAME,
+                        bool loop = false,
+                        bool debug = false);
+                /*!
+                 * \brief Destroys a FileSink object.
+                 */
+                virtual ~FileSink();
+                /*!
+                 * \brief Opens and maps a waveform file.
+                 *
+                 * Any file already open is closed first.  Playback restarts
+                 * at the beginning of the new file.
+                 * \param filename Waveform file name
+                 * \returns True if the action succeeds, false otherwise.
+                 */
+                bool open(const std::string& filename);
+                /*!
+                 * \brief Unmaps and closes the waveform file.
+                 */
+                void close();
+                /*!
+                 * \brief Gets whether or not a waveform file is open.
+                 * \returns True if a file is open, false otherwise.
+                 */
+                bool isOpen() { return (_data != NULL); };
+                /*!
+                 * \brief Gets the number of samples in the waveform file.
+                 * \returns The number of samples.
+                 */
+                unsigned long long getNumSamples() { return _numSamples; };
+                /*!
+                 * \brief Sets whether or not to loop at the end of the file.
+                 * \param loop Whether or not to loop
+                 */
+                void setLoop(bool loop) { _loop = loop; };
+                /*!
+                 * \brief Gets whether or not playback loops at the end of the file.
+                 * \returns True if looping, false otherwise.
+                 */
+                bool getLoop() { return _loop; };
+                /*!
+                 * \brief Sets whether or not to swap I and Q in each sample.
+                 *
+                 * Must be called before start().
+                 * \param swapIQ Whether or not to swap I and Q
+                 */
+                void setSwapIQ(bool swapIQ);
+                /*!
+                 * \brief Moves the playback position.
+                 * \param sample Sample offset from the start of the file
+                 * \returns True if the action succeeds, false otherwise.
+                 */
+                bool seek(unsigned long long sample);
+                /*!
+                 * \brief Gets the playback position.
+                 * \returns The offset of the next sample to send.
+                 */
+                unsigned long long getPosition();
+                /*!
+                 * \brief Gets the number of samples sent since start().
+                 * \returns The number of samples sent.
+                 */
+                unsigned long long getSamplesSent() { return _samplesSent; };
+                /*!
+                 * \brief Gets whether or not playback reached the end of a
+                 *    non-looping file.
+                 * \returns True if playback has finished, false otherwise.
+                 */
+                bool isFinished() { return _finished; };
+                /*!
+                 * \brief Starts the transmit client and the streaming thread.
+                 */
+                virtual void start();
+                /*!
+                 * \brief Stops the streaming thread and the transmit client.
+                 *
+                 * Waits for the streaming thread to exit before stopping the
+                 * client.
+                 * \param disableRF Whether or not to disable the transmitter
+                 */
+                void stop(bool disableRF = false);
+                /*!
+                 * \brief Executes the main processing loop for the thread.
+                 */
+                virtual void run();
+
+            private:
+                short * _nextFrame(void);
+
+            private:
+                TXClient * _txClient;
+                std::string _filename;
+                unsigned int _samplesPerFrame;
+                bool _loop;
+                bool _swapIQ;
+                // File mapping
+                int _fd;
+                size_t _mapLength;
+                const short * _data;
+                unsigned long long _numSamples;
+                // Frame assembly for wrapped frames and I/Q swapping
+                std::vector<short> _frameBuffer;
+                // Playback state
+                boost::atomic<unsigned long long> _position;
+                boost::atomic<unsigned long long> _seekTarget;
+                boost::atomic<bool> _seekPending;
+                boost::atomic<unsigned long long> _samplesSent;
+                boost::atomic<bool> _finished;
+                boost::atomic<bool> _running;
+                // Wakes the streaming thread at the end of the file on
+                // seek() or stop()
+                boost::mutex _wakeMutex;
+                boost::condition_variable _wake;
+        };
+
+    } /* namespace NDR651 */
+}
+
+#endif /* INCLUDED_LIBCYBERRADIO_NDR651_FILESINK_H */
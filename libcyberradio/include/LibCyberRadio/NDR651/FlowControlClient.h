@@ -82,6 +82,17 @@ namespace LibCyberRadio
                  * \returns The update delay.
                  */
                 unsigned int getUpdateDelay() { return _fcUpdateDelay; };
+                /*!
+                 * \brief Gets the number of samples the DUC drains between
+                 *    status updates.
+                 * \returns The number of samples per update.
+                 */
+                long int getSamplesPerUpdate() { return _samplesPerUpdate; };
+                /*!
+                 * \brief Gets the DUC sample rate for the current rate index.
+                 * \returns The sample rate, in samples per second.
+                 */
+                long getDucSampleRate() const { return _getDucSampleRate(); };
                 /*!
                  * \brief Sets the DUC channel number.
                  * \param ducChannel DUC channel number
@@ -17,6 +17,7 @@
 #include <stdint.h>
 
 #define SAMPLES_PER_FRAME 1024
+#define MAX_SAMPLES_PER_FRAME 8192
 
 #define VRLP 0x56524c50
 #define VEND 0x56454e44
@@ -93,6 +94,22 @@ namespace LibCyberRadio
                 struct Vita49Trailer vend;  //!< VITA 49 frame trailer
         } __attribute__((aligned));
 
+        /*!
+         * \brief Header portion of a variable-length VITA 49
+         *    transmit-over-UDP frame.
+         *
+         * The payload (2*samplesPerFrame interleaved I/Q values) and a
+         * Vita49Trailer follow the header directly.  Unlike TxFrame, this
+         * structure is packed, so the IP header immediately follows the
+         * Ethernet header on the wire.
+         */
+        struct TxFrameHeader {
+                struct ethhdr eth;          //!< Ethernet header
+                struct iphdr ip;            //!< IP header
+                struct udphdr udp;          //!< UDP header
+                struct Vita49Header v49;    //!< VITA 49 frame header
+        } __attribute__((packed));
+
         /*!
          * \brief Transmit status information.
          */
@@ -22,6 +22,7 @@
 #include <sys/types.h>
 #include <sys/uio.h>
 #include <unistd.h>
+#include <time.h>
 
 #include "LibCyberRadio/Common/Debuggable.h"
 #include "LibCyberRadio/NDR651/PacketTypes.h"
@@ -41,7 +42,24 @@ namespace LibCyberRadio
                 unsigned long long sampleRate;
                 int txSocket;
                 struct iovec txVec[3];  // Will hold Vita Header, Payload of Samples, Vita Footer
-                uint32_t fracTimestampIncrement;
+                // Timestamp of the first frame since the timestamp was set, and
+                // samples sent since; each frame's timestamp is computed from
+                // these so rounding does not accumulate
+                uint32_t timestampBaseSeconds;
+                uint32_t timestampBaseTicks;
+                unsigned long long timestampSampleCount;
+                bool useTxTime;
+                long long txTimeOffsetNs;
+                clockid_t txTimeClock;
+                // Launch-time clock reading and VITA time of the first frame
+                // sent since launch times were enabled or the timestamp set
+                bool txTimeAnchored;
+                uint64_t txTimeBaseNs;
+                uint64_t txTimeBaseVitaNs;
+                unsigned long txTimeSendCount;
+                unsigned long txTimeDropCount;
+                char txTimeControl[CMSG_SPACE(sizeof(uint64_t))];
+                struct msghdr txMsg;
 
                 /* Instance methods */
                 void setVitaHeader(unsigned short streamId);
@@ -58,6 +76,23 @@ namespace LibCyberRadio
                 void start();
                 void sendFrame(short * samples);
                 void setSamplesPerFrame(unsigned int samplesPerFrame);
+                // Launch-time (SO_TXTIME) scheduling.  When enabled, the first
+                // frame launches launchOffsetNs after it is sent, measured on
+                // clockId, and each later frame launches its VITA timestamp's
+                // distance after that.  Disabling reopens the socket, since
+                // the kernel cannot clear SO_TXTIME.
+                bool setTxTime(bool enable, clockid_t clockId = CLOCK_TAI, long long launchOffsetNs = 1000000, bool deadlineMode = false);
+                uint64_t getLaunchTime();
+                // Frames the qdisc dropped because their launch time was missed
+                unsigned long getTxTimeDropCount();
+                // Timestamp carried by the next frame.  Frames sent after this
+                // call advance from the given time by one frame period each.
+                // The fractional part counts DAC_RATE ticks.
+                void setTimestamp(uint32_t seconds, uint32_t fracTicks);
+                void setTimestamp(double utcTime);
+                double getTimestamp();
+                // Returns to untimed frames (TSI cleared, zero timestamp)
+                void clearTimestamp();
 
 
         };
@@ -93,6 +93,7 @@ namespace LibCyberRadio
                 bool setDUCGE(unsigned int ducGroup, bool enable);
                 bool querySTAT(bool verbose);
                 bool queryTSTAT(bool verbose);
+                long getUTC();
         };
     }
 }
@@ -0,0 +1,76 @@
+/***************************************************************************
+ * \file SampleConversion.h
+ *
+ * \brief NDR651 sample format conversion kernels.
+ *
+ * \author DA
+ * \copyright Copyright (c) 2015-2021 CyberRadio Solutions, Inc.
+ *
+ */
+
+#ifndef INCLUDED_LIBCYBERRADIO_NDR651_SAMPLECONVERSION_H
+#define INCLUDED_LIBCYBERRADIO_NDR651_SAMPLECONVERSION_H
+
+#include <complex>
+#include <string>
+
+/*!
+ * \brief Provides programming elements for controlling CyberRadio Solutions products.
+ */
+namespace LibCyberRadio
+{
+    /*!
+     * \brief Provides programming elements for controlling the CyberRadio Solutions
+     *    NDR651 radio.
+     */
+    namespace NDR651
+    {
+
+        /*!
+         * \brief Converts complex float samples to interleaved 16-bit I/Q.
+         *
+         * Each sample is scaled, rounded to the nearest integer, and
+         * saturated to the 16-bit range, so overdriven input clips rather
+         * than wrapping around.  The kernel is chosen at run time from the
+         * instruction sets the CPU supports (AVX2, SSE2, or scalar).
+         *
+         * \param input Complex input samples
+         * \param output Output buffer.  This buffer must hold at least
+         *    2*numSamples values.
+         * \param numSamples Number of complex samples to convert
+         * \param scale Scale factor applied before rounding
+         * \param swapIQ If true, output is ordered Q then I (the order
+         *    the NDR651 DUC expects); otherwise I then Q.
+         */
+        void convertComplexFloatToShort(const std::complex<float>* input,
+                short* output,
+                unsigned int numSamples,
+                float scale,
+                bool swapIQ);
+
+        /*!
+         * \brief Scalar version of convertComplexFloatToShort().
+         *
+         * Provided for reference and for CPUs without SIMD support.
+         * \param input Complex input samples
+         * \param output Output buffer
+         * \param numSamples Number of complex samples to convert
+         * \param scale Scale factor applied before rounding
+         * \param swapIQ Whether to output Q before I
+         */
+        void convertComplexFloatToShortScalar(const std::complex<float>* input,
+                short* output,
+                unsigned int numSamples,
+                float scale,
+                bool swapIQ);
+
+        /*!
+         * \brief Gets the name of the conversion kernel selected for this CPU.
+         * \returns "avx2", "sse2", or "scalar".
+         */
+        std::string getSampleConversionKernel();
+
+    } /* namespace NDR651 */
+}
+
+#endif /* INCLUDED_LIBCYBERRADIO_NDR651_SAMPLECONVERSION_H */
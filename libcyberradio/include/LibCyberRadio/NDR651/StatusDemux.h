@@ -0,0 +1,139 @@
+/***************************************************************************
+ * \file StatusDemux.h
+ *
+ * \brief NDR651 shared DUC status receiver.
+ *
+ * \author JVM
+ * \copyright Copyright (c) 2015-2021 CyberRadio Solutions, Inc.
+ *
+ */
+
+#ifndef INCLUDED_LIBCYBERRADIO_NDR651_STATUSDEMUX_H
+#define INCLUDED_LIBCYBERRADIO_NDR651_STATUSDEMUX_H
+
+#include "LibCyberRadio/Common/Debuggable.h"
+#include "LibCyberRadio/Common/Thread.h"
+#include "LibCyberRadio/NDR651/PacketTypes.h"
+#include "LibCyberRadio/NDR651/StatusReceiver.h"
+#include "LibCyberRadio/NDR651/UdpStatusReceiver.h"
+#include <boost/atomic.hpp>
+#include <boost/function.hpp>
+#include <boost/thread/mutex.hpp>
+#include <map>
+#include <vector>
+
+/*!
+ * \brief Provides programming elements for controlling CyberRadio Solutions products.
+ */
+namespace LibCyberRadio
+{
+    /*!
+     * \brief Provides programming elements for controlling the CyberRadio Solutions
+     *    NDR651 radio.
+     */
+    namespace NDR651
+    {
+
+        /*!
+         * \brief Receives DUC status (DUCHS) frames for many DUC channels
+         *    on one thread.
+         *
+         * Without a demultiplexer, every TXClient or TransmitPacketizer
+         * runs its own status receiver thread on its own UDP port.  A
+         * StatusDemux instead listens on one port (or a few, gathered in
+         * one epoll set), reads frames in batches, and routes each one by
+         * its VITA stream ID to the flow-control state of the channel that
+         * owns that stream.
+         *
+         * Receivers fed by a demultiplexer are not started; the owning
+         * client points its DUC status DIP entry at the demultiplexer's
+         * port instead.  See TXClient::setStatusDemux() and
+         * TransmitPacketizer::setStatusDemux().
+         */
+        class StatusDemux : public Thread, public Debuggable
+        {
+            public:
+                /*!
+                 * \brief Constructs a StatusDemux object.
+                 * \param port UDP port to receive status frames on
+                 * \param debug Whether or not to produce debug output
+                 */
+                StatusDemux(unsigned int port, bool debug = false);
+                /*!
+                 * \brief Destroys a StatusDemux object.
+                 */
+                virtual ~StatusDemux();
+                /*!
+                 * \brief Adds another UDP port to receive status frames on.
+                 * \param port UDP port
+                 * \returns True if the action succeeds, false otherwise.
+                 */
+                bool addPort(unsigned int port);
+                /*!
+                 * \brief Gets the primary UDP port.
+                 * \returns The port number.
+                 */
+                unsigned int getUdpPort() { return _port; };
+                /*!
+                 * \brief Routes status frames for a stream to a receiver.
+                 *
+                 * Any existing route for the stream is replaced.
+                 * \param streamId VITA stream ID of the DUC status frames
+                 * \param receiver Receiver that tracks the DUC's flow control
+                 */
+                void addRoute(unsigned int streamId, StatusReceiver * receiver);
+                /*!
+                 * \brief Routes status frames for a stream to a receiver.
+                 *
+                 * Any existing route for the stream is replaced.
+                 * \param streamId VITA stream ID of the DUC status frames
+                 * \param receiver Receiver that tracks the DUC's flow control
+                 */
+                void addRoute(unsigned int streamId, UdpStatusReceiver * receiver);
+                /*!
+                 * \brief Removes the route for a stream.
+                 *
+                 * Once this returns, the receiver is no longer used and may
+                 * be deleted.
+                 * \param streamId VITA stream ID
+                 */
+                void removeRoute(unsigned int streamId);
+                /*!
+                 * \brief Gets the number of status frames received.
+                 * \returns The number of frames.
+                 */
+                unsigned long long getFrameCount() { return _frameCount; };
+                /*!
+                 * \brief Gets the number of status frames that matched no route.
+                 * \returns The number of frames.
+                 */
+                unsigned long long getUnroutedCount() { return _unroutedCount; };
+                /*!
+                 * \brief Executes the main processing loop for the thread.
+                 */
+                virtual void run();
+
+            private:
+                typedef boost::function<void (const struct TxStatusFrame *)> Route;
+                int _makeSocket(unsigned int port);
+                void _route(const struct TxStatusFrame * status);
+
+            private:
+                unsigned int _port;
+                int _epfd;
+                std::vector<int> _sockets;
+                // Receive buffers for one recvmmsg() batch
+                std::vector<struct TxStatusFrame> _rxFrames;
+                // Routes by stream ID.  The mutex is held while a frame is
+                // handed to its receiver, so removeRoute() cannot race with
+                // delivery.
+                std::map<unsigned int, Route> _routes;
+                boost::mutex _routeMutex;
+                boost::atomic<unsigned long long> _frameCount;
+                boost::atomic<unsigned long long> _unroutedCount;
+        };
+
+    } /* namespace NDR651 */
+}
+
+#endif /* INCLUDED_LIBCYBERRADIO_NDR651_STATUSDEMUX_H */
@@ -32,6 +32,8 @@ namespace LibCyberRadio
     namespace NDR651
     {
 
+        struct TxStatusFrame;
+
         /*!
          * \brief UDP status receiver.
          */
@@ -54,6 +56,16 @@ namespace LibCyberRadio
                  * \brief Executes the main processing loop for the thread.
                  */
                 virtual void run();
+                /*!
+                 * \brief Applies a DUC status frame to the flow-control state.
+                 *
+                 * The receive thread calls this for every frame it reads.  A
+                 * receiver constructed with port 0 opens no socket, and can
+                 * instead be fed by a StatusDemux that shares one socket
+                 * among several DUC channels.
+                 * \param status Status frame
+                 */
+                void processStatusFrame(const struct TxStatusFrame * status);
                 /*!
                  * \brief Sets the interface name.
                  * \param ifname Ethernet interface name
@@ -103,9 +115,37 @@ namespace LibCyberRadio
                 bool getUpdatePE(void) { return _updatePE; };
                 int setMaxFreeSpace(float fs, float maxLatency);
                 int getMaxFreeSpace(void) { return _freeSpaceMax; };
+                /*!
+                 * \brief Limits the number of samples queued in the DUC.
+                 *
+                 * Credit from each status update is reduced so that the
+                 * DUC buffer occupancy does not exceed the target.
+                 * \param samples Target occupancy, in samples
+                 * \returns The target occupancy in effect.
+                 */
+                int setTargetOccupancy(int samples);
+                int getTargetOccupancy(void) { return _targetOccupancy; };
+                /*!
+                 * \brief Gets the DUC buffer occupancy from the latest status update.
+                 * \returns Number of samples queued in the DUC.
+                 */
+                int getBufferOccupancy(void);
+                /*!
+                 * \brief Gets the number of underruns reported by the radio
+                 *    since this receiver started.
+                 * \returns The underrun count.
+                 */
+                unsigned long long getUnderrunCount(void);
                 //~ bool setUdpPort(unsigned int port);
                 int getUdpPort(void) { return _port; };
                 void blockUntilAvailable(unsigned int numSamples);
+                /*!
+                 * \brief Waits for room in the DUC buffer, with a timeout.
+                 * \param numSamples Number of samples to send
+                 * \param timeout Maximum time to wait, in seconds
+                 * \returns True if there is room, false if the wait timed out.
+                 */
+                bool blockUntilAvailable(unsigned int numSamples, double timeout);
 
             private:
                 int _sockfd;
@@ -121,6 +161,11 @@ namespace LibCyberRadio
 
                 int _651freeSpace;
                 int _freeSpaceMax;
+                int _targetOccupancy;
+                int _bufferOccupancy;
+                // The radio's underrun counter is 7 bits; track the running total
+                int _lastUnderrunCounter;
+                unsigned long long _underrunCount;
 
                 // Synchronization and signal mechanisms
                 boost::mutex objectAccessMutex;
@@ -128,6 +173,7 @@ namespace LibCyberRadio
 
                 bool _makeSocket(void);
                 bool _setFreeSpace(int, bool, bool, bool);
+                void _updateUnderruns(int underrunCounter);
         };
 
     } /* namespace NDR651 */
@@ -14,6 +14,8 @@
 #include <LibCyberRadio/NDR651/StatusReceiver.h>
 #include <LibCyberRadio/NDR651/RadioController.h>
 #include <LibCyberRadio/NDR651/Packetizer.h>
+#include <boost/thread.hpp>
+#include <boost/chrono.hpp>
 #include <vector>
 
 namespace LibCyberRadio
@@ -37,6 +39,34 @@ namespace LibCyberRadio
                 bool checkClientStatus(void);
                 bool areAllDucsPaused(void);
 
+                // Parallel sending.  When enabled (the default), start()
+                // launches one sender thread per TXClient and sendFrames()
+                // hands each thread its frame, so a client blocked in flow
+                // control does not hold up the others.  sendFrames() returns
+                // once every client has sent its frame, keeping the group
+                // aligned frame by frame.  Must be set before start().
+                bool setParallelSend(bool parallel);
+                bool isParallelSend();
+
+                // Group statistics.  Skew is the spread between the first
+                // and last client finishing a frame.  A stall is a frame
+                // whose skew exceeds the stall threshold; it is charged to
+                // the client that finished last.  Send time is the total
+                // time a client spent in sendFrame(), flow control included.
+                void setStallThreshold(double seconds);
+                unsigned long long getFramesSent();
+                double getSkewMean();
+                double getSkewMax();
+                unsigned long long getStallCount(unsigned int client);
+                double getSendTime(unsigned int client);
+                void resetStats();
+
+            private:
+                void startSenders();
+                void stopSenders();
+                void senderLoop(unsigned int client);
+                void updateStats();
+
             private:
                 std::vector<TXClient *> txClients;
                 std::string hostname;
@@ -44,6 +74,29 @@ namespace LibCyberRadio
                 bool isRunning;
                 int ducGroup;
                 bool waitingToEnableDUCGE;
+
+                // Parallel send state, guarded by sendMutex.  Each sendFrames()
+                // call bumps sendGeneration; senders pick up their frame and
+                // count down sendsOutstanding when done.
+                bool parallelSend;
+                boost::thread_group senderThreads;
+                boost::mutex sendMutex;
+                boost::condition_variable sendCond;
+                boost::condition_variable doneCond;
+                bool sendersRunning;
+                unsigned long long sendGeneration;
+                unsigned int sendsOutstanding;
+                short **pendingFrames;
+                unsigned int pendingSamplesPerFrame;
+                std::vector<boost::chrono::high_resolution_clock::time_point> sendDoneTime;
+
+                // Statistics
+                double stallThreshold;
+                unsigned long long framesSent;
+                double skewTotal;
+                double skewMax;
+                std::vector<unsigned long long> clientStallCount;
+                std::vector<double> clientSendTime;
         };
     }
 }
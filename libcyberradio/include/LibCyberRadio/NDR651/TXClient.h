@@ -13,11 +13,15 @@
 #include "LibCyberRadio/NDR651/PacketTypes.h"
 #include "LibCyberRadio/NDR651/UdpStatusReceiver.h"
 #include "LibCyberRadio/NDR651/StatusReceiver.h"
+#include "LibCyberRadio/NDR651/StatusDemux.h"
 #include "LibCyberRadio/NDR651/RadioController.h"
 #include "LibCyberRadio/NDR651/Packetizer.h"
 
 #include <boost/algorithm/string.hpp>
 #include <boost/thread.hpp>
+#include <boost/atomic.hpp>
+#include <boost/lockfree/spsc_queue.hpp>
+#include <vector>
 
 #define UDP_STATUS_BASE 65500
 #define INVALID_VALUE 100000
@@ -26,6 +30,19 @@ namespace LibCyberRadio
 {
     namespace NDR651
     {
+        // Outcome of a timed burst (see TXClient::sendBurstAt).  Times are
+        // UTC seconds on the TXClient time base.
+        struct TimedBurstStatus
+        {
+            bool deadlineMet;        // Staged before, and released within tolerance of, the start time
+            unsigned int framesStaged;  // Frames queued in the paused DUC ahead of the start time
+            unsigned int framesSent;    // Total frames sent
+            double requestedStart;   // Requested start time
+            double stagedTime;       // Time staging finished
+            double startedTime;      // Time the DUC release was acknowledged
+            double lateness;         // startedTime - requestedStart
+        };
+
         class TXClient : public Debuggable
         {
 
@@ -54,6 +71,7 @@ namespace LibCyberRadio
                 Packetizer *packetizer;
                 //UdpStatusReceiver *statusRX;
                 StatusReceiver *statusRX;
+                StatusDemux *statusDemux; // Shared status receiver (not owned)
                 RadioController *rc;
                 bool isGrouped; // Is this Client part of a sync transmit?
                 bool isRunning;  // Has the user called start()
@@ -64,10 +82,69 @@ namespace LibCyberRadio
                 // To synchronize calls from other threads
                 boost::mutex objectAccessMutex;
 
+                // Asynchronous transmit pipeline.  Frames are copied into a
+                // preallocated pool; pool slot indices travel to the sender
+                // thread on readyQueue and come back on freeQueue.
+                bool asyncMode;
+                unsigned int asyncQueueDepth;
+                unsigned int asyncMaxSamplesPerFrame;
+                int asyncSenderCpu;
+                std::vector<short> asyncFramePool;
+                std::vector<unsigned int> asyncFrameSamples;
+                boost::lockfree::spsc_queue<unsigned int> *readyQueue;
+                boost::lockfree::spsc_queue<unsigned int> *freeQueue;
+                boost::thread senderThread;
+                boost::atomic<bool> senderRunning;
+                // Frames move through the queues without locking.  The mutex
+                // is only taken to sleep on an empty queue (the sender, on
+                // frameReady) or a full one (the producer, on frameFree), and
+                // to wake a thread that says it is sleeping.
+                boost::mutex senderMutex;
+                boost::condition_variable frameReady;
+                boost::condition_variable frameFree;
+                boost::atomic<bool> senderWaiting;
+                boost::atomic<bool> producerWaiting;
+                // Producers inside sendFrame(); stopSender() waits for them
+                // before freeing the queues
+                boost::atomic<unsigned int> producersActive;
+                boost::atomic<unsigned long long> unsentFrameCount;
+                boost::atomic<unsigned long long> enqueueWaitCount;
+                boost::atomic<unsigned long long> enqueueWaitNs;
+                boost::atomic<unsigned long long> enqueueWaitMaxNs;
+
+                // Whole-second offset from host time (CLOCK_REALTIME) to
+                // radio UTC, set by syncToRadioTime()
+                long radioTimeOffset;
+
+                // Adaptive prefill/occupancy control (producer thread only).
+                // producerDebt is how far the producer has fallen behind the
+                // DUC drain over the current burst; its decayed peak sets
+                // the buffer depth, scaled up by underrunMargin on underruns.
+                bool adaptiveMode;
+                double adaptiveMinLatency;
+                double adaptiveMaxLatency;
+                double targetLatency;
+                double producerDebt;
+                double producerDebtPeak;
+                double producerPeakDecay;
+                unsigned int producerDecayFrameSize;
+                double underrunMargin;
+                unsigned long long lastUnderrunCount;
+                bool haveLastSend;
+                boost::chrono::high_resolution_clock::time_point lastSendExit;
+                boost::chrono::high_resolution_clock::time_point lastMarginChange;
+
                 /* Instance methods */
                 std::string getSourceMac();
                 std::string getSourceIP();
                 bool validInputs(std::string &errors);
+                void enqueueFrame(short * samples, unsigned int samplesPerFrame);
+                void sendFrameSync(short * samples, unsigned int samplesPerFrame);
+                void startSender();
+                void stopSender();
+                void senderLoop();
+                void updateAdaptiveTarget(unsigned int samplesPerFrame);
+                void applyTargetLatency();
 
             public:
                 /* Constructors */
@@ -77,8 +154,22 @@ namespace LibCyberRadio
                 /* Instance methods */
                 void start();
                 void stop(bool disableRF = false);
+                // Receive DUC status through a shared StatusDemux instead of a
+                // per-client receiver thread (NULL = own receiver).  The
+                // demux must be started by the caller and outlive the client.
+                // Takes effect at the next call to start().
+                void setStatusDemux(StatusDemux * demux);
                 void setGrouped(bool isGrouped);
                 void sendFrame(short * samples, unsigned int samplesPerFrame);
+                // Non-blocking send: returns false without sending if the DUC
+                // does not have room for the frame.
+                bool trySendFrame(short * samples, unsigned int samplesPerFrame);
+                bool readyToSend(unsigned int numSamples);
+                // Waits up to timeout seconds for room for numSamples;
+                // returns whether there is room.
+                bool waitToSend(unsigned int numSamples, double timeout);
+                long getFreeSpace();
+                double getDUCSampleRate();
                 unsigned int getDucChannel();
                 bool isDUCPaused();
                 bool isDUCReady();
@@ -102,6 +193,52 @@ namespace LibCyberRadio
                 bool setTxInversion(bool txInversion);
                 bool pauseDUC(bool paused = true);
 
+                // Asynchronous transmit mode.  In async mode, sendFrame() only
+                // enqueues the frame; a dedicated sender thread (optionally
+                // pinned to senderCpu) does the flow-control wait and the
+                // socket write.  Must be set before start().
+                bool setAsyncMode(bool async, unsigned int queueDepth = 64,
+                        int senderCpu = -1,
+                        unsigned int maxSamplesPerFrame = SAMPLES_PER_FRAME);
+                bool isAsyncMode();
+                unsigned int getQueueDepth();
+                unsigned int getQueueCapacity();
+                unsigned long long getEnqueueWaitCount();
+                double getEnqueueWaitTime();
+                double getEnqueueWaitMax();
+                // Frames still queued when the sender thread was stopped
+                // and could not be drained
+                unsigned long long getUnsentFrameCount();
+                void resetQueueStats();
+
+                // Adaptive prefill.  Instead of prefilling half the DUC buffer,
+                // size the prefill and the target DUC buffer occupancy (as a
+                // latency) from the observed producer jitter, the DUC rate and
+                // the flow-control update period, growing the target when the
+                // radio reports underruns and easing it back after a quiet
+                // period.  Must be set before start().
+                bool setAdaptivePrefill(bool enable, double minLatency = 0.005,
+                        double maxLatency = 0.5);
+                bool isAdaptivePrefill();
+                double getTargetLatency();
+                double getProducerJitter();
+                unsigned long long getUnderrunCount();
+
+                // Timed bursts.  Time is host CLOCK_REALTIME (PTP-disciplined
+                // if PTP is running) plus the whole-second offset measured by
+                // syncToRadioTime() against the radio's PPS-driven UTC.
+                bool syncToRadioTime();
+                double getCurrentTime();
+                // Stamps numFrames frames starting at startTime, pre-stages
+                // as many as the DUC buffer holds with the DUC paused, releases
+                // the DUC at startTime and streams the remainder.  Samples
+                // already queued in the DUC play out ahead of the burst.
+                // Frames sent after the burst are untimed again.  If the DUC
+                // cannot be released, returns with only the staged frames sent.
+                TimedBurstStatus sendBurstAt(short * samples, unsigned int numFrames,
+                        unsigned int samplesPerFrame, double startTime,
+                        double tolerance = 0.001);
+
             protected:
                 bool setDUCRateIndexUnlocked(unsigned int ducRateIndex);
 
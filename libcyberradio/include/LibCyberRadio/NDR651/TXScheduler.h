@@ -0,0 +1,157 @@
+/***************************************************************************
+ * \file TXScheduler.h
+ *
+ * \brief NDR651 multi-DUC transmit scheduler.
+ *
+ * \author JVM
+ * \copyright Copyright (c) 2015-2021 CyberRadio Solutions, Inc.
+ *
+ */
+
+#ifndef INCLUDED_LIBCYBERRADIO_NDR651_TXSCHEDULER_H
+#define INCLUDED_LIBCYBERRADIO_NDR651_TXSCHEDULER_H
+
+#include "LibCyberRadio/Common/Debuggable.h"
+#include "LibCyberRadio/Common/Thread.h"
+#include "LibCyberRadio/NDR651/TXClient.h"
+#include <boost/atomic.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/lockfree/queue.hpp>
+#include <boost/lockfree/spsc_queue.hpp>
+#include <vector>
+
+/*!
+ * \brief Provides programming elements for controlling CyberRadio Solutions products.
+ */
+namespace LibCyberRadio
+{
+    /*!
+     * \brief Provides programming elements for controlling the CyberRadio Solutions
+     *    NDR651 radio.
+     */
+    namespace NDR651
+    {
+
+        /*!
+         * \brief Services several DUC channels from a single sender thread.
+         *
+         * Callers enqueue frames per channel with sendFrame(); frames are
+         * copied into a frame pool shared by all channels.  The scheduler
+         * thread (optionally pinned to a CPU) picks the next frame by
+         * start-time fair queuing: among channels that have a frame queued
+         * and flow-control credit for it, the channel that is furthest
+         * behind relative to its DUC sample rate goes next, with ties going
+         * to the channel with the most free DUC buffer space.  Sends never
+         * block on flow control, so one full DUC cannot stall the others;
+         * a frame the client refuses stays at the head of its queue and is
+         * counted as sent only once the client accepts it.
+         * When no channel can send, the thread sleeps until a frame is
+         * queued, re-checking flow-control credit every creditPollUs
+         * microseconds while frames are waiting.
+         *
+         * Each channel is a configured TXClient.  The scheduler starts and
+         * stops the clients, and does not take ownership of them.  Each
+         * channel should be fed by one producer thread.
+         */
+        class TXScheduler : public Thread, public Debuggable
+        {
+            public:
+                /*!
+                 * \brief Constructs a TXScheduler object.
+                 * \param txClients Configured transmit clients, one per DUC channel
+                 * \param framesPerChannel Queue depth per channel; the shared pool
+                 *    holds this many frames for each channel
+                 * \param senderCpu CPU to pin the sender thread to (-1 = no pinning)
+                 * \param maxSamplesPerFrame Largest frame that will be enqueued
+                 * \param debug Whether or not to produce debug output
+                 * \param creditPollUs Interval at which to re-check flow-control
+                 *    credit while frames are waiting for it, in microseconds
+                 */
+                TXScheduler(std::vector<TXClient *> txClients,
+                        unsigned int framesPerChannel = 64,
+                        int senderCpu = -1,
+                        unsigned int maxSamplesPerFrame = SAMPLES_PER_FRAME,
+                        bool debug = false,
+                        unsigned int creditPollUs = 100);
+                /*!
+                 * \brief Destroys a TXScheduler object.
+                 */
+                virtual ~TXScheduler();
+                /*!
+                 * \brief Starts the transmit clients and the sender thread.
+                 */
+                virtual void start();
+                /*!
+                 * \brief Stops the sender thread and the transmit clients.
+                 *
+                 * Waits for the sender thread to exit before stopping the
+                 * clients.
+                 * \param disableRF Whether or not to disable the transmitters
+                 */
+                void stop(bool disableRF = false);
+                /*!
+                 * \brief Executes the main processing loop for the thread.
+                 */
+                virtual void run();
+                /*!
+                 * \brief Queues a frame for transmission on a channel.
+                 *
+                 * Waits for a free frame if the shared pool is exhausted.
+                 * \param channel Channel index (position in the client list)
+                 * \param samples Interleaved I/Q samples
+                 * \param samplesPerFrame Number of samples in the frame
+                 * \returns True if the frame was queued, false otherwise.
+                 */
+                bool sendFrame(unsigned int channel, short * samples,
+                        unsigned int samplesPerFrame);
+                /*!
+                 * \brief Gets the number of channels serviced.
+                 * \returns The number of channels.
+                 */
+                unsigned int getNumChannels() { return _clients.size(); };
+                /*!
+                 * \brief Gets the number of frames queued on a channel.
+                 * \param channel Channel index
+                 * \returns The number of queued frames.
+                 */
+                unsigned int getQueueDepth(unsigned int channel);
+                /*!
+                 * \brief Gets the number of frames sent on a channel.
+                 * \param channel Channel index
+                 * \returns The number of frames sent.
+                 */
+                unsigned long long getFramesSent(unsigned int channel);
+
+            private:
+                int _selectChannel(void);
+                bool _framesQueued(void);
+
+            private:
+                std::vector<TXClient *> _clients;
+                unsigned int _framesPerChannel;
+                int _senderCpu;
+                unsigned int _maxSamplesPerFrame;
+                unsigned int _creditPollUs;
+                // Shared frame pool and per-channel queues of pool slots
+                std::vector<short> _framePool;
+                std::vector<unsigned int> _frameSamples;
+                boost::lockfree::queue<unsigned int> * _freeQueue;
+                std::vector<boost::lockfree::spsc_queue<unsigned int> *> _readyQueues;
+                // Scheduling state (sender thread only)
+                std::vector<double> _virtualTime;
+                std::vector<double> _sampleRate;
+                double _globalVirtualTime;
+                std::vector<unsigned long long> _framesSent;
+                boost::atomic<bool> _running;
+                // Wakes the sender when a frame is queued, and producers
+                // when a pool slot is freed
+                boost::mutex _wakeMutex;
+                boost::condition_variable _frameQueued;
+                boost::condition_variable _slotFreed;
+        };
+
+    } /* namespace NDR651 */
+}
+
+#endif /* INCLUDED_LIBCYBERRADIO_NDR651_TXSCHEDULER_H */
@@ -15,7 +15,10 @@
 #include "LibCyberRadio/NDR651/FlowControlClient.h"
 #include "LibCyberRadio/NDR651/PacketTypes.h"
 #include "LibCyberRadio/NDR651/TransmitSocket.h"
+#include "LibCyberRadio/NDR651/StatusDemux.h"
 #include "LibCyberRadio/NDR651/UdpStatusReceiver.h"
+#include <boost/thread.hpp>
+#include <boost/atomic.hpp>
 
 bool setCpuAffinity(int cpu);
 
@@ -191,6 +194,85 @@ namespace LibCyberRadio
                  * \brief Stops the packetizer.
                  */
                 void stop();
+                /*!
+                 * \brief Receives DUC status through a shared demultiplexer.
+                 *
+                 * Instead of running its own status receiver thread, the
+                 * packetizer registers its stream ID with the demux and
+                 * points the DUC status DIP entry at the demux's port.  The
+                 * demux must be started by the caller and outlive the
+                 * packetizer.  Must be called before start().
+                 * \param demux Shared status demultiplexer (NULL = own receiver)
+                 */
+                void setStatusDemux(StatusDemux * demux);
+                /*!
+                 * \brief Sets the number of samples carried in each VITA 49 frame.
+                 *
+                 * The IP/UDP lengths, IP checksum and VITA 49 size fields are
+                 * rebuilt for the new frame size.
+                 * \param samplesPerFrame Samples per frame (1 to MAX_SAMPLES_PER_FRAME)
+                 * \returns True if the action succeeds, false otherwise.
+                 */
+                bool setSamplesPerFrame(unsigned int samplesPerFrame);
+                /*!
+                 * \brief Gets the number of samples carried in each VITA 49 frame.
+                 * \returns The number of samples per frame.
+                 */
+                unsigned int getSamplesPerFrame(void) { return _samplesPerFrame; };
+                /*!
+                 * \brief Gets the largest frame size that fits in the MTU of
+                 *    the transmit interface.
+                 * \returns The number of samples per frame, or 0 if the MTU
+                 *    cannot be determined.
+                 */
+                unsigned int getMaxSamplesPerFrame(void);
+                /*!
+                 * \brief Sizes frames to fill the MTU of the transmit interface
+                 *    (for example, to use jumbo frames).
+                 * \returns True if the action succeeds, false otherwise.
+                 */
+                bool setSamplesPerFrameFromMtu(void);
+                /*!
+                 * \brief Sets the timestamp carried by the next VITA 49 frame.
+                 *
+                 * Once set, the timestamp advances by one frame period with
+                 * each frame sent.  Until this is called, frames carry a
+                 * zero timestamp.
+                 * \param seconds UTC time, integer seconds
+                 * \param fracTicks Fractional seconds, in DAC clock ticks
+                 */
+                void setTimestamp(unsigned int seconds, unsigned int fracTicks);
+                /*!
+                 * \brief Returns to untimed frames (TSI cleared, zero timestamp).
+                 */
+                void clearTimestamp(void);
+                /*!
+                 * \brief Enables or disables launch-time (SO_TXTIME) scheduling
+                 *    on the transmit sockets.
+                 *
+                 * Each frame's launch time follows from its VITA timestamp:
+                 * the first frame after enabling (or after setTimestamp())
+                 * launches launchOffsetNs from now, and later frames keep
+                 * their timestamp spacing.  Untimed frames launch
+                 * launchOffsetNs after they are sent.  The etf or fq qdisc
+                 * must be set up on the interface.
+                 * \param enable Whether or not to enable launch-time scheduling
+                 * \param clockId Reference clock for launch times (CLOCK_TAI
+                 *    for the etf qdisc, CLOCK_MONOTONIC for fq)
+                 * \param launchOffsetNs Delay of the first launch time, in
+                 *    nanoseconds
+                 * \param deadlineMode Whether or not the launch time is treated
+                 *    as a deadline rather than an exact time (etf only)
+                 * \returns True if the action succeeds, false otherwise.
+                 */
+                bool setTxTime(bool enable, clockid_t clockId = CLOCK_TAI,
+                        long long launchOffsetNs = 1000000, bool deadlineMode = false);
+                /*!
+                 * \brief Gets the number of frames the qdisc dropped because
+                 *    their launch time was missed or invalid.
+                 * \returns The number of dropped frames.
+                 */
+                unsigned long getTxTimeDropCount(void);
                 /*!
                  * \brief Sends a number of samples as a VITA 49 frame.
                  * \param samples Buffer of samples.  This buffer must be twice the
@@ -198,6 +280,55 @@ namespace LibCyberRadio
                  * \returns The number of samples actually sent.
                  */
                 unsigned int sendFrame(short * samples);
+                /*!
+                 * \brief Registers a cyclic waveform.
+                 *
+                 * The waveform is built once into complete frames (headers
+                 * included) held in locked memory.  Sending a cyclic frame
+                 * only updates the frame counters and timestamp in its
+                 * header, so no sample data is copied while looping.
+                 * Registering a new waveform replaces the old one.  The
+                 * frame size cannot be changed while a waveform is
+                 * registered.
+                 * \param samples Interleaved I/Q samples
+                 * \param numSamples Number of samples in the waveform.  This
+                 *    must be a multiple of the number of samples per frame.
+                 * \returns True if the action succeeds, false otherwise.
+                 */
+                bool setCyclicWaveform(const short * samples, unsigned int numSamples);
+                /*!
+                 * \brief Stops cyclic transmission and releases the
+                 *    registered cyclic waveform.
+                 */
+                void clearCyclicWaveform(void);
+                /*!
+                 * \brief Gets whether or not a cyclic waveform is registered.
+                 * \returns True if a waveform is registered, false otherwise.
+                 */
+                bool hasCyclicWaveform(void) { return (_cyclicNumFrames > 0); };
+                /*!
+                 * \brief Sends the next frame of the cyclic waveform.
+                 *
+                 * Waits for flow control in the same way as sendFrame().
+                 * \returns The number of samples actually sent.
+                 */
+                unsigned int sendCyclicFrame(void);
+                /*!
+                 * \brief Starts a thread that loops the cyclic waveform
+                 *    until stopCyclicTransmit() is called.
+                 * \param cpu CPU to pin the thread to (-1 = no pinning)
+                 * \returns True if the action succeeds, false otherwise.
+                 */
+                bool startCyclicTransmit(int cpu = -1);
+                /*!
+                 * \brief Stops the cyclic transmit thread.
+                 */
+                void stopCyclicTransmit(void);
+                /*!
+                 * \brief Gets whether or not the cyclic transmit thread is running.
+                 * \returns True if the thread is running, false otherwise.
+                 */
+                bool isCyclicTransmitRunning(void) { return _cyclicRunning; };
                 /*!
                  * \brief Gets whether or not the packetizer is connected.
                  * \returns True if the packetizer is connected, false otherwise.
@@ -214,10 +345,63 @@ namespace LibCyberRadio
                 unsigned int getDuchsPeThresh(void) { return _duchsPeThresh; };
                 unsigned int getDuchsPeriod(void) { return _duchsPeriod; };
                 bool getUpdatePE(void) { return _updatePE; };
+                /*!
+                 * \brief Enables or disables predictive flow-control credit.
+                 *
+                 * Credits the drain the DUC is expected to have made since
+                 * the last status frame, at the DUC sample rate, so that
+                 * smaller buffers stay full between status updates.  See
+                 * UdpStatusReceiver::setPredictiveCredit().
+                 * \param enable Whether or not to predict the drain
+                 */
+                void setPredictiveCredit(bool enable);
+                bool getPredictiveCredit(void) { return _predictiveCredit; };
+                /*!
+                 * \brief Sets a target transmit latency.
+                 *
+                 * The latency of a frame is how long its last sample waits
+                 * in the DUC buffer before it is played.  The credit cap
+                 * from UdpStatusReceiver::setMaxFreeSpace() starts at the
+                 * target; after each frame the allowed buffer occupancy is
+                 * steered from the status stream so that the achieved
+                 * latency settles on the target, but never below what the
+                 * producer's measured inter-frame gaps need to avoid an
+                 * underrun.
+                 * \param seconds Target latency, in seconds (0 = no target)
+                 * \returns True if the action succeeds, false otherwise.
+                 */
+                bool setTargetLatency(double seconds);
+                double getTargetLatency(void) { return _targetLatency; };
+                /*!
+                 * \brief Gets the buffer occupancy currently allowed by the
+                 *    latency control loop, as a latency.
+                 * \returns The allowed latency, in seconds.
+                 */
+                double getAllowedLatency(void);
+                /*!
+                 * \brief Gets the measured producer rate.
+                 * \returns The average rate frames are sent at, in samples
+                 *    per second.
+                 */
+                double getProducerRate(void) { return _producerRate; };
+                /*!
+                 * \brief Gets a percentile of the achieved latency over the
+                 *    most recent frames sent with a target latency.
+                 * \param percentile Percentile, from 0 to 100
+                 * \returns The latency, in seconds.
+                 */
+                double getLatencyPercentile(double percentile);
+                /*!
+                 * \brief Clears the achieved-latency history.
+                 */
+                void resetLatencyStats(void);
 
             private:
                 unsigned int _waitLoop(void);
+                void _updateLatencyControl(void);
                 void _incrementVitaHeader(void);
+                bool _sendCurrentFrame(unsigned char * frame);
+                uint64_t _getLaunchTime(void);
                 bool setEthernetHeader(const std::string& sourceMac,
                         const std::string& destMac);
                 bool setIpHeader(const std::string& sourceIp,
@@ -225,6 +409,10 @@ namespace LibCyberRadio
                 bool setUdpHeader(unsigned short sourcePort,
                         unsigned short destPort);
                 bool setVitaHeader(unsigned int streamId);
+                void _buildFrame(void);
+                void _updateIpChecksum(void);
+                void _refreshCyclicHeaders(void);
+                void _cyclicLoop(int cpu);
 
             private:
                 unsigned int _frameCount, _pauseCount;
@@ -251,11 +439,29 @@ namespace LibCyberRadio
                 unsigned int _numSock, _currentSockIndex;
                 FlowControlClient * _fcClient;
                 UdpStatusReceiver * _statusRx;
-                struct TxFrame _frame;
+                StatusDemux * _statusDemux;
+                std::vector<unsigned char> _frameBuffer;
+                struct TxFrameHeader * _frame;
+                short * _payload;
+                struct Vita49Trailer * _trailer;
+                bool _rawFrame;
                 unsigned char * _frameStart;
                 unsigned int _frameLength;
                 /* State data */
                 unsigned int _samplesSent;
+                // Timestamp set by setTimestamp() and samples sent since
+                unsigned int _timestampSeconds;
+                unsigned int _timestampTicks;
+                unsigned long long _timestampSamples;
+                // Launch-time scheduling; launch times are anchored to the
+                // first frame's VITA timestamp
+                bool _useTxTime;
+                clockid_t _txTimeClock;
+                long long _txTimeOffsetNs;
+                bool _txTimeDeadline;
+                bool _txTimeAnchored;
+                uint64_t _txTimeBaseNs;
+                uint64_t _txTimeBaseVitaNs;
                 std::string _sMac;
                 std::string _dMac;
                 std::string _sIp;
@@ -269,7 +475,37 @@ namespace LibCyberRadio
                 unsigned int _samplesPerFrame;
                 unsigned int _duchsPeriod, _duchsPfThresh, _duchsPeThresh;
                 bool _updatePE;
+                bool _predictiveCredit;
+                /* Latency targeting (sending thread only, except history) */
+                double _targetLatency;
+                double _allowedOccupancy;
+                double _latencyAvg;
+                double _producerGapPeak;
+                double _producerRate;
+                bool _haveLastSend;
+                boost::chrono::steady_clock::time_point _lastSendTime;
+                std::vector<float> _latencyHistory;
+                unsigned int _latencyIndex;
+                unsigned int _latencyCount;
+                boost::mutex _latencyMutex;
+                // Held while a frame is built, sent or has its header
+                // changed, so the frame buffer is never reallocated under a
+                // sending thread and a header change always marks the cyclic
+                // frames stale after they were last refreshed.  Not recursive:
+                // the header setters and _buildFrame() take it themselves.
+                boost::mutex _sendMutex;
                 unsigned int _txinvMode;
+                /* Cyclic waveform (prebuilt frames, laid out back to back) */
+                std::vector<unsigned char> _cyclicFrames;
+                unsigned int _cyclicNumFrames;
+                unsigned int _cyclicFrameBytes;
+                unsigned int _cyclicIndex;
+                bool _cyclicLocked;
+                // Set by any setter that changes the frame header; read by
+                // the cyclic sending thread
+                boost::atomic<bool> _cyclicHeadersStale;
+                boost::thread _cyclicThread;
+                boost::atomic<bool> _cyclicRunning;
 
         };
 
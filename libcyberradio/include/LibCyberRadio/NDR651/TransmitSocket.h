@@ -13,6 +13,8 @@
 
 #include <string>
 #include <vector>
+#include <stdint.h>
+#include <time.h>
 #include <boost/thread/mutex.hpp>
 
 /*!
@@ -57,6 +59,11 @@ namespace LibCyberRadio
                  * \returns The IP broadcast address string.
                  */
                 std::string getIpBroadcastAddress();
+                /*!
+                 * \brief Gets the MTU of the interface.
+                 * \returns The MTU, in bytes, or 0 if it cannot be determined.
+                 */
+                int getMtu();
                 /*!
                  * \brief Sends a frame of data.
                  * \param frame The data to send
@@ -64,6 +71,60 @@ namespace LibCyberRadio
                  * \returns True if the action succeeds, false otherwise.
                  */
                 bool sendFrame(unsigned char * frame, const int & frameLen);
+                /*!
+                 * \brief Sends a frame of data at a given launch time.
+                 *
+                 * The launch time is passed to the kernel as an SCM_TXTIME
+                 * control message, so the frame is held by the qdisc (etf
+                 * or fq) until that time.  If launch-time scheduling is not
+                 * enabled, the frame is sent immediately.
+                 * \param frame The data to send
+                 * \param frameLen The length of the data
+                 * \param txTimeNs Launch time, in nanoseconds on the clock
+                 *    given to setTxTime()
+                 * \returns True if the action succeeds, false otherwise.
+                 */
+                bool sendFrame(unsigned char * frame, const int & frameLen,
+                        uint64_t txTimeNs);
+                /*!
+                 * \brief Enables or disables SO_TXTIME launch-time scheduling.
+                 *
+                 * The kernel cannot clear SO_TXTIME once it is set, so
+                 * disabling launch-time scheduling reopens the socket.
+                 * \param enable Whether or not to enable launch-time scheduling
+                 * \param clockId Reference clock for launch times (CLOCK_TAI
+                 *    for the etf qdisc, CLOCK_MONOTONIC for fq)
+                 * \param deadlineMode Whether or not the launch time is treated
+                 *    as a deadline rather than an exact time (etf only)
+                 * \returns True if the action succeeds, false otherwise.
+                 */
+                bool setTxTime(bool enable, clockid_t clockId = CLOCK_TAI,
+                        bool deadlineMode = false);
+                /*!
+                 * \brief Gets the current time on the launch-time clock.
+                 * \returns The time, in nanoseconds on the clock given to
+                 *    setTxTime()
+                 */
+                uint64_t getTxTimeNow(void);
+                /*!
+                 * \brief Gets the number of frames the qdisc dropped because
+                 *    their launch time was missed or invalid.
+                 *
+                 * Drops reported since the last send are collected first.
+                 * \returns The number of dropped frames.
+                 */
+                unsigned long getTxTimeDropCount(void);
+                /*!
+                 * \brief Reads launch-time errors from a socket's error queue.
+                 *
+                 * The etf qdisc reports each frame it drops on the sending
+                 * socket's error queue (origin SO_EE_ORIGIN_TXTIME).  The queue
+                 * is read without blocking.
+                 * \param sockfd The socket to read
+                 * \returns The number of dropped frames reported.
+                 */
+                static unsigned int readTxTimeErrors(int sockfd);
+                bool isUsingTxTime(void) { return _useTxTime; };
                 bool isUsingRawSocket(void) { return _isRaw; };
                 bool isUsingUdpSocket(void) { return !_isRaw; };
                 // bool sendFrame(std::vector<short> frame);
@@ -77,6 +138,9 @@ namespace LibCyberRadio
                 int _txBytes;
                 long unsigned int _sendCount, _byteCount;
                 unsigned int _sport;
+                bool _useTxTime;
+                clockid_t _txTimeClock;
+                unsigned long _txTimeDropCount;
 
                 bool _makeSocket();
                 bool _makeRawSocket();
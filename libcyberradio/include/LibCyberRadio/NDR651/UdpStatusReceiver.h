@@ -12,6 +12,9 @@
 #define INCLUDED_LIBCYBERRADIO_NDR651_UDPSTATUSRECEIVER_H_
 
 #include <boost/thread/mutex.hpp>
+#include <boost/thread/tss.hpp>
+#include <boost/atomic.hpp>
+#include <boost/chrono.hpp>
 #include "LibCyberRadio/Common/Debuggable.h"
 #include "LibCyberRadio/Common/Thread.h"
 
@@ -31,8 +34,16 @@ namespace LibCyberRadio
     namespace NDR651
     {
 
+        struct TxStatusFrame;
+
         /*!
          * \brief UDP status receiver.
+         *
+         * Flow-control credit (free DUC buffer space, in samples) is an
+         * atomic counter: the status thread replaces it when a status frame
+         * arrives, and senders take from it without locking.  The mutex
+         * and condition variable are only used to put senders to sleep
+         * while they wait for credit.
          */
         class UdpStatusReceiver: public LibCyberRadio::Thread, public LibCyberRadio::Debuggable
         {
@@ -53,6 +64,16 @@ namespace LibCyberRadio
                  * \brief Executes the main processing loop for the thread.
                  */
                 virtual void run();
+                /*!
+                 * \brief Applies a DUC status frame to the flow-control state.
+                 *
+                 * The receive thread calls this for every frame it reads.  A
+                 * receiver constructed with port 0 opens no socket, and can
+                 * instead be fed by a StatusDemux that shares one socket
+                 * among several DUC channels.
+                 * \param status Status frame
+                 */
+                void processStatusFrame(const struct TxStatusFrame * status);
                 /*!
                  * \brief Sets the interface name.
                  * \param ifname Ethernet interface name
@@ -82,7 +103,9 @@ namespace LibCyberRadio
                 /*!
                  * \brief Determines if it is OK to send data.
                  * \param pendingSamples Number of samples pending
-                 * \param lockIfOk Whether or not to lock sending if sending is OK
+                 * \param lockIfOk Whether or not to reserve the credit if sending
+                 *    is OK.  The reservation is settled by the calling thread's
+                 *    next call to sentNSamples().
                  * \returns True if OK to send, false otherwise.
                  */
                 bool okToSend(long int pendingSamples, bool lockIfOk);
@@ -104,13 +127,79 @@ namespace LibCyberRadio
                 int getMaxFreeSpace(void) { return _freeSpaceMax; };
                 //~ bool setUdpPort(unsigned int port);
                 int getUdpPort(void) { return _port; };
+                /*!
+                 * \brief Waits until there is room to send a number of samples.
+                 *
+                 * The caller is woken as soon as a status frame adds enough
+                 * credit.  The wait is a Boost thread interruption point.
+                 * \param numSamples Number of samples to send
+                 * \param timeout Maximum time to wait, in seconds (negative =
+                 *    wait indefinitely)
+                 * \returns True if there is room, false if the wait timed out
+                 *    or the receiver is shutting down.
+                 */
+                bool blockUntilAvailable(long int numSamples, double timeout = -1.0);
+                /*!
+                 * \brief Enables or disables predictive credit.
+                 *
+                 * Between status frames the DUC keeps draining its buffer at
+                 * the DUC sample rate.  With predictive credit enabled, the
+                 * drain expected since the last status frame is added to the
+                 * credit as time passes, limited to what the DUC can have
+                 * buffered, so senders need not stall until the next frame.
+                 * Each status frame replaces the prediction with the radio's
+                 * figure, and overestimates seen there are held back from
+                 * later predictions.
+                 * The sample rate is kept even when prediction is disabled,
+                 * for use by getBufferOccupancy().
+                 * \param enable Whether or not to predict the drain
+                 * \param sampleRate DUC sample rate, in samples per second
+                 */
+                void setPredictiveCredit(bool enable, double sampleRate);
+                /*!
+                 * \brief Gets whether or not predictive credit is enabled.
+                 * \returns True if enabled, false otherwise.
+                 */
+                bool isPredictiveCredit(void) { return _predictive; };
+                /*!
+                 * \brief Gets how far the prediction was off at the last
+                 *    status frame.
+                 * \returns Predicted minus reported credit, in samples
+                 *    (positive = the prediction was too optimistic).
+                 */
+                long int getPredictionError(void) { return _predictionError; };
+                /*!
+                 * \brief Gets the safety margin withheld from predicted drain.
+                 * \returns The margin, in samples.
+                 */
+                long int getPredictionMargin(void) { return (long int)_predictionMargin; };
+                /*!
+                 * \brief Sets the most samples the DUC buffer may hold.
+                 *
+                 * Credit from each status frame is limited so that the
+                 * buffered samples stay at or below this target.  This bounds
+                 * how long a newly sent sample waits before it is played.
+                 * \param samples Target occupancy, in samples
+                 * \returns The target occupancy in effect.
+                 */
+                int setTargetOccupancy(int samples);
+                int getTargetOccupancy(void) { return _targetOccupancy; };
+                /*!
+                 * \brief Estimates the number of samples buffered in the DUC.
+                 *
+                 * Starts from the last status frame and accounts for the
+                 * samples sent and, at the sample rate given to
+                 * setPredictiveCredit(), played out since.
+                 * \returns The estimated occupancy, in samples.
+                 */
+                long int getBufferOccupancy(void);
 
             private:
                 int _sockfd;
                 char _rxbuff[MAX_RX_SIZE];
                 fd_set set;
                 boost::mutex _fcMutex, _selMutex;
-                bool _sendLock;
+                boost::condition_variable _fcCondition;
                 bool _shutdown;
                 bool _updatePE;
 
@@ -118,11 +207,33 @@ namespace LibCyberRadio
                 unsigned int _port;
                 uint64_t timeoutCount;
 
-                int _651freeSpace;
-                int _freeSpaceMax;
+                boost::atomic<long int> _651freeSpace;
+                boost::atomic<int> _freeSpaceMax;
+                // Credit reserved by okToSend(..., true) and not yet settled
+                // by sentNSamples(), per sending thread
+                boost::thread_specific_ptr<long int> _reservedSamples;
+
+                // Predictive credit.  _predictMutex guards the model; senders
+                // only try_lock it, so they never wait on one another.
+                boost::mutex _predictMutex;
+                boost::atomic<bool> _predictive;
+                double _drainRate;
+                boost::atomic<bool> _haveUpdate;
+                long int _drainHeadroom;
+                long int _drainCredited;
+                boost::atomic<long int> _sentSinceUpdate;
+                boost::atomic<int> _lastReported;
+                boost::atomic<long long> _updateTimeNs;
+                boost::atomic<int> _targetOccupancy;
+                boost::atomic<long int> _predictionError;
+                double _predictionMargin;
 
                 bool _makeSocket(void);
                 bool _setFreeSpace(int, bool, bool, bool);
+                long int& _threadReservation(void);
+                void _creditDrain(void);
+                void _creditDrainLocked(void);
+                double _secondsSinceUpdate(void);
         };
 
     } /* namespace NDR651 */
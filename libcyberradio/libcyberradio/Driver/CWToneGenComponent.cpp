@@ -184,11 +184,12 @@ namespace LibCyberRadio
         bool CWToneGenComponent::setConfiguration(ConfigurationDict& cfg)
         {
             this->debug("[CWToneGenComponent::setConfiguration] Called\n");
+            ConfigurationDict delta = this->changedConfiguration(cfg);
             // Call the "grandparent" version of this method instead of the
             // parent version. We want the normalization, but not the
             // automatic enabling.
             bool ret = Configurable::setConfiguration(cfg);
-            // Use the keys provided in the *incoming* dictionary to determine
+            // Use the keys that changed in the *incoming* dictionary to determine
             // what needs to be changed via hardware calls.
             double adjFrequency = _frequency;
             double adjAmplitude = _amplitude;
@@ -200,42 +201,42 @@ namespace LibCyberRadio
             bool adjEnabled = _enabled;
             bool toneCmdNeedsExecuting = false;
             bool sweepCmdNeedsExecuting = false;
-            if ( cfg.hasKey("enable") && _config.hasKey("enable") )
+            if ( delta.hasKey("enable") && _config.hasKey("enable") )
             {
                 adjEnabled = getConfigurationValueAsBool("enable");
                 toneCmdNeedsExecuting = true;
             }
-            if ( cfg.hasKey("cwFrequency") && _config.hasKey("cwFrequency") )
+            if ( delta.hasKey("cwFrequency") && _config.hasKey("cwFrequency") )
             {
                 adjFrequency = getConfigurationValueAsDbl("cwFrequency");
                 toneCmdNeedsExecuting = true;
             }
-            if ( cfg.hasKey("cwAmplitude") && _config.hasKey("cwAmplitude") )
+            if ( delta.hasKey("cwAmplitude") && _config.hasKey("cwAmplitude") )
             {
                 adjAmplitude = getConfigurationValueAsInt("cwAmplitude");
                 toneCmdNeedsExecuting = true;
             }
-            if ( cfg.hasKey("cwPhase") && _config.hasKey("cwPhase") )
+            if ( delta.hasKey("cwPhase") && _config.hasKey("cwPhase") )
             {
                 adjPhase = getConfigurationValueAsInt("cwPhase");
                 toneCmdNeedsExecuting = true;
             }
-            if ( cfg.hasKey("cwSweepStart") && _config.hasKey("cwSweepStart") )
+            if ( delta.hasKey("cwSweepStart") && _config.hasKey("cwSweepStart") )
             {
                 adjStart = getConfigurationValueAsDbl("cwSweepStart");
                 sweepCmdNeedsExecuting = true;
             }
-            if ( cfg.hasKey("cwSweepStop") && _config.hasKey("cwSweepStop") )
+            if ( delta.hasKey("cwSweepStop") && _config.hasKey("cwSweepStop") )
             {
                 adjStop = getConfigurationValueAsDbl("cwSweepStop");
                 sweepCmdNeedsExecuting = true;
             }
-            if ( cfg.hasKey("cwSweepStep") && _config.hasKey("cwSweepStep") )
+            if ( delta.hasKey("cwSweepStep") && _config.hasKey("cwSweepStep") )
             {
                 adjStep = getConfigurationValueAsDbl("cwSweepStep");
                 sweepCmdNeedsExecuting = true;
             }
-            if ( cfg.hasKey("cwSweepDwell") && _config.hasKey("cwSweepDwell") )
+            if ( delta.hasKey("cwSweepDwell") && _config.hasKey("cwSweepDwell") )
             {
                 adjDwell = getConfigurationValueAsInt("cwSweepDwell");
                 sweepCmdNeedsExecuting = true;
@@ -262,6 +263,8 @@ namespace LibCyberRadio
                 _dwellTime = adjDwell;
                 updateConfigurationDict();
             }
+            if ( !ret )
+                this->invalidate();
             this->debug("[CWToneGenComponent::setConfiguration] Returning\n");
             return ret;
         }
@@ -386,6 +389,7 @@ namespace LibCyberRadio
 
         bool CWToneGenComponent::setFrequency(double freq)
         {
+            this->ensureState();
             bool ret = false;
             if ( _config.hasKey("frequency") )
             {
@@ -409,6 +413,7 @@ namespace LibCyberRadio
 
         bool CWToneGenComponent::setAmplitude(double amp)
         {
+            this->ensureState();
             bool ret = false;
             if ( _config.hasKey("cwAmplitude") )
             {
@@ -433,6 +438,7 @@ namespace LibCyberRadio
 
         bool CWToneGenComponent::setPhase(double phase)
         {
+            this->ensureState();
             bool ret = false;
             if ( _config.hasKey("cwPhase") )
             {
@@ -10,11 +10,14 @@
  ***************************************************************************/
 
 #include "LibCyberRadio/Driver/Configurable.h"
+#include <boost/format.hpp>
 #include <sstream>
 #include <algorithm>
 #include <cstdio>
 #include <cstdarg>
 #include <ctype.h>
+#include <cstdlib>
+#include <cmath>
 
 
 namespace LibCyberRadio
@@ -56,7 +59,11 @@ namespace LibCyberRadio
 
         Configurable::Configurable(const std::string& name, bool debug) :
             Debuggable(debug, name),
-            _name(name)
+            _name(name),
+            _lazyQuery(false),
+            _stateTtl(0.0),
+            _stateValid(false),
+            _refreshing(false)
         {
         }
 
@@ -66,7 +73,12 @@ namespace LibCyberRadio
 
         Configurable::Configurable(const Configurable& other) :
             _name(other._name),
-            _config(other._config)
+            _config(other._config),
+            _lazyQuery(other._lazyQuery),
+            _stateTtl(other._stateTtl),
+            _stateValid(other._stateValid),
+            _refreshing(false),
+            _stateTime(other._stateTime)
         {
         }
 
@@ -76,6 +88,10 @@ namespace LibCyberRadio
             {
                 _name = other._name;
                 _config = other._config;
+                _lazyQuery = other._lazyQuery;
+                _stateTtl = other._stateTtl;
+                _stateValid = other._stateValid;
+                _stateTime = other._stateTime;
             }
             return *this;
         }
@@ -92,6 +108,7 @@ namespace LibCyberRadio
 
         ConfigurationDict Configurable::getConfiguration() const
         {
+            this->ensureState();
             return _config;
         }
 
@@ -174,6 +191,20 @@ namespace LibCyberRadio
             return true;
         }
 
+        std::string Configurable::validateConfiguration(const ConfigurationDict& cfg) const
+        {
+            std::string ret = "";
+            for (ConfigurationDict::const_iterator it = cfg.begin(); it != cfg.end(); it++)
+            {
+                if ( _config.find(it->first) == _config.end() )
+                {
+                    ret = "Unsupported setting for " + _name + ": " + it->first;
+                    break;
+                }
+            }
+            return ret;
+        }
+
         bool Configurable::setConfigurationValue(const std::string& key,
                 const std::string& value)
         {
@@ -218,6 +249,132 @@ namespace LibCyberRadio
         {
         }
 
+        void Configurable::refresh()
+        {
+            _refreshing = true;
+            this->queryConfiguration();
+            _refreshing = false;
+            _stateValid = true;
+            _stateTime = boost::chrono::steady_clock::now();
+        }
+
+        void Configurable::invalidate()
+        {
+            _stateValid = false;
+        }
+
+        void Configurable::setLazyQuery(bool lazy, double ttl)
+        {
+            _lazyQuery = lazy;
+            _stateTtl = ttl;
+        }
+
+        bool Configurable::isLazyQuery() const
+        {
+            return _lazyQuery;
+        }
+
+        bool Configurable::isStateCurrent() const
+        {
+            if ( !_stateValid )
+                return false;
+            if ( _stateTtl <= 0.0 )
+                return true;
+            boost::chrono::duration<double> age = boost::chrono::steady_clock::now() - _stateTime;
+            return ( age.count() < _stateTtl );
+        }
+
+        void Configurable::ensureState() const
+        {
+            // Reads made while the state is being queried see the state as is
+            if ( _lazyQuery && !_refreshing && !this->isStateCurrent() )
+            {
+                Configurable* self = const_cast<Configurable*>(this);
+                self->debug("[Configurable::ensureState] Querying state\n");
+                self->refresh();
+            }
+        }
+
+        // Values that both parse as numbers compare numerically, so that
+        // "10" and "10.000000" are the same setting.  The comparison is
+        // exact: settings such as frequencies in Hz are large enough that a
+        // relative tolerance would hide a real change.
+        static bool sameConfigValue(const std::string& a, const std::string& b)
+        {
+            if ( a == b )
+                return true;
+            const char* aStr = a.c_str();
+            const char* bStr = b.c_str();
+            char* aEnd = NULL;
+            char* bEnd = NULL;
+            double aVal = strtod(aStr, &aEnd);
+            double bVal = strtod(bStr, &bEnd);
+            if ( (aEnd == aStr) || (*aEnd != '\0') ||
+                 (bEnd == bStr) || (*bEnd != '\0') )
+                return false;
+            return ( aVal == bVal );
+        }
+
+        ConfigurationDict Configurable::changedConfiguration(
+                const ConfigurationDict& cfg)
+        {
+            this->ensureState();
+            ConfigurationDict normCfg = normalizedConfigurationDict(cfg);
+            if ( !this->isStateCurrent() )
+                return normCfg;
+            ConfigurationDict ret;
+            ConfigurationDict::const_iterator cit;
+            for (ConfigurationDict::iterator it = normCfg.begin(); it != normCfg.end(); it++)
+            {
+                cit = _config.find(it->first);
+                if ( (cit == _config.end()) || !sameConfigValue(cit->second, it->second) )
+                    ret[it->first] = it->second;
+            }
+            this->debug("[Configurable::changedConfiguration] %u of %u keys changed\n",
+                    (unsigned int)ret.size(), (unsigned int)normCfg.size());
+            return ret;
+        }
+
+        std::string Configurable::validateRange(const ConfigurationDict& cfg,
+                const std::string& key, double min, double max) const
+        {
+            std::string ret = "";
+            ConfigurationDict::const_iterator it = cfg.find(key);
+            ConfigurationDict::const_iterator cit = _config.find(key);
+            if ( (it != cfg.end()) && (cit != _config.end()) &&
+                 !sameConfigValue(cit->second, it->second) )
+            {
+                const char* str = it->second.c_str();
+                char* end = NULL;
+                double val = strtod(str, &end);
+                if ( (end == str) || (*end != '\0') )
+                    ret = "Invalid " + key + " for " + _name + ": " + it->second;
+                else if ( (min < max) && ((val < min) || (val > max)) )
+                    ret = ( boost::format("%s for %s out of range: %s (%g to %g)") %
+                            key % _name % it->second % min % max ).str();
+            }
+            return ret;
+        }
+
+        std::string Configurable::validateChoice(const ConfigurationDict& cfg,
+                const std::string& key, const BasicIntList& choices) const
+        {
+            std::string ret = "";
+            ConfigurationDict::const_iterator it = cfg.find(key);
+            ConfigurationDict::const_iterator cit = _config.find(key);
+            if ( (it != cfg.end()) && (cit != _config.end()) && !choices.empty() &&
+                 !sameConfigValue(cit->second, it->second) )
+            {
+                const char* str = it->second.c_str();
+                char* end = NULL;
+                long val = strtol(str, &end, 10);
+                if ( (end == str) || (*end != '\0') ||
+                     (std::find(choices.begin(), choices.end(), (int)val) == choices.end()) )
+                    ret = "Invalid " + key + " for " + _name + ": " + it->second;
+            }
+            return ret;
+        }
+
         void Configurable::initConfigurationDict()
         {
         }
@@ -84,22 +84,25 @@ namespace LibCyberRadio
         bool DataPort::setConfiguration(ConfigurationDict& cfg)
         {
             this->debug("[DataPort::setConfiguration] Called\n");
+            ConfigurationDict delta = this->changedConfiguration(cfg);
             // Call the base-class version to modify the configuration dictionary
             bool ret = Configurable::setConfiguration(cfg);
-            // Use the keys provided in the *incoming* dictionary to determine
+            // Use the keys that changed in the *incoming* dictionary to determine
             // what needs to be changed.
-            if ( cfg.hasKey("sourceIP") && _config.hasKey("sourceIP") )
+            if ( delta.hasKey("sourceIP") && _config.hasKey("sourceIP") )
             {
                 ret &= setSourceIP(cfg["sourceIP"]);
             }
-            if ( cfg.hasKey("errors") && _config.hasKey("errors") )
+            if ( delta.hasKey("errors") && _config.hasKey("errors") )
             {
                 ret &= enableErrors( cfg["errors"].asBool() );
             }
-            if ( cfg.hasKey("flowControl") && _config.hasKey("flowControl") )
+            if ( delta.hasKey("flowControl") && _config.hasKey("flowControl") )
             {
                 ret &= enableFlowControl( cfg["flowControl"].asBool() );
             }
+            if ( !ret )
+                this->invalidate();
             this->debug("[DataPort::setConfiguration] Returning\n");
             return ret;
         }
@@ -147,6 +150,7 @@ namespace LibCyberRadio
 
         std::string DataPort::getSourceIP() const
         {
+            this->ensureState();
             return _sourceIP;
         }
 
@@ -168,6 +172,7 @@ namespace LibCyberRadio
 
         std::string DataPort::getDestMACAddress(int dipIndex) const
         {
+            this->ensureState();
             std::string ret;
             if ( _macAddresses.find(dipIndex) != _macAddresses.end() )
                 ret = _macAddresses.at(dipIndex);
@@ -176,6 +181,7 @@ namespace LibCyberRadio
 
         std::string DataPort::getDestIPAddress(int dipIndex) const
         {
+            this->ensureState();
             std::string ret;
             if ( _ipAddresses.find(dipIndex) != _ipAddresses.end() )
                 ret = _ipAddresses.at(dipIndex);
@@ -184,6 +190,7 @@ namespace LibCyberRadio
 
         unsigned int DataPort::getDestSourcePort(int dipIndex) const
         {
+            this->ensureState();
             int ret = 0;
             if ( _sourcePorts.find(dipIndex) != _sourcePorts.end() )
                 ret = _sourcePorts.at(dipIndex);
@@ -192,6 +199,7 @@ namespace LibCyberRadio
 
         unsigned int DataPort::getDestDestPort(int dipIndex) const
         {
+            this->ensureState();
             int ret = 0;
             if ( _destPorts.find(dipIndex) != _destPorts.end() )
                 ret = _destPorts.at(dipIndex);
@@ -20,7 +20,14 @@
 #include "LibCyberRadio/Common/Pythonesque.h"
 #include "LibCyberRadio/Common/BasicList.h"
 #include "LibCyberRadio/Common/Debuggable.h"
+#include <boost/bind.hpp>
+#include <boost/format.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
 #include <algorithm>
+#include <set>
 #include <stdlib.h>
 #include <iostream>
 
@@ -31,115 +38,295 @@ namespace LibCyberRadio
     namespace Driver
     {
 
-        RadioHandlerPtr getRadioObject(
-                const std::string& nameString,
-                const std::string& device,
-                int devicePort,
-                bool debug)
+        // Creates the radio handler for an adjusted (lower-case, alphanumeric)
+        // name string, or returns NULL if there is none.
+        static RadioHandler* createRadioHandler(
+                const std::string& adjNameString,
+                bool debug,
+                Debuggable& dbg)
         {
-            Debuggable dbg(debug, "getRadioObject");
-            dbg.debug("Called\n");
-            dbg.debug("-- Name string = \"%s\"\n", nameString.c_str());
-            RadioHandlerPtr sptr = NULL;
-            // Adjust the incoming name string
-            // -- NOTE: This operation requires that we pre-fill the adjusted
-            //    name string (assume all characters are copied), and then
-            //    trim the string after the conditional copy.
-            std::string adjNameString = nameString;
-            // -- Copy alphanumeric characters from input string to adjusted
-            //    name string
-            std::string::iterator its = std::copy_if(nameString.begin(),
-                                                     nameString.end(),
-                                                     adjNameString.begin(),
-                                                     isalnum );
-            adjNameString.erase(its, adjNameString.end());
-            // -- Convert adjusted name string to lower case
-            std::transform(adjNameString.begin(), adjNameString.end(),
-                           adjNameString.begin(), tolower);
-            // [FUTURE] Support radio auto-detection
-            // Get an appropriate radio handler object based on name string
+            RadioHandler* ret = NULL;
             dbg.debug("Getting handler for \"%s\"...\n", adjNameString.c_str());
             if ( adjNameString == "ndr308" )
             {
                 dbg.debug("-- FOUND ndr308\n");
-                sptr = std::shared_ptr<RadioHandler>(
-                        (RadioHandler*)new NDR308::RadioHandler(debug)
-                       );
+                ret = (RadioHandler*)new NDR308::RadioHandler(debug);
             }
             else if ( adjNameString == "ndr308ts" )
             {
                 dbg.debug("-- FOUND ndr308ts\n");
-                sptr = std::shared_ptr<RadioHandler>(
-                        (RadioHandler*)new NDR308TS::RadioHandler(debug)
-                       );
+                ret = (RadioHandler*)new NDR308TS::RadioHandler(debug);
             }
             else if ( adjNameString == "ndr308a" )
             {
                 dbg.debug("-- FOUND ndr308\n");
-                sptr = std::shared_ptr<RadioHandler>(
-                        (RadioHandler*)new NDR308::RadioHandler(debug)
-                       );
+                ret = (RadioHandler*)new NDR308::RadioHandler(debug);
             }
             else if ( adjNameString == "ndr651" )
             {
                 dbg.debug("-- FOUND ndr651\n");
-                sptr = std::shared_ptr<RadioHandler>(
-                        (RadioHandler*)new NDR651::RadioHandler(debug)
-                       );
+                ret = (RadioHandler*)new NDR651::RadioHandler(debug);
             }
             else if ( adjNameString == "ndr810" )
             {
                 dbg.debug("-- FOUND ndr810\n");
-                sptr = std::shared_ptr<RadioHandler>(
-                        (RadioHandler*)new NDR810::RadioHandler(debug)
-                       );
+                ret = (RadioHandler*)new NDR810::RadioHandler(debug);
             }
             else if ( adjNameString == "ndr472" )
             {
                 dbg.debug("-- FOUND ndr472\n");
-                sptr = std::shared_ptr<RadioHandler>(
-                        (RadioHandler*)new NDR472::RadioHandler(debug)
-                       );
+                ret = (RadioHandler*)new NDR472::RadioHandler(debug);
             }
             else if ( adjNameString == "ndr551" )
             {
                 dbg.debug("-- FOUND ndr551\n");
-                sptr = std::shared_ptr<RadioHandler>(
-                        (RadioHandler*)new NDR551::RadioHandler(debug)
-                       );
+                ret = (RadioHandler*)new NDR551::RadioHandler(debug);
             }
             else if ( adjNameString == "ndr358" )
             {
                 dbg.debug("-- FOUND ndr358\n");
-                sptr = std::shared_ptr<RadioHandler>(
-                        (RadioHandler*)new NDR358::RadioHandler(debug)
-                       );
+                ret = (RadioHandler*)new NDR358::RadioHandler(debug);
             }
             else if ( adjNameString == "ndr324" )
             {
                 dbg.debug("-- FOUND ndr324\n");
-                sptr = std::shared_ptr<RadioHandler>(
-                        (RadioHandler*)new NDR324::RadioHandler(debug)
-                       );
+                ret = (RadioHandler*)new NDR324::RadioHandler(debug);
             }
             else
             {
                 dbg.debug("-- CANNOT FIND %s\n", adjNameString.c_str());
             }
+            return ret;
+        }
+
+        // Names of the radio types that auto-detection chooses among.  A name
+        // comes before any name that is its prefix, so it matches first.
+        static const char* detectableNames[] = {
+            "ndr308ts",
+            "ndr308",
+            "ndr324",
+            "ndr358",
+            "ndr472",
+            "ndr551",
+            "ndr651",
+            "ndr810",
+            NULL
+        };
+
+        // Reduces a string to lower-case alphanumeric characters.
+        static std::string adjustNameString(const std::string& nameString)
+        {
+            std::string ret;
+            for (std::string::const_iterator it = nameString.begin();
+                 it != nameString.end(); it++)
+            {
+                if ( isalnum(*it) )
+                    ret.push_back(tolower(*it));
+            }
+            return ret;
+        }
+
+        // Finds the radio type named in an identity response, or returns
+        // an empty string.
+        static std::string detectRadioType(const std::string& identity)
+        {
+            std::string adjIdentity = adjustNameString(identity);
+            for (int i = 0; detectableNames[i] != NULL; i++)
+            {
+                if ( adjIdentity.find(detectableNames[i]) != std::string::npos )
+                    return detectableNames[i];
+            }
+            return "";
+        }
+
+        // A connection to try: the handler that probes it, the connection
+        // mode, and the port number or baud rate.
+        struct ConnectionProbe
+        {
+            RadioHandlerPtr handler;
+            std::string mode;
+            int port;
+        };
+
+        // State shared between runConnectionProbes() and the probes it runs.
+        struct ConnectionProbeState
+        {
+            boost::mutex mutex;
+            boost::condition_variable cond;
+            // Number of probes still running
+            size_t pending;
+            // Index of the first probe to succeed, or -1
+            int winner;
+            // Whether a probe only succeeds if its radio type is recognized
+            bool detect;
+            // Radio type detected by each probe
+            std::vector<std::string> radioTypes;
+        };
+
+        static void runConnectionProbe(
+                boost::shared_ptr<ConnectionProbeState> state,
+                size_t index,
+                ConnectionProbe probe,
+                std::string device,
+                double timeout)
+        {
+            std::string identity;
+            bool ok = probe.handler->probeConnection(probe.mode, device,
+                    probe.port, timeout, identity);
+            std::string radioType = detectRadioType(identity);
+            boost::mutex::scoped_lock lock(state->mutex);
+            state->radioTypes[index] = radioType;
+            if ( ok && (state->winner < 0) && (!state->detect || (radioType != "")) )
+                state->winner = (int)index;
+            state->pending--;
+            state->cond.notify_all();
+        }
+
+        // Runs the probes in parallel and returns the index of the first one
+        // to succeed, or -1 if none succeeds before the deadline.  Sets
+        // radioType to the radio type that probe detected.  Returns as soon
+        // as there is a winner; the losing probes run on in the background
+        // until their own deadline, each holding its handler and the shared
+        // state, so nothing they use goes away under them.
+        static int runConnectionProbes(
+                const std::vector<ConnectionProbe>& probes,
+                const std::string& device,
+                double timeout,
+                bool detect,
+                std::string& radioType,
+                Debuggable& dbg)
+        {
+            boost::shared_ptr<ConnectionProbeState> state(new ConnectionProbeState());
+            state->pending = probes.size();
+            state->winner = -1;
+            state->detect = detect;
+            state->radioTypes.resize(probes.size());
+            for (size_t i = 0; i < probes.size(); i++)
+            {
+                dbg.debug("-- Probing %s connection on %d\n", probes[i].mode.c_str(),
+                        probes[i].port);
+                boost::thread(boost::bind(&runConnectionProbe, state, i,
+                        probes[i], device, timeout)).detach();
+            }
+            // Each probe gives up at the deadline; the extra second lets a
+            // probe that answers right at the deadline report back.
+            boost::chrono::steady_clock::time_point deadline =
+                    boost::chrono::steady_clock::now() +
+                    boost::chrono::milliseconds((long)(1000 * (timeout + 1.0)));
+            boost::mutex::scoped_lock lock(state->mutex);
+            while ( (state->winner < 0) && (state->pending > 0) )
+            {
+                if ( state->cond.wait_until(lock, deadline) == boost::cv_status::timeout )
+                    break;
+            }
+            if ( state->winner >= 0 )
+                radioType = state->radioTypes[state->winner];
+            return state->winner;
+        }
+
+        RadioHandlerPtr getRadioObject(
+                const std::string& nameString,
+                const std::string& device,
+                int devicePort,
+                bool debug,
+                double connectTimeout)
+        {
+            Debuggable dbg(debug, "getRadioObject");
+            dbg.debug("Called\n");
+            dbg.debug("-- Name string = \"%s\"\n", nameString.c_str());
+            RadioHandlerPtr sptr = NULL;
+            // Adjust the incoming name string
+            std::string adjNameString = adjustNameString(nameString);
+            std::string connMode = "";
+            int connPort = devicePort;
+            // Probes always need a deadline, even when connecting does not
+            double probeTimeout = ( connectTimeout >= 0 ) ? connectTimeout : 5.0;
+            if ( adjNameString == "auto" )
+            {
+                // Support radio auto-detection: probe every candidate radio
+                // type at once, and use the first that identifies itself.
+                // Radio types that share a connection mode and port share
+                // one probe.  Each probe uses a handler of its own, so that no
+                // probe runs on the handler this returns.
+                dbg.debug("Auto-detection started...\n");
+                std::vector<ConnectionProbe> probes;
+                std::set<std::string> probed;
+                for (int i = 0; (device != "") && (detectableNames[i] != NULL); i++)
+                {
+                    RadioHandlerPtr candidate(createRadioHandler(detectableNames[i], debug, dbg));
+                    BasicStringList connModes = candidate->getConnectionModeList();
+                    for (BasicStringList::const_iterator it = connModes.begin();
+                         it != connModes.end(); it++)
+                    {
+                        ConnectionProbe probe;
+                        probe.mode = *it;
+                        probe.port = ( devicePort >= 0 ) ? devicePort :
+                                candidate->getDefaultDeviceInfo();
+                        std::string key = ( boost::format("%s:%d") % probe.mode % probe.port ).str();
+                        if ( probed.insert(key).second )
+                        {
+                            probe.handler = RadioHandlerPtr(
+                                    createRadioHandler(detectableNames[i], debug, dbg));
+                            probes.push_back(probe);
+                        }
+                    }
+                }
+                std::string radioType;
+                int winner = runConnectionProbes(probes, device, probeTimeout, true,
+                        radioType, dbg);
+                if ( winner >= 0 )
+                {
+                    dbg.debug("-- Detected %s\n", radioType.c_str());
+                    adjNameString = radioType;
+                    connMode = probes[winner].mode;
+                    connPort = probes[winner].port;
+                }
+                else
+                    dbg.debug("-- No radio detected\n");
+            }
+            // Get an appropriate radio handler object based on name string
+            RadioHandler* handler = createRadioHandler(adjNameString, debug, dbg);
+            if ( handler != NULL )
+                sptr = RadioHandlerPtr(handler);
             // Support radio auto-connection
             if ( (sptr != NULL) && (device != "") )
             {
                 dbg.debug("Auto-connection started...\n");
                 dbg.debug("-- Device = %s\n", device.c_str());
+                sptr->setConnectTimeout(connectTimeout);
+                if ( connPort < 0 )
+                    connPort = sptr->getDefaultDeviceInfo();
                 BasicStringList connModes = sptr->getConnectionModeList();
-                for (BasicStringList::const_iterator it = connModes.begin();
-                     it != connModes.end(); it++)
+                if ( (connMode == "") && (connModes.size() > 1) )
+                {
+                    // Probe all connection modes at once, and use the first
+                    // one that answers
+                    std::vector<ConnectionProbe> probes;
+                    for (BasicStringList::const_iterator it = connModes.begin();
+                         it != connModes.end(); it++)
+                    {
+                        ConnectionProbe probe;
+                        probe.handler = RadioHandlerPtr(
+                                createRadioHandler(adjNameString, debug, dbg));
+                        probe.mode = *it;
+                        probe.port = connPort;
+                        probes.push_back(probe);
+                    }
+                    std::string radioType;
+                    int winner = runConnectionProbes(probes, device, probeTimeout, false,
+                            radioType, dbg);
+                    if ( winner >= 0 )
+                        connMode = probes[winner].mode;
+                }
+                else if ( connMode == "" )
+                    connMode = connModes.front();
+                if ( connMode != "" )
                 {
-                    dbg.debug("-- Attempting connection mode: %s\n", it->c_str());
-                    sptr->connect(*it, device, sptr->getDefaultDeviceInfo());
-                    if ( sptr->isConnected() )
-                        break;
+                    dbg.debug("-- Attempting connection mode: %s\n", connMode.c_str());
+                    sptr->connect(connMode, device, connPort);
                 }
+                else
+                    dbg.debug("-- No connection mode answered\n");
             }
             // Return the pointer to the radio handler (or NULL)
             //dbg.debug("Returning %08p\n", sptr.get());
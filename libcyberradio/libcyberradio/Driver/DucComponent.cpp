@@ -135,11 +135,12 @@ namespace LibCyberRadio
         bool DucComponent::setConfiguration(ConfigurationDict& cfg)
         {
             this->debug("[DucComponent::setConfiguration] Called\n");
+            ConfigurationDict delta = this->changedConfiguration(cfg);
             // Call the "grandparent" version of this method instead of the
             // parent version. We want the normalization, but not the
             // automatic enabling.
             bool ret = Configurable::setConfiguration(cfg);
-            // Use the keys provided in the *incoming* dictionary to determine
+            // Use the keys that changed in the *incoming* dictionary to determine
             // what needs to be changed via hardware calls.
             int adjDataPort = _dataPort;
             double adjFrequency = _frequency;
@@ -151,50 +152,50 @@ namespace LibCyberRadio
             bool ddcCmdNeedsExecuting = false;
             bool snapLoadCmdNeedsExecuting = false;
             bool snapTxCmdNeedsExecuting = false;
-            if ( cfg.hasKey("frequency") && _config.hasKey("frequency") )
+            if ( delta.hasKey("frequency") && _config.hasKey("frequency") )
             {
                 adjFrequency = getConfigurationValueAsDbl("frequency");
                 ddcCmdNeedsExecuting = true;
             }
-            if ( cfg.hasKey("attenuation") && _config.hasKey("attenuation") )
+            if ( delta.hasKey("attenuation") && _config.hasKey("attenuation") )
             {
                 adjAttenuation = getConfigurationValueAsDbl("attenuation");
                 ddcCmdNeedsExecuting = true;
             }
-            if ( cfg.hasKey("dataPort") && _config.hasKey("dataPort") )
+            if ( delta.hasKey("dataPort") && _config.hasKey("dataPort") )
             {
                 adjDataPort = getConfigurationValueAsInt("dataPort");
                 ddcCmdNeedsExecuting = true;
             }
-            if ( cfg.hasKey("rateIndex") && _config.hasKey("rateIndex") )
+            if ( delta.hasKey("rateIndex") && _config.hasKey("rateIndex") )
             {
                 adjRateIndex = getConfigurationValueAsInt("rateIndex");
                 ddcCmdNeedsExecuting = true;
             }
-            if ( cfg.hasKey("txChannels") && _config.hasKey("txChannels") )
+            if ( delta.hasKey("txChannels") && _config.hasKey("txChannels") )
             {
                 adjTxChannels = getConfigurationValueAsInt("txChannels");
                 ddcCmdNeedsExecuting = true;
             }
-            if ( cfg.hasKey("mode") && _config.hasKey("mode") )
+            if ( delta.hasKey("mode") && _config.hasKey("mode") )
             {
                 adjMode = getConfigurationValueAsInt("mode");
                 ddcCmdNeedsExecuting = true;
             }
-            if ( cfg.hasKey("streamId") && _config.hasKey("streamId") )
+            if ( delta.hasKey("streamId") && _config.hasKey("streamId") )
             {
                 adjStreamId = getConfigurationValueAsUInt("streamId");
                 ddcCmdNeedsExecuting = true;
             }
-            if ( cfg.hasKey("filename") && _config.hasKey("filename") )
+            if ( delta.hasKey("filename") && _config.hasKey("filename") )
             {
                 snapLoadCmdNeedsExecuting = true;
             }
-            if ( cfg.hasKey("singlePlayback") && _config.hasKey("singlePlayback") )
+            if ( delta.hasKey("singlePlayback") && _config.hasKey("singlePlayback") )
             {
                 snapTxCmdNeedsExecuting = true;
             }
-            if ( cfg.hasKey("pauseUntilEnabled") && _config.hasKey("pauseUntilEnabled") )
+            if ( delta.hasKey("pauseUntilEnabled") && _config.hasKey("pauseUntilEnabled") )
             {
                 snapTxCmdNeedsExecuting = true;
             }
@@ -227,6 +228,26 @@ namespace LibCyberRadio
             }
             this->debug("[DucComponent::setConfiguration] Returning\n");
 
+            if ( !ret )
+                this->invalidate();
+            return ret;
+        }
+
+        std::string DucComponent::validateConfiguration(const ConfigurationDict& cfg) const
+        {
+            std::string ret = RadioComponent::validateConfiguration(cfg);
+            if ( ret.empty() )
+            {
+                BasicIntList rates;
+                for (DucRateSet::const_iterator it = _rateSet.begin();
+                        it != _rateSet.end(); it++)
+                    rates.push_back(it->first);
+                ret = this->validateChoice(cfg, "rateIndex", rates);
+            }
+            if ( ret.empty() )
+                ret = this->validateRange(cfg, "frequency", _freqRangeMin, _freqRangeMax);
+            if ( ret.empty() )
+                ret = this->validateRange(cfg, "attenuation", _attRangeMin, _attRangeMax);
             return ret;
         }
 
@@ -253,11 +274,13 @@ namespace LibCyberRadio
 
         int DucComponent::getDataPort() const
         {
+            this->ensureState();
             return _dataPort;
         }
 
         bool DucComponent::setDataPort(int port)
         {
+            this->ensureState();
             bool ret = false;
             if ( _config.hasKey("dataPort") )
             {
@@ -281,11 +304,13 @@ namespace LibCyberRadio
 
         double DucComponent::getFrequency() const
         {
+            this->ensureState();
             return _frequency;
         }
 
         bool DucComponent::setFrequency(double freq)
         {
+            this->ensureState();
             bool ret = false;
             if ( _config.hasKey("frequency") )
             {
@@ -327,11 +352,13 @@ namespace LibCyberRadio
 
         double DucComponent::getAttenuation() const
         {
+            this->ensureState();
             return _attenuation;
         }
 
         bool DucComponent::setAttenuation(double atten)
         {
+            this->ensureState();
             bool ret = false;
             if ( _config.hasKey("attenuation") )
             {
@@ -368,11 +395,13 @@ namespace LibCyberRadio
 
         int DucComponent::getRateIndex() const
         {
+            this->ensureState();
             return _rateIndex;
         }
 
         bool DucComponent::setRateIndex(int index)
         {
+            this->ensureState();
             bool ret = false;
             if ( _config.hasKey("rateIndex") )
             {
@@ -396,11 +425,13 @@ namespace LibCyberRadio
 
         int DucComponent::getTxChannelBitmap() const
         {
+            this->ensureState();
             return _txChannels;
         }
 
         bool DucComponent::setTxChannelBitmap(int txChannels)
         {
+            this->ensureState();
             bool ret = false;
             if ( _config.hasKey("txChannels") )
             {
@@ -424,11 +455,13 @@ namespace LibCyberRadio
 
         int DucComponent::getMode() const
         {
+            this->ensureState();
             return _mode;
         }
 
         bool DucComponent::setMode(int mode)
         {
+            this->ensureState();
             bool ret = false;
             if ( _config.hasKey("mode") )
             {
@@ -452,11 +485,13 @@ namespace LibCyberRadio
 
         unsigned int DucComponent::getStreamId() const
         {
+            this->ensureState();
             return _streamId;
         }
 
         bool DucComponent::setStreamId(unsigned int sid)
         {
+            this->ensureState();
             bool ret = false;
             if ( _config.hasKey("streamId") )
             {
@@ -0,0 +1,514 @@
+/***************************************************************************
+ * \file JsonCodec.cpp
+ * \brief Defines a lightweight encoder for JSON radio commands and a
+ *    decoder for JSON radio responses.
+ * \author DA
+ * \copyright (c) 2018 CyberRadio Solutions, Inc.  All rights reserved.
+ *
+ * \note Requires C++11 compiler support.
+ *
+ ***************************************************************************/
+
+#include "LibCyberRadio/Driver/JsonCodec.h"
+#include <boost/thread/tss.hpp>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+// Deepest object/array nesting the decoder will follow
+#define JSONCODEC_MAX_DEPTH 64
+
+
+namespace LibCyberRadio
+{
+
+    namespace Driver
+    {
+
+        JsonCommandEncoder::JsonCommandEncoder() :
+            _msg(0),
+            _inParams(false),
+            _hasParams(false),
+            _closed(false)
+        {
+            _buf.reserve(256);
+        }
+
+        JsonCommandEncoder& JsonCommandEncoder::local()
+        {
+            static boost::thread_specific_ptr<JsonCommandEncoder> encoder;
+            if ( encoder.get() == NULL )
+                encoder.reset(new JsonCommandEncoder());
+            return *encoder;
+        }
+
+        JsonCommandEncoder& JsonCommandEncoder::begin(const char* cmd, uint32_t msg)
+        {
+            // clear() keeps the capacity, so the buffer is reused
+            _buf.clear();
+            _buf += '{';
+            if ( cmd != NULL )
+            {
+                writeKey("cmd", true);
+                writeString(cmd, strlen(cmd));
+            }
+            writeKey("msg", cmd == NULL);
+            writeInt(msg);
+            _msg = msg;
+            _inParams = false;
+            _hasParams = false;
+            _closed = false;
+            return *this;
+        }
+
+        JsonCommandEncoder& JsonCommandEncoder::field(const char* key, int value)
+        {
+            writeKey(key, _inParams && !_hasParams);
+            _hasParams = _hasParams || _inParams;
+            writeInt(value);
+            return *this;
+        }
+
+        JsonCommandEncoder& JsonCommandEncoder::field(const char* key, unsigned int value)
+        {
+            writeKey(key, _inParams && !_hasParams);
+            _hasParams = _hasParams || _inParams;
+            writeInt(value);
+            return *this;
+        }
+
+        JsonCommandEncoder& JsonCommandEncoder::field(const char* key, const std::string& value)
+        {
+            writeKey(key, _inParams && !_hasParams);
+            _hasParams = _hasParams || _inParams;
+            writeString(value.data(), value.length());
+            return *this;
+        }
+
+        JsonCommandEncoder& JsonCommandEncoder::param(const char* key, int value)
+        {
+            openParams();
+            writeKey(key, !_hasParams);
+            _hasParams = true;
+            writeInt(value);
+            return *this;
+        }
+
+        JsonCommandEncoder& JsonCommandEncoder::param(const char* key, unsigned int value)
+        {
+            openParams();
+            writeKey(key, !_hasParams);
+            _hasParams = true;
+            writeInt(value);
+            return *this;
+        }
+
+        JsonCommandEncoder& JsonCommandEncoder::param(const char* key, double value)
+        {
+            openParams();
+            writeKey(key, !_hasParams);
+            _hasParams = true;
+            if ( !std::isfinite(value) )
+            {
+                _buf += "null";
+            }
+            else
+            {
+                // Same form as Json::FastWriter: 17 significant digits, and
+                // always recognizable as a real number
+                char tmp[32];
+                int len = snprintf(tmp, sizeof(tmp), "%.17g", value);
+                _buf.append(tmp, len);
+                if ( strpbrk(tmp, ".eE") == NULL )
+                    _buf += ".0";
+            }
+            return *this;
+        }
+
+        JsonCommandEncoder& JsonCommandEncoder::param(const char* key, bool value)
+        {
+            openParams();
+            writeKey(key, !_hasParams);
+            _hasParams = true;
+            _buf += value ? "true" : "false";
+            return *this;
+        }
+
+        JsonCommandEncoder& JsonCommandEncoder::param(const char* key, const char* value)
+        {
+            openParams();
+            writeKey(key, !_hasParams);
+            _hasParams = true;
+            writeString(value, strlen(value));
+            return *this;
+        }
+
+        JsonCommandEncoder& JsonCommandEncoder::param(const char* key, const std::string& value)
+        {
+            openParams();
+            writeKey(key, !_hasParams);
+            _hasParams = true;
+            writeString(value.data(), value.length());
+            return *this;
+        }
+
+        uint32_t JsonCommandEncoder::msgId() const
+        {
+            return _msg;
+        }
+
+        const std::string& JsonCommandEncoder::str()
+        {
+            if ( !_closed )
+            {
+                // Commands always carry a parameter object, even if empty
+                openParams();
+                _buf += "}}\n";
+                _closed = true;
+            }
+            return _buf;
+        }
+
+        void JsonCommandEncoder::writeKey(const char* key, bool first)
+        {
+            if ( !first )
+                _buf += ',';
+            writeString(key, strlen(key));
+            _buf += ':';
+        }
+
+        void JsonCommandEncoder::openParams()
+        {
+            if ( !_inParams )
+            {
+                writeKey("params", false);
+                _buf += '{';
+                _inParams = true;
+            }
+        }
+
+        void JsonCommandEncoder::writeString(const char* value, size_t len)
+        {
+            _buf += '"';
+            size_t run = 0;
+            for (size_t i = 0; i < len; i++)
+            {
+                char c = value[i];
+                // Copy characters that need no escaping in one go
+                if ( (c != '"') && (c != '\\') && ((unsigned char)c >= 0x20) )
+                    continue;
+                _buf.append(value + run, i - run);
+                run = i + 1;
+                switch (c)
+                {
+                    case '"':
+                        _buf += "\\\"";
+                        break;
+                    case '\\':
+                        _buf += "\\\\";
+                        break;
+                    case '\n':
+                        _buf += "\\n";
+                        break;
+                    case '\r':
+                        _buf += "\\r";
+                        break;
+                    case '\t':
+                        _buf += "\\t";
+                        break;
+                    default:
+                        {
+                            char tmp[8];
+                            snprintf(tmp, sizeof(tmp), "\\u%04x", (unsigned int)c);
+                            _buf += tmp;
+                        }
+                        break;
+                }
+            }
+            _buf.append(value + run, len - run);
+            _buf += '"';
+        }
+
+        void JsonCommandEncoder::writeInt(long long value)
+        {
+            char tmp[24];
+            int len = snprintf(tmp, sizeof(tmp), "%lld", value);
+            _buf.append(tmp, len);
+        }
+
+        namespace
+        {
+            const char* skipWs(const char* p, const char* end)
+            {
+                while ( (p < end) && ((*p == ' ') || (*p == '\t') ||
+                        (*p == '\r') || (*p == '\n')) )
+                    p++;
+                return p;
+            }
+
+            // Skips a string literal starting at its opening quote.  Returns
+            // the position after the closing quote, or NULL.
+            const char* skipString(const char* p, const char* end)
+            {
+                for (p++; p < end; p++)
+                {
+                    if ( *p == '\\' )
+                        p++;
+                    else if ( *p == '"' )
+                        return p + 1;
+                }
+                return NULL;
+            }
+
+            // Skips (and checks the form of) a value.  Returns the position
+            // after the value, or NULL if it is malformed.
+            const char* skipValue(const char* p, const char* end, int depth)
+            {
+                p = skipWs(p, end);
+                if ( (p >= end) || (depth > JSONCODEC_MAX_DEPTH) )
+                    return NULL;
+                if ( *p == '"' )
+                    return skipString(p, end);
+                if ( (*p == '{') || (*p == '[') )
+                {
+                    bool isObject = (*p == '{');
+                    char close = isObject ? '}' : ']';
+                    p = skipWs(p + 1, end);
+                    if ( (p < end) && (*p == close) )
+                        return p + 1;
+                    while ( p < end )
+                    {
+                        if ( isObject )
+                        {
+                            p = skipWs(p, end);
+                            if ( (p >= end) || (*p != '"') ||
+                                 ((p = skipString(p, end)) == NULL) )
+                                return NULL;
+                            p = skipWs(p, end);
+                            if ( (p >= end) || (*p != ':') )
+                                return NULL;
+                            p++;
+                        }
+                        p = skipValue(p, end, depth + 1);
+                        if ( p == NULL )
+                            return NULL;
+                        p = skipWs(p, end);
+                        if ( (p < end) && (*p == ',') )
+                            p++;
+                        else if ( (p < end) && (*p == close) )
+                            return p + 1;
+                        else
+                            return NULL;
+                    }
+                    return NULL;
+                }
+                // Number or literal
+                const char* start = p;
+                while ( (p < end) && (strchr("0123456789+-.eEtrufalsn", *p) != NULL) )
+                    p++;
+                return ( p > start ) ? p : NULL;
+            }
+
+            // Finds a member of the object at p.  Returns the start of the
+            // member's value, or NULL.
+            const char* findMember(const char* p, const char* end,
+                    const char* key, size_t keyLen)
+            {
+                p = skipWs(p, end);
+                if ( (p >= end) || (*p != '{') )
+                    return NULL;
+                p++;
+                while ( true )
+                {
+                    p = skipWs(p, end);
+                    if ( (p >= end) || (*p != '"') )
+                        return NULL;
+                    const char* keyStart = p + 1;
+                    p = skipString(p, end);
+                    if ( p == NULL )
+                        return NULL;
+                    bool match = ( ((size_t)(p - 1 - keyStart) == keyLen) &&
+                            (memcmp(keyStart, key, keyLen) == 0) );
+                    p = skipWs(p, end);
+                    if ( (p >= end) || (*p != ':') )
+                        return NULL;
+                    p = skipWs(p + 1, end);
+                    if ( match )
+                        return p;
+                    p = skipValue(p, end, 0);
+                    if ( p == NULL )
+                        return NULL;
+                    p = skipWs(p, end);
+                    if ( (p >= end) || (*p != ',') )
+                        return NULL;
+                    p++;
+                }
+            }
+
+            // Appends the contents of the string literal at p to out
+            void decodeString(const char* p, const char* end, std::string& out)
+            {
+                for (p++; (p < end) && (*p != '"'); p++)
+                {
+                    if ( (*p != '\\') || (p + 1 >= end) )
+                    {
+                        out += *p;
+                        continue;
+                    }
+                    p++;
+                    switch (*p)
+                    {
+                        case 'b': out += '\b'; break;
+                        case 'f': out += '\f'; break;
+                        case 'n': out += '\n'; break;
+                        case 'r': out += '\r'; break;
+                        case 't': out += '\t'; break;
+                        case 'u':
+                            if ( p + 4 < end )
+                            {
+                                char hex[5] = { p[1], p[2], p[3], p[4], 0 };
+                                unsigned long cp = strtoul(hex, NULL, 16);
+                                // Radio responses are ASCII
+                                out += ( cp < 0x80 ) ? (char)cp : '?';
+                                p += 4;
+                            }
+                            break;
+                        default: out += *p; break;
+                    }
+                }
+            }
+        }
+
+        JsonResponseDecoder::JsonResponseDecoder(const std::string& text) :
+            _begin(text.data()),
+            _end(text.data() + text.length())
+        {
+        }
+
+        bool JsonResponseDecoder::isValid() const
+        {
+            const char* p = skipWs(_begin, _end);
+            if ( (p >= _end) || (*p != '{') )
+                return false;
+            p = skipValue(p, _end, 0);
+            return ( (p != NULL) && (skipWs(p, _end) == _end) );
+        }
+
+        bool JsonResponseDecoder::has(const char* path) const
+        {
+            return ( find(path) != NULL );
+        }
+
+        bool JsonResponseDecoder::isString(const char* path) const
+        {
+            const char* v = find(path);
+            return ( (v != NULL) && (*v == '"') );
+        }
+
+        bool JsonResponseDecoder::getBool(const char* path, bool defVal) const
+        {
+            char buf[32];
+            const char* v = findScalar(path, buf, sizeof(buf));
+            if ( v == NULL )
+                return defVal;
+            if ( strncmp(v, "true", 4) == 0 )
+                return true;
+            if ( strncmp(v, "false", 5) == 0 )
+                return false;
+            return ( strtod(v, NULL) != 0.0 );
+        }
+
+        int JsonResponseDecoder::getInt(const char* path, int defVal) const
+        {
+            char buf[32];
+            const char* v = findScalar(path, buf, sizeof(buf));
+            if ( v == NULL )
+                return defVal;
+            if ( strncmp(v, "true", 4) == 0 )
+                return 1;
+            return (int)(long long)strtod(v, NULL);
+        }
+
+        unsigned int JsonResponseDecoder::getUInt(const char* path, unsigned int defVal) const
+        {
+            char buf[32];
+            const char* v = findScalar(path, buf, sizeof(buf));
+            if ( v == NULL )
+                return defVal;
+            if ( strncmp(v, "true", 4) == 0 )
+                return 1;
+            return (unsigned int)(long long)strtod(v, NULL);
+        }
+
+        double JsonResponseDecoder::getDouble(const char* path, double defVal) const
+        {
+            char buf[32];
+            const char* v = findScalar(path, buf, sizeof(buf));
+            if ( v == NULL )
+                return defVal;
+            if ( strncmp(v, "true", 4) == 0 )
+                return 1.0;
+            return strtod(v, NULL);
+        }
+
+        std::string JsonResponseDecoder::getString(const char* path,
+                const std::string& defVal) const
+        {
+            const char* v = find(path);
+            if ( (v == NULL) || (strncmp(v, "null", 4) == 0) )
+                return defVal;
+            std::string ret;
+            if ( *v == '"' )
+            {
+                decodeString(v, _end, ret);
+            }
+            else
+            {
+                // Anything else comes back as its JSON text
+                const char* stop = skipValue(v, _end, 0);
+                if ( stop != NULL )
+                    ret.assign(v, stop - v);
+            }
+            return ret;
+        }
+
+        const char* JsonResponseDecoder::find(const char* path) const
+        {
+            const char* p = _begin;
+            while ( (p != NULL) && (*path != '\0') )
+            {
+                const char* dot = strchr(path, '.');
+                size_t len = ( dot != NULL ) ? (size_t)(dot - path) : strlen(path);
+                p = findMember(p, _end, path, len);
+                path += len;
+                if ( *path == '.' )
+                    path++;
+            }
+            return ( (p != NULL) && (p < _end) ) ? p : NULL;
+        }
+
+        const char* JsonResponseDecoder::findScalar(const char* path, char* buf,
+                size_t len) const
+        {
+            const char* v = find(path);
+            if ( (v == NULL) || (strncmp(v, "null", 4) == 0) ||
+                 (*v == '{') || (*v == '[') )
+                return NULL;
+            // Strings hold numbers on some radios; copy the text out so it
+            // can be converted like any other value.  Other values convert
+            // in place, since strtod() stops at the delimiter.
+            if ( *v == '"' )
+            {
+                size_t i = 0;
+                for (const char* p = v + 1; (p < _end) && (*p != '"') && (i + 1 < len); p++)
+                    buf[i++] = *p;
+                buf[i] = '\0';
+                return buf;
+            }
+            return v;
+        }
+
+    } /* namespace Driver */
+
+} /* namespace LibCyberRadio */
@@ -136,6 +136,7 @@ namespace LibCyberRadio
 
             RadioHandler::~RadioHandler()
             {
+                this->stopAsync();
             }
 
             RadioHandler::RadioHandler(const RadioHandler &other) :
@@ -23,8 +23,6 @@
 #include <iostream>
 #include <cstring>
 
-static uint32_t msgCounter = 1;
-
 namespace LibCyberRadio
 {
 
@@ -145,6 +143,7 @@ namespace LibCyberRadio
 
             RadioHandler::~RadioHandler()
             {
+                this->stopAsync();
             }
 
             RadioHandler::RadioHandler(const RadioHandler &other) :
@@ -173,6 +172,7 @@ namespace LibCyberRadio
             void RadioHandler::queryConfiguration()
             {
                     this->debug("[NDR324]::RadioHandler::queryConfiguration] Called\n");
+                    boost::chrono::steady_clock::time_point phaseStart = boost::chrono::steady_clock::now();
                     // Purge the banner sent over when a connection is made.
                     //BasicStringList rsp = _transport.receive(_defaultTimeout);
                     // Call the base-class queryConfiguration() to retrieve identity info
@@ -184,29 +184,34 @@ namespace LibCyberRadio
                     root["params"] = params;
                     Json::FastWriter fastWriter;
                     std::string output = fastWriter.write(root);
-                    ::LibCyberRadio::Driver::RadioHandler::sendCommand(output,1.0);
+                    ::LibCyberRadio::Driver::RadioHandler::sendCommand(output, 1.0, root["msg"].asUInt());
                     if ( _config.hasKey("referenceMode") )
                     {
                         this->executeReferenceModeQuery(_referenceMode);
                     }
                     this->debug("[NDR324::RadioHandler::queryConfiguration] Returning\n");
 
+                    this->recordStartupPhase("radio", phaseStart);
+                    std::vector<Configurable*> components;
                     for ( TunerComponentDict::iterator it = _tuners.begin();
                             it != _tuners.end(); it++)
                     {
-                        it->second->queryConfiguration();
+                        components.push_back(it->second);
                     }
                     for ( WbddcComponentDict::iterator it = _wbddcs.begin();
                             it != _wbddcs.end(); it++)
                     {
-                        it->second->queryConfiguration();
+                        components.push_back(it->second);
                     }
                     for ( DataPortDict::iterator it = _dataPorts.begin();
                             it != _dataPorts.end(); it++)
                     {
-                        it->second->queryConfiguration();   
+                        components.push_back(it->second);
                     }
+                    this->queryComponents(components);
+                    this->recordStartupPhase("components", phaseStart);
                     this->queryVersionInfo();
+                    this->recordStartupPhase("version", phaseStart);
             }
 
             bool RadioHandler::query324Specifics()
@@ -219,10 +224,12 @@ namespace LibCyberRadio
                 root["params"] = params;
                 Json::FastWriter fastWriter;
                 std::string output = fastWriter.write(root);
-                BasicStringList rsp = ::LibCyberRadio::Driver::RadioHandler::sendCommand(output,1.0);
+                BasicStringList rsp = ::LibCyberRadio::Driver::RadioHandler::sendCommand(output, 1.0, root["msg"].asUInt());
+                if ( rsp.empty() )
+                    return false;
                 Json::Reader reader;
                 Json::Value returnVal; 
-                std::string t = rsp.at(0);
+                std::string t = rsp.front();
                 bool parsingSuccessful = reader.parse( t.c_str(), returnVal );     //parse process
                 if( parsingSuccessful ){
                     std::string result = returnVal["result"].asString();
@@ -254,10 +261,12 @@ namespace LibCyberRadio
                 root["params"] = params;
                 Json::FastWriter fastWriter;
                 std::string output = fastWriter.write(root);
-                BasicStringList rsp = ::LibCyberRadio::Driver::RadioHandler::sendCommand(output,1.0);
+                BasicStringList rsp = ::LibCyberRadio::Driver::RadioHandler::sendCommand(output, 1.0, root["msg"].asUInt());
+                if ( rsp.empty() )
+                    return false;
                 Json::Reader reader;
                 Json::Value returnVal; 
-                std::string t = rsp.at(0);
+                std::string t = rsp.front();
                 bool parsingSuccessful = reader.parse( t.c_str(), returnVal );     //parse process
                 if( parsingSuccessful ){
                     _versionInfo["model"] = returnVal["result"]["model"].asString();
@@ -301,11 +310,6 @@ namespace LibCyberRadio
                 return ::LibCyberRadio::Driver::RadioHandler::executeQueryHREV(hardwareInfo);
             }
 
-            uint32_t RadioHandler::getMessageId( void )
-            {
-                return msgCounter++;
-            }
-
             bool RadioHandler::executeReferenceModeQuery(int& refMode)
             {
                 this->debug("[NDR324::RadioHandler::queryVersionInfo] Called\n");
@@ -318,10 +322,12 @@ namespace LibCyberRadio
                 root["params"] = params;
                 Json::FastWriter fastWriter;
                 std::string output = fastWriter.write(root);
-                BasicStringList rsp = this->sendCommand(output);
+                BasicStringList rsp = this->sendCommand(output, -1, root["msg"].asUInt());
+                if ( rsp.empty() )
+                    return false;
                 Json::Reader reader;
                 Json::Value returnVal; 
-                std::string t = rsp.at(0);
+                std::string t = rsp.front();
                 bool parsingSuccessful = reader.parse( t.c_str(), returnVal );     //parse process
                 if( parsingSuccessful ){
                     refMode = boost::lexical_cast<int>(returnVal["result"]["cfg10m"].asInt());
@@ -343,10 +349,12 @@ namespace LibCyberRadio
                 root["params"] = params;
                 Json::FastWriter fastWriter;
                 std::string output = fastWriter.write(root);
-                BasicStringList rsp = this->sendCommand(output);
+                BasicStringList rsp = this->sendCommand(output, -1, root["msg"].asUInt());
+                if ( rsp.empty() )
+                    return false;
                 Json::Reader reader;
                 Json::Value returnVal; 
-                std::string t = rsp.at(0);
+                std::string t = rsp.front();
                 bool parsingSuccessful = reader.parse( t.c_str(), returnVal );     //parse process
                 if( parsingSuccessful ){
                     ret = boost::lexical_cast<bool>(returnVal["success"].asBool());
@@ -87,10 +87,11 @@ namespace LibCyberRadio
             bool TunerComponent::setConfiguration(ConfigurationDict& cfg)
             {
                 this->debug("[TunerComponent::setConfiguration] Called\n");
+                ConfigurationDict delta = this->changedConfiguration(cfg);
                 // Call the base-class version to modify the configuration dictionary
                 // (this including any enabling/disabling)
                 bool ret = RadioComponent::setConfiguration(cfg);
-                // Use the keys provided in the *incoming* dictionary to determine
+                // Use the keys that changed in the *incoming* dictionary to determine
                 // what needs to be changed via hardware calls.
                 double adjFrequency = _frequency;
                 double adjAttenuation = _attenuation;
@@ -102,27 +103,27 @@ namespace LibCyberRadio
                 bool filCmdNeedsExecuting = false;
                 bool adjCmdNeedsExecuting = false;
                 bool ifCmdNeedsExecuting = false;
-                if ( cfg.hasKey("frequency") && _config.hasKey("frequency") )
+                if ( delta.hasKey("frequency") && _config.hasKey("frequency") )
                 {
                     adjFrequency = getConfigurationValueAsDbl("frequency");
                     freqCmdNeedsExecuting = true;
                 }
-                if ( cfg.hasKey("attenuation") && _config.hasKey("attenuation") )
+                if ( delta.hasKey("attenuation") && _config.hasKey("attenuation") )
                 {
                     adjAttenuation = getConfigurationValueAsDbl("attenuation");
                     attCmdNeedsExecuting = true;
                 }
-                if ( cfg.hasKey("filter") && _config.hasKey("filter") )
+                if ( delta.hasKey("filter") && _config.hasKey("filter") )
                 {
                     adjFilter = getConfigurationValueAsInt("filter");
                     filCmdNeedsExecuting = true;
                 }
-                if ( cfg.hasKey("timingAdj") && _config.hasKey("timingAdj") )
+                if ( delta.hasKey("timingAdj") && _config.hasKey("timingAdj") )
                 {
                     adjAdj = getConfigurationValueAsInt("timingAdj");
                     adjCmdNeedsExecuting = true;
                 }
-                if ( cfg.hasKey("if") && _config.hasKey("if") )
+                if ( delta.hasKey("if") && _config.hasKey("if") )
                 {
                     _if = getConfigurationValueAsInt("if");
                     ifCmdNeedsExecuting = true;
@@ -147,6 +148,8 @@ namespace LibCyberRadio
                 {
                     ret &= executeCommand();
                 }
+                if ( !ret )
+                    this->invalidate();
                 this->debug("[TunerComponent::setConfiguration] Returning %s\n", debugBool(ret));
                 return ret;
             }
@@ -194,10 +197,12 @@ namespace LibCyberRadio
                     command["params"]["freq"] = freq;
                     Json::FastWriter fastWriter;
                     std::string output = fastWriter.write(command);
-                    BasicStringList rsp = _parent->sendCommand(output);
+                    BasicStringList rsp = _parent->sendCommand(output, -1, command["msg"].asUInt());
+                    if ( rsp.empty() )
+                        return false;
                     Json::Reader reader;
                     Json::Value returnVal; 
-                    std::string t = rsp.at(0);
+                    std::string t = rsp.front();
                     bool parsingSuccessful = reader.parse( t.c_str(), returnVal );     //parse process
                     ret = true;
                     ///Json::Value result = returnVal["result"];
@@ -217,10 +222,15 @@ namespace LibCyberRadio
                 command["params"]["id"] = _index;
                 Json::FastWriter fastWriter;
                 std::string output = fastWriter.write(command);
-                BasicStringList rsp = _parent->sendCommand(output);
+                BasicStringList rsp = _parent->sendCommand(output, -1, command["msg"].asUInt());
+                if ( rsp.empty() )
+                {
+                    this->debug("[TunerComponent::queryConfiguration] No response\n");
+                    return;
+                }
                 Json::Reader reader;
                 Json::Value returnVal; 
-                std::string t = rsp.at(0);
+                std::string t = rsp.front();
                 bool parsingSuccessful = reader.parse( t.c_str(), returnVal );     //parse process
                 _enabled = boost::lexical_cast<bool>(returnVal["result"]["enable"].asBool());
                 _frequency = boost::lexical_cast<double>(returnVal["result"]["freq"].asDouble());
@@ -245,10 +255,12 @@ namespace LibCyberRadio
                     command["params"]["enable"] = enabled;
                     Json::FastWriter fastWriter;
                     std::string output = fastWriter.write(command);
-                    BasicStringList rsp = _parent->sendCommand(output);
+                    BasicStringList rsp = _parent->sendCommand(output, -1, command["msg"].asUInt());
+                    if ( rsp.empty() )
+                        return false;
                     Json::Reader reader;
                     Json::Value returnVal; 
-                    std::string t = rsp.at(0);
+                    std::string t = rsp.front();
                     bool parsingSuccessful = reader.parse( t.c_str(), returnVal );     //parse process
                     ret = returnVal["success"].asBool();
                 }
@@ -269,10 +281,12 @@ namespace LibCyberRadio
                     command["params"]["atten"] = atten;
                     Json::FastWriter fastWriter;
                     std::string output = fastWriter.write(command);
-                    BasicStringList rsp = _parent->sendCommand(output);
+                    BasicStringList rsp = _parent->sendCommand(output, -1, command["msg"].asUInt());
+                    if ( rsp.empty() )
+                        return false;
                     Json::Reader reader;
                     Json::Value returnVal; 
-                    std::string t = rsp.at(0);
+                    std::string t = rsp.front();
                     bool parsingSuccessful = reader.parse( t.c_str(), returnVal );     //parse process
                     ret = returnVal["success"].asBool();
                 }
@@ -296,10 +310,12 @@ namespace LibCyberRadio
                     command["mode"] = _mode;
                     Json::FastWriter fastWriter;
                     std::string output = fastWriter.write(command);
-                    BasicStringList rsp = _parent->sendCommand(output);
+                    BasicStringList rsp = _parent->sendCommand(output, -1, command["msg"].asUInt());
+                    if ( rsp.empty() )
+                        return false;
                     Json::Reader reader;
                     Json::Value returnVal; 
-                    std::string t = rsp.at(0);
+                    std::string t = rsp.front();
                     bool parsingSuccessful = reader.parse( t.c_str(), returnVal );     //parse process
                     ret = returnVal["success"].asBool();
                 }
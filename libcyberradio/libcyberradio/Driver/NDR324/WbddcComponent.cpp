@@ -131,6 +131,14 @@ namespace LibCyberRadio
             {
                 bool ret = false;
                 this->debug("[NDR324WbddcComponent::setConfiguration] Called\n");
+                // Only settings that differ from the current state go into
+                // the command; if none do, nothing needs to be sent.
+                ConfigurationDict delta = this->changedConfiguration(cfg);
+                if ( delta.empty() )
+                {
+                    this->debug("[NDR324WbddcComponent::setConfiguration] No changes\n");
+                    return true;
+                }
                 // Setup the JSON Command.
                 Json::Value command;
                 Json::Value params;
@@ -139,8 +147,8 @@ namespace LibCyberRadio
                 command["params"] = Json::objectValue;
                 command["params"]["id"] = _index;
 
-                for( ConfigurationDict::const_iterator it = cfg.begin();
-                     it != cfg.end(); ++it)
+                for( ConfigurationDict::const_iterator it = delta.begin();
+                     it != delta.end(); ++it)
                 {
                     if ( (it->first == "mode") || 
                          (it->first == "rfch") || 
@@ -160,12 +168,22 @@ namespace LibCyberRadio
                 Json::FastWriter fastWriter;
                 std::string output = fastWriter.write(command);
                 std::cout << output << std::endl;
-                BasicStringList rsp = _parent->sendCommand(output);
+                BasicStringList rsp = _parent->sendCommand(output, -1, command["msg"].asUInt());
+                if ( rsp.empty() )
+                {
+                    this->invalidate();
+                    return false;
+                }
                 Json::Reader reader;
                 Json::Value returnVal; 
-                std::string t = rsp.at(0);
+                std::string t = rsp.front();
                 bool parsingSuccessful = reader.parse( t.c_str(), returnVal );     //parse process
                 ret = returnVal["success"].asBool();
+                // Keep the cached state in step with what the radio now has
+                if ( ret )
+                    Configurable::setConfiguration(delta);
+                else
+                    this->invalidate();
                 return ret;
             }
 
@@ -262,10 +280,15 @@ namespace LibCyberRadio
                 command["params"]["id"] = _index;
                 Json::FastWriter fastWriter;
                 std::string output = fastWriter.write(command);
-                BasicStringList rsp = _parent->sendCommand(output);
+                BasicStringList rsp = _parent->sendCommand(output, -1, command["msg"].asUInt());
+                if ( rsp.empty() )
+                {
+                    this->debug("[WbddcComponent::queryConfiguration] No response\n");
+                    return;
+                }
                 Json::Reader reader;
                 Json::Value returnVal; 
-                std::string t = rsp.at(0);
+                std::string t = rsp.front();
                 bool parsingSuccessful = reader.parse( t.c_str(), returnVal );     //parse process
                 _enabled = boost::lexical_cast<bool>(returnVal["result"]["enable"].asBool());
                 _frequency = boost::lexical_cast<double>(returnVal["result"]["offset"].asDouble());
@@ -313,10 +336,12 @@ namespace LibCyberRadio
                     root["params"] = params;
                     Json::FastWriter fastWriter;
                     std::string output = fastWriter.write(root);
-                    LibCyberRadio::BasicStringList recv = _parent->sendCommand(output,1.0);
+                    LibCyberRadio::BasicStringList recv = _parent->sendCommand(output, 1.0, root["msg"].asUInt());
+                    if ( recv.empty() )
+                        return false;
                     Json::Reader reader;
                     Json::Value returnVal; 
-                    std::string t = recv.at(0);
+                    std::string t = recv.front();
                     bool parsingSuccessful = reader.parse( t.c_str(), returnVal );     //parse process
                     Json::Value result = returnVal["result"];
                     rateIndex = boost::lexical_cast<int>(result["filter"].asInt());
@@ -342,10 +367,12 @@ namespace LibCyberRadio
                     root["params"] = params;
                     Json::FastWriter fastWriter;
                     std::string output = fastWriter.write(root);
-                    LibCyberRadio::BasicStringList recv = _parent->sendCommand(output,1.0);
+                    LibCyberRadio::BasicStringList recv = _parent->sendCommand(output, 1.0, root["msg"].asUInt());
+                    if ( recv.empty() )
+                        return false;
                     Json::Reader reader;
                     Json::Value returnVal; 
-                    std::string t = recv.at(0);
+                    std::string t = recv.front();
                     bool parsingSuccessful = reader.parse( t.c_str(), returnVal );     //parse process
                     ret = returnVal["success"].asBool();
                 }
@@ -369,10 +396,12 @@ namespace LibCyberRadio
                     root["params"] = params;
                     Json::FastWriter fastWriter;
                     std::string output = fastWriter.write(root);
-                    LibCyberRadio::BasicStringList recv = _parent->sendCommand(output,1.0);
+                    LibCyberRadio::BasicStringList recv = _parent->sendCommand(output, 1.0, root["msg"].asUInt());
+                    if ( recv.empty() )
+                        return false;
                     Json::Reader reader;
                     Json::Value returnVal; 
-                    std::string t = recv.at(0);
+                    std::string t = recv.front();
                     bool parsingSuccessful = reader.parse( t.c_str(), returnVal );     //parse process
                     ret = returnVal["success"].asBool();
                 }
@@ -394,10 +423,12 @@ namespace LibCyberRadio
                     root["params"] = params;
                     Json::FastWriter fastWriter;
                     std::string output = fastWriter.write(root);
-                    LibCyberRadio::BasicStringList recv = _parent->sendCommand(output,1.0);
+                    LibCyberRadio::BasicStringList recv = _parent->sendCommand(output, 1.0, root["msg"].asUInt());
+                    if ( recv.empty() )
+                        return false;
                     Json::Reader reader;
                     Json::Value returnVal; 
-                    std::string t = recv.at(0);
+                    std::string t = recv.front();
                     bool parsingSuccessful = reader.parse( t.c_str(), returnVal );     //parse process
                     ret = returnVal["success"].asBool();
                 }
@@ -426,10 +457,12 @@ namespace LibCyberRadio
                     Json::FastWriter fastWriter;
                     std::string output = fastWriter.write(root);
                     this->debug("CMD: %s\n", output.c_str());
-                    LibCyberRadio::BasicStringList recv = _parent->sendCommand(output,1.0);
+                    LibCyberRadio::BasicStringList recv = _parent->sendCommand(output, 1.0, root["msg"].asUInt());
+                    if ( recv.empty() )
+                        return false;
                     Json::Reader reader;
                     Json::Value returnVal; 
-                    std::string t = recv.at(0);
+                    std::string t = recv.front();
                     bool parsingSuccessful = reader.parse( t.c_str(), returnVal );     //parse process
                     ret = returnVal["success"].asBool();
                 }
@@ -438,6 +471,7 @@ namespace LibCyberRadio
 
             bool WbddcComponent::setRateIndex(int index)
             {
+                this->ensureState();
                 this->debug("Index: %d\n", index);
                 bool ret = false;
                 if ( _config.hasKey("filter") )
@@ -492,6 +526,7 @@ namespace LibCyberRadio
 
             bool WbddcComponent::setUdpDestination(int dest)
             {
+                this->ensureState();
                 bool ret = false;
                 if ( _config.hasKey("dest") )
                 {
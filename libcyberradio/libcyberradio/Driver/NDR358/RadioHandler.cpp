@@ -16,15 +16,13 @@
 #include "LibCyberRadio/Driver/NDR551/WbddcComponent.h"
 //#include "LibCyberRadio/Driver/NDR551/WbddcGroupComponent.h"
 //#include "LibCyberRadio/Driver/NDR551/NbddcGroupComponent.h"
+#include "LibCyberRadio/Driver/JsonCodec.h"
 #include "LibCyberRadio/Common/Pythonesque.h"
-#include <json/json.h>
 #include <sstream>
 #include <cstdio>
 #include <iostream>
 #include <cstring>
 
-static uint32_t msgCounter = 1;
-
 namespace LibCyberRadio
 {
 
@@ -144,6 +142,7 @@ namespace LibCyberRadio
 
             RadioHandler::~RadioHandler()
             {
+                this->stopAsync();
             }
 
             RadioHandler::RadioHandler(const RadioHandler &other) :
@@ -172,60 +171,55 @@ namespace LibCyberRadio
             void RadioHandler::queryConfiguration()
             {
                     this->debug("[NDR358]::RadioHandler::queryConfiguration] Called\n");
+                    boost::chrono::steady_clock::time_point phaseStart = boost::chrono::steady_clock::now();
                     // Purge the banner sent over when a connection is made.
                     //BasicStringList rsp = _transport.receive(_defaultTimeout);
                     // Call the base-class queryConfiguration() to retrieve identity info
                     // and query configuration for all components
-                    Json::Value root(Json::objectValue);
-                    root["msg"] = this->getMessageId();
-                    root["cmd"] = "qstatus";
-                    Json::Value params(Json::objectValue);
-                    root["params"] = params;
-                    Json::FastWriter fastWriter;
-                    std::string output = fastWriter.write(root);
-                    ::LibCyberRadio::Driver::RadioHandler::sendCommand(output,1.0);
+                    JsonCommandEncoder& command = JsonCommandEncoder::local();
+                    command.begin("qstatus", this->getMessageId());
+                    ::LibCyberRadio::Driver::RadioHandler::sendCommand(command.str(), 1.0, command.msgId());
                     if ( _config.hasKey("referenceMode") )
                     {
                         this->executeReferenceModeQuery(_referenceMode);
                     }
                     this->debug("[NDR358::RadioHandler::queryConfiguration] Returning\n");
 
+                    this->recordStartupPhase("radio", phaseStart);
+                    std::vector<Configurable*> components;
                     for ( TunerComponentDict::iterator it = _tuners.begin();
                             it != _tuners.end(); it++)
                     {
-                        it->second->queryConfiguration();
+                        components.push_back(it->second);
                     }
                     for ( WbddcComponentDict::iterator it = _wbddcs.begin();
                             it != _wbddcs.end(); it++)
                     {
-                        it->second->queryConfiguration();
+                        components.push_back(it->second);
                     }
                     for ( DataPortDict::iterator it = _dataPorts.begin();
                             it != _dataPorts.end(); it++)
                     {
-                        it->second->queryConfiguration();   
+                        components.push_back(it->second);
                     }
+                    this->queryComponents(components);
+                    this->recordStartupPhase("components", phaseStart);
                     this->queryVersionInfo();
+                    this->recordStartupPhase("version", phaseStart);
             }
 
             bool RadioHandler::query358Specifics()
             {
-                Json::Value root(Json::objectValue);
-                root["msg"] = this->getMessageId();
-                root["cmd"] = "cli";
-                Json::Value params(Json::objectValue);
-                params["input"] = "version";
-                root["params"] = params;
-                Json::FastWriter fastWriter;
-                std::string output = fastWriter.write(root);
-                BasicStringList rsp = ::LibCyberRadio::Driver::RadioHandler::sendCommand(output,1.0);
-                Json::Reader reader;
-                Json::Value returnVal; 
-                std::string t = rsp.at(0);
-                bool parsingSuccessful = reader.parse( t.c_str(), returnVal );     //parse process
-                if( parsingSuccessful ){
-                    if ( returnVal["result"].isString() ) {
-                        std::string result = returnVal["result"].asString();
+                JsonCommandEncoder& command = JsonCommandEncoder::local();
+                command.begin("cli", this->getMessageId())
+                       .param("input", "version");
+                BasicStringList rsp = ::LibCyberRadio::Driver::RadioHandler::sendCommand(command.str(), 1.0, command.msgId());
+                if ( rsp.empty() )
+                    return false;
+                JsonResponseDecoder returnVal(rsp.front());
+                if( returnVal.isValid() ){
+                    if ( returnVal.isString("result") ) {
+                        std::string result = returnVal.getString("result");
                         LibCyberRadio::BasicStringList l = Pythonesque::Split(Pythonesque::Lstrip(result), "\n"); //Pythonesque::Split(Pythonesque::Replace(result," ", ""), "\n");
                         for(int i = 0; i < l.size(); i++)
                         {
@@ -250,24 +244,19 @@ namespace LibCyberRadio
                 this->debug("[RadioHandler::queryVersionInfo] Called\n");
                 // First, call the base-class version
                 bool ret = true;
-                Json::Value root(Json::objectValue);
-                root["msg"] = this->getMessageId();
-                root["cmd"] = "qstatus";
-                Json::Value params(Json::objectValue);
-                root["params"] = params;
-                Json::FastWriter fastWriter;
-                std::string output = fastWriter.write(root);
-                BasicStringList rsp = ::LibCyberRadio::Driver::RadioHandler::sendCommand(output,1.0);
-                Json::Reader reader;
-                Json::Value returnVal; 
-                std::string t = rsp.at(0);
-                bool parsingSuccessful = reader.parse( t.c_str(), returnVal );     //parse process
-                if( parsingSuccessful ){
-                    _versionInfo["model"] = returnVal["result"]["model"].asString();
-                    _versionInfo["softwareVersion"] = returnVal["result"]["sw"].asString();
-                    _versionInfo["firmwareVersion"] = returnVal["result"]["fw"].asString();
-                    _versionInfo["unitRevision"] = returnVal["result"]["unit"].asString();
-                    _versionInfo["hardwareVersion"] = returnVal["result"]["unit"].asString();
+                JsonCommandEncoder& command = JsonCommandEncoder::local();
+                command.begin("qstatus", this->getMessageId());
+                BasicStringList rsp = ::LibCyberRadio::Driver::RadioHandler::sendCommand(command.str(), 1.0, command.msgId());
+                if ( !rsp.empty() )
+                {
+                    JsonResponseDecoder returnVal(rsp.front());
+                    if( returnVal.isValid() ){
+                        _versionInfo["model"] = returnVal.getString("result.model");
+                        _versionInfo["softwareVersion"] = returnVal.getString("result.sw");
+                        _versionInfo["firmwareVersion"] = returnVal.getString("result.fw");
+                        _versionInfo["unitRevision"] = returnVal.getString("result.unit");
+                        _versionInfo["hardwareVersion"] = returnVal.getString("result.unit");
+                    }
                 }
                 this->query358Specifics();               
                 this->debug("[NDR358::RadioHandler::queryVersionInfo] Returning %s\n", debugBool(ret));
@@ -303,30 +292,19 @@ namespace LibCyberRadio
                 return ::LibCyberRadio::Driver::RadioHandler::executeQueryHREV(hardwareInfo);
             }
 
-            uint32_t RadioHandler::getMessageId( void )
-            {
-                return msgCounter++;
-            }
-
             bool RadioHandler::executeReferenceModeQuery(int& refMode)
             {
                 this->debug("[NDR358::RadioHandler::queryVersionInfo] Called\n");
                 // First, call the base-class version
                 bool ret = false;
-                Json::Value root(Json::objectValue);
-                root["msg"] = this->getMessageId();
-                root["cmd"] = "qref";
-                Json::Value params(Json::objectValue);
-                root["params"] = params;
-                Json::FastWriter fastWriter;
-                std::string output = fastWriter.write(root);
-                BasicStringList rsp = this->sendCommand(output);
-                Json::Reader reader;
-                Json::Value returnVal; 
-                std::string t = rsp.at(0);
-                bool parsingSuccessful = reader.parse( t.c_str(), returnVal );     //parse process
-                if( parsingSuccessful ){
-                    refMode = boost::lexical_cast<int>(returnVal["result"]["cfg10m"].asInt());
+                JsonCommandEncoder& command = JsonCommandEncoder::local();
+                command.begin("qref", this->getMessageId());
+                BasicStringList rsp = this->sendCommand(command.str(), -1, command.msgId());
+                if ( rsp.empty() )
+                    return false;
+                JsonResponseDecoder returnVal(rsp.front());
+                if( returnVal.isValid() ){
+                    refMode = returnVal.getInt("result.cfg10m");
                     ret = true;
                 }
                 return ret;
@@ -337,21 +315,15 @@ namespace LibCyberRadio
                 this->debug("[NDR358::RadioHandler::queryVersionInfo] Called\n");
                 // First, call the base-class version
                 bool ret = false;
-                Json::Value root(Json::objectValue);
-                root["msg"] = this->getMessageId();
-                root["cmd"] = "ref";
-                Json::Value params(Json::objectValue);
-                params["cfg10m"] = refMode;
-                root["params"] = params;
-                Json::FastWriter fastWriter;
-                std::string output = fastWriter.write(root);
-                BasicStringList rsp = this->sendCommand(output);
-                Json::Reader reader;
-                Json::Value returnVal; 
-                std::string t = rsp.at(0);
-                bool parsingSuccessful = reader.parse( t.c_str(), returnVal );     //parse process
-                if( parsingSuccessful ){
-                    ret = boost::lexical_cast<bool>(returnVal["success"].asBool());
+                JsonCommandEncoder& command = JsonCommandEncoder::local();
+                command.begin("ref", this->getMessageId())
+                       .param("cfg10m", refMode);
+                BasicStringList rsp = this->sendCommand(command.str(), -1, command.msgId());
+                if ( rsp.empty() )
+                    return false;
+                JsonResponseDecoder returnVal(rsp.front());
+                if( returnVal.isValid() ){
+                    ret = returnVal.getBool("success");
                 }
                 return ret;
             }
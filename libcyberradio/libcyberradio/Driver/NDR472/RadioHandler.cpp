@@ -110,6 +110,7 @@ namespace LibCyberRadio
 
             RadioHandler::~RadioHandler()
             {
+                this->stopAsync();
             }
 
             RadioHandler::RadioHandler(const RadioHandler &other) :
@@ -10,6 +10,7 @@
 
 #include "LibCyberRadio/Driver/NDR551/DataPort.h"
 #include "LibCyberRadio/Driver/RadioHandler.h"
+#include "LibCyberRadio/Driver/JsonCodec.h"
 #include <boost/format.hpp>
 
 
@@ -67,22 +68,19 @@ namespace LibCyberRadio
             }
             void DataPort::queryConfiguration()
             {
-                Json::Value command;
-                Json::Value params;
-                command["cmd"] = "qcfge10g";
-                command["msg"] = _parent->getMessageId();
-                command["params"] = Json::objectValue;
-                command["params"]["link"] = _index;
-                Json::FastWriter fastWriter;
-                std::string output = fastWriter.write(command);
-                BasicStringList rsp = _parent->sendCommand(output);
-                Json::Reader reader;
-                Json::Value returnVal; 
-                std::string t = rsp.at(0);
-                bool parsingSuccessful = reader.parse( t.c_str(), returnVal );     //parse process
-                _sourceIP = boost::lexical_cast<std::string>(returnVal["result"]["ip"].asString());
-                _sourceMacAddr = boost::lexical_cast<std::string>(returnVal["result"]["mac"].asString());
-                _sourcePort = boost::lexical_cast<uint16_t>(returnVal["result"]["port"].asUInt());
+                JsonCommandEncoder& command = JsonCommandEncoder::local();
+                command.begin("qcfge10g", _parent->getMessageId())
+                       .param("link", _index);
+                BasicStringList rsp = _parent->sendCommand(command.str(), -1, command.msgId());
+                if ( rsp.empty() )
+                {
+                    this->debug("[DataPort::queryConfiguration] No response\n");
+                    return;
+                }
+                JsonResponseDecoder returnVal(rsp.front());
+                _sourceIP = returnVal.getString("result.ip");
+                _sourceMacAddr = returnVal.getString("result.mac");
+                _sourcePort = (uint16_t)returnVal.getUInt("result.port");
                 for(int i = _dipEntryIndexBase; i < _numDipEntries; i++ )
                 {
                     this->executeDestIPQuery(_index, i, _ipAddresses[i],
@@ -96,23 +94,19 @@ namespace LibCyberRadio
             bool DataPort::executeSourceIPQuery(int index, std::string& ipAddr)
             {
                 bool ret = false;
-                Json::Value command;
-                Json::Value params;
-                command["cmd"] = "qcfge10g";
-                command["msg"] = _parent->getMessageId();
-                command["params"] = Json::objectValue;
-                command["params"]["link"] = index;
-                Json::FastWriter fastWriter;
-                std::string output = fastWriter.write(command);
-                BasicStringList rsp = _parent->sendCommand(output);
-                Json::Reader reader;
-                Json::Value returnVal; 
-                std::string t = rsp.at(0);
-                bool parsingSuccessful = reader.parse( t.c_str(), returnVal );     //parse process
-                ret = returnVal["success"].asBool();
-                if(ret){
-                    ipAddr = boost::lexical_cast<std::string>(returnVal["result"]["ip"].asString());
-                } else {
+                JsonCommandEncoder& command = JsonCommandEncoder::local();
+                command.begin("qcfge10g", _parent->getMessageId())
+                       .param("link", index);
+                BasicStringList rsp = _parent->sendCommand(command.str(), -1, command.msgId());
+                if ( !rsp.empty() )
+                {
+                    JsonResponseDecoder returnVal(rsp.front());
+                    ret = returnVal.getBool("success");
+                    if(ret){
+                        ipAddr = returnVal.getString("result.ip");
+                    }
+                }
+                if(!ret){
                     ipAddr = "0.0.0.0";
                 }
                 return ret;
@@ -120,21 +114,12 @@ namespace LibCyberRadio
             bool DataPort::executeSourceIPCommand(int index, std::string& ipAddr)
             {
                 bool ret = false;
-                Json::Value command;
-                Json::Value params;
-                command["cmd"] = "cfge10g";
-                command["msg"] = _parent->getMessageId();
-                command["params"] = Json::objectValue;
-                command["params"]["link"] = index;
-                command["params"]["ip"] = ipAddr.c_str();
-                Json::FastWriter fastWriter;
-                std::string output = fastWriter.write(command);
-                BasicStringList rsp = _parent->sendCommand(output);
-                Json::Reader reader;
-                Json::Value returnVal; 
-                std::string t = rsp.at(0);
-                bool parsingSuccessful = reader.parse( t.c_str(), returnVal );     //parse process
-                ret = returnVal["success"].asBool();
+                JsonCommandEncoder& command = JsonCommandEncoder::local();
+                command.begin("cfge10g", _parent->getMessageId())
+                       .param("link", index)
+                       .param("ip", ipAddr);
+                BasicStringList rsp = _parent->sendCommand(command.str(), -1, command.msgId());
+                ret = !rsp.empty() && JsonResponseDecoder(rsp.front()).getBool("success");
                 return ret;
             }
             // Default implementation uses the NDR308 pattern
@@ -153,28 +138,22 @@ namespace LibCyberRadio
                 if ( (_parent != NULL) && (_parent->isConnected()) &&
                         ( _macAddresses.find(dipIndex) != _macAddresses.end()) )
                 {
-                    Json::Value command;
-                    Json::Value params;
-                    command["cmd"] = "qe10g";
-                    command["msg"] = _parent->getMessageId();
-                    command["params"] = Json::objectValue;
-                    command["params"]["link"] = index;
-                    command["params"]["dest"] = dipIndex;
-                    Json::FastWriter fastWriter;
-                    std::string output = fastWriter.write(command);
-                    BasicStringList rsp = _parent->sendCommand(output);
-                    Json::Reader reader;
-                    Json::Value returnVal; 
-                    std::string t = rsp.at(0);
-                    bool parsingSuccessful = reader.parse( t.c_str(), returnVal );     //parse process
-                    ret = returnVal["success"].asBool();
-                    if(ret)
+                    JsonCommandEncoder& command = JsonCommandEncoder::local();
+                    command.begin("qe10g", _parent->getMessageId())
+                           .param("link", index)
+                           .param("dest", dipIndex);
+                    BasicStringList rsp = _parent->sendCommand(command.str(), -1, command.msgId());
+                    if ( !rsp.empty() )
                     {
-                        ipAddr = boost::lexical_cast<std::string>(returnVal["result"]["ip"].asString());
-                        macAddr = boost::lexical_cast<std::string>(returnVal["result"]["mac"].asString());
-                        //sourcePort = boost::lexical_cast<uint16_t>(returnVal["result"]["port"].asUInt());
-                        sourcePort = 0;
-                        destPort = boost::lexical_cast<uint16_t>(returnVal["result"]["port"].asUInt());
+                        JsonResponseDecoder returnVal(rsp.front());
+                        ret = returnVal.getBool("success");
+                        if(ret)
+                        {
+                            ipAddr = returnVal.getString("result.ip");
+                            macAddr = returnVal.getString("result.mac");
+                            sourcePort = 0;
+                            destPort = (uint16_t)returnVal.getUInt("result.port");
+                        }
                     }
                 }
                 return ret;
@@ -187,25 +166,16 @@ namespace LibCyberRadio
                             unsigned int& destPort)
             {
                 bool ret = false;
-                Json::Value command;
-                Json::Value params;
-                command["cmd"] = "e10g";
-                command["msg"] = _parent->getMessageId();
-                command["params"] = Json::objectValue;
-                command["params"]["link"] = index;
-                command["params"]["dest"] = dipIndex;
-                command["params"]["ip"] = ipAddr.c_str();
-                command["params"]["port"] = destPort;
-                command["params"]["mac"] = macAddr.c_str();
-                command["params"]["arp"] = false;
-                Json::FastWriter fastWriter;
-                std::string output = fastWriter.write(command);
-                BasicStringList rsp = _parent->sendCommand(output);
-                Json::Reader reader;
-                Json::Value returnVal; 
-                std::string t = rsp.at(0);
-                bool parsingSuccessful = reader.parse( t.c_str(), returnVal );     //parse process
-                ret = returnVal["success"].asBool();
+                JsonCommandEncoder& command = JsonCommandEncoder::local();
+                command.begin("e10g", _parent->getMessageId())
+                       .param("link", index)
+                       .param("dest", dipIndex)
+                       .param("ip", ipAddr)
+                       .param("port", destPort)
+                       .param("mac", macAddr)
+                       .param("arp", false);
+                BasicStringList rsp = _parent->sendCommand(command.str(), -1, command.msgId());
+                ret = !rsp.empty() && JsonResponseDecoder(rsp.front()).getBool("success");
                 return ret;
             }
 
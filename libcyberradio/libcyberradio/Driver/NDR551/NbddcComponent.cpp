@@ -10,9 +10,9 @@
 
 #include "LibCyberRadio/Driver/NDR551/NbddcComponent.h"
 #include "LibCyberRadio/Driver/RadioHandler.h"
+#include "LibCyberRadio/Driver/JsonCodec.h"
 #include <boost/format.hpp>
 #include <boost/lexical_cast.hpp>
-#include <json/json.h>
 
 namespace LibCyberRadio
 {
@@ -158,26 +158,23 @@ namespace LibCyberRadio
             void NbddcComponent::queryConfiguration()
             {
                 this->debug("[NbddcComponent::queryConfiguration] Called\n");
-                Json::Value command;
-                Json::Value params;
-                command["cmd"] = "qnbddc";
-                command["msg"] = _parent->getMessageId();
-                command["params"] = Json::objectValue;
-                command["params"]["id"] = _index;
-                Json::FastWriter fastWriter;
-                std::string output = fastWriter.write(command);
-                BasicStringList rsp = _parent->sendCommand(output);
-                Json::Reader reader;
-                Json::Value returnVal; 
-                std::string t = rsp.at(0);
-                bool parsingSuccessful = reader.parse( t.c_str(), returnVal["result"] );     //parse process
-                _enabled = boost::lexical_cast<bool>(returnVal["enable"].asBool());
-                _frequency = boost::lexical_cast<double>(returnVal["freq"].asDouble());
-                _source = boost::lexical_cast<int>(returnVal["source"].asInt());
-                _udpDestination = boost::lexical_cast<int>(returnVal["dest"].asInt());
-                _rateIndex = boost::lexical_cast<int>(returnVal["filter"].asInt());
-                _streamId = boost::lexical_cast<int>(returnVal["vita"].asUInt());
-                _mode = boost::lexical_cast<std::string>(returnVal["mode"].asString());
+                JsonCommandEncoder& command = JsonCommandEncoder::local();
+                command.begin("qnbddc", _parent->getMessageId())
+                       .param("id", _index);
+                BasicStringList rsp = _parent->sendCommand(command.str(), -1, command.msgId());
+                if ( rsp.empty() )
+                {
+                    this->debug("[NbddcComponent::queryConfiguration] No response\n");
+                    return;
+                }
+                JsonResponseDecoder returnVal(rsp.front());
+                _enabled = returnVal.getBool("result.enable");
+                _frequency = returnVal.getDouble("result.freq");
+                _source = returnVal.getInt("result.source");
+                _udpDestination = returnVal.getInt("result.dest");
+                _rateIndex = returnVal.getInt("result.filter");
+                _streamId = returnVal.getUInt("result.vita");
+                _mode = returnVal.getString("result.mode");
             }
 
             // Default implementation uses the NDR308 syntax.
@@ -194,25 +191,19 @@ namespace LibCyberRadio
                 bool ret = false;
                 if ( (_parent != NULL) && (_parent->isConnected()) )
                 {
-                    Json::Value root(Json::objectValue);
-                    root["msg"] = _parent->getMessageId();
-                    root["cmd"] = "qnbddc";
-                    Json::Value params(Json::objectValue);
-                    params["id"] = index;
-                    root["params"] = params;
-                    Json::FastWriter fastWriter;
-                    std::string output = fastWriter.write(root);
-                    LibCyberRadio::BasicStringList recv = _parent->sendCommand(output,1.0);
-                    Json::Reader reader;
-                    Json::Value returnVal; 
-                    std::string t = recv.at(0);
-                    bool parsingSuccessful = reader.parse( t.c_str(), returnVal );     //parse process
-                    Json::Value result = returnVal["result"];
-                    rateIndex = boost::lexical_cast<int>(result["filter"].asInt());
-                    udpDestination = boost::lexical_cast<int>(result["dest"].asInt());
-                    enabled = boost::lexical_cast<bool>(result["enable"].asBool());
-                    vitaEnable = boost::lexical_cast<int>(result["enable"].asBool());
-                    streamId = boost::lexical_cast<unsigned int>(result["vita"].asUInt());
+                    JsonCommandEncoder& command = JsonCommandEncoder::local();
+                    command.begin("qnbddc", _parent->getMessageId())
+                           .param("id", index);
+                    LibCyberRadio::BasicStringList recv = _parent->sendCommand(command.str(), 1.0, command.msgId());
+                    if ( !recv.empty() )
+                    {
+                        JsonResponseDecoder returnVal(recv.front());
+                        rateIndex = returnVal.getInt("result.filter");
+                        udpDestination = returnVal.getInt("result.dest");
+                        enabled = returnVal.getBool("result.enable");
+                        vitaEnable = returnVal.getBool("result.enable");
+                        streamId = returnVal.getUInt("result.vita");
+                    }
                 }
                 return ret;
             }
@@ -224,21 +215,12 @@ namespace LibCyberRadio
                 bool ret = false;
                 if ( (_parent != NULL) && (_parent->isConnected()) )
                 {
-                    Json::Value root(Json::objectValue);
-                    root["msg"] = m551Parent->getMessageId();
-                    root["cmd"] = "nbddc";
-                    Json::Value params(Json::objectValue);
-                    params["id"] = index;
-                    params["rfch"] = std::to_string(source);
-                    root["params"] = params;
-                    Json::FastWriter fastWriter;
-                    std::string output = fastWriter.write(root);
-                    LibCyberRadio::BasicStringList recv = _parent->sendCommand(output,1.0);
-                    Json::Reader reader;
-                    Json::Value returnVal; 
-                    std::string t = recv.at(0);
-                    bool parsingSuccessful = reader.parse( t.c_str(), returnVal );     //parse process
-                    ret = returnVal["success"].asBool();
+                    JsonCommandEncoder& command = JsonCommandEncoder::local();
+                    command.begin("nbddc", m551Parent->getMessageId())
+                           .param("id", index)
+                           .param("rfch", std::to_string(source));
+                    LibCyberRadio::BasicStringList recv = _parent->sendCommand(command.str(), 1.0, command.msgId());
+                    ret = !recv.empty() && JsonResponseDecoder(recv.front()).getBool("success");
                 }
                 return ret;
             }
@@ -250,21 +232,12 @@ namespace LibCyberRadio
                 bool ret = false;
                 if ( (_parent != NULL) && (_parent->isConnected()) )
                 {
-                    Json::Value root(Json::objectValue);
-                    root["msg"] = m551Parent->getMessageId();
-                    root["cmd"] = "nbddc";
-                    Json::Value params(Json::objectValue);
-                    params["id"] = index;
-                    params["offset"] = freq;
-                    root["params"] = params;
-                    Json::FastWriter fastWriter;
-                    std::string output = fastWriter.write(root);
-                    LibCyberRadio::BasicStringList recv = _parent->sendCommand(output,1.0);
-                    Json::Reader reader;
-                    Json::Value returnVal; 
-                    std::string t = recv.at(0);
-                    bool parsingSuccessful = reader.parse( t.c_str(), returnVal );     //parse process
-                    ret = returnVal["success"].asBool();
+                    JsonCommandEncoder& command = JsonCommandEncoder::local();
+                    command.begin("nbddc", m551Parent->getMessageId())
+                           .param("id", index)
+                           .param("offset", freq);
+                    LibCyberRadio::BasicStringList recv = _parent->sendCommand(command.str(), 1.0, command.msgId());
+                    ret = !recv.empty() && JsonResponseDecoder(recv.front()).getBool("success");
                 }
                 return ret;
             }
@@ -283,25 +256,16 @@ namespace LibCyberRadio
                 bool ret = false;
                 if ( (_parent != NULL) && (_parent->isConnected()) )
                 {
-                    Json::Value root(Json::objectValue);
-                    root["msg"] = _parent->getMessageId();
-                    root["cmd"] = "nbddc";
-                    Json::Value params(Json::objectValue);
-                    params["id"] = index;
-                    params["filter"] = rateIndex;
-                    params["dest"] = udpDestination;
-                    params["enable"] = boost::lexical_cast<bool>(vitaEnable);
-                    params["vita"] = streamId;
-                    params["rfch"] = std::to_string(source);
-                    root["params"] = params;
-                    Json::FastWriter fastWriter;
-                    std::string output = fastWriter.write(root);
-                    LibCyberRadio::BasicStringList recv = _parent->sendCommand(output,1.0);
-                    Json::Reader reader;
-                    Json::Value returnVal; 
-                    std::string t = recv.at(0);
-                    bool parsingSuccessful = reader.parse( t.c_str(), returnVal );     //parse process
-                    ret = returnVal["success"].asBool();
+                    JsonCommandEncoder& command = JsonCommandEncoder::local();
+                    command.begin("nbddc", _parent->getMessageId())
+                           .param("id", index)
+                           .param("filter", rateIndex)
+                           .param("dest", udpDestination)
+                           .param("enable", boost::lexical_cast<bool>(vitaEnable))
+                           .param("vita", streamId)
+                           .param("rfch", std::to_string(source));
+                    LibCyberRadio::BasicStringList recv = _parent->sendCommand(command.str(), 1.0, command.msgId());
+                    ret = !recv.empty() && JsonResponseDecoder(recv.front()).getBool("success");
                 }
                 return ret;
             }
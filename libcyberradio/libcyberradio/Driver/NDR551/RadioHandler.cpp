@@ -16,8 +16,8 @@
 #include "LibCyberRadio/Driver/NDR551/WbddcComponent.h"
 //#include "LibCyberRadio/Driver/NDR551/WbddcGroupComponent.h"
 //#include "LibCyberRadio/Driver/NDR551/NbddcGroupComponent.h"
+#include "LibCyberRadio/Driver/JsonCodec.h"
 #include "LibCyberRadio/Common/Pythonesque.h"
-#include <json/json.h>
 #include <sstream>
 #include <cstdio>
 
@@ -148,6 +148,7 @@ namespace LibCyberRadio
 
             RadioHandler::~RadioHandler()
             {
+                this->stopAsync();
             }
 
             RadioHandler::RadioHandler(const RadioHandler &other) :
@@ -177,39 +178,39 @@ namespace LibCyberRadio
             void RadioHandler::queryConfiguration()
             {
                 this->debug("[NDR551::RadioHandler::queryConfiguration] Called\n");
+                boost::chrono::steady_clock::time_point phaseStart = boost::chrono::steady_clock::now();
                 // Purge the banner sent over when a connection is made.
                 //BasicStringList rsp = _transport.receive(_defaultTimeout);
                 // Call the base-class queryConfiguration() to retrieve identity info
                 // and query configuration for all components
-                Json::Value root(Json::objectValue);
-                root["msg"] = this->getMessageId();
-                root["cmd"] = "qstatus";
-                Json::Value params(Json::objectValue);
-                root["params"] = params;
-                Json::FastWriter fastWriter;
-                std::string output = fastWriter.write(root);
-                ::LibCyberRadio::Driver::RadioHandler::sendCommand(output,1.0);
+                JsonCommandEncoder& command = JsonCommandEncoder::local();
+                command.begin("qstatus", this->getMessageId());
+                ::LibCyberRadio::Driver::RadioHandler::sendCommand(command.str(), 1.0, command.msgId());
                 if ( _config.hasKey("referenceMode") )
                 {
                     this->executeReferenceModeQuery(_referenceMode);
                 }
                 this->debug("[NDR551::RadioHandler::queryConfiguration] Returning\n");
 
+                this->recordStartupPhase("radio", phaseStart);
+                std::vector<Configurable*> components;
                 for ( TunerComponentDict::iterator it = _tuners.begin();
                     it != _tuners.end(); it++)
                 {
-                    it->second->queryConfiguration();
+                    components.push_back(it->second);
                 }
                 for ( WbddcComponentDict::iterator it = _wbddcs.begin();
                         it != _wbddcs.end(); it++)
                 {
-                    it->second->queryConfiguration();
+                    components.push_back(it->second);
                 }
                 for ( DataPortDict::iterator it = _dataPorts.begin();
                         it != _dataPorts.end(); it++)
                 {
-                    it->second->queryConfiguration();   
+                    components.push_back(it->second);
                 }
+                this->queryComponents(components);
+                this->recordStartupPhase("components", phaseStart);
             }
 
             bool RadioHandler::queryVersionInfo()
@@ -217,14 +218,9 @@ namespace LibCyberRadio
                 this->debug("[NDR551::RadioHandler::queryVersionInfo] Called\n");
                 // First, call the base-class version
                 bool ret = true;
-                Json::Value root(Json::objectValue);
-                root["msg"] = this->getMessageId();
-                root["cmd"] = "qstatus";
-                Json::Value params(Json::objectValue);
-                root["params"] = params;
-                Json::FastWriter fastWriter;
-                std::string output = fastWriter.write(root);
-                ::LibCyberRadio::Driver::RadioHandler::sendCommand(output,1.0);
+                JsonCommandEncoder& command = JsonCommandEncoder::local();
+                command.begin("qstatus", this->getMessageId());
+                ::LibCyberRadio::Driver::RadioHandler::sendCommand(command.str(), 1.0, command.msgId());
                 // Next, use the hardware version info string to determine
                 // -- unit revision
                 // -- number of tuner boards
@@ -361,33 +357,19 @@ namespace LibCyberRadio
                 return ::LibCyberRadio::Driver::RadioHandler::executeQueryHREV(hardwareInfo);
             }
 
-            uint32_t RadioHandler::getMessageId( void )
-            {
-                auto time = std::chrono::system_clock::now();
-                auto now_sec = std::chrono::time_point_cast<std::chrono::seconds>(time);
-                auto epoch = now_sec.time_since_epoch();
-                auto v = std::chrono::duration_cast<std::chrono::milliseconds>(epoch);
-                return (uint32_t)v.count();
-            }
             bool RadioHandler::executeReferenceModeQuery(int& refMode)
             {
                 this->debug("[NDR551::RadioHandler::queryVersionInfo] Called\n");
                 // First, call the base-class version
                 bool ret = true;
-                Json::Value root(Json::objectValue);
-                root["msg"] = this->getMessageId();
-                root["cmd"] = "qref";
-                Json::Value params(Json::objectValue);
-                root["params"] = params;
-                Json::FastWriter fastWriter;
-                std::string output = fastWriter.write(root);
-                LibCyberRadio::BasicStringList rsp = ::LibCyberRadio::Driver::RadioHandler::sendCommand(output,1.0);
-                Json::Reader reader;
-                Json::Value returnVal; 
-                std::string t = rsp.at(0);
+                JsonCommandEncoder& command = JsonCommandEncoder::local();
+                command.begin("qref", this->getMessageId());
+                LibCyberRadio::BasicStringList rsp = ::LibCyberRadio::Driver::RadioHandler::sendCommand(command.str(), 1.0, command.msgId());
+                if ( rsp.empty() )
+                    return false;
+                std::string t = rsp.front();
                 printf("%s\n",t.c_str());
-                bool parsingSuccessful = reader.parse( t.c_str(), returnVal );     //parse process
-                refMode = boost::lexical_cast<int>(returnVal["cfg10m"].asInt());
+                refMode = JsonResponseDecoder(t).getInt("result.cfg10m");
                 return ret;
             }
 
@@ -396,13 +378,8 @@ namespace LibCyberRadio
                 this->debug("[NDR551::RadioHandler::queryVersionInfo] Called\n");
                 // First, call the base-class version
                 bool ret = true;
-                Json::Value root(Json::objectValue);
-                root["msg"] = this->getMessageId();
-                root["cmd"] = "ref";
-                Json::Value params(Json::objectValue);
-                root["params"] = params;
-                Json::FastWriter fastWriter;
-                std::string output = fastWriter.write(root);
+                JsonCommandEncoder& command = JsonCommandEncoder::local();
+                command.begin("ref", this->getMessageId());
                 return ret;
             }
 
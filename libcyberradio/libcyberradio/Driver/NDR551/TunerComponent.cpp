@@ -10,9 +10,9 @@
 
 #include "LibCyberRadio/Driver/NDR551/TunerComponent.h"
 #include "LibCyberRadio/Driver/RadioHandler.h"
+#include "LibCyberRadio/Driver/JsonCodec.h"
 #include <boost/format.hpp>
 #include <boost/lexical_cast.hpp>
-#include <json/json.h>
 
 namespace LibCyberRadio
 {
@@ -87,10 +87,11 @@ namespace LibCyberRadio
             bool TunerComponent::setConfiguration(ConfigurationDict& cfg)
             {
                 this->debug("[TunerComponent::setConfiguration] Called\n");
+                ConfigurationDict delta = this->changedConfiguration(cfg);
                 // Call the base-class version to modify the configuration dictionary
                 // (this including any enabling/disabling)
                 bool ret = RadioComponent::setConfiguration(cfg);
-                // Use the keys provided in the *incoming* dictionary to determine
+                // Use the keys that changed in the *incoming* dictionary to determine
                 // what needs to be changed via hardware calls.
                 double adjFrequency = _frequency;
                 double adjAttenuation = _attenuation;
@@ -102,27 +103,27 @@ namespace LibCyberRadio
                 bool filCmdNeedsExecuting = false;
                 bool adjCmdNeedsExecuting = false;
                 bool ifCmdNeedsExecuting = false;
-                if ( cfg.hasKey("frequency") && _config.hasKey("frequency") )
+                if ( delta.hasKey("frequency") && _config.hasKey("frequency") )
                 {
                     adjFrequency = getConfigurationValueAsDbl("frequency");
                     freqCmdNeedsExecuting = true;
                 }
-                if ( cfg.hasKey("attenuation") && _config.hasKey("attenuation") )
+                if ( delta.hasKey("attenuation") && _config.hasKey("attenuation") )
                 {
                     adjAttenuation = getConfigurationValueAsDbl("attenuation");
                     attCmdNeedsExecuting = true;
                 }
-                if ( cfg.hasKey("filter") && _config.hasKey("filter") )
+                if ( delta.hasKey("filter") && _config.hasKey("filter") )
                 {
                     adjFilter = getConfigurationValueAsInt("filter");
                     filCmdNeedsExecuting = true;
                 }
-                if ( cfg.hasKey("timingAdj") && _config.hasKey("timingAdj") )
+                if ( delta.hasKey("timingAdj") && _config.hasKey("timingAdj") )
                 {
                     adjAdj = getConfigurationValueAsInt("timingAdj");
                     adjCmdNeedsExecuting = true;
                 }
-                if ( cfg.hasKey("if") && _config.hasKey("if") )
+                if ( delta.hasKey("if") && _config.hasKey("if") )
                 {
                     _if = getConfigurationValueAsInt("if");
                     ifCmdNeedsExecuting = true;
@@ -147,6 +148,8 @@ namespace LibCyberRadio
                 {
                     ret &= executeCommand();
                 }
+                if ( !ret )
+                    this->invalidate();
                 this->debug("[TunerComponent::setConfiguration] Returning %s\n", debugBool(ret));
                 return ret;
             }
@@ -185,23 +188,12 @@ namespace LibCyberRadio
                 bool ret = false;
                 if ( (_parent != NULL) && (_parent->isConnected()) )
                 {
-                    Json::Value command;
-                    Json::Value params;
-                    command["cmd"] = "tuner";
-                    command["msg"] = _parent->getMessageId();
-                    command["params"] = Json::objectValue;
-                    command["params"]["id"] = index;
-                    command["params"]["freq"] = freq;
-                    Json::FastWriter fastWriter;
-                    std::string output = fastWriter.write(command);
-                    BasicStringList rsp = _parent->sendCommand(output);
-                    Json::Reader reader;
-                    Json::Value returnVal; 
-                    std::string t = rsp.at(0);
-                    bool parsingSuccessful = reader.parse( t.c_str(), returnVal );     //parse process
+                    JsonCommandEncoder& command = JsonCommandEncoder::local();
+                    command.begin("tuner", _parent->getMessageId())
+                           .param("id", index)
+                           .param("freq", freq);
+                    _parent->sendCommand(command.str(), -1, command.msgId());
                     ret = true;
-                    ///Json::Value result = returnVal["result"];
-                    //ret = boost::lexical_cast<bool>(result["success"]);
                 }
                 return ret;
             }
@@ -209,24 +201,21 @@ namespace LibCyberRadio
             void TunerComponent::queryConfiguration()
             {
                 this->debug("[TunerComponent::queryConfiguration] Called\n");
-                Json::Value command;
-                Json::Value params;
-                command["cmd"] = "qtuner";
-                command["msg"] = _parent->getMessageId();
-                command["params"] = Json::objectValue;
-                command["params"]["id"] = _index;
-                Json::FastWriter fastWriter;
-                std::string output = fastWriter.write(command);
-                BasicStringList rsp = _parent->sendCommand(output);
-                Json::Reader reader;
-                Json::Value returnVal; 
-                std::string t = rsp.at(0);
-                bool parsingSuccessful = reader.parse( t.c_str(), returnVal );     //parse process
-                _enabled = boost::lexical_cast<bool>(returnVal["result"]["enable"].asBool());
-                _frequency = boost::lexical_cast<double>(returnVal["result"]["freq"].asDouble());
-                _attenuation = boost::lexical_cast<double>(returnVal["result"]["atten"].asDouble());
-                _mode = boost::lexical_cast<std::string>(returnVal["result"]["mode"].asString());
-                _if = boost::lexical_cast<unsigned int>(returnVal["result"]["if"].asUInt());
+                JsonCommandEncoder& command = JsonCommandEncoder::local();
+                command.begin("qtuner", _parent->getMessageId())
+                       .param("id", _index);
+                BasicStringList rsp = _parent->sendCommand(command.str(), -1, command.msgId());
+                if ( rsp.empty() )
+                {
+                    this->debug("[TunerComponent::queryConfiguration] No response\n");
+                    return;
+                }
+                JsonResponseDecoder returnVal(rsp.front());
+                _enabled = returnVal.getBool("result.enable");
+                _frequency = returnVal.getDouble("result.freq");
+                _attenuation = returnVal.getDouble("result.atten");
+                _mode = returnVal.getString("result.mode");
+                _if = returnVal.getUInt("result.if");
                 updateConfigurationDict();
                 this->debug("[NDR551] [TunerComponent::queryConfiguration] Returning\n");
             }
@@ -236,21 +225,12 @@ namespace LibCyberRadio
                 bool ret = false;
                 if ( (_parent != NULL) && (_parent->isConnected()) )
                 {
-                    Json::Value command;
-                    Json::Value params;
-                    command["cmd"] = "tuner";
-                    command["msg"] = _parent->getMessageId();
-                    command["params"] = Json::objectValue;
-                    command["params"]["id"] = index;
-                    command["params"]["enable"] = enabled;
-                    Json::FastWriter fastWriter;
-                    std::string output = fastWriter.write(command);
-                    BasicStringList rsp = _parent->sendCommand(output);
-                    Json::Reader reader;
-                    Json::Value returnVal; 
-                    std::string t = rsp.at(0);
-                    bool parsingSuccessful = reader.parse( t.c_str(), returnVal );     //parse process
-                    ret = returnVal["success"].asBool();
+                    JsonCommandEncoder& command = JsonCommandEncoder::local();
+                    command.begin("tuner", _parent->getMessageId())
+                           .param("id", index)
+                           .param("enable", enabled);
+                    BasicStringList rsp = _parent->sendCommand(command.str(), -1, command.msgId());
+                    ret = !rsp.empty() && JsonResponseDecoder(rsp.front()).getBool("success");
                 }
                 return ret;
             }
@@ -260,21 +240,12 @@ namespace LibCyberRadio
                 bool ret = false;
                 if ( (_parent != NULL) && (_parent->isConnected()) )
                 {
-                    Json::Value command;
-                    Json::Value params;
-                    command["cmd"] = "tuner";
-                    command["msg"] = _parent->getMessageId();
-                    command["params"] = Json::objectValue;
-                    command["params"]["id"] = index;
-                    command["params"]["atten"] = atten;
-                    Json::FastWriter fastWriter;
-                    std::string output = fastWriter.write(command);
-                    BasicStringList rsp = _parent->sendCommand(output);
-                    Json::Reader reader;
-                    Json::Value returnVal; 
-                    std::string t = rsp.at(0);
-                    bool parsingSuccessful = reader.parse( t.c_str(), returnVal );     //parse process
-                    ret = returnVal["success"].asBool();
+                    JsonCommandEncoder& command = JsonCommandEncoder::local();
+                    command.begin("tuner", _parent->getMessageId())
+                           .param("id", index)
+                           .param("atten", atten);
+                    BasicStringList rsp = _parent->sendCommand(command.str(), -1, command.msgId());
+                    ret = !rsp.empty() && JsonResponseDecoder(rsp.front()).getBool("success");
                 }
                 return ret;
             }
@@ -284,24 +255,15 @@ namespace LibCyberRadio
                 bool ret = false;
                 if ( (_parent != NULL) && (_parent->isConnected()) )
                 {
-                    Json::Value command;
-                    Json::Value params;
-                    command["cmd"] = "tuner";
-                    command["msg"] = _parent->getMessageId();
-                    command["params"] = Json::objectValue;
-                    command["params"]["id"] = _index;
-                    command["params"]["atten"] = _attenuation;
-                    command["params"]["freq"] = _frequency;
-                    command["if"] = _if;
-                    command["mode"] = _mode;
-                    Json::FastWriter fastWriter;
-                    std::string output = fastWriter.write(command);
-                    BasicStringList rsp = _parent->sendCommand(output);
-                    Json::Reader reader;
-                    Json::Value returnVal; 
-                    std::string t = rsp.at(0);
-                    bool parsingSuccessful = reader.parse( t.c_str(), returnVal );     //parse process
-                    ret = returnVal["success"].asBool();
+                    JsonCommandEncoder& command = JsonCommandEncoder::local();
+                    command.begin("tuner", _parent->getMessageId())
+                           .field("if", _if)
+                           .field("mode", _mode)
+                           .param("id", _index)
+                           .param("atten", _attenuation)
+                           .param("freq", _frequency);
+                    BasicStringList rsp = _parent->sendCommand(command.str(), -1, command.msgId());
+                    ret = !rsp.empty() && JsonResponseDecoder(rsp.front()).getBool("success");
                 }
                 return ret;
             }
@@ -10,10 +10,9 @@
 
 #include "LibCyberRadio/Driver/NDR551/WbddcComponent.h"
 #include "LibCyberRadio/Driver/RadioHandler.h"
+#include "LibCyberRadio/Driver/JsonCodec.h"
 #include <boost/format.hpp>
-#include <json/json.h>
 #include <boost/lexical_cast.hpp>
-#include <iostream>
 
 
 namespace LibCyberRadio
@@ -133,41 +132,45 @@ namespace LibCyberRadio
             {
                 bool ret = false;
                 this->debug("[NDR551WbddcComponent::setConfiguration] Called\n");
+                // Only settings that differ from the current state go into
+                // the command; if none do, nothing needs to be sent.
+                ConfigurationDict delta = this->changedConfiguration(cfg);
+                if ( delta.empty() )
+                {
+                    this->debug("[NDR551WbddcComponent::setConfiguration] No changes\n");
+                    return true;
+                }
                 // Setup the JSON Command.
-                Json::Value command;
-                Json::Value params;
-                command["cmd"] = "wbddc";
-                command["msg"] = _parent->getMessageId();
-                command["params"] = Json::objectValue;
-                command["params"]["id"] = _index;
+                JsonCommandEncoder& command = JsonCommandEncoder::local();
+                command.begin("wbddc", _parent->getMessageId())
+                       .param("id", _index);
 
-                for( ConfigurationDict::const_iterator it = cfg.begin();
-                     it != cfg.end(); ++it)
+                for( ConfigurationDict::const_iterator it = delta.begin();
+                     it != delta.end(); ++it)
                 {
                     if ( (it->first == "mode") || 
                          (it->first == "rfch") || 
                          (it->first == "type") )
                     {
-                        command["params"][it->first.c_str()] = it->second.c_str();
+                        command.param(it->first.c_str(), it->second);
                     } 
                     else if ( (it->first == "enable") )
                     {
-                        command["params"][it->first.c_str()] = it->second.asBool();
+                        command.param(it->first.c_str(), it->second.asBool());
                     }
                     else
                     {
-                        command["params"][it->first.c_str()] = it->second.asInt();
+                        command.param(it->first.c_str(), it->second.asInt());
                     }                    
                 }
-                Json::FastWriter fastWriter;
-                std::string output = fastWriter.write(command);
-                std::cout << output << std::endl;
-                BasicStringList rsp = _parent->sendCommand(output);
-                Json::Reader reader;
-                Json::Value returnVal; 
-                std::string t = rsp.at(0);
-                bool parsingSuccessful = reader.parse( t.c_str(), returnVal );     //parse process
-                ret = returnVal["success"].asBool();
+                this->debug("[NDR551WbddcComponent::setConfiguration] Sending %s\n", command.str().c_str());
+                BasicStringList rsp = _parent->sendCommand(command.str(), -1, command.msgId());
+                ret = !rsp.empty() && JsonResponseDecoder(rsp.front()).getBool("success");
+                // Keep the cached state in step with what the radio now has
+                if ( ret )
+                    Configurable::setConfiguration(delta);
+                else
+                    this->invalidate();
                 return ret;
             }
 
@@ -256,43 +259,40 @@ namespace LibCyberRadio
             void WbddcComponent::queryConfiguration()
             {
                 this->debug("[WbddcComponent::queryConfiguration] Called\n");
-                Json::Value command;
-                Json::Value params;
-                command["cmd"] = "qwbddc";
-                command["msg"] = _parent->getMessageId();
-                command["params"] = Json::objectValue;
-                command["params"]["id"] = _index;
-                Json::FastWriter fastWriter;
-                std::string output = fastWriter.write(command);
-                BasicStringList rsp = _parent->sendCommand(output);
-                Json::Reader reader;
-                Json::Value returnVal; 
-                std::string t = rsp.at(0);
-                bool parsingSuccessful = reader.parse( t.c_str(), returnVal );     //parse process
-                if( parsingSuccessful && returnVal.isMember("result") ) { 
-                    _enabled = boost::lexical_cast<bool>(returnVal["result"]["enable"].asBool());
-                    _frequency = boost::lexical_cast<double>(returnVal["result"]["offset"].asDouble());
-                    _source = boost::lexical_cast<int>(returnVal["result"]["rfch"].asString());
-                    _dataPort = boost::lexical_cast<int>(returnVal["result"]["link"].asInt());
-                    _udpDestination = boost::lexical_cast<int>(returnVal["result"]["dest"].asInt());
-                    _rateIndex = boost::lexical_cast<int>(returnVal["result"]["filter"].asInt());
-                    _streamId = boost::lexical_cast<int>(returnVal["result"]["vita"].asUInt());
-                    _ovs = boost::lexical_cast<int>(returnVal["result"]["ovs"].asInt());
-                    _decimation = boost::lexical_cast<int>(returnVal["result"]["decimation"].asInt());
-                    _type = boost::lexical_cast<std::string>(returnVal["result"]["type"].asString());
-                    _mode = boost::lexical_cast<std::string>(returnVal["result"]["mode"].asString());
-                    _dgv = boost::lexical_cast<int>(returnVal["result"]["dgv"].asInt());
-                    _dul = boost::lexical_cast<int>(returnVal["result"]["dul"].asInt());
-                    _dll = boost::lexical_cast<int>(returnVal["result"]["dll"].asInt());
-                    _dtl = boost::lexical_cast<int>(returnVal["result"]["dtl"].asInt());
-                    _dal = boost::lexical_cast<int>(returnVal["result"]["dal"].asInt());
-                    _ddl = boost::lexical_cast<int>(returnVal["result"]["ddl"].asInt());
-                    _dao = boost::lexical_cast<int>(returnVal["result"]["dao"].asInt());
-                    _ddo = boost::lexical_cast<int>(returnVal["result"]["ddo"].asInt());
-                    _datc = boost::lexical_cast<int>(returnVal["result"]["datc"].asInt());
-                    _ddtc = boost::lexical_cast<int>(returnVal["result"]["ddtc"].asInt());
-                    _dat = boost::lexical_cast<int>(returnVal["result"]["dat"].asInt());
-                    _ddt = boost::lexical_cast<int>(returnVal["result"]["ddt"].asInt());
+                JsonCommandEncoder& command = JsonCommandEncoder::local();
+                command.begin("qwbddc", _parent->getMessageId())
+                       .param("id", _index);
+                BasicStringList rsp = _parent->sendCommand(command.str(), -1, command.msgId());
+                if ( rsp.empty() )
+                {
+                    this->debug("[WbddcComponent::queryConfiguration] No response\n");
+                    return;
+                }
+                JsonResponseDecoder returnVal(rsp.front());
+                if( returnVal.isValid() && returnVal.has("result") ) { 
+                    _enabled = returnVal.getBool("result.enable");
+                    _frequency = returnVal.getDouble("result.offset");
+                    _source = boost::lexical_cast<int>(returnVal.getString("result.rfch"));
+                    _dataPort = returnVal.getInt("result.link");
+                    _udpDestination = returnVal.getInt("result.dest");
+                    _rateIndex = returnVal.getInt("result.filter");
+                    _streamId = returnVal.getUInt("result.vita");
+                    _ovs = returnVal.getInt("result.ovs");
+                    _decimation = returnVal.getInt("result.decimation");
+                    _type = returnVal.getString("result.type");
+                    _mode = returnVal.getString("result.mode");
+                    _dgv = returnVal.getInt("result.dgv");
+                    _dul = returnVal.getInt("result.dul");
+                    _dll = returnVal.getInt("result.dll");
+                    _dtl = returnVal.getInt("result.dtl");
+                    _dal = returnVal.getInt("result.dal");
+                    _ddl = returnVal.getInt("result.ddl");
+                    _dao = returnVal.getInt("result.dao");
+                    _ddo = returnVal.getInt("result.ddo");
+                    _datc = returnVal.getInt("result.datc");
+                    _ddtc = returnVal.getInt("result.ddtc");
+                    _dat = returnVal.getInt("result.dat");
+                    _ddt = returnVal.getInt("result.ddt");
                     updateConfigurationDict();
                 }
                 this->debug("[WbddcComponent::queryConfiguration] Returning\n");
@@ -309,24 +309,19 @@ namespace LibCyberRadio
                 bool ret = false;
                 if ( (_parent != NULL) && (_parent->isConnected()) )
                 {
-                    Json::Value root(Json::objectValue);
-                    root["msg"] = m551Parent->getMessageId();
-                    Json::Value params(Json::objectValue);
-                    params["id"] = index;
-                    root["params"] = params;
-                    Json::FastWriter fastWriter;
-                    std::string output = fastWriter.write(root);
-                    LibCyberRadio::BasicStringList recv = _parent->sendCommand(output,1.0);
-                    Json::Reader reader;
-                    Json::Value returnVal; 
-                    std::string t = recv.at(0);
-                    bool parsingSuccessful = reader.parse( t.c_str(), returnVal );     //parse process
-                    Json::Value result = returnVal["result"];
-                    rateIndex = boost::lexical_cast<int>(result["filter"].asInt());
-                    udpDestination = boost::lexical_cast<int>(result["dest"].asInt());
-                    enabled = boost::lexical_cast<int>(result["enable"].asBool());
-                    vitaEnable = boost::lexical_cast<int>(result["enable"].asBool());
-                    streamId = boost::lexical_cast<unsigned int>(result["vita"].asUInt());
+                    JsonCommandEncoder& command = JsonCommandEncoder::local();
+                    command.begin(NULL, m551Parent->getMessageId())
+                           .param("id", index);
+                    LibCyberRadio::BasicStringList recv = _parent->sendCommand(command.str(), 1.0, command.msgId());
+                    if ( !recv.empty() )
+                    {
+                        JsonResponseDecoder returnVal(recv.front());
+                        rateIndex = returnVal.getInt("result.filter");
+                        udpDestination = returnVal.getInt("result.dest");
+                        enabled = returnVal.getBool("result.enable");
+                        vitaEnable = returnVal.getBool("result.enable");
+                        streamId = returnVal.getUInt("result.vita");
+                    }
                 }
                 return ret;
             }
@@ -336,21 +331,12 @@ namespace LibCyberRadio
                 bool ret = false;
                 if ( (_parent != NULL) && (_parent->isConnected()) )
                 {
-                    Json::Value root(Json::objectValue);
-                    root["msg"] = m551Parent->getMessageId();
-                    root["cmd"] = "wbddc";
-                    Json::Value params(Json::objectValue);
-                    params["id"] = index;
-                    params["link"] = dataPort;
-                    root["params"] = params;
-                    Json::FastWriter fastWriter;
-                    std::string output = fastWriter.write(root);
-                    LibCyberRadio::BasicStringList recv = _parent->sendCommand(output,1.0);
-                    Json::Reader reader;
-                    Json::Value returnVal; 
-                    std::string t = recv.at(0);
-                    bool parsingSuccessful = reader.parse( t.c_str(), returnVal );     //parse process
-                    ret = returnVal["success"].asBool();
+                    JsonCommandEncoder& command = JsonCommandEncoder::local();
+                    command.begin("wbddc", m551Parent->getMessageId())
+                           .param("id", index)
+                           .param("link", dataPort);
+                    LibCyberRadio::BasicStringList recv = _parent->sendCommand(command.str(), 1.0, command.msgId());
+                    ret = !recv.empty() && JsonResponseDecoder(recv.front()).getBool("success");
                 }
                 return ret;
             }
@@ -362,22 +348,12 @@ namespace LibCyberRadio
                 bool ret = false;
                 if ( (_parent != NULL) && (_parent->isConnected()) )
                 {
-                    Json::Value root(Json::objectValue);
-                    root["msg"] = m551Parent->getMessageId();
-                    root["cmd"] = "wbddc";
-                    Json::Value params(Json::objectValue);
-                    params["id"] = index;
-                    
-                    params["rfch"] = std::to_string(source);
-                    root["params"] = params;
-                    Json::FastWriter fastWriter;
-                    std::string output = fastWriter.write(root);
-                    LibCyberRadio::BasicStringList recv = _parent->sendCommand(output,1.0);
-                    Json::Reader reader;
-                    Json::Value returnVal; 
-                    std::string t = recv.at(0);
-                    bool parsingSuccessful = reader.parse( t.c_str(), returnVal );     //parse process
-                    ret = returnVal["success"].asBool();
+                    JsonCommandEncoder& command = JsonCommandEncoder::local();
+                    command.begin("wbddc", m551Parent->getMessageId())
+                           .param("id", index)
+                           .param("rfch", std::to_string(source));
+                    LibCyberRadio::BasicStringList recv = _parent->sendCommand(command.str(), 1.0, command.msgId());
+                    ret = !recv.empty() && JsonResponseDecoder(recv.front()).getBool("success");
                 }
                 return ret;
             }
@@ -388,21 +364,12 @@ namespace LibCyberRadio
                 bool ret = false;
                 if ( (_parent != NULL) && (_parent->isConnected()) )
                 {
-                    Json::Value root(Json::objectValue);
-                    root["msg"] = m551Parent->getMessageId();
-                    root["cmd"] = "wbddc";
-                    Json::Value params(Json::objectValue);
-                    params["id"] = index;
-                    params["offset"] = freq;
-                    root["params"] = params;
-                    Json::FastWriter fastWriter;
-                    std::string output = fastWriter.write(root);
-                    LibCyberRadio::BasicStringList recv = _parent->sendCommand(output,1.0);
-                    Json::Reader reader;
-                    Json::Value returnVal; 
-                    std::string t = recv.at(0);
-                    bool parsingSuccessful = reader.parse( t.c_str(), returnVal );     //parse process
-                    ret = returnVal["success"].asBool();
+                    JsonCommandEncoder& command = JsonCommandEncoder::local();
+                    command.begin("wbddc", m551Parent->getMessageId())
+                           .param("id", index)
+                           .param("offset", freq);
+                    LibCyberRadio::BasicStringList recv = _parent->sendCommand(command.str(), 1.0, command.msgId());
+                    ret = !recv.empty() && JsonResponseDecoder(recv.front()).getBool("success");
                 }
                 return ret;
             }
@@ -416,30 +383,22 @@ namespace LibCyberRadio
                 bool ret = false;
                 if ( (_parent != NULL) && (_parent->isConnected()) )
                 {
-                    Json::Value root(Json::objectValue);
-                    root["msg"] = m551Parent->getMessageId();
-                    root["cmd"] = "wbddc";
-                    Json::Value params(Json::objectValue);
-                    params["id"] = index;
-                    params["filter"] = rateIndex;
-                    params["dest"] = udpDestination;
-                    params["enable"] = boost::lexical_cast<bool>(enabled);
-                    params["vita"] = streamId;
-                    root["params"] = params;
-                    Json::FastWriter fastWriter;
-                    std::string output = fastWriter.write(root);
-                    LibCyberRadio::BasicStringList recv = _parent->sendCommand(output,1.0);
-                    Json::Reader reader;
-                    Json::Value returnVal; 
-                    std::string t = recv.at(0);
-                    bool parsingSuccessful = reader.parse( t.c_str(), returnVal );     //parse process
-                    ret = returnVal["success"].asBool();
+                    JsonCommandEncoder& command = JsonCommandEncoder::local();
+                    command.begin("wbddc", m551Parent->getMessageId())
+                           .param("id", index)
+                           .param("filter", rateIndex)
+                           .param("dest", udpDestination)
+                           .param("enable", enabled)
+                           .param("vita", streamId);
+                    LibCyberRadio::BasicStringList recv = _parent->sendCommand(command.str(), 1.0, command.msgId());
+                    ret = !recv.empty() && JsonResponseDecoder(recv.front()).getBool("success");
                 }
                 return ret;
             }
 
             bool WbddcComponent::setRateIndex(int index)
             {
+                this->ensureState();
                 bool ret = false;
                 if ( _config.hasKey("filter") )
                 {
@@ -492,6 +451,7 @@ namespace LibCyberRadio
 
             bool WbddcComponent::setUdpDestination(int dest)
             {
+                this->ensureState();
                 bool ret = false;
                 if ( _config.hasKey("dest") )
                 {
@@ -107,9 +107,13 @@ namespace LibCyberRadio
 
         bool NbddcComponent::enable(bool enabled)
         {
+            this->ensureState();
             bool ret = false;
             if ( _config.hasKey("enable") )
             {
+                // Nothing to send if the radio already has this setting
+                if ( this->isStateCurrent() && (enabled == _enabled) )
+                    return true;
                 int adjRateIndex = _rateIndex;
                 int adjUdpDest = _udpDestination;
                 int adjVita = _vitaEnable;
@@ -130,11 +134,12 @@ namespace LibCyberRadio
 
         bool NbddcComponent::setConfiguration(ConfigurationDict& cfg)
         {
+            ConfigurationDict delta = this->changedConfiguration(cfg);
             // Call the "grandparent" version of this method instead of the
             // parent version. We want the normalization, but not the
             // automatic enabling.
             bool ret = Configurable::setConfiguration(cfg);
-            // Use the keys provided in the *incoming* dictionary to determine
+            // Use the keys that changed in the *incoming* dictionary to determine
             // what needs to be changed via hardware calls.
             int adjRateIndex = _rateIndex;
             int adjUdpDest = _udpDestination;
@@ -148,32 +153,32 @@ namespace LibCyberRadio
             bool freqCmdNeedsExecuting = false;
             bool srcCmdNeedsExecuting = false;
             bool dpCmdNeedsExecuting = false;
-            if ( cfg.hasKey("enable") && _config.hasKey("enable") )
+            if ( delta.hasKey("enable") && _config.hasKey("enable") )
             {
                 adjEnabled = getConfigurationValueAsBool("enable");
                 ddcCmdNeedsExecuting = true;
             }
-            if ( cfg.hasKey("rateIndex") && _config.hasKey("rateIndex") )
+            if ( delta.hasKey("rateIndex") && _config.hasKey("rateIndex") )
             {
                 adjRateIndex = getConfigurationValueAsInt("rateIndex");
                 ddcCmdNeedsExecuting = true;
             }
-            if ( cfg.hasKey("udpDestination") && _config.hasKey("udpDestination") )
+            if ( delta.hasKey("udpDestination") && _config.hasKey("udpDestination") )
             {
                 adjUdpDest = getConfigurationValueAsInt("udpDestination");
                 ddcCmdNeedsExecuting = true;
             }
-            if ( cfg.hasKey("vitaEnable") && _config.hasKey("vitaEnable") )
+            if ( delta.hasKey("vitaEnable") && _config.hasKey("vitaEnable") )
             {
                 adjVita = getConfigurationValueAsInt("vitaEnable");
                 ddcCmdNeedsExecuting = true;
             }
-            if ( cfg.hasKey("streamId") && _config.hasKey("streamId") )
+            if ( delta.hasKey("streamId") && _config.hasKey("streamId") )
             {
                 adjStream = getConfigurationValueAsUInt("streamId");
                 ddcCmdNeedsExecuting = true;
             }
-            if ( cfg.hasKey("frequency") && _config.hasKey("frequency") )
+            if ( delta.hasKey("frequency") && _config.hasKey("frequency") )
             {
                 adjFreq = getConfigurationValueAsDbl("frequency");
                 if ( _nbddcCommandSetsFreq )
@@ -181,7 +186,7 @@ namespace LibCyberRadio
                 else
                     freqCmdNeedsExecuting = true;
             }
-            if ( cfg.hasKey("source") && _config.hasKey("source") )
+            if ( delta.hasKey("source") && _config.hasKey("source") )
             {
                 adjSource = getConfigurationValueAsInt("source");
                 if ( _nbddcCommandSetsSource )
@@ -189,7 +194,7 @@ namespace LibCyberRadio
                 else
                     srcCmdNeedsExecuting = true;
             }
-            if ( cfg.hasKey("dataPort") && _config.hasKey("dataPort") )
+            if ( delta.hasKey("dataPort") && _config.hasKey("dataPort") )
             {
                 adjDataPort = getConfigurationValueAsInt("dataPort");
                 if ( _selectableDataPort )
@@ -225,6 +230,24 @@ namespace LibCyberRadio
                 _dataPort = adjDataPort;
                 updateConfigurationDict();
             }
+            if ( !ret )
+                this->invalidate();
+            return ret;
+        }
+
+        std::string NbddcComponent::validateConfiguration(const ConfigurationDict& cfg) const
+        {
+            std::string ret = RadioComponent::validateConfiguration(cfg);
+            if ( ret.empty() )
+            {
+                BasicIntList rates;
+                for (NbddcRateSet::const_iterator it = _rateSet.begin();
+                        it != _rateSet.end(); it++)
+                    rates.push_back(it->first);
+                ret = this->validateChoice(cfg, "rateIndex", rates);
+            }
+            if ( ret.empty() )
+                ret = this->validateRange(cfg, "frequency", _freqRangeMin, _freqRangeMax);
             return ret;
         }
 
@@ -260,14 +283,19 @@ namespace LibCyberRadio
 
         double NbddcComponent::getFrequency() const
         {
+            this->ensureState();
             return _frequency;
         }
 
         bool NbddcComponent::setFrequency(double freq)
         {
+            this->ensureState();
             bool ret = false;
             if ( _config.hasKey("frequency") )
             {
+                // Nothing to send if the radio already has this setting
+                if ( this->isStateCurrent() && (freq == _frequency) )
+                    return true;
                 double adjFreq = freq;
                 if ( _nbddcCommandSetsFreq )
                 {
@@ -313,14 +341,19 @@ namespace LibCyberRadio
 
         int NbddcComponent::getSource() const
         {
+            this->ensureState();
             return _source;
         }
 
         bool NbddcComponent::setSource(int source)
         {
+            this->ensureState();
             bool ret = false;
             if ( _config.hasKey("source") )
             {
+                // Nothing to send if the radio already has this setting
+                if ( this->isStateCurrent() && (source == _source) )
+                    return true;
                 int adjSource = source;
                 if ( _nbddcCommandSetsSource )
                 {
@@ -348,14 +381,19 @@ namespace LibCyberRadio
 
         int NbddcComponent::getRateIndex() const
         {
+            this->ensureState();
             return _rateIndex;
         }
 
         bool NbddcComponent::setRateIndex(int index)
         {
+            this->ensureState();
             bool ret = false;
             if ( _config.hasKey("rateIndex") )
             {
+                // Nothing to send if the radio already has this setting
+                if ( this->isStateCurrent() && (index == _rateIndex) )
+                    return true;
                 int adjRateIndex = index;
                 int adjUdpDest = _udpDestination;
                 int adjVita = _vitaEnable;
@@ -377,14 +415,19 @@ namespace LibCyberRadio
 
         int NbddcComponent::getUdpDestination() const
         {
+            this->ensureState();
             return _udpDestination;
         }
 
         bool NbddcComponent::setUdpDestination(int dest)
         {
+            this->ensureState();
             bool ret = false;
             if ( _config.hasKey("udpDestination") )
             {
+                // Nothing to send if the radio already has this setting
+                if ( this->isStateCurrent() && (dest == _udpDestination) )
+                    return true;
                 int adjRateIndex = _rateIndex;
                 int adjUdpDest = dest;
                 int adjVita = _vitaEnable;
@@ -406,14 +449,19 @@ namespace LibCyberRadio
 
         int NbddcComponent::getVitaEnable() const
         {
+            this->ensureState();
             return _vitaEnable;
         }
 
         bool NbddcComponent::setVitaEnable(int enable)
         {
+            this->ensureState();
             bool ret = false;
             if ( _config.hasKey("vitaEnable") )
             {
+                // Nothing to send if the radio already has this setting
+                if ( this->isStateCurrent() && (enable == _vitaEnable) )
+                    return true;
                 int adjRateIndex = _rateIndex;
                 int adjUdpDest = _udpDestination;
                 int adjVita = enable;
@@ -435,14 +483,19 @@ namespace LibCyberRadio
 
         unsigned int NbddcComponent::getStreamId() const
         {
+            this->ensureState();
             return _streamId;
         }
 
         bool NbddcComponent::setStreamId(unsigned int sid)
         {
+            this->ensureState();
             bool ret = false;
             if ( _config.hasKey("streamId") )
             {
+                // Nothing to send if the radio already has this setting
+                if ( this->isStateCurrent() && (sid == _streamId) )
+                    return true;
                 int adjRateIndex = _rateIndex;
                 int adjUdpDest = _udpDestination;
                 int adjVita = _vitaEnable;
@@ -464,6 +517,7 @@ namespace LibCyberRadio
 
         int NbddcComponent::getDataPort() const
         {
+            this->ensureState();
             return _dataPort;
         }
 
@@ -472,6 +526,9 @@ namespace LibCyberRadio
             bool ret = false;
             if ( _selectableDataPort && _config.hasKey("dataPort") )
             {
+                // Nothing to send if the radio already has this setting
+                if ( this->isStateCurrent() && (port == _dataPort) )
+                    return true;
                 int adjDataPort = port;
                 ret = executeDataPortCommand(_index, adjDataPort);
                 if ( ret )
@@ -87,20 +87,24 @@ namespace LibCyberRadio
 
         bool RadioComponent::isEnabled() const
         {
+            this->ensureState();
             return _enabled;
         }
 
         bool RadioComponent::setConfiguration(ConfigurationDict& cfg)
         {
             //this->debug("[RadioComponent::setConfiguration] Called\n");
+            ConfigurationDict delta = this->changedConfiguration(cfg);
             // Call the base-class version to modify the configuration dictionary
             bool ret = Configurable::setConfiguration(cfg);
-            // Use the keys provided in the *incoming* dictionary to determine
+            // Use the keys that changed in the *incoming* dictionary to determine
             // what needs to be changed.
-            if ( cfg.hasKey("enable") && _config.hasKey("enable") )
+            if ( delta.hasKey("enable") && _config.hasKey("enable") )
             {
                 ret = enable( _config["enable"].asBool() );
             }
+            if ( !ret )
+                this->invalidate();
             //this->debug("[RadioComponent::setConfiguration] Returning\n");
             return ret;
         }
@@ -9,16 +9,27 @@
  ***************************************************************************/
 
 #include "LibCyberRadio/Driver/RadioHandler.h"
+#include "LibCyberRadio/Driver/JsonCodec.h"
 #include "LibCyberRadio/Common/Pythonesque.h"
+#include <json/json.h>
+#include <boost/bind.hpp>
 #include <boost/format.hpp>
 #include <boost/lexical_cast.hpp>
+#include <boost/thread/thread.hpp>
 #include <algorithm>
+#include <fstream>
 #include <sstream>
 #include <iomanip>
 #include <cstdio>
 #include <cstring>
 #include <ctime>
 #include <arpa/inet.h>
+#include <cerrno>
+#include <cstdlib>
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 namespace LibCyberRadio
 {
@@ -85,7 +96,23 @@ namespace LibCyberRadio
             _calibFrequency(0.0),
             _lastCmdErrorInfo(""),
             _defaultTimeout(2.0),
-            _defaultDeviceInfo(0)
+            _defaultDeviceInfo(0),
+            _cmdBatchSize(32),
+            _prefetchMode(PREFETCH_OFF),
+            _queryConnections(1),
+            _lazyComponents(false),
+            _componentTtl(0.0),
+            _configCacheFile(""),
+            _configCacheSpotChecks(3),
+            _configFromCache(false),
+            _configCacheHeld(true),
+            _captureRsp(false),
+            _transactionOpen(false),
+            _transactionStaging(false),
+            _asyncStop(false),
+            _asyncIoThread(NULL),
+            _asyncWorkerCount(4),
+            _asyncWorkers(NULL)
         {
             _versionInfo["model"] = "N/A";
             _versionInfo["serialNumber"] = "N/A";
@@ -100,6 +127,7 @@ namespace LibCyberRadio
 
         RadioHandler::~RadioHandler()
         {
+            this->stopAsync();
             if ( isConnected() )
             {
                 disconnect();
@@ -192,6 +220,25 @@ namespace LibCyberRadio
             _connectionInfo = other._connectionInfo;
             _defaultTimeout = other._defaultTimeout;
             _defaultDeviceInfo = other._defaultDeviceInfo;
+            _cmdBatchSize = other._cmdBatchSize;
+            _prefetchMode = PREFETCH_OFF;
+            _queryConnections = other._queryConnections;
+            _startupTiming = other._startupTiming;
+            _lazyComponents = other._lazyComponents;
+            _componentTtl = other._componentTtl;
+            _configCacheFile = other._configCacheFile;
+            _configCacheSpotChecks = other._configCacheSpotChecks;
+            _configFromCache = other._configFromCache;
+            _configCacheHeld = other._configCacheHeld.load();
+            _captureRsp = false;
+            // Transactions refer to the other object's components
+            _transactionOpen = false;
+            _transactionStaging = false;
+            // Asynchronous threads are started on first use
+            _asyncStop = false;
+            _asyncIoThread = NULL;
+            _asyncWorkerCount = other._asyncWorkerCount;
+            _asyncWorkers = NULL;
         }
 
         RadioHandler& RadioHandler::operator=(const RadioHandler& other)
@@ -238,6 +285,29 @@ namespace LibCyberRadio
                 _connectionInfo = other._connectionInfo;
                 _defaultTimeout = other._defaultTimeout;
                 _defaultDeviceInfo = other._defaultDeviceInfo;
+                _cmdBatchSize = other._cmdBatchSize;
+                _prefetchMode = PREFETCH_OFF;
+                _prefetchCmds.clear();
+                _prefetchIds.clear();
+                _prefetchRsp.clear();
+                _queryConnections = other._queryConnections;
+                _startupTiming = other._startupTiming;
+                _lazyComponents = other._lazyComponents;
+                _componentTtl = other._componentTtl;
+                _configCacheFile = other._configCacheFile;
+                _configCacheSpotChecks = other._configCacheSpotChecks;
+                _configFromCache = other._configFromCache;
+                _configCacheHeld = other._configCacheHeld.load();
+                _captureRsp = false;
+                _capturedRsp.clear();
+                _transactionOpen = false;
+                _transactionStaging = false;
+                _transactionCmds.clear();
+                _transactionIds.clear();
+                _transactionError = "";
+                _transactionUndo.clear();
+                this->stopAsync();
+                _asyncWorkerCount = other._asyncWorkerCount;
             }
             return *this;
         }
@@ -262,11 +332,15 @@ namespace LibCyberRadio
             this->debug("[RadioHandler::connect] Called; mode=\"%s\", HorD=\"%s\", PorB=%d\n", mode.c_str(), host_or_dev.c_str(), port_or_baudrate);
             bool ret = false;
             _connectionInfo = BasicStringStringDict();
+            _startupTiming.clear();
+            boost::chrono::steady_clock::time_point connectStart = boost::chrono::steady_clock::now();
+            boost::chrono::steady_clock::time_point phaseStart = connectStart;
             // Sanity check: Make sure radio supports the given connection mode
             if ( isConnectionModeSupported(mode) )
             {
                 ret = _transport.connect(mode, host_or_dev, port_or_baudrate);
                 this->debug("[RadioHandler::connect] Connect result: %s\n", debugBool(ret));
+                this->recordStartupPhase("connect", phaseStart);
                 if (ret)
                 {
                     _connectionInfo["mode"] = mode;
@@ -281,7 +355,8 @@ namespace LibCyberRadio
                         _connectionInfo["baudrate"] = ( boost::format("%d") % port_or_baudrate ).str();
                     }
                     this->debug("[RadioHandler::connect] Querying configuration\n");
-                    this->queryConfiguration();
+                    this->refresh();
+                    this->recordStartupPhase("total", connectStart);
                 }
                 else
                     _lastCmdErrorInfo = _transport.getLastCommandErrorInfo();
@@ -299,101 +374,660 @@ namespace LibCyberRadio
         void RadioHandler::disconnect()
         {
             this->debug("[RadioHandler::disconnect] Called\n");
+            this->stopAsync();
             if (_transport.isConnected())
                 _transport.disconnect();
             this->debug("[RadioHandler::disconnect] Returning\n");
         }
 
-        BasicStringList RadioHandler::sendCommand(const std::string &cmdString, double timeout)
+        void RadioHandler::setConnectTimeout(double timeout)
+        {
+            _transport.setConnectTimeout(timeout);
+        }
+
+        double RadioHandler::getConnectTimeout() const
+        {
+            return _transport.getConnectTimeout();
+        }
+
+        bool RadioHandler::probeConnection(const std::string &mode,
+                const std::string &host_or_dev, int port_or_baudrate,
+                double timeout, std::string &identity)
+        {
+            this->debug("[RadioHandler::probeConnection] Called; mode=\"%s\", HorD=\"%s\", PorB=%d, timeout=%0.1f\n",
+                    mode.c_str(), host_or_dev.c_str(), port_or_baudrate, timeout);
+            bool ret = false;
+            identity = "";
+            boost::chrono::steady_clock::time_point deadline = boost::chrono::steady_clock::now() +
+                    boost::chrono::duration_cast<boost::chrono::steady_clock::duration>(
+                            boost::chrono::duration<double>(timeout));
+            if ( isConnectionModeSupported(mode) )
+            {
+                RadioTransport transport(_transport.isJson(), _debug);
+                transport.setConnectTimeout(timeout);
+                if ( transport.connect(mode, host_or_dev, port_or_baudrate) )
+                {
+                    BasicStringList rsp;
+                    if ( transport.isJson() )
+                    {
+                        JsonCommandEncoder& command = JsonCommandEncoder::local();
+                        command.begin("qstatus", this->getMessageId());
+                        if ( transport.sendCommand(command.str(), true, command.msgId()) )
+                            rsp = transport.receive(this->getProbeTimeRemaining(deadline));
+                        if ( !rsp.empty() )
+                        {
+                            JsonResponseDecoder returnVal(rsp.front());
+                            ret = returnVal.isValid();
+                            identity = returnVal.getString("result.model");
+                        }
+                    }
+                    else
+                    {
+                        // Purge the banner sent over when a connection is made.
+                        if ( mode == "tcp" )
+                            transport.receive(this->getProbeTimeRemaining(deadline));
+                        if ( transport.sendCommand("*IDN?\n") )
+                            rsp = transport.receive(this->getProbeTimeRemaining(deadline));
+                        ret = !rsp.empty();
+                        identity = Pythonesque::Join(rsp, "\n");
+                    }
+                    transport.disconnect();
+                }
+            }
+            this->debug("[RadioHandler::probeConnection] Returning %s; identity=\"%s\"\n",
+                    debugBool(ret), identity.c_str());
+            return ret;
+        }
+
+        double RadioHandler::getProbeTimeRemaining(
+                const boost::chrono::steady_clock::time_point& deadline) const
+        {
+            double remaining = boost::chrono::duration<double>(
+                    deadline - boost::chrono::steady_clock::now()).count();
+            return ( remaining > 0.0 ) ? remaining : 0.0;
+        }
+
+        BasicStringList RadioHandler::sendCommand(const std::string &cmdString, double timeout,
+                int64_t msgId)
         {
             this->debug("[RadioHandler::sendCommand] Called; cmd=\"%s\"\n",
                     Pythonesque::Strip(cmdString).c_str());
             BasicStringList ret;
-            _lastCmdErrorInfo = "";
-            if ( _transport.sendCommand(cmdString) )
+            // Query worker threads use their own connection and error info
+            QuerySession* session = _querySession.get();
+            RadioTransport& transport = ( session != NULL ) ? *(session->transport) : _transport;
+            std::string& errorInfo = ( session != NULL ) ? session->lastCmdErrorInfo : _lastCmdErrorInfo;
+            errorInfo = "";
+            if ( (session != NULL) && session->queued )
             {
-                ret = _transport.receive(timeout);
+                // Asynchronous setter threads send through the I/O thread, so
+                // that their commands share pipelined batches
+                AsyncCommandResult result = this->sendCommandAsync(cmdString, timeout, msgId).get();
+                errorInfo = result.errorInfo;
+                this->debug("[RadioHandler::sendCommand] Returning %lu queued elements\n",
+                        result.response.size());
+                return result.response;
             }
-            else
-                _lastCmdErrorInfo = _transport.getLastCommandErrorInfo();
+            if ( (session == NULL) && _transactionStaging )
+            {
+                // Stage the command for the transaction commit.  Callers see
+                // success, so they take on the staged settings.
+                _transactionCmds.push_back(cmdString);
+                _transactionIds.push_back(msgId);
+                if ( _transport.isJson() )
+                    ret.push_back("{\"success\": true}");
+                this->debug("[RadioHandler::sendCommand] Staged\n");
+                return ret;
+            }
+            if ( (session == NULL) && (_prefetchMode == PREFETCH_RECORD) )
+            {
+                // Collect the command for the next batch.  Callers see an
+                // error, so they leave their settings alone on this pass.
+                _prefetchCmds.push_back(cmdString);
+                _prefetchIds.push_back(msgId);
+                _lastCmdErrorInfo = "Deferred";
+                this->debug("[RadioHandler::sendCommand] Deferred\n");
+                return ret;
+            }
+            if ( (session == NULL) && (_prefetchMode == PREFETCH_REPLAY) )
+            {
+                std::map<std::string, std::deque<std::pair<BasicStringList, std::string> > >::iterator pit =
+                        _prefetchRsp.find(cmdString);
+                if ( (pit != _prefetchRsp.end()) && !pit->second.empty() )
+                {
+                    ret = pit->second.front().first;
+                    _lastCmdErrorInfo = pit->second.front().second;
+                    pit->second.pop_front();
+                    if ( _captureRsp && _lastCmdErrorInfo.empty() )
+                        _capturedRsp[cmdString].push_back(std::make_pair(ret, _lastCmdErrorInfo));
+                    this->debug("[RadioHandler::sendCommand] Returning %lu prefetched elements\n", ret.size());
+                    return ret;
+                }
+                // Commands that were not recorded (for example, ones that
+                // depend on an earlier response) go to the radio as usual.
+            }
+            {
+                // The I/O thread shares the primary connection
+                boost::unique_lock<boost::mutex> lock(_transportMutex, boost::defer_lock);
+                if ( &transport == &_transport )
+                    lock.lock();
+                if ( transport.sendCommand(cmdString, true, msgId) )
+                {
+                    ret = transport.receive(timeout);
+                }
+                else
+                    errorInfo = transport.getLastCommandErrorInfo();
+            }
+            std::string rspError = this->processCommandResponse(cmdString, ret);
+            if ( !rspError.empty() )
+                errorInfo = rspError;
+            if ( errorInfo.empty() )
+                this->dropConfigCacheOnSet(cmdString);
+            // Failed commands are left out of the cache, so they are retried
+            if ( _captureRsp && errorInfo.empty() )
+            {
+                boost::mutex::scoped_lock lock(_captureMutex);
+                _capturedRsp[cmdString].push_back(std::make_pair(ret, errorInfo));
+            }
+            // Debug print
+            this->debug("[RadioHandler::sendCommand] Returning %lu elements\n", ret.size());
+            for (BasicStringList::iterator it = ret.begin(); it != ret.end(); it++)
+                this->debug("[RadioHandler::sendCommand] -- %s\n", it->c_str());
+            return ret;
+        }
+
+        std::vector<BasicStringList> RadioHandler::sendCommands(
+                const BasicStringList& cmds, double timeout,
+                const std::vector<int64_t>& msgIds)
+        {
+            this->debug("[RadioHandler::sendCommands] Called; %lu commands\n", cmds.size());
+            QuerySession* session = _querySession.get();
+            RadioTransport& transport = ( session != NULL ) ? *(session->transport) : _transport;
+            std::string& errorInfo = ( session != NULL ) ? session->lastCmdErrorInfo : _lastCmdErrorInfo;
+            std::vector<BasicStringList> ret;
+            std::string transportError;
+            {
+                boost::unique_lock<boost::mutex> lock(_transportMutex, boost::defer_lock);
+                if ( &transport == &_transport )
+                    lock.lock();
+                ret = transport.sendCommandBatch(cmds, timeout, msgIds);
+                transportError = transport.getLastCommandErrorInfo();
+            }
+            errorInfo = "";
+            for (size_t i = 0; i < ret.size(); i++)
+            {
+                std::string rspError = this->processCommandResponse(cmds[i], ret[i]);
+                if ( rspError.empty() && ret[i].empty() )
+                    rspError = transportError;
+                if ( rspError.empty() )
+                    this->dropConfigCacheOnSet(cmds[i]);
+                if ( errorInfo.empty() )
+                    errorInfo = rspError;
+            }
+            this->debug("[RadioHandler::sendCommands] Returning %lu responses\n", ret.size());
+            return ret;
+        }
+
+        std::string RadioHandler::processCommandResponse(const std::string& cmdString,
+                BasicStringList& rsp)
+        {
+            std::string ret = "";
             // This covers the case where the act of sending the command itself
             // generates an error, but not the case where the command/response happens
             // but the response contains an error message.  This section looks for
             // error messages in the response and sets last command error info accordingly.
             BasicStringList::iterator it;
-            for (it = ret.begin(); it != ret.end(); it++)
+            for (it = rsp.begin(); it != rsp.end(); it++)
             {
                 if ( it->find("ERROR") != std::string::npos )
                 {
-                    _lastCmdErrorInfo = Pythonesque::Replace(*it, "ERROR: ", "");
+                    ret = Pythonesque::Replace(*it, "ERROR: ", "");
                     break;
                 }
             }
             // If the first line of the response just echoed the command, remove it
-            if ( (ret.size() > 0) && (ret.front() == Pythonesque::Strip(cmdString)) )
-                ret.erase(ret.begin());
-            // Debug print
-            this->debug("[RadioHandler::sendCommand] Returning %lu elements\n", ret.size());
-            for (it = ret.begin(); it != ret.end(); it++)
-                this->debug("[RadioHandler::sendCommand] -- %s\n", it->c_str());
+            if ( (rsp.size() > 0) && (rsp.front() == Pythonesque::Strip(cmdString)) )
+                rsp.erase(rsp.begin());
             return ret;
         }
 
         void RadioHandler::queryConfiguration()
         {
+            boost::chrono::steady_clock::time_point phaseStart = boost::chrono::steady_clock::now();
             this->queryVersionInfo();
+            this->recordStartupPhase("version", phaseStart);
+            _configFromCache = this->queryConfigurationCached();
+            if ( _configFromCache )
+            {
+                this->recordStartupPhase("cache", phaseStart);
+                return;
+            }
+            std::string cacheKey = this->getConfigCacheKey();
+            if ( !cacheKey.empty() )
+            {
+                _capturedRsp.clear();
+                _captureRsp = true;
+            }
+            // Concurrent queries give each connection a share of the
+            // components; otherwise, pipeline them over the one connection.
+            if ( !((_queryConnections > 1) && this->supportsQueryPool()) &&
+                    this->queryConfigurationBatched() )
+            {
+                this->recordStartupPhase("batch", phaseStart);
+            }
+            else
+            {
+                if ( this->queryRadioConfiguration() )
+                    this->updateConfigurationDict();
+                this->recordStartupPhase("radio", phaseStart);
+                this->queryComponentConfiguration();
+                this->recordStartupPhase("components", phaseStart);
+            }
+            if ( _captureRsp )
+            {
+                _captureRsp = false;
+                this->saveConfigCache(cacheKey, _capturedRsp);
+                _capturedRsp.clear();
+            }
+        }
+
+        bool RadioHandler::queryConfigurationCached()
+        {
+            std::string key = this->getConfigCacheKey();
+            std::map<std::string, std::deque<std::pair<BasicStringList, std::string> > > cached;
+            if ( key.empty() || !this->loadConfigCache(key, cached) || cached.empty() )
+                return false;
+            this->debug("[RadioHandler::queryConfigurationCached] Cache found for %s\n", key.c_str());
+            // Spot-check: re-send a few cached queries, spread across the
+            // (sorted) command list so that they touch different components
+            int checks = std::min((int)cached.size(), _configCacheSpotChecks);
+            for (int i = 0; i < checks; i++)
+            {
+                std::map<std::string, std::deque<std::pair<BasicStringList, std::string> > >::iterator it =
+                        cached.begin();
+                std::advance(it, (i * cached.size()) / checks);
+                BasicStringList rsp = this->sendCommand(it->first, _defaultTimeout);
+                if ( (_lastCmdErrorInfo != "") || (rsp != it->second.front().first) )
+                {
+                    this->debug("[RadioHandler::queryConfigurationCached] Spot-check failed: %s\n",
+                            Pythonesque::Strip(it->first).c_str());
+                    return false;
+                }
+            }
+            // Answer the queries from the cache
+            _prefetchRsp = cached;
+            _prefetchMode = PREFETCH_REPLAY;
+            if ( this->queryRadioConfiguration() )
+                this->updateConfigurationDict();
+            this->queryComponentConfiguration();
+            _prefetchMode = PREFETCH_OFF;
+            _prefetchRsp.clear();
+            this->debug("[RadioHandler::queryConfigurationCached] Returning\n");
+            return true;
+        }
+
+        std::string RadioHandler::getConfigCacheKey()
+        {
+            std::string ret = "";
+            if ( !_configCacheFile.empty() && !_lazyComponents )
+            {
+                std::string model = _versionInfo["model"];
+                std::string serial = _versionInfo["serialNumber"];
+                std::string firmware = _versionInfo["firmwareVersion"];
+                // A radio that did not report its identity cannot be matched
+                if ( (model != "N/A") && (serial != "N/A") && (firmware != "N/A") )
+                    ret = model + "|" + serial + "|" + firmware;
+            }
+            return ret;
+        }
+
+        bool RadioHandler::loadConfigCache(const std::string& key,
+                std::map<std::string, std::deque<std::pair<BasicStringList, std::string> > >& rsps)
+        {
+            bool ret = false;
+            std::ifstream ifs(_configCacheFile.c_str());
+            Json::Value root;
+            Json::Reader reader;
+            if ( ifs.good() && reader.parse(ifs, root) && root.isObject() &&
+                    root.isMember(key) )
+            {
+                const Json::Value& entries = root[key]["responses"];
+                for (Json::ArrayIndex i = 0; i < entries.size(); i++)
+                {
+                    BasicStringList rsp;
+                    for (Json::ArrayIndex j = 0; j < entries[i]["rsp"].size(); j++)
+                        rsp.push_back(entries[i]["rsp"][j].asString());
+                    rsps[entries[i]["cmd"].asString()].push_back(std::make_pair(rsp, std::string("")));
+                }
+                ret = true;
+            }
+            this->debug("[RadioHandler::loadConfigCache] %s: %s\n", key.c_str(), debugBool(ret));
+            return ret;
+        }
+
+        // Replaces (or, given a NULL entry, removes) one radio's entry in the
+        // cache file.  The read-modify-write holds an exclusive lock on a
+        // companion lock file, so that handlers sharing the cache do not lose
+        // each other's entries, and the new file is written under a unique
+        // name and renamed into place, so that a reader never sees a partial
+        // cache.
+        static bool updateConfigCacheFile(const std::string& cacheFile,
+                const std::string& key, const Json::Value* entry)
+        {
+            std::string lockFile = cacheFile + ".lock";
+            int lockFd = open(lockFile.c_str(), O_RDWR | O_CREAT, 0644);
+            if ( lockFd < 0 )
+                return false;
+            bool ret = false;
+            if ( flock(lockFd, LOCK_EX) == 0 )
+            {
+                // Keep the entries for other radios
+                Json::Value root(Json::objectValue);
+                {
+                    std::ifstream ifs(cacheFile.c_str());
+                    Json::Reader reader;
+                    if ( !ifs.good() || !reader.parse(ifs, root) || !root.isObject() )
+                        root = Json::Value(Json::objectValue);
+                }
+                if ( entry != NULL )
+                    root[key] = *entry;
+                else
+                    root.removeMember(key);
+                std::string text = Json::StyledWriter().write(root);
+                std::string tmpTemplate = cacheFile + ".XXXXXX";
+                std::vector<char> tmpFile(tmpTemplate.begin(), tmpTemplate.end());
+                tmpFile.push_back('\0');
+                int tmpFd = mkstemp(&tmpFile[0]);
+                if ( tmpFd >= 0 )
+                {
+                    size_t written = 0;
+                    while ( written < text.size() )
+                    {
+                        ssize_t n = write(tmpFd, text.data() + written, text.size() - written);
+                        if ( (n < 0) && (errno == EINTR) )
+                            continue;
+                        if ( n <= 0 )
+                            break;
+                        written += n;
+                    }
+                    // mkstemp() creates the file readable by its owner only
+                    ret = ( written == text.size() ) && ( fchmod(tmpFd, 0644) == 0 );
+                    ret = ( close(tmpFd) == 0 ) && ret;
+                    if ( ret )
+                        ret = ( rename(&tmpFile[0], cacheFile.c_str()) == 0 );
+                    if ( !ret )
+                        unlink(&tmpFile[0]);
+                }
+                flock(lockFd, LOCK_UN);
+            }
+            close(lockFd);
+            return ret;
+        }
+
+        bool RadioHandler::saveConfigCache(const std::string& key,
+                const std::map<std::string, std::deque<std::pair<BasicStringList, std::string> > >& rsps)
+        {
+            Json::Value entries(Json::arrayValue);
+            std::map<std::string, std::deque<std::pair<BasicStringList, std::string> > >::const_iterator it;
+            for (it = rsps.begin(); it != rsps.end(); it++)
+            {
+                std::deque<std::pair<BasicStringList, std::string> >::const_iterator rit;
+                for (rit = it->second.begin(); rit != it->second.end(); rit++)
+                {
+                    Json::Value entry(Json::objectValue);
+                    entry["cmd"] = it->first;
+                    entry["rsp"] = Json::Value(Json::arrayValue);
+                    for (BasicStringList::const_iterator sit = rit->first.begin();
+                            sit != rit->first.end(); sit++)
+                        entry["rsp"].append(*sit);
+                    entries.append(entry);
+                }
+            }
+            Json::Value radio(Json::objectValue);
+            radio["saved"] = (Json::UInt64)time(NULL);
+            radio["responses"] = entries;
+            bool ret = updateConfigCacheFile(_configCacheFile, key, &radio);
+            if ( ret )
+                _configCacheHeld = true;
+            this->debug("[RadioHandler::saveConfigCache] %s: %s\n", key.c_str(), debugBool(ret));
+            return ret;
+        }
+
+        bool RadioHandler::isQueryCommand(const std::string& cmdString) const
+        {
+            if ( _transport.isJson() )
+            {
+                // JSON query commands are the ones named "q..."
+                std::string cmd = JsonResponseDecoder(cmdString).getString("cmd");
+                return !cmd.empty() && (cmd[0] == 'q');
+            }
+            return ( cmdString.find('?') != std::string::npos );
+        }
+
+        void RadioHandler::dropConfigCacheOnSet(const std::string& cmdString)
+        {
+            // Only the first setting after the cache was written touches the
+            // file; the entry stays gone until the next full query saves it.
+            if ( _configCacheFile.empty() || !_configCacheHeld.load() ||
+                    this->isQueryCommand(cmdString) )
+                return;
+            std::string key = this->getConfigCacheKey();
+            if ( key.empty() || !_configCacheHeld.exchange(false) )
+                return;
+            if ( !updateConfigCacheFile(_configCacheFile, key, NULL) )
+                _configCacheHeld = true;
+            this->debug("[RadioHandler::dropConfigCacheOnSet] %s: %s\n", key.c_str(),
+                    debugBool(!_configCacheHeld.load()));
+        }
+
+        bool RadioHandler::queryConfigurationBatched()
+        {
+            if ( (_cmdBatchSize <= 1) || !_transport.supportsCommandBatch() )
+                return false;
+            this->debug("[RadioHandler::queryConfigurationBatched] Called\n");
+            // Record pass: learn which commands the queries issue
+            _prefetchCmds.clear();
+            _prefetchIds.clear();
+            _prefetchRsp.clear();
+            _prefetchMode = PREFETCH_RECORD;
+            this->queryRadioConfiguration();
+            this->queryComponentConfiguration();
+            _prefetchMode = PREFETCH_OFF;
+            // Send the recorded commands in pipelined batches
+            this->debug("[RadioHandler::queryConfigurationBatched] Sending %lu commands\n",
+                    _prefetchCmds.size());
+            for (size_t start = 0; start < _prefetchCmds.size(); start += _cmdBatchSize)
+            {
+                size_t stop = std::min(_prefetchCmds.size(), start + _cmdBatchSize);
+                BasicStringList batch(_prefetchCmds.begin() + start, _prefetchCmds.begin() + stop);
+                std::vector<int64_t> batchIds(_prefetchIds.begin() + start, _prefetchIds.begin() + stop);
+                std::vector<BasicStringList> rsps = _transport.sendCommandBatch(batch,
+                        _defaultTimeout, batchIds);
+                std::string transportError = _transport.getLastCommandErrorInfo();
+                for (size_t i = 0; i < batch.size(); i++)
+                {
+                    BasicStringList rsp;
+                    if ( i < rsps.size() )
+                        rsp = rsps[i];
+                    std::string rspError = this->processCommandResponse(batch[i], rsp);
+                    if ( rspError.empty() && rsp.empty() )
+                        rspError = transportError;
+                    _prefetchRsp[batch[i]].push_back(std::make_pair(rsp, rspError));
+                }
+            }
+            _prefetchCmds.clear();
+            _prefetchIds.clear();
+            // Replay pass: the queries run again, answered from the batches
+            _prefetchMode = PREFETCH_REPLAY;
             if ( this->queryRadioConfiguration() )
                 this->updateConfigurationDict();
+            this->queryComponentConfiguration();
+            _prefetchMode = PREFETCH_OFF;
+            _prefetchRsp.clear();
+            this->debug("[RadioHandler::queryConfigurationBatched] Returning\n");
+            return true;
+        }
+
+        void RadioHandler::queryComponentConfiguration()
+        {
+            std::vector<Configurable*> components;
             for ( TunerComponentDict::iterator it = _tuners.begin();
                     it != _tuners.end(); it++)
             {
-                it->second->queryConfiguration();
+                components.push_back(it->second);
             }
             for ( WbddcComponentDict::iterator it = _wbddcs.begin();
                     it != _wbddcs.end(); it++)
             {
-                it->second->queryConfiguration();
+                components.push_back(it->second);
             }
             for ( NbddcComponentDict::iterator it = _nbddcs.begin();
                     it != _nbddcs.end(); it++)
             {
-                it->second->queryConfiguration();
+                components.push_back(it->second);
             }
             for ( TransmitterComponentDict::iterator it = _txs.begin();
                     it != _txs.end(); it++)
             {
-                it->second->queryConfiguration();
+                components.push_back(it->second);
             }
             for ( DataPortDict::iterator it = _dataPorts.begin();
                     it != _dataPorts.end(); it++)
             {
-                it->second->queryConfiguration();
+                components.push_back(it->second);
             }
             for ( DucComponentDict::iterator it = _ducs.begin();
                     it != _ducs.end(); it++)
             {
-                it->second->queryConfiguration();
+                components.push_back(it->second);
             }
             for ( WbddcGroupComponentDict::iterator it = _wbddcGroups.begin();
                     it != _wbddcGroups.end(); it++)
             {
-                it->second->queryConfiguration();
+                components.push_back(it->second);
             }
             for ( NbddcGroupComponentDict::iterator it = _nbddcGroups.begin();
                     it != _nbddcGroups.end(); it++)
             {
-                it->second->queryConfiguration();
+                components.push_back(it->second);
             }
             for ( SimpleIpSetupDict::iterator it = _simpleIpSetups.begin();
                     it != _simpleIpSetups.end(); it++)
             {
-                it->second->queryConfiguration();
+                components.push_back(it->second);
+            }
+            this->queryComponents(components);
+        }
+
+        void RadioHandler::queryComponents(const std::vector<Configurable*>& components)
+        {
+            this->debug("[RadioHandler::queryComponents] Called; %lu components\n",
+                    components.size());
+            // In lazy mode, components query their own state when first read
+            for (std::vector<Configurable*>::const_iterator it = components.begin();
+                    it != components.end(); it++)
+            {
+                (*it)->setLazyQuery(_lazyComponents, _componentTtl);
+                (*it)->invalidate();
+            }
+            if ( _lazyComponents )
+            {
+                this->debug("[RadioHandler::queryComponents] Deferred (lazy mode)\n");
+                return;
+            }
+            // Open the extra connections.  Ones that fail to connect are
+            // skipped; the primary connection always takes part.
+            std::vector<RadioTransport*> pool;
+            // Replayed queries are answered locally, so need no extra connections
+            if ( (_queryConnections > 1) && this->supportsQueryPool() &&
+                    (_prefetchMode == PREFETCH_OFF) )
+            {
+                std::string mode = _connectionInfo["mode"];
+                std::string host = _connectionInfo["hostname"];
+                int port = boost::lexical_cast<int>(_connectionInfo["port"]);
+                for (int i = 1; (i < _queryConnections) && ((size_t)i < components.size()); i++)
+                {
+                    RadioTransport* transport = new RadioTransport(_transport.isJson(), _debug);
+                    transport->setConnectTimeout(_transport.getConnectTimeout());
+                    if ( transport->connect(mode, host, port) )
+                    {
+                        // Purge the banner sent over when a connection is made.
+                        if ( !_transport.isJson() )
+                            transport->receive(_defaultTimeout);
+                        pool.push_back(transport);
+                    }
+                    else
+                    {
+                        this->debug("[RadioHandler::queryComponents] Extra connection failed: %s\n",
+                                transport->getLastCommandErrorInfo().c_str());
+                        delete transport;
+                        break;
+                    }
+                }
+                this->debug("[RadioHandler::queryComponents] Using %lu connections\n",
+                        pool.size() + 1);
+            }
+            boost::atomic<size_t> next(0);
+            boost::thread_group workers;
+            for (std::vector<RadioTransport*>::iterator it = pool.begin(); it != pool.end(); it++)
+            {
+                workers.create_thread(boost::bind(&RadioHandler::queryComponentsWorker,
+                        this, *it, &components, &next));
             }
+            this->queryComponentsWorker(NULL, &components, &next);
+            workers.join_all();
+            for (std::vector<RadioTransport*>::iterator it = pool.begin(); it != pool.end(); it++)
+            {
+                (*it)->disconnect();
+                delete *it;
+            }
+            this->debug("[RadioHandler::queryComponents] Returning\n");
+        }
+
+        void RadioHandler::queryComponentsWorker(RadioTransport* transport,
+                const std::vector<Configurable*>* components,
+                boost::atomic<size_t>* next)
+        {
+            if ( transport != NULL )
+            {
+                QuerySession* session = new QuerySession();
+                session->transport = transport;
+                session->queued = false;
+                _querySession.reset(session);
+            }
+            size_t index;
+            while ( (index = (*next)++) < components->size() )
+            {
+                (*components)[index]->refresh();
+            }
+            _querySession.reset();
+        }
+
+        bool RadioHandler::supportsQueryPool() const
+        {
+            // Command-line radios take several TCP sessions; JSON radios
+            // answer each UDP socket separately.
+            BasicStringStringDict::const_iterator it = _connectionInfo.find("mode");
+            if ( it == _connectionInfo.end() )
+                return false;
+            return ( ((it->second == "tcp") && !_transport.isJson()) ||
+                     ((it->second == "udp") && _transport.isJson()) );
+        }
+
+        void RadioHandler::recordStartupPhase(const std::string& phase,
+                boost::chrono::steady_clock::time_point& start)
+        {
+            boost::chrono::steady_clock::time_point now = boost::chrono::steady_clock::now();
+            _startupTiming[phase] = boost::chrono::duration<double>(now - start).count();
+            this->debug("[RadioHandler::recordStartupPhase] %s: %0.3f s\n", phase.c_str(),
+                    _startupTiming[phase]);
+            start = now;
         }
 
         bool RadioHandler::setConfiguration(ConfigurationDict& cfg)
         {
             this->debug("[RadioHandler::setConfiguration] Called\n");
+            ConfigurationDict delta = this->changedConfiguration(cfg);
             // Call the parent version.
             bool ret = Configurable::setConfiguration(cfg);
             int adjCfg = _configMode;
@@ -404,42 +1038,42 @@ namespace LibCyberRadio
             int adjRtv = _referenceTuningVoltage;
             int adjByp = _referenceBypass;
             double adjCal = _calibFrequency;
-            if ( cfg.find("configMode") != cfg.end() )
+            if ( delta.find("configMode") != delta.end() )
             {
                 adjCfg = getConfigurationValueAsInt("configMode");
                 ret &= this->executeConfigModeCommand(adjCfg);
             }
-            if ( cfg.find("coherentMode") != cfg.end() )
+            if ( delta.find("coherentMode") != delta.end() )
             {
                 adjCoh = getConfigurationValueAsInt("coherentMode");
                 ret &= this->executeCoherentModeCommand(adjCoh);
             }
-            if ( cfg.find("freqNormalization") != cfg.end() )
+            if ( delta.find("freqNormalization") != delta.end() )
             {
                 adjFnr = getConfigurationValueAsInt("freqNormalization");
                 ret &= this->executeFreqNormalizationCommand(adjFnr);
             }
-            if ( cfg.find("gpsEnabled") != cfg.end() )
+            if ( delta.find("gpsEnabled") != delta.end() )
             {
                 adjGps = getConfigurationValueAsInt("gpsEnabled");
                 ret &= this->executeGpsEnabledCommand(adjGps);
             }
-            if ( cfg.find("referenceMode") != cfg.end() )
+            if ( delta.find("referenceMode") != delta.end() )
             {
                 adjRef = getConfigurationValueAsInt("referenceMode");
                 ret &= this->executeReferenceModeCommand(adjRef);
             }
-            if ( cfg.find("referenceTuningVoltage") != cfg.end() )
+            if ( delta.find("referenceTuningVoltage") != delta.end() )
             {
                 adjRtv = getConfigurationValueAsInt("referenceTuningVoltage");
                 ret &= this->executeReferenceVoltageCommand(adjRtv);
             }
-            if ( cfg.find("bypassMode") != cfg.end() )
+            if ( delta.find("bypassMode") != delta.end() )
             {
                 adjByp = getConfigurationValueAsInt("bypassMode");
                 ret &= this->executeReferenceBypassCommand(adjByp);
             }
-            if ( cfg.find("calibFrequency") != cfg.end() )
+            if ( delta.find("calibFrequency") != delta.end() )
             {
                 adjCal = getConfigurationValueAsDbl("calibFrequency");
                 ret &= this->executeCalibFrequencyCommand(adjCal);
@@ -456,12 +1090,17 @@ namespace LibCyberRadio
                 _calibFrequency = adjCal;
                 updateConfigurationDict();
             }
+            if ( !ret )
+                this->invalidate();
             this->debug("[RadioHandler::setConfiguration] Returning\n");
             return ret;
         }
 
         std::string RadioHandler::getLastCommandErrorInfo() const
         {
+            QuerySession* session = _querySession.get();
+            if ( session != NULL )
+                return session->lastCmdErrorInfo;
             return _lastCmdErrorInfo;
         }
 
@@ -910,8 +1549,8 @@ namespace LibCyberRadio
         {
             bool ret = false;
             TunerComponentDict::const_iterator it = _tuners.find(index);
-            if ( it != _tuners.end() )
-                ret = it->second->setConfiguration(cfg);
+            ret = this->applyComponentConfiguration(
+                    ( it != _tuners.end() ) ? it->second : NULL, cfg);
             return ret;
         }
 
@@ -1162,8 +1801,8 @@ namespace LibCyberRadio
         {
             bool ret = false;
             WbddcComponentDict::const_iterator it = _wbddcs.find(index);
-            if ( it != _wbddcs.end() )
-                ret = it->second->setConfiguration(cfg);
+            ret = this->applyComponentConfiguration(
+                    ( it != _wbddcs.end() ) ? it->second : NULL, cfg);
             return ret;
         }
 
@@ -1260,9 +1899,9 @@ namespace LibCyberRadio
         bool RadioHandler::setNbddcConfiguration(int index, ConfigurationDict& cfg)
         {
             bool ret = false;
-            NbddcComponentDict::const_iterator it = _nbddcs.begin();
-            if ( it != _nbddcs.end() )
-                ret = it->second->setConfiguration(cfg);
+            NbddcComponentDict::const_iterator it = _nbddcs.find(index);
+            ret = this->applyComponentConfiguration(
+                    ( it != _nbddcs.end() ) ? it->second : NULL, cfg);
             return ret;
         }
 
@@ -1532,8 +2171,8 @@ namespace LibCyberRadio
         {
             bool ret = false;
             TransmitterComponentDict::const_iterator it = _txs.find(index);
-            if ( it != _txs.end() )
-                ret = it->second->setConfiguration(cfg);
+            ret = this->applyComponentConfiguration(
+                    ( it != _txs.end() ) ? it->second : NULL, cfg);
             return ret;
         }
 
@@ -1900,8 +2539,8 @@ namespace LibCyberRadio
         {
             bool ret = false;
             DucComponentDict::const_iterator it = _ducs.find(index);
-            if ( it != _ducs.end() )
-                ret = it->second->setConfiguration(cfg);
+            ret = this->applyComponentConfiguration(
+                    ( it != _ducs.end() ) ? it->second : NULL, cfg);
             return ret;
         }
 
@@ -2156,8 +2795,8 @@ namespace LibCyberRadio
         {
             bool ret = false;
             WbddcGroupComponentDict::const_iterator it = _wbddcGroups.find(index);
-            if ( it != _wbddcGroups.end() )
-                ret = it->second->setConfiguration(cfg);
+            ret = this->applyComponentConfiguration(
+                    ( it != _wbddcGroups.end() ) ? it->second : NULL, cfg);
             return ret;
         }
 
@@ -2246,8 +2885,8 @@ namespace LibCyberRadio
         {
             bool ret = false;
             NbddcGroupComponentDict::const_iterator it = _nbddcGroups.find(index);
-            if ( it != _nbddcGroups.end() )
-                ret = it->second->setConfiguration(cfg);
+            ret = this->applyComponentConfiguration(
+                    ( it != _nbddcGroups.end() ) ? it->second : NULL, cfg);
             return ret;
         }
 
@@ -2333,8 +2972,8 @@ namespace LibCyberRadio
         {
             bool ret = false;
             DataPortDict::const_iterator it = _dataPorts.find(index);
-            if ( it != _dataPorts.end() )
-                ret = it->second->setConfiguration(cfg);
+            ret = this->applyComponentConfiguration(
+                    ( it != _dataPorts.end() ) ? it->second : NULL, cfg);
             return ret;
         }
 
@@ -2542,6 +3181,649 @@ namespace LibCyberRadio
             return _defaultDeviceInfo;
         }
 
+        void RadioHandler::setCommandBatchSize(int size)
+        {
+            _cmdBatchSize = size;
+        }
+
+        int RadioHandler::getCommandBatchSize() const
+        {
+            return _cmdBatchSize;
+        }
+
+        void RadioHandler::setQueryConnections(int connections)
+        {
+            _queryConnections = ( connections < 1 ) ? 1 : connections;
+        }
+
+        int RadioHandler::getQueryConnections() const
+        {
+            return _queryConnections;
+        }
+
+        BasicStringDoubleDict RadioHandler::getStartupTiming() const
+        {
+            return _startupTiming;
+        }
+
+        void RadioHandler::setLazyQuery(bool lazy, double ttl)
+        {
+            _lazyComponents = lazy;
+            _componentTtl = ttl;
+        }
+
+        bool RadioHandler::isLazyQuery() const
+        {
+            return _lazyComponents;
+        }
+
+        void RadioHandler::setConfigCacheFile(const std::string& path)
+        {
+            _configCacheFile = path;
+        }
+
+        std::string RadioHandler::getConfigCacheFile() const
+        {
+            return _configCacheFile;
+        }
+
+        void RadioHandler::setConfigCacheSpotChecks(int checks)
+        {
+            _configCacheSpotChecks = ( checks < 0 ) ? 0 : checks;
+        }
+
+        int RadioHandler::getConfigCacheSpotChecks() const
+        {
+            return _configCacheSpotChecks;
+        }
+
+        bool RadioHandler::isConfigFromCache() const
+        {
+            return _configFromCache;
+        }
+
+        bool RadioHandler::beginTransaction()
+        {
+            this->debug("[RadioHandler::beginTransaction] Called\n");
+            if ( _transactionOpen )
+                return false;
+            _transactionOpen = true;
+            _transactionCmds.clear();
+            _transactionIds.clear();
+            _transactionError = "";
+            _transactionUndo.clear();
+            return true;
+        }
+
+        bool RadioHandler::commitTransaction()
+        {
+            this->debug("[RadioHandler::commitTransaction] Called; %lu commands\n",
+                    _transactionCmds.size());
+            if ( !_transactionOpen )
+                return false;
+            bool ret = false;
+            if ( !_transactionError.empty() )
+            {
+                // Nothing was sent, so only the cached state needs restoring
+                this->restoreTransactionState();
+                _lastCmdErrorInfo = _transactionError;
+            }
+            else
+            {
+                BasicStringList cmds = _transactionCmds;
+                std::vector<int64_t> ids = _transactionIds;
+                ret = this->sendCommandSequence(cmds, ids);
+                if ( !ret )
+                {
+                    std::string error = _lastCmdErrorInfo;
+                    this->debug("[RadioHandler::commitTransaction] Rolling back: %s\n",
+                            error.c_str());
+                    _transactionCmds.clear();
+                    _transactionIds.clear();
+                    this->restoreTransactionState();
+                    BasicStringList rollbackCmds = _transactionCmds;
+                    std::vector<int64_t> rollbackIds = _transactionIds;
+                    if ( !this->sendCommandSequence(rollbackCmds, rollbackIds) )
+                    {
+                        // The components' hardware state is unknown now
+                        error += " (rollback failed: " + _lastCmdErrorInfo + ")";
+                        for (std::vector<std::pair<Configurable*, ConfigurationDict> >::iterator it =
+                                _transactionUndo.begin(); it != _transactionUndo.end(); it++)
+                            it->first->invalidate();
+                    }
+                    _lastCmdErrorInfo = error;
+                }
+            }
+            _transactionOpen = false;
+            _transactionCmds.clear();
+            _transactionIds.clear();
+            _transactionError = "";
+            _transactionUndo.clear();
+            this->debug("[RadioHandler::commitTransaction] Returning %s\n", debugBool(ret));
+            return ret;
+        }
+
+        void RadioHandler::abortTransaction()
+        {
+            this->debug("[RadioHandler::abortTransaction] Called\n");
+            if ( _transactionOpen )
+                this->restoreTransactionState();
+            _transactionOpen = false;
+            _transactionCmds.clear();
+            _transactionIds.clear();
+            _transactionError = "";
+            _transactionUndo.clear();
+        }
+
+        bool RadioHandler::isTransactionOpen() const
+        {
+            return _transactionOpen;
+        }
+
+        AsyncCommandFuture RadioHandler::sendCommandAsync(const std::string& cmdString,
+                double timeout, int64_t msgId)
+        {
+            AsyncRequest request;
+            request.cmdString = cmdString;
+            request.msgId = msgId;
+            request.timeout = timeout;
+            request.result.reset(new boost::promise<AsyncCommandResult>());
+            AsyncCommandFuture ret(request.result->get_future());
+            bool stopping = false;
+            {
+                boost::mutex::scoped_lock lock(_asyncMutex);
+                stopping = _asyncStop;
+                if ( !stopping )
+                {
+                    this->startAsync();
+                    _asyncRequests.push_back(request);
+                    _asyncIoCond.notify_one();
+                }
+            }
+            if ( stopping )
+            {
+                AsyncCommandResult result;
+                result.errorInfo = "Disconnected";
+                request.result->set_value(result);
+            }
+            return ret;
+        }
+
+        void RadioHandler::sendCommandAsync(const std::string& cmdString,
+                const AsyncCommandCallback& callback, double timeout, int64_t msgId)
+        {
+            AsyncRequest request;
+            request.cmdString = cmdString;
+            request.msgId = msgId;
+            request.timeout = timeout;
+            request.callback = callback;
+            bool stopping = false;
+            {
+                boost::mutex::scoped_lock lock(_asyncMutex);
+                stopping = _asyncStop;
+                if ( !stopping )
+                {
+                    this->startAsync();
+                    _asyncRequests.push_back(request);
+                    _asyncIoCond.notify_one();
+                }
+            }
+            if ( stopping && callback )
+            {
+                AsyncCommandResult result;
+                result.errorInfo = "Disconnected";
+                callback(result);
+            }
+        }
+
+        void RadioHandler::setAsyncWorkers(int workers)
+        {
+            boost::mutex::scoped_lock lock(_asyncMutex);
+            _asyncWorkerCount = std::max(1, workers);
+        }
+
+        int RadioHandler::getAsyncWorkers() const
+        {
+            return _asyncWorkerCount;
+        }
+
+        AsyncSetterFuture RadioHandler::runAsync(const boost::function<bool ()>& setter,
+                const std::string& component)
+        {
+            boost::shared_ptr<boost::promise<bool> > result(new boost::promise<bool>());
+            AsyncSetterFuture ret(result->get_future());
+            bool stopping = false;
+            {
+                boost::mutex::scoped_lock lock(_asyncMutex);
+                stopping = _asyncStop;
+                if ( !stopping )
+                {
+                    this->startAsync();
+                    AsyncTask task;
+                    task.component = component;
+                    task.setter = setter;
+                    task.result = result;
+                    _asyncTasks.push_back(task);
+                    _asyncTaskCond.notify_one();
+                }
+            }
+            if ( stopping )
+                result->set_value(false);
+            return ret;
+        }
+
+        AsyncSetterFuture RadioHandler::setTunerFrequencyAsync(int index, double freq)
+        {
+            return this->runAsync(boost::bind(&RadioHandler::setTunerFrequency, this, index, freq),
+                    this->asyncComponent("tuner", index));
+        }
+
+        AsyncSetterFuture RadioHandler::setTunerAttenuationAsync(int index, double atten)
+        {
+            return this->runAsync(boost::bind(&RadioHandler::setTunerAttenuation, this, index, atten),
+                    this->asyncComponent("tuner", index));
+        }
+
+        AsyncSetterFuture RadioHandler::setTunerConfigurationAsync(int index,
+                const ConfigurationDict& cfg)
+        {
+            return this->runAsync(boost::bind(&RadioHandler::applyConfigurationCopy, this,
+                    &RadioHandler::setTunerConfiguration, index, cfg),
+                    this->asyncComponent("tuner", index));
+        }
+
+        AsyncSetterFuture RadioHandler::setWbddcFrequencyAsync(int index, double freq)
+        {
+            return this->runAsync(boost::bind(&RadioHandler::setWbddcFrequency, this, index, freq),
+                    this->asyncComponent("wbddc", index));
+        }
+
+        AsyncSetterFuture RadioHandler::setWbddcRateIndexAsync(int index, int rateIndex)
+        {
+            return this->runAsync(boost::bind(&RadioHandler::setWbddcRateIndex, this, index, rateIndex),
+                    this->asyncComponent("wbddc", index));
+        }
+
+        AsyncSetterFuture RadioHandler::setWbddcConfigurationAsync(int index,
+                const ConfigurationDict& cfg)
+        {
+            return this->runAsync(boost::bind(&RadioHandler::applyConfigurationCopy, this,
+                    &RadioHandler::setWbddcConfiguration, index, cfg),
+                    this->asyncComponent("wbddc", index));
+        }
+
+        AsyncSetterFuture RadioHandler::setNbddcFrequencyAsync(int index, double freq)
+        {
+            return this->runAsync(boost::bind(&RadioHandler::setNbddcFrequency, this, index, freq),
+                    this->asyncComponent("nbddc", index));
+        }
+
+        AsyncSetterFuture RadioHandler::setNbddcRateIndexAsync(int index, int rateIndex)
+        {
+            return this->runAsync(boost::bind(&RadioHandler::setNbddcRateIndex, this, index, rateIndex),
+                    this->asyncComponent("nbddc", index));
+        }
+
+        AsyncSetterFuture RadioHandler::setNbddcConfigurationAsync(int index,
+                const ConfigurationDict& cfg)
+        {
+            return this->runAsync(boost::bind(&RadioHandler::applyConfigurationCopy, this,
+                    &RadioHandler::setNbddcConfiguration, index, cfg),
+                    this->asyncComponent("nbddc", index));
+        }
+
+        AsyncSetterFuture RadioHandler::setTransmitterFrequencyAsync(int index, double freq)
+        {
+            return this->runAsync(boost::bind(&RadioHandler::setTransmitterFrequency, this, index, freq),
+                    this->asyncComponent("transmitter", index));
+        }
+
+        AsyncSetterFuture RadioHandler::setTransmitterAttenuationAsync(int index, double atten)
+        {
+            return this->runAsync(boost::bind(&RadioHandler::setTransmitterAttenuation, this, index, atten),
+                    this->asyncComponent("transmitter", index));
+        }
+
+        AsyncSetterFuture RadioHandler::setDucFrequencyAsync(int index, double freq)
+        {
+            return this->runAsync(boost::bind(&RadioHandler::setDucFrequency, this, index, freq),
+                    this->asyncComponent("duc", index));
+        }
+
+        AsyncSetterFuture RadioHandler::setDucAttenuationAsync(int index, double atten)
+        {
+            return this->runAsync(boost::bind(&RadioHandler::setDucAttenuation, this, index, atten),
+                    this->asyncComponent("duc", index));
+        }
+
+        AsyncSetterFuture RadioHandler::setDucConfigurationAsync(int index,
+                const ConfigurationDict& cfg)
+        {
+            return this->runAsync(boost::bind(&RadioHandler::applyConfigurationCopy, this,
+                    &RadioHandler::setDucConfiguration, index, cfg),
+                    this->asyncComponent("duc", index));
+        }
+
+        AsyncSetterFuture RadioHandler::setDataPortConfigurationAsync(int index,
+                const ConfigurationDict& cfg)
+        {
+            return this->runAsync(boost::bind(&RadioHandler::applyConfigurationCopy, this,
+                    &RadioHandler::setDataPortConfiguration, index, cfg),
+                    this->asyncComponent("dataport", index));
+        }
+
+        std::string RadioHandler::asyncComponent(const char* type, int index) const
+        {
+            return ( boost::format("%s%d") % type % index ).str();
+        }
+
+        void RadioHandler::startAsync()
+        {
+            if ( _asyncIoThread == NULL )
+            {
+                this->debug("[RadioHandler::startAsync] Starting I/O thread\n");
+                _asyncIoThread = new boost::thread(boost::bind(&RadioHandler::asyncIoLoop, this));
+            }
+            if ( _asyncWorkers == NULL )
+            {
+                this->debug("[RadioHandler::startAsync] Starting %d setter threads\n",
+                        _asyncWorkerCount);
+                _asyncWorkers = new boost::thread_group();
+                for (int i = 0; i < _asyncWorkerCount; i++)
+                    _asyncWorkers->create_thread(boost::bind(&RadioHandler::asyncWorkerLoop, this));
+            }
+        }
+
+        void RadioHandler::stopAsync()
+        {
+            boost::thread* ioThread = NULL;
+            boost::thread_group* workers = NULL;
+            {
+                boost::mutex::scoped_lock lock(_asyncMutex);
+                if ( (_asyncIoThread == NULL) && (_asyncWorkers == NULL) )
+                    return;
+                this->debug("[RadioHandler::stopAsync] Stopping\n");
+                _asyncStop = true;
+                ioThread = _asyncIoThread;
+                workers = _asyncWorkers;
+            }
+            _asyncIoCond.notify_all();
+            _asyncTaskCond.notify_all();
+            // Stop the I/O thread first, then fail what it left queued, so that
+            // setters waiting on those commands can finish
+            if ( ioThread != NULL )
+            {
+                ioThread->join();
+                delete ioThread;
+            }
+            this->failAsyncRequests("Disconnected");
+            if ( workers != NULL )
+            {
+                workers->join_all();
+                delete workers;
+            }
+            boost::mutex::scoped_lock lock(_asyncMutex);
+            for (std::deque<AsyncTask>::iterator it = _asyncTasks.begin();
+                    it != _asyncTasks.end(); it++)
+                it->result->set_value(false);
+            _asyncTasks.clear();
+            _asyncBusyComponents.clear();
+            _asyncIoThread = NULL;
+            _asyncWorkers = NULL;
+            _asyncStop = false;
+        }
+
+        void RadioHandler::failAsyncRequests(const std::string& error)
+        {
+            std::deque<AsyncRequest> requests;
+            {
+                boost::mutex::scoped_lock lock(_asyncMutex);
+                requests.swap(_asyncRequests);
+            }
+            AsyncCommandResult result;
+            result.errorInfo = error;
+            for (std::deque<AsyncRequest>::iterator it = requests.begin(); it != requests.end(); it++)
+            {
+                if ( it->result )
+                    it->result->set_value(result);
+                if ( it->callback )
+                    it->callback(result);
+            }
+        }
+
+        void RadioHandler::asyncIoLoop()
+        {
+            this->debug("[RadioHandler::asyncIoLoop] Called\n");
+            while ( true )
+            {
+                std::vector<AsyncRequest> batch;
+                {
+                    boost::mutex::scoped_lock lock(_asyncMutex);
+                    while ( !_asyncStop && _asyncRequests.empty() )
+                        _asyncIoCond.wait(lock);
+                    if ( _asyncStop )
+                        break;
+                    // Everything queued so far goes out in one pipelined batch
+                    size_t maxBatch = 1;
+                    if ( _transport.supportsCommandBatch() && (_cmdBatchSize > 1) )
+                        maxBatch = _cmdBatchSize;
+                    while ( !_asyncRequests.empty() && (batch.size() < maxBatch) )
+                    {
+                        batch.push_back(_asyncRequests.front());
+                        _asyncRequests.pop_front();
+                    }
+                }
+                BasicStringList cmds;
+                std::vector<int64_t> ids;
+                double timeout = 0.0;
+                for (std::vector<AsyncRequest>::iterator it = batch.begin(); it != batch.end(); it++)
+                {
+                    cmds.push_back(it->cmdString);
+                    ids.push_back(it->msgId);
+                    // A negative timeout asks for the default
+                    timeout = std::max(timeout, ( it->timeout < 0 ) ? _defaultTimeout : it->timeout);
+                }
+                std::vector<BasicStringList> rsps;
+                std::string transportError;
+                {
+                    boost::mutex::scoped_lock lock(_transportMutex);
+                    rsps = _transport.sendCommandBatch(cmds, timeout, ids);
+                    transportError = _transport.getLastCommandErrorInfo();
+                }
+                for (size_t i = 0; i < batch.size(); i++)
+                {
+                    AsyncCommandResult result;
+                    if ( i < rsps.size() )
+                        result.response = rsps[i];
+                    result.errorInfo = this->processCommandResponse(batch[i].cmdString,
+                            result.response);
+                    if ( result.errorInfo.empty() && result.response.empty() )
+                        result.errorInfo = transportError;
+                    if ( result.errorInfo.empty() )
+                        this->dropConfigCacheOnSet(batch[i].cmdString);
+                    if ( batch[i].result )
+                        batch[i].result->set_value(result);
+                    if ( batch[i].callback )
+                        batch[i].callback(result);
+                }
+                this->debug("[RadioHandler::asyncIoLoop] Completed %lu commands\n", batch.size());
+            }
+            this->debug("[RadioHandler::asyncIoLoop] Returning\n");
+        }
+
+        void RadioHandler::asyncWorkerLoop()
+        {
+            QuerySession* session = new QuerySession();
+            session->transport = &_transport;
+            session->queued = true;
+            _querySession.reset(session);
+            while ( true )
+            {
+                AsyncTask task;
+                {
+                    boost::mutex::scoped_lock lock(_asyncMutex);
+                    // Take the oldest setter whose component is not being set
+                    // by another thread, so that setters for one component run
+                    // one at a time and in the order they were queued
+                    std::deque<AsyncTask>::iterator it = _asyncTasks.end();
+                    while ( !_asyncStop )
+                    {
+                        for (it = _asyncTasks.begin(); it != _asyncTasks.end(); it++)
+                        {
+                            if ( it->component.empty() ||
+                                 (_asyncBusyComponents.count(it->component) == 0) )
+                                break;
+                        }
+                        if ( it != _asyncTasks.end() )
+                            break;
+                        _asyncTaskCond.wait(lock);
+                    }
+                    if ( _asyncStop )
+                        break;
+                    task = *it;
+                    _asyncTasks.erase(it);
+                    if ( !task.component.empty() )
+                        _asyncBusyComponents.insert(task.component);
+                }
+                this->runAsyncSetter(task.setter, task.result);
+                if ( !task.component.empty() )
+                {
+                    {
+                        boost::mutex::scoped_lock lock(_asyncMutex);
+                        _asyncBusyComponents.erase(task.component);
+                    }
+                    _asyncTaskCond.notify_all();
+                }
+            }
+            _querySession.reset();
+        }
+
+        void RadioHandler::runAsyncSetter(const boost::function<bool ()>& setter,
+                boost::shared_ptr<boost::promise<bool> > result)
+        {
+            bool ret = false;
+            try
+            {
+                ret = setter();
+            }
+            catch (std::exception& ex)
+            {
+                this->debug("[RadioHandler::runAsyncSetter] Exception: %s\n", ex.what());
+            }
+            result->set_value(ret);
+        }
+
+        bool RadioHandler::applyConfigurationCopy(
+                bool (RadioHandler::*setter)(int, ConfigurationDict&),
+                int index, ConfigurationDict cfg)
+        {
+            return (this->*setter)(index, cfg);
+        }
+
+        bool RadioHandler::applyComponentConfiguration(Configurable* component,
+                ConfigurationDict& cfg)
+        {
+            if ( !_transactionOpen )
+                return ( component != NULL ) && component->setConfiguration(cfg);
+            // Once a change has failed, the transaction will not be sent
+            if ( !_transactionError.empty() )
+                return false;
+            if ( component == NULL )
+            {
+                _transactionError = "No such component";
+                _lastCmdErrorInfo = _transactionError;
+                return false;
+            }
+            _transactionError = component->validateConfiguration(cfg);
+            if ( !_transactionError.empty() )
+            {
+                this->debug("[RadioHandler::applyComponentConfiguration] Invalid: %s\n",
+                        _transactionError.c_str());
+                _lastCmdErrorInfo = _transactionError;
+                return false;
+            }
+            // Save the previous value of each setting the first time the
+            // transaction changes it.  This also brings the component's state
+            // up to date before staging starts, so no queries get staged.
+            ConfigurationDict current = component->getConfiguration();
+            std::vector<std::pair<Configurable*, ConfigurationDict> >::iterator uit;
+            for (uit = _transactionUndo.begin(); uit != _transactionUndo.end(); uit++)
+            {
+                if ( uit->first == component )
+                    break;
+            }
+            if ( uit == _transactionUndo.end() )
+            {
+                _transactionUndo.push_back(std::make_pair(component, ConfigurationDict()));
+                uit = _transactionUndo.end() - 1;
+            }
+            for (ConfigurationDict::iterator it = cfg.begin(); it != cfg.end(); it++)
+            {
+                ConfigurationDict::iterator cit = current.find(it->first);
+                if ( (cit != current.end()) && !cit->second.empty() && !uit->second.hasKey(it->first) )
+                    uit->second[it->first] = cit->second;
+            }
+            _transactionStaging = true;
+            bool ret = component->setConfiguration(cfg);
+            _transactionStaging = false;
+            if ( !ret )
+            {
+                _transactionError = "Could not stage configuration for " + component->getName();
+                _lastCmdErrorInfo = _transactionError;
+            }
+            return ret;
+        }
+
+        void RadioHandler::restoreTransactionState()
+        {
+            std::vector<std::pair<Configurable*, ConfigurationDict> >::reverse_iterator it;
+            for (it = _transactionUndo.rbegin(); it != _transactionUndo.rend(); it++)
+            {
+                // Bring the state up to date first, so any query is sent
+                it->first->getConfiguration();
+                _transactionStaging = true;
+                it->first->setConfiguration(it->second);
+                _transactionStaging = false;
+            }
+        }
+
+        bool RadioHandler::sendCommandSequence(const BasicStringList& cmds,
+                const std::vector<int64_t>& msgIds)
+        {
+            bool ret = true;
+            _lastCmdErrorInfo = "";
+            size_t batchSize = 1;
+            if ( _transport.supportsCommandBatch() && (_cmdBatchSize > 1) )
+                batchSize = _cmdBatchSize;
+            for (size_t start = 0; ret && (start < cmds.size()); start += batchSize)
+            {
+                size_t stop = std::min(cmds.size(), start + batchSize);
+                BasicStringList batch(cmds.begin() + start, cmds.begin() + stop);
+                std::vector<int64_t> batchIds(msgIds.begin() + start, msgIds.begin() + stop);
+                std::vector<BasicStringList> rsps;
+                if ( batchSize > 1 )
+                    rsps = this->sendCommands(batch, _defaultTimeout, batchIds);
+                else
+                    rsps.push_back(this->sendCommand(batch.front(), _defaultTimeout,
+                            batchIds.front()));
+                ret = _lastCmdErrorInfo.empty();
+                // JSON radios report failure in the response body
+                for (size_t i = 0; ret && _transport.isJson() && (i < batch.size()); i++)
+                {
+                    Json::Reader reader;
+                    Json::Value root;
+                    if ( (i >= rsps.size()) || rsps[i].empty() ||
+                         !reader.parse(rsps[i].front(), root) ||
+                         !root.get("success", false).asBool() )
+                    {
+                        _lastCmdErrorInfo = "Command failed: " + Pythonesque::Strip(batch[i]);
+                        ret = false;
+                    }
+                }
+            }
+            return ret;
+        }
+
         // Default implementation is the NDR308 pattern
         void RadioHandler::initConfigurationDict()
         {
@@ -3416,7 +4698,12 @@ namespace LibCyberRadio
 
         uint32_t RadioHandler::getMessageId( void )
         {
-            return 0;
+            // One counter for every handler in the process, so no two
+            // outstanding commands share an ID.  Seeding it from the clock
+            // keeps a restarted client from reusing IDs that late responses
+            // to its previous run may still carry.
+            static boost::atomic<uint32_t> nextId((uint32_t)std::time(NULL) * 1000u);
+            return nextId++;
         }
 
     } /* namespace Driver */
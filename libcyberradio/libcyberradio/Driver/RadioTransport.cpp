@@ -11,16 +11,26 @@
  ***************************************************************************/
 
 #include "LibCyberRadio/Driver/RadioTransport.h"
+#include "LibCyberRadio/Driver/JsonCodec.h"
 #include "LibCyberRadio/Common/Pythonesque.h"
 #include "json/json.h"
+#include <algorithm>
 #include <sstream>
 #include <cstdio>
 #include <sys/socket.h>
 #include <arpa/inet.h>
 #include <netdb.h>
 #include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
 #include <string.h>
 #include <sys/select.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+
+// Time to wait for each owed response when recovering from a TCP batch
+// that had no timeout of its own
+#define CLI_TCP_RECOVER_TIMEOUT 1.0
 
 
 namespace LibCyberRadio
@@ -41,7 +51,13 @@ namespace LibCyberRadio
             _httpsSession(NULL),
             _httpsConnTestUrl(""),
             _httpsApiCmdUrl(""),
-            _lastCmdErrInfo("")
+            _lastCmdErrInfo(""),
+            _jsonUdpRetries(1),
+            _jsonUdpWindow(16),
+            _jsonUdpLastCmd(""),
+            _jsonUdpLastHasId(false),
+            _jsonUdpLastId(0),
+            _connectTimeout(5.0)
         {
             this->debug("CONSTRUCTED\n");
         }
@@ -67,13 +83,20 @@ namespace LibCyberRadio
              Debuggable(other)
         {
             _isJson = other._isJson;
-            _tcpSocket = other._tcpSocket;
-            _udpSocket = other._udpSocket;
-            _serial = other._serial;
-            _httpsSession = other._httpsSession;
+            // The connection stays with the original, which closes it
+            _tcpSocket = 0;
+            _udpSocket = 0;
+            _serial = NULL;
+            _httpsSession = NULL;
             _httpsConnTestUrl = other._httpsConnTestUrl;
             _httpsApiCmdUrl = other._httpsApiCmdUrl;
             _lastCmdErrInfo = other._lastCmdErrInfo;
+            _jsonUdpRetries = other._jsonUdpRetries;
+            _jsonUdpWindow = other._jsonUdpWindow;
+            _jsonUdpLastCmd = other._jsonUdpLastCmd;
+            _jsonUdpLastHasId = other._jsonUdpLastHasId;
+            _jsonUdpLastId = other._jsonUdpLastId;
+            _connectTimeout = other._connectTimeout;
         }
 
         RadioTransport &RadioTransport::operator=(const RadioTransport &other)
@@ -82,14 +105,19 @@ namespace LibCyberRadio
             // Protect against self-assignment
             if (this != &other)
             {
+                // The connection stays with the original, which closes it
+                if ( isConnected() )
+                    disconnect();
                 _isJson = other._isJson;
-                _tcpSocket = other._tcpSocket;
-                _udpSocket = other._udpSocket;
-                _serial = other._serial;
-                _httpsSession = other._httpsSession;
                 _httpsConnTestUrl = other._httpsConnTestUrl;
                 _httpsApiCmdUrl = other._httpsApiCmdUrl;
                 _lastCmdErrInfo = other._lastCmdErrInfo;
+                _jsonUdpRetries = other._jsonUdpRetries;
+                _jsonUdpWindow = other._jsonUdpWindow;
+                _jsonUdpLastCmd = other._jsonUdpLastCmd;
+                _jsonUdpLastHasId = other._jsonUdpLastHasId;
+                _jsonUdpLastId = other._jsonUdpLastId;
+                _connectTimeout = other._connectTimeout;
             }
             return *this;
         }
@@ -100,6 +128,11 @@ namespace LibCyberRadio
             _isJson = json;
         }
 
+        bool RadioTransport::isJson() const
+        {
+            return _isJson;
+        }
+
 
         bool RadioTransport::connect(
                 const std::string &mode,
@@ -142,12 +175,16 @@ namespace LibCyberRadio
                 int ok = shutdown(_udpSocket, SHUT_RDWR);
                 if (ok != 0)
                     translateErrno();
+                close(_udpSocket);
+                _udpSocket = 0;
             }
             else if (_tcpSocket > 0)
             {
                 int ok = shutdown(_tcpSocket, SHUT_RDWR);
                 if (ok != 0)
                     translateErrno();
+                close(_tcpSocket);
+                _tcpSocket = 0;
             }
             else if (_serial != NULL)
             {
@@ -171,7 +208,8 @@ namespace LibCyberRadio
 
         bool RadioTransport::sendCommand(
                 const std::string &cmdString,
-                bool clearRx
+                bool clearRx,
+                int64_t msgId
             )
         {
             this->debug("[sendCommand] Called; cmd=\"%s\"\n",
@@ -187,7 +225,7 @@ namespace LibCyberRadio
             }
             else if (_udpSocket > 0)
             {
-                ret = sendCommandUdp(cmdString, clearRx);
+                ret = sendCommandUdp(cmdString, clearRx, msgId);
             }
             else if (_tcpSocket > 0)
             {
@@ -218,6 +256,76 @@ namespace LibCyberRadio
             return ret;
         }
 
+        std::vector<BasicStringList> RadioTransport::sendCommandBatch(
+                const BasicStringList& cmds,
+                double timeout,
+                const std::vector<int64_t>& msgIds
+            )
+        {
+            this->debug("[sendCommandBatch] Called; %u commands\n", cmds.size());
+            std::vector<BasicStringList> ret;
+            if ( supportsCommandBatch() )
+            {
+                if ( _isJson )
+                    ret = sendCommandBatchJsonUdp(cmds, msgIds, timeout);
+                else
+                    ret = sendCommandBatchTcp(cmds, timeout);
+            }
+            else
+            {
+                for (size_t i = 0; i < cmds.size(); i++)
+                {
+                    if ( sendCommand(cmds[i], true, ( i < msgIds.size() ) ? msgIds[i] : -1) )
+                        ret.push_back(receive(timeout));
+                    else
+                        ret.push_back(BasicStringList());
+                }
+            }
+            this->debug("[sendCommandBatch] Returning\n");
+            return ret;
+        }
+
+        bool RadioTransport::supportsCommandBatch() const
+        {
+            // CLI responses over TCP are split on the prompt; JSON responses
+            // over UDP are matched by message ID.  HTTPS is request/response.
+            if ( _httpsSession != NULL )
+                return false;
+            if ( _isJson )
+                return (_udpSocket > 0);
+            return ( (_udpSocket <= 0) && (_tcpSocket > 0) );
+        }
+
+        void RadioTransport::setJsonUdpRetries(int retries)
+        {
+            _jsonUdpRetries = std::max(retries, 0);
+        }
+
+        int RadioTransport::getJsonUdpRetries() const
+        {
+            return _jsonUdpRetries;
+        }
+
+        void RadioTransport::setJsonUdpWindow(int window)
+        {
+            _jsonUdpWindow = std::max(window, 1);
+        }
+
+        int RadioTransport::getJsonUdpWindow() const
+        {
+            return _jsonUdpWindow;
+        }
+
+        void RadioTransport::setConnectTimeout(double timeout)
+        {
+            _connectTimeout = timeout;
+        }
+
+        double RadioTransport::getConnectTimeout() const
+        {
+            return _connectTimeout;
+        }
+
         std::string RadioTransport::getLastCommandErrorInfo() const
         {
             return _lastCmdErrInfo;
@@ -229,25 +337,50 @@ namespace LibCyberRadio
             )
         {
             this->debug("[connectTcp] Called; host=\"%s\", port=%d\n", host.c_str(), port);
+            struct sockaddr_in addr;
+            if ( !resolveHost(host, port, addr) )
+                return false;
             _tcpSocket = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
             this->debug("[connectTcp] Socket created; FD=%d\n", _tcpSocket);
             if (_tcpSocket > 0)
             {
-                struct hostent *hent = gethostbyname(host.c_str());
-                char buf[128];
-                memset(buf, 0, sizeof(buf));
-                inet_ntop(AF_INET, hent->h_addr_list[0], buf, sizeof(buf));
-                this->debug("[connectTcp] Host IP address: %s\n", buf);
-                struct sockaddr_in addr;
-                memset(&addr, 0, sizeof(struct sockaddr_in));
-                addr.sin_family = AF_INET;
-                memcpy(&(addr.sin_addr.s_addr), hent->h_addr_list[0], hent->h_length);
-                addr.sin_port = htons(port);
+                // Connect without blocking, then wait for the handshake to
+                // finish, so an unreachable radio fails at the deadline
+                int flags = fcntl(_tcpSocket, F_GETFL, 0);
+                if ( _connectTimeout >= 0 )
+                    fcntl(_tcpSocket, F_SETFL, flags | O_NONBLOCK);
                 this->debug("[connectTcp] Connecting\n");
                 int ok = ::connect(_tcpSocket, (const sockaddr*)&addr, sizeof(struct sockaddr_in));
+                if ( (ok != 0) && (errno == EINPROGRESS) )
+                {
+                    fd_set outs;
+                    FD_ZERO(&outs);
+                    FD_SET(_tcpSocket, &outs);
+                    struct timeval tv;
+                    tv.tv_sec = (long)_connectTimeout;
+                    tv.tv_usec = (long)(1000000 * (_connectTimeout - (long)_connectTimeout));
+                    int nfds = select(_tcpSocket + 1, NULL, &outs, NULL, &tv);
+                    if (nfds > 0)
+                    {
+                        int err = 0;
+                        socklen_t len = sizeof(err);
+                        getsockopt(_tcpSocket, SOL_SOCKET, SO_ERROR, &err, &len);
+                        ok = ( err == 0 ) ? 0 : -1;
+                        errno = err;
+                    }
+                    else if (nfds == 0)
+                        errno = ETIMEDOUT;
+                }
                 this->debug("[connectTcp] -- ok = %d\n", ok);
-                if (ok != 0)
+                if (ok == 0)
+                    fcntl(_tcpSocket, F_SETFL, flags);
+                else
+                {
+                    int err = errno;
+                    close(_tcpSocket);
+                    errno = err;
                     _tcpSocket = 0;
+                }
             }
             if (_tcpSocket <= 0)
             {
@@ -264,26 +397,23 @@ namespace LibCyberRadio
             )
         {
             this->debug("[connectUdp] Called; host=\"%s\", port=%d\n", host.c_str(), port);
-            
+            struct sockaddr_in addr;
+            if ( !resolveHost(host, port, addr) )
+                return false;
             _udpSocket = socket(AF_INET, SOCK_DGRAM, 0);
             this->debug("[connectUdp] Socket created; FD=%d\n", _udpSocket);
             if (_udpSocket > 0)
             {
-                struct hostent *hent = gethostbyname(host.c_str());
-                char buf[128];
-                memset(buf, 0, sizeof(buf));
-                inet_ntop(AF_INET, hent->h_addr_list[0], buf, sizeof(buf));
-                this->debug("[connectUdp] Host IP address: %s\n", buf);
-                struct sockaddr_in addr;
-                memset(&addr, 0, sizeof(struct sockaddr_in));
-                addr.sin_family = AF_INET;
-                memcpy(&(addr.sin_addr.s_addr), hent->h_addr_list[0], hent->h_length);
-                addr.sin_port = htons(port);
                 this->debug("[connectUdp] Connecting\n");
                 int ok = ::connect(_udpSocket, (const sockaddr*)&addr, sizeof(struct sockaddr_in));
                 this->debug("[connectUdp] -- ok = %d\n", ok);
                 if (ok != 0)
+                {
+                    int err = errno;
+                    close(_udpSocket);
+                    errno = err;
                     _udpSocket = 0;
+                }
             }
             if (_udpSocket <= 0)
             {
@@ -294,6 +424,35 @@ namespace LibCyberRadio
             return ret;
         }
 
+        bool RadioTransport::resolveHost(
+                const std::string& host,
+                int port,
+                struct sockaddr_in& addr
+            )
+        {
+            // getaddrinfo() is reentrant, unlike gethostbyname(), so several
+            // transports can connect at once from different threads
+            struct addrinfo hints;
+            memset(&hints, 0, sizeof(hints));
+            hints.ai_family = AF_INET;
+            struct addrinfo* res = NULL;
+            int err = getaddrinfo(host.c_str(), NULL, &hints, &res);
+            if ( (err != 0) || (res == NULL) )
+            {
+                _lastCmdErrInfo = gai_strerror(err);
+                this->debug("[resolveHost] Lookup failed: %s\n", _lastCmdErrInfo.c_str());
+                return false;
+            }
+            memcpy(&addr, res->ai_addr, sizeof(struct sockaddr_in));
+            addr.sin_port = htons(port);
+            freeaddrinfo(res);
+            char buf[128];
+            memset(buf, 0, sizeof(buf));
+            inet_ntop(AF_INET, &(addr.sin_addr), buf, sizeof(buf));
+            this->debug("[resolveHost] Host IP address: %s\n", buf);
+            return true;
+        }
+
         bool RadioTransport::connectHttps(
                 const std::string &host,
                 int port
@@ -402,7 +561,8 @@ namespace LibCyberRadio
 
         bool RadioTransport::sendCommandUdp(
                 const std::string& cmdString,
-                bool clearRx
+                bool clearRx,
+                int64_t msgId
             )
         {
            this->debug("[sendCommandUdp] Called; cmd=%s\n",
@@ -413,6 +573,13 @@ namespace LibCyberRadio
             if (bytes > 0)
             {
                 ret = true;
+                // Remember what the next receive is waiting for
+                if ( _isJson )
+                {
+                    _jsonUdpLastCmd = cmdString;
+                    _jsonUdpLastHasId = ( msgId >= 0 );
+                    _jsonUdpLastId = (uint32_t)msgId;
+                }
             }
             else
             {
@@ -507,35 +674,24 @@ namespace LibCyberRadio
         {
             this->debug("[receiveJsonUdp] Called; timeout=%0.1f\n", timeout);
             BasicStringList ret;
-            std::ostringstream oss;
-            fd_set ins;
-            struct timeval tv;
-            tv.tv_sec = (long)timeout;
-            tv.tv_usec = (long)(1000000 * (timeout - (long)timeout));
-
-            char buf[1024];
-            // data available
-            memset(buf, 0, sizeof(buf));
-            recv(_udpSocket, buf, sizeof(buf), 0);
-            this->debug("[receiveJsonUdp] Received chunk: \"%s\"\n", buf);
-            oss << buf;
-            this->debug("[receiveJsonUdp] Received: \"%s\"\n",
-                    this->rawString(oss.str()).c_str());
-            Json::Reader reader;
-            Json::Value root; 
-            std::string t = buf;
-            bool parsingSuccessful = reader.parse( t.c_str(), root );     //parse process
-            if ( !parsingSuccessful )
+            BasicStringList cmds;
+            std::vector<uint32_t> ids;
+            if ( _jsonUdpLastHasId )
             {
-                this->debug("[receiveJsonUdp] Parsing JSON Error\n");
+                cmds.push_back(_jsonUdpLastCmd);
+                ids.push_back(_jsonUdpLastId);
             }
-            Json::FastWriter fastWriter;
-            std::string output = fastWriter.write(root);
-            ret.push_back(output);
+            // Without a message ID to wait for (nothing sent, or the command
+            // carried no "msg"), the next datagram is the response.
+            std::vector<BasicStringList> rsps = exchangeJsonUdp(cmds, ids,
+                    cmds.size(), timeout);
+            _jsonUdpLastHasId = false;
+            if ( !rsps.empty() )
+                ret = rsps.front();
+            this->debug("[receiveJsonUdp] Returning %u elements\n", ret.size());
             return ret;
         }
 
-
         BasicStringList RadioTransport::receiveJsonHttps(
                 double timeout
             )
@@ -618,18 +774,7 @@ namespace LibCyberRadio
             }
             this->debug("[receiveCliTcp] Received: \"%s\"\n",
                     this->rawString(oss.str()).c_str());
-            // Split the response into a list of non-empty strings
-            // -- Remove carriage returns and prompt character
-            std::string tmp = Pythonesque::Replace(Pythonesque::Replace(oss.str(), "\r", ""), ">", "");
-            // -- Split on newlines
-            BasicStringList tmpList = Pythonesque::Split(tmp, "\n");
-            // -- Compile the non-empty strings into a list
-            for (BasicStringList::iterator it = tmpList.begin(); it != tmpList.end(); it++)
-            {
-                tmp = Pythonesque::Rstrip(*it);
-                if ( !tmp.empty() )
-                    ret.push_back(tmp);
-            }
+            ret = splitCliResponse(oss.str());
             this->debug("[receiveCliTcp] Returning %u elements\n", ret.size());
             return ret;
         }
@@ -659,9 +804,355 @@ namespace LibCyberRadio
             }
             this->debug("[receiveCliTty] Received: \"%s\"\n",
                     this->rawString(oss.str()).c_str());
+            ret = splitCliResponse(oss.str());
+            this->debug("[receiveCliTty] Returning %u elements\n", ret.size());
+            return ret;
+        }
+
+        std::vector<BasicStringList> RadioTransport::sendCommandBatchTcp(
+                const BasicStringList& cmds,
+                double timeout
+            )
+        {
+            this->debug("[sendCommandBatchTcp] Called; %u commands\n", cmds.size());
+            std::vector<BasicStringList> ret(cmds.size());
+            // Write the whole batch at once
+            std::string batch;
+            for (BasicStringList::const_iterator it = cmds.begin(); it != cmds.end(); it++)
+                batch += *it;
+            size_t sent = 0;
+            while ( sent < batch.length() )
+            {
+                int bytes = send(_tcpSocket, batch.data() + sent, batch.length() - sent, 0);
+                if (bytes <= 0)
+                {
+                    translateErrno();
+                    return ret;
+                }
+                sent += bytes;
+            }
+            this->debug("[sendCommandBatchTcp] -- Bytes sent: %u\n", sent);
+            // Each response ends with a prompt; hand out the text between
+            // prompts in command order.
+            std::string pending;
+            size_t received = 0;
+            fd_set ins;
+            struct timeval tv;
+            char buf[4096];
+            while ( received < cmds.size() )
+            {
+                FD_ZERO(&ins);
+                FD_SET(_tcpSocket, &ins);
+                // The timeout applies to each response, not the whole batch
+                tv.tv_sec = (long)timeout;
+                tv.tv_usec = (long)(1000000 * (timeout - (long)timeout));
+                int nfds = select(_tcpSocket + 1, &ins, NULL, NULL, timeout < 0 ? NULL : &tv);
+                if (nfds > 0)
+                {
+                    int bytes = recv(_tcpSocket, buf, sizeof(buf), 0);
+                    if (bytes <= 0)
+                    {
+                        translateErrno();
+                        break;
+                    }
+                    pending.append(buf, bytes);
+                    // Acknowledge at once.  A radio that writes each response
+                    // separately would otherwise hold the next one back until
+                    // our delayed ACK fires, costing ~40 ms per batch.
+                    int quickAck = 1;
+                    setsockopt(_tcpSocket, IPPROTO_TCP, TCP_QUICKACK, &quickAck, sizeof(quickAck));
+                    size_t pos;
+                    while ( (received < cmds.size()) &&
+                            ((pos = pending.find('>')) != std::string::npos) )
+                    {
+                        ret[received++] = splitCliResponse(pending.substr(0, pos));
+                        pending.erase(0, pos + 1);
+                    }
+                }
+                else if (nfds == 0)
+                {
+                    this->debug("[sendCommandBatchTcp] Timeout after %u responses\n", received);
+                    _lastCmdErrInfo = "Timeout";
+                    break;
+                }
+                else
+                {
+                    translateErrno();
+                    this->debug("[sendCommandBatchTcp] Socket select error: %s\n", _lastCmdErrInfo.c_str());
+                    break;
+                }
+            }
+            if ( received < cmds.size() )
+                recoverCliTcp(cmds.size() - received, timeout);
+            this->debug("[sendCommandBatchTcp] Returning %u responses\n", received);
+            return ret;
+        }
+
+        bool RadioTransport::recoverCliTcp(
+                size_t outstanding,
+                double timeout
+            )
+        {
+            this->debug("[recoverCliTcp] Called; %u responses outstanding\n", outstanding);
+            double wait = ( timeout > 0 ) ? timeout : CLI_TCP_RECOVER_TIMEOUT;
+            fd_set ins;
+            struct timeval tv;
+            char buf[4096];
+            while ( (outstanding > 0) && (_tcpSocket > 0) )
+            {
+                FD_ZERO(&ins);
+                FD_SET(_tcpSocket, &ins);
+                tv.tv_sec = (long)wait;
+                tv.tv_usec = (long)(1000000 * (wait - (long)wait));
+                if ( select(_tcpSocket + 1, &ins, NULL, NULL, &tv) <= 0 )
+                    break;
+                int bytes = recv(_tcpSocket, buf, sizeof(buf), 0);
+                if (bytes <= 0)
+                    break;
+                size_t prompts = std::count(buf, buf + bytes, '>');
+                outstanding -= std::min(outstanding, prompts);
+            }
+            bool ret = ( outstanding == 0 );
+            if ( !ret )
+            {
+                this->debug("[recoverCliTcp] %u responses never arrived; reconnecting\n", outstanding);
+                ret = reconnectTcp();
+                // Purge the banner sent over when a connection is made.
+                if ( ret )
+                    receiveCliTcp(wait);
+            }
+            this->debug("[recoverCliTcp] Returning %s\n", this->debugBool(ret));
+            return ret;
+        }
+
+        bool RadioTransport::reconnectTcp()
+        {
+            this->debug("[reconnectTcp] Called\n");
+            bool ret = false;
+            struct sockaddr_in addr;
+            socklen_t len = sizeof(addr);
+            if ( (_tcpSocket > 0) &&
+                 (getpeername(_tcpSocket, (struct sockaddr*)&addr, &len) == 0) )
+            {
+                char host[INET_ADDRSTRLEN];
+                inet_ntop(AF_INET, &addr.sin_addr, host, sizeof(host));
+                disconnect();
+                ret = connectTcp(host, ntohs(addr.sin_port));
+            }
+            else
+            {
+                translateErrno();
+                disconnect();
+            }
+            this->debug("[reconnectTcp] Returning %s\n", this->debugBool(ret));
+            return ret;
+        }
+
+        std::vector<BasicStringList> RadioTransport::sendCommandBatchJsonUdp(
+                const BasicStringList& cmds,
+                const std::vector<int64_t>& msgIds,
+                double timeout
+            )
+        {
+            this->debug("[sendCommandBatchJsonUdp] Called; %u commands\n", cmds.size());
+            std::vector<BasicStringList> ret;
+            // Correlation needs a distinct message ID on every command
+            std::vector<uint32_t> ids;
+            std::map<uint32_t, size_t> seen;
+            for (size_t i = 0; (i < cmds.size()) && (i < msgIds.size()); i++)
+            {
+                if ( (msgIds[i] < 0) || !seen.insert(std::make_pair((uint32_t)msgIds[i], i)).second )
+                    break;
+                ids.push_back((uint32_t)msgIds[i]);
+            }
+            if ( ids.size() == cmds.size() )
+            {
+                ret = exchangeJsonUdp(cmds, ids, 0, timeout);
+            }
+            else
+            {
+                this->debug("[sendCommandBatchJsonUdp] Missing or repeated message IDs; sending one at a time\n");
+                for (size_t i = 0; i < cmds.size(); i++)
+                {
+                    if ( sendCommandUdp(cmds[i], true, ( i < msgIds.size() ) ? msgIds[i] : -1) )
+                        ret.push_back(receiveJsonUdp(timeout));
+                    else
+                        ret.push_back(BasicStringList());
+                }
+            }
+            this->debug("[sendCommandBatchJsonUdp] Returning\n");
+            return ret;
+        }
+
+        std::vector<BasicStringList> RadioTransport::exchangeJsonUdp(
+                const BasicStringList& cmds,
+                const std::vector<uint32_t>& ids,
+                size_t numSent,
+                double timeout
+            )
+        {
+            typedef boost::chrono::steady_clock Clock;
+            // An empty command list means "take the next datagram"
+            size_t numCmds = std::max(cmds.size(), (size_t)1);
+            std::vector<BasicStringList> ret(numCmds);
+            // Each attempt gets an equal share of the timeout
+            bool retry = (timeout >= 0) && !cmds.empty();
+            Clock::duration attemptTime = boost::chrono::duration_cast<Clock::duration>(
+                    boost::chrono::duration<double>(
+                            std::max(timeout, 0.0) / (retry ? _jsonUdpRetries + 1 : 1)));
+            // Outstanding commands: message ID -> (command index, attempts)
+            std::map<uint32_t, std::pair<size_t, int> > pending;
+            std::map<uint32_t, Clock::time_point> deadlines;
+            Clock::time_point now = Clock::now();
+            for (size_t i = 0; i < numSent; i++)
+            {
+                pending[ids[i]] = std::make_pair(i, 1);
+                deadlines[ids[i]] = now + attemptTime;
+            }
+            size_t next = numSent;
+            size_t answered = 0;
+            if ( cmds.empty() )
+                deadlines[0] = now + attemptTime;
+            std::vector<char> buf(65536);
+            while ( answered < numCmds )
+            {
+                // Fill the window
+                while ( (next < cmds.size()) && (pending.size() < (size_t)_jsonUdpWindow) )
+                {
+                    if ( send(_udpSocket, cmds[next].c_str(), cmds[next].length(), 0) <= 0 )
+                    {
+                        translateErrno();
+                        answered++;
+                    }
+                    else
+                    {
+                        pending[ids[next]] = std::make_pair(next, 1);
+                        deadlines[ids[next]] = Clock::now() + attemptTime;
+                    }
+                    next++;
+                }
+                if ( answered >= numCmds )
+                    break;
+                // Wait until a response arrives or the earliest attempt expires
+                struct timeval tv;
+                struct timeval* tvp = NULL;
+                if ( timeout >= 0 )
+                {
+                    Clock::time_point earliest = deadlines.begin()->second;
+                    for (std::map<uint32_t, Clock::time_point>::iterator it = deadlines.begin();
+                            it != deadlines.end(); it++)
+                        earliest = std::min(earliest, it->second);
+                    long long usec = std::max((long long)0,
+                            (long long)boost::chrono::duration_cast<boost::chrono::microseconds>(
+                                    earliest - Clock::now()).count());
+                    tv.tv_sec = (long)(usec / 1000000);
+                    tv.tv_usec = (long)(usec % 1000000);
+                    tvp = &tv;
+                }
+                fd_set ins;
+                FD_ZERO(&ins);
+                FD_SET(_udpSocket, &ins);
+                int nfds = select(_udpSocket + 1, &ins, NULL, NULL, tvp);
+                if (nfds > 0)
+                {
+                    int bytes = recv(_udpSocket, &buf[0], buf.size(), 0);
+                    if (bytes <= 0)
+                    {
+                        translateErrno();
+                        break;
+                    }
+                    std::string rsp(&buf[0], bytes);
+                    this->debug("[exchangeJsonUdp] Received: \"%s\"\n",
+                            this->rawString(rsp).c_str());
+                    JsonResponseDecoder decoder(rsp);
+                    if ( !decoder.isValid() )
+                    {
+                        this->debug("[exchangeJsonUdp] Parsing JSON Error\n");
+                        continue;
+                    }
+                    // Match by message ID; a response without one can only
+                    // belong to a lone outstanding command.
+                    uint32_t id = 0;
+                    bool hasId = decoder.has("msg") && !decoder.isString("msg");
+                    if ( hasId )
+                        id = decoder.getUInt("msg");
+                    size_t index = 0;
+                    if ( cmds.empty() )
+                    {
+                        index = 0;
+                    }
+                    else if ( hasId && (pending.find(id) != pending.end()) )
+                    {
+                        index = pending[id].first;
+                    }
+                    else if ( !hasId && (pending.size() == 1) )
+                    {
+                        id = pending.begin()->first;
+                        index = pending.begin()->second.first;
+                    }
+                    else
+                    {
+                        // A late response to a command that already timed
+                        // out, or a duplicate of one already answered
+                        this->debug("[exchangeJsonUdp] Discarding response for msg %u\n", id);
+                        continue;
+                    }
+                    ret[index].push_back(rsp);
+                    pending.erase(id);
+                    deadlines.erase(cmds.empty() ? 0 : id);
+                    answered++;
+                }
+                else if (nfds == 0)
+                {
+                    // Resend overdue commands, or give up on them
+                    now = Clock::now();
+                    std::map<uint32_t, Clock::time_point>::iterator it = deadlines.begin();
+                    while ( it != deadlines.end() )
+                    {
+                        if ( it->second > now )
+                        {
+                            it++;
+                            continue;
+                        }
+                        std::map<uint32_t, std::pair<size_t, int> >::iterator pit = pending.find(it->first);
+                        if ( retry && (pit != pending.end()) && (pit->second.second <= _jsonUdpRetries) )
+                        {
+                            const std::string& cmd = cmds[pit->second.first];
+                            this->debug("[exchangeJsonUdp] Resending msg %u\n", it->first);
+                            send(_udpSocket, cmd.c_str(), cmd.length(), 0);
+                            pit->second.second++;
+                            it->second = now + attemptTime;
+                            it++;
+                        }
+                        else
+                        {
+                            this->debug("[exchangeJsonUdp] Timeout on msg %u\n", it->first);
+                            _lastCmdErrInfo = "Timeout";
+                            if ( pit != pending.end() )
+                                pending.erase(pit);
+                            deadlines.erase(it++);
+                            answered++;
+                        }
+                    }
+                }
+                else
+                {
+                    translateErrno();
+                    this->debug("[exchangeJsonUdp] Socket select error: %s\n", _lastCmdErrInfo.c_str());
+                    break;
+                }
+            }
+            return ret;
+        }
+
+        BasicStringList RadioTransport::splitCliResponse(
+                const std::string& rsp
+            )
+        {
+            BasicStringList ret;
             // Split the response into a list of non-empty strings
             // -- Remove carriage returns and prompt character
-            std::string tmp = Pythonesque::Replace(Pythonesque::Replace(oss.str(), "\r", ""), ">", "");
+            std::string tmp = Pythonesque::Replace(Pythonesque::Replace(rsp, "\r", ""), ">", "");
             // -- Split on newlines
             BasicStringList tmpList = Pythonesque::Split(tmp, "\n");
             // -- Compile the non-empty strings into a list
@@ -671,7 +1162,6 @@ namespace LibCyberRadio
                 if ( !tmp.empty() )
                     ret.push_back(tmp);
             }
-            this->debug("[receiveCliTty] Returning %u elements\n", ret.size());
             return ret;
         }
 
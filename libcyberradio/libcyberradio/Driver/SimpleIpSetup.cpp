@@ -69,22 +69,25 @@ namespace LibCyberRadio
         bool SimpleIpSetup::setConfiguration(ConfigurationDict& cfg)
         {
             this->debug("[SimpleIpSetup::setConfiguration] Called\n");
+            ConfigurationDict delta = this->changedConfiguration(cfg);
             // Call the base-class version to modify the configuration dictionary
             bool ret = Configurable::setConfiguration(cfg);
-            // Use the keys provided in the *incoming* dictionary to determine
+            // Use the keys that changed in the *incoming* dictionary to determine
             // what needs to be changed.
-            if ( cfg.hasKey("sourceIP") && _config.hasKey("sourceIP") )
+            if ( delta.hasKey("sourceIP") && _config.hasKey("sourceIP") )
             {
                 ret &= setSourceIP(cfg["sourceIP"]);
             }
-            if ( cfg.hasKey("destIP") && _config.hasKey("destIP") )
+            if ( delta.hasKey("destIP") && _config.hasKey("destIP") )
             {
                 ret &= setDestIPAddress(cfg["destIP"]);
             }
-            if ( cfg.hasKey("destMAC") && _config.hasKey("destMAC") )
+            if ( delta.hasKey("destMAC") && _config.hasKey("destMAC") )
             {
                 ret &= setDestMACAddress(cfg["destMAC"]);
             }
+            if ( !ret )
+                this->invalidate();
             this->debug("[SimpleIpSetup::setConfiguration] Returning\n");
             return ret;
         }
@@ -107,11 +110,13 @@ namespace LibCyberRadio
 
         std::string SimpleIpSetup::getSourceMAC() const
         {
+            this->ensureState();
             return _sourceMAC;
         }
 
         std::string SimpleIpSetup::getSourceIP() const
         {
+            this->ensureState();
             return _sourceIP;
         }
 
@@ -133,11 +138,13 @@ namespace LibCyberRadio
 
         std::string SimpleIpSetup::getDestMACAddress() const
         {
+            this->ensureState();
             return _destMAC;
         }
 
         std::string SimpleIpSetup::getDestIPAddress() const
         {
+            this->ensureState();
             return _destIP;
         }
 
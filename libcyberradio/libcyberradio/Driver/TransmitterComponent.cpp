@@ -118,12 +118,13 @@ namespace LibCyberRadio
         bool TransmitterComponent::setConfiguration(ConfigurationDict& cfg)
         {
             this->debug("[TransmitterComponent::setConfiguration] Called\n");
+            ConfigurationDict delta = this->changedConfiguration(cfg);
             // Call the base-class version to modify the configuration dictionary
             // (this including any enabling/disabling)
             bool ret = RadioComponent::setConfiguration(cfg);
-            // Use the keys provided in the *incoming* dictionary to determine
+            // Use the keys that changed in the *incoming* dictionary to determine
             // what needs to be changed via hardware calls.
-            if ( cfg.hasKey("frequency") && _config.hasKey("frequency") )
+            if ( delta.hasKey("frequency") && _config.hasKey("frequency") )
             {
                 try
                 {
@@ -139,7 +140,7 @@ namespace LibCyberRadio
             {
                 //this->debug("[setConfiguration] -- CAN'T set freq = not in incoming\n");
             }
-            if ( cfg.hasKey("attenuation") && _config.hasKey("attenuation") )
+            if ( delta.hasKey("attenuation") && _config.hasKey("attenuation") )
             {
                 try
                 {
@@ -155,10 +156,22 @@ namespace LibCyberRadio
             {
                 //this->debug("[setConfiguration] -- CAN'T set atten = not in incoming\n");
             }
+            if ( !ret )
+                this->invalidate();
             this->debug("[TransmitterComponent::setConfiguration] Returning %s\n", debugBool(ret));
             return ret;
         }
 
+        std::string TransmitterComponent::validateConfiguration(const ConfigurationDict& cfg) const
+        {
+            std::string ret = RadioComponent::validateConfiguration(cfg);
+            if ( ret.empty() )
+                ret = this->validateRange(cfg, "frequency", _freqRangeMin, _freqRangeMax);
+            if ( ret.empty() )
+                ret = this->validateRange(cfg, "attenuation", _attRangeMin, _attRangeMax);
+            return ret;
+        }
+
         void TransmitterComponent::queryConfiguration()
         {
             this->debug("[TransmitterComponent::queryConfiguration] Called\n");
@@ -179,13 +192,14 @@ namespace LibCyberRadio
             for ( CWToneGenComponentDict::iterator it = _cwToneGens.begin();
                     it != _cwToneGens.end(); it++)
             {
-                it->second->queryConfiguration();
+                it->second->refresh();
             }
             this->debug("[TransmitterComponent::queryConfiguration] Returning\n");
         }
 
         double TransmitterComponent::getFrequency() const
         {
+            this->ensureState();
             return _frequency;
         }
 
@@ -207,6 +221,7 @@ namespace LibCyberRadio
 
         double TransmitterComponent::getAttenuation() const
         {
+            this->ensureState();
             return _attenuation;
         }
 
@@ -427,6 +442,7 @@ namespace LibCyberRadio
 
         ConfigurationDict TransmitterComponent::getCWConfiguration(int index) const
         {
+            this->ensureState();
             ConfigurationDict ret;
             CWToneGenComponentDict::const_iterator it = _cwToneGens.begin();
             if ( it != _cwToneGens.end() )
@@ -445,6 +461,7 @@ namespace LibCyberRadio
 
         double TransmitterComponent::getCWFrequency(int index) const
         {
+            this->ensureState();
             double ret = 0.0;
             CWToneGenComponentDict::const_iterator it = _cwToneGens.begin();
             if ( it != _cwToneGens.end() )
@@ -463,6 +480,7 @@ namespace LibCyberRadio
 
         double TransmitterComponent::getCWAmplitude(int index) const
         {
+            this->ensureState();
             double ret = 0.0;
             CWToneGenComponentDict::const_iterator it = _cwToneGens.begin();
             if ( it != _cwToneGens.end() )
@@ -481,6 +499,7 @@ namespace LibCyberRadio
 
         double TransmitterComponent::getCWPhase(int index) const
         {
+            this->ensureState();
             double ret = 0.0;
             CWToneGenComponentDict::const_iterator it = _cwToneGens.begin();
             if ( it != _cwToneGens.end() )
@@ -508,6 +527,7 @@ namespace LibCyberRadio
 
         double TransmitterComponent::getCWSweepStartFrequency(int index) const
         {
+            this->ensureState();
             double ret = 0.0;
             CWToneGenComponentDict::const_iterator it = _cwToneGens.begin();
             if ( it != _cwToneGens.end() )
@@ -517,6 +537,7 @@ namespace LibCyberRadio
 
         double TransmitterComponent::getCWSweepStopFrequency(int index) const
         {
+            this->ensureState();
             double ret = 0.0;
             CWToneGenComponentDict::const_iterator it = _cwToneGens.begin();
             if ( it != _cwToneGens.end() )
@@ -526,6 +547,7 @@ namespace LibCyberRadio
 
         double TransmitterComponent::getCWSweepFrequencyStep(int index) const
         {
+            this->ensureState();
             double ret = 0.0;
             CWToneGenComponentDict::const_iterator it = _cwToneGens.begin();
             if ( it != _cwToneGens.end() )
@@ -535,6 +557,7 @@ namespace LibCyberRadio
 
         double TransmitterComponent::getCWSweepDwellTime(int index) const
         {
+            this->ensureState();
             double ret = 0.0;
             CWToneGenComponentDict::const_iterator it = _cwToneGens.begin();
             if ( it != _cwToneGens.end() )
@@ -116,10 +116,11 @@ namespace LibCyberRadio
         bool TunerComponent::setConfiguration(ConfigurationDict& cfg)
         {
             this->debug("[TunerComponent::setConfiguration] Called\n");
+            ConfigurationDict delta = this->changedConfiguration(cfg);
             // Call the base-class version to modify the configuration dictionary
             // (this including any enabling/disabling)
             bool ret = RadioComponent::setConfiguration(cfg);
-            // Use the keys provided in the *incoming* dictionary to determine
+            // Use the keys that changed in the *incoming* dictionary to determine
             // what needs to be changed via hardware calls.
             double adjFrequency = _frequency;
             double adjAttenuation = _attenuation;
@@ -129,22 +130,22 @@ namespace LibCyberRadio
             bool attCmdNeedsExecuting = false;
             bool filCmdNeedsExecuting = false;
             bool adjCmdNeedsExecuting = false;
-            if ( cfg.hasKey("frequency") && _config.hasKey("frequency") )
+            if ( delta.hasKey("frequency") && _config.hasKey("frequency") )
             {
                 adjFrequency = getConfigurationValueAsDbl("frequency");
                 freqCmdNeedsExecuting = true;
             }
-            if ( cfg.hasKey("attenuation") && _config.hasKey("attenuation") )
+            if ( delta.hasKey("attenuation") && _config.hasKey("attenuation") )
             {
                 adjAttenuation = getConfigurationValueAsDbl("attenuation");
                 attCmdNeedsExecuting = true;
             }
-            if ( cfg.hasKey("filter") && _config.hasKey("filter") )
+            if ( delta.hasKey("filter") && _config.hasKey("filter") )
             {
                 adjFilter = getConfigurationValueAsInt("filter");
                 filCmdNeedsExecuting = true;
             }
-            if ( cfg.hasKey("timingAdj") && _config.hasKey("timingAdj") )
+            if ( delta.hasKey("timingAdj") && _config.hasKey("timingAdj") )
             {
                 adjAdj = getConfigurationValueAsInt("timingAdj");
                 adjCmdNeedsExecuting = true;
@@ -165,10 +166,22 @@ namespace LibCyberRadio
             {
                 ret &= executeTimingAdjustmentCommand(_index, adjAdj);
             }
+            if ( !ret )
+                this->invalidate();
             this->debug("[TunerComponent::setConfiguration] Returning %s\n", debugBool(ret));
             return ret;
         }
 
+        std::string TunerComponent::validateConfiguration(const ConfigurationDict& cfg) const
+        {
+            std::string ret = RadioComponent::validateConfiguration(cfg);
+            if ( ret.empty() )
+                ret = this->validateRange(cfg, "frequency", _freqRangeMin, _freqRangeMax);
+            if ( ret.empty() )
+                ret = this->validateRange(cfg, "attenuation", _attRangeMin, _attRangeMax);
+            return ret;
+        }
+
         void TunerComponent::queryConfiguration()
         {
             this->debug("[TunerComponent::queryConfiguration] Called\n");
@@ -198,6 +211,7 @@ namespace LibCyberRadio
 
         double TunerComponent::getFrequency() const
         {
+            this->ensureState();
             return _frequency;
         }
 
@@ -219,6 +233,7 @@ namespace LibCyberRadio
 
         double TunerComponent::getAttenuation() const
         {
+            this->ensureState();
             return _attenuation;
         }
 
@@ -240,6 +255,7 @@ namespace LibCyberRadio
 
         int TunerComponent::getFilter() const
         {
+            this->ensureState();
             return _filter;
         }
 
@@ -261,6 +277,7 @@ namespace LibCyberRadio
 
         int TunerComponent::getTimingAdjustment() const
         {
+            this->ensureState();
             return _timingAdj;
         }
 
@@ -111,9 +111,13 @@ namespace LibCyberRadio
 
         bool WbddcComponent::enable(bool enabled)
         {
+            this->ensureState();
             bool ret = false;
             if ( _config.hasKey("enable") )
             {
+                // Nothing to send if the radio already has this setting
+                if ( this->isStateCurrent() && (enabled == _enabled) )
+                    return true;
                 int adjRateIndex = _rateIndex;
                 int adjUdpDest = _udpDestination;
                 int adjVita = _vitaEnable;
@@ -132,11 +136,12 @@ namespace LibCyberRadio
         bool WbddcComponent::setConfiguration(ConfigurationDict& cfg)
         {
             this->debug("[WbddcComponent::setConfiguration] Called\n");
+            ConfigurationDict delta = this->changedConfiguration(cfg);
             // Call the "grandparent" version of this method instead of the
             // parent version. We want the normalization, but not the
             // automatic enabling.
             bool ret = Configurable::setConfiguration(cfg);
-            // Use the keys provided in the *incoming* dictionary to determine
+            // Use the keys that changed in the *incoming* dictionary to determine
             // what needs to be changed via hardware calls.
             int adjRateIndex = _rateIndex;
             int adjUdpDest = _udpDestination;
@@ -150,34 +155,34 @@ namespace LibCyberRadio
             bool freqCmdNeedsExecuting = false;
             bool srcCmdNeedsExecuting = false;
             bool dpCmdNeedsExecuting = false;
-            if ( cfg.hasKey("enable") && _config.hasKey("enable") )
+            if ( delta.hasKey("enable") && _config.hasKey("enable") )
             {
                 adjEnabled = getConfigurationValueAsBool("enable");
                 ddcCmdNeedsExecuting = true;
             }
-            if ( cfg.hasKey("rateIndex") && _config.hasKey("rateIndex") )
+            if ( delta.hasKey("rateIndex") && _config.hasKey("rateIndex") )
             {
                 adjRateIndex = getConfigurationValueAsInt("rateIndex");
                 ddcCmdNeedsExecuting = true;
             }
-            if ( cfg.hasKey("udpDestination") && _config.hasKey("udpDestination") )
+            if ( delta.hasKey("udpDestination") && _config.hasKey("udpDestination") )
             {
                 adjUdpDest = getConfigurationValueAsInt("udpDestination");
                 ddcCmdNeedsExecuting = true;
             }
-            if ( cfg.hasKey("vitaEnable") && _config.hasKey("vitaEnable") )
+            if ( delta.hasKey("vitaEnable") && _config.hasKey("vitaEnable") )
             {
                 adjVita = getConfigurationValueAsInt("vitaEnable");
                 ddcCmdNeedsExecuting = true;
             }
-            if ( cfg.hasKey("streamId") && _config.hasKey("streamId") )
+            if ( delta.hasKey("streamId") && _config.hasKey("streamId") )
             {
                 adjStream = getConfigurationValueAsUInt("streamId");
                 ddcCmdNeedsExecuting = true;
             }
             if ( _tunable )
             {
-                if ( cfg.hasKey("frequency") && _config.hasKey("frequency") )
+                if ( delta.hasKey("frequency") && _config.hasKey("frequency") )
                 {
                     adjFreq = getConfigurationValueAsDbl("frequency");
                     freqCmdNeedsExecuting = true;
@@ -185,7 +190,7 @@ namespace LibCyberRadio
             }
             if ( _selectableSource )
             {
-                if ( cfg.hasKey("source") && _config.hasKey("source") )
+                if ( delta.hasKey("source") && _config.hasKey("source") )
                 {
                     adjSource = getConfigurationValueAsInt("source");
                     srcCmdNeedsExecuting = true;
@@ -193,7 +198,7 @@ namespace LibCyberRadio
             }
             if ( _selectableDataPort )
             {
-                if ( cfg.hasKey("dataPort") && _config.hasKey("dataPort") )
+                if ( delta.hasKey("dataPort") && _config.hasKey("dataPort") )
                 {
                     adjDataPort = getConfigurationValueAsInt("dataPort");
                     dpCmdNeedsExecuting = true;
@@ -228,10 +233,28 @@ namespace LibCyberRadio
                 _dataPort = adjDataPort;
                 updateConfigurationDict();
             }
+            if ( !ret )
+                this->invalidate();
             this->debug("[WbddcComponent::setConfiguration] Returning\n");
             return ret;
         }
 
+        std::string WbddcComponent::validateConfiguration(const ConfigurationDict& cfg) const
+        {
+            std::string ret = RadioComponent::validateConfiguration(cfg);
+            if ( ret.empty() )
+            {
+                BasicIntList rates;
+                for (WbddcRateSet::const_iterator it = _rateSet.begin();
+                        it != _rateSet.end(); it++)
+                    rates.push_back(it->first);
+                ret = this->validateChoice(cfg, "rateIndex", rates);
+            }
+            if ( ret.empty() && _tunable )
+                ret = this->validateRange(cfg, "frequency", _freqRangeMin, _freqRangeMax);
+            return ret;
+        }
+
         void WbddcComponent::queryConfiguration()
         {
             this->debug("[WbddcComponent::queryConfiguration] Called\n");
@@ -262,6 +285,7 @@ namespace LibCyberRadio
 
         double WbddcComponent::getFrequency() const
         {
+            this->ensureState();
             return _frequency;
         }
 
@@ -270,6 +294,9 @@ namespace LibCyberRadio
             bool ret = false;
             if ( _tunable && _config.hasKey("frequency") )
             {
+                // Nothing to send if the radio already has this setting
+                if ( this->isStateCurrent() && (freq == _frequency) )
+                    return true;
                 double adjFreq = _frequency;
                 ret = executeFreqCommand(_index, adjFreq);
                 if ( ret )
@@ -316,6 +343,7 @@ namespace LibCyberRadio
 
         int WbddcComponent::getSource() const
         {
+            this->ensureState();
             return _source;
         }
 
@@ -324,6 +352,9 @@ namespace LibCyberRadio
             bool ret = false;
             if ( _selectableSource && _config.hasKey("source") )
             {
+                // Nothing to send if the radio already has this setting
+                if ( this->isStateCurrent() && (source == _source) )
+                    return true;
                 int adjSource = source;
                 ret = executeSourceCommand(_index, adjSource);
                 if ( ret )
@@ -337,14 +368,19 @@ namespace LibCyberRadio
 
         int WbddcComponent::getRateIndex() const
         {
+            this->ensureState();
             return _rateIndex;
         }
 
         bool WbddcComponent::setRateIndex(int index)
         {
+            this->ensureState();
             bool ret = false;
             if ( _config.hasKey("rateIndex") )
             {
+                // Nothing to send if the radio already has this setting
+                if ( this->isStateCurrent() && (index == _rateIndex) )
+                    return true;
                 int adjRateIndex = index;
                 int adjUdpDest = _udpDestination;
                 int adjVita = _vitaEnable;
@@ -362,14 +398,19 @@ namespace LibCyberRadio
 
         int WbddcComponent::getUdpDestination() const
         {
+            this->ensureState();
             return _udpDestination;
         }
 
         bool WbddcComponent::setUdpDestination(int dest)
         {
+            this->ensureState();
             bool ret = false;
             if ( _config.hasKey("udpDestination") )
             {
+                // Nothing to send if the radio already has this setting
+                if ( this->isStateCurrent() && (dest == _udpDestination) )
+                    return true;
                 int adjRateIndex = _rateIndex;
                 int adjUdpDest = dest;
                 int adjVita = _vitaEnable;
@@ -387,14 +428,19 @@ namespace LibCyberRadio
 
         int WbddcComponent::getVitaEnable() const
         {
+            this->ensureState();
             return _vitaEnable;
         }
 
         bool WbddcComponent::setVitaEnable(int enable)
         {
+            this->ensureState();
             bool ret = false;
             if ( _config.hasKey("vitaEnable") )
             {
+                // Nothing to send if the radio already has this setting
+                if ( this->isStateCurrent() && (enable == _vitaEnable) )
+                    return true;
                 int adjRateIndex = _rateIndex;
                 int adjUdpDest = _udpDestination;
                 int adjVita = enable;
@@ -412,14 +458,19 @@ namespace LibCyberRadio
 
         unsigned int WbddcComponent::getStreamId() const
         {
+            this->ensureState();
             return _streamId;
         }
 
         bool WbddcComponent::setStreamId(unsigned int sid)
         {
+            this->ensureState();
             bool ret = false;
             if ( _config.hasKey("streamId") )
             {
+                // Nothing to send if the radio already has this setting
+                if ( this->isStateCurrent() && (sid == _streamId) )
+                    return true;
                 int adjRateIndex = _rateIndex;
                 int adjUdpDest = _udpDestination;
                 int adjVita = _vitaEnable;
@@ -437,6 +488,7 @@ namespace LibCyberRadio
 
         int WbddcComponent::getDataPort() const
         {
+            this->ensureState();
             return _dataPort;
         }
 
@@ -445,6 +497,9 @@ namespace LibCyberRadio
             bool ret = false;
             if ( _selectableDataPort && _config.hasKey("dataPort") )
             {
+                // Nothing to send if the radio already has this setting
+                if ( this->isStateCurrent() && (port == _dataPort) )
+                    return true;
                 int adjDataPort = port;
                 ret = executeDataPortCommand(_index, adjDataPort);
                 if ( ret )
@@ -75,6 +75,7 @@ namespace LibCyberRadio
         bool WbddcGroupComponent::setConfiguration(ConfigurationDict& cfg)
         {
             this->debug("[WbddcGroupComponent::setConfiguration] Called\n");
+            ConfigurationDict delta = this->changedConfiguration(cfg);
             // Call the "grandparent" version of this method instead of the
             // parent version. We want the normalization, but not the
             // automatic enabling.
@@ -83,12 +84,12 @@ namespace LibCyberRadio
             BasicIntList adjMembers = _groupMembers;
             bool enableCmdNeedsExecuting = false;
             bool memberCmdNeedsExecuting = false;
-            if ( cfg.hasKey("enable") && _config.hasKey("enable") )
+            if ( delta.hasKey("enable") && _config.hasKey("enable") )
             {
                 adjEnabled = getConfigurationValueAsBool("enable");
                 enableCmdNeedsExecuting = true;
             }
-            if ( cfg.hasKey("members") && _config.hasKey("members") )
+            if ( delta.hasKey("members") && _config.hasKey("members") )
             {
                 BasicStringList vec = Pythonesque::Split(getConfigurationValue("members"), ",");
                 adjMembers.clear();
@@ -112,6 +113,8 @@ namespace LibCyberRadio
                 _groupMembers = adjMembers;
                 updateConfigurationDict();
             }
+            if ( !ret )
+                this->invalidate();
             this->debug("[WbddcGroupComponent::setConfiguration] Returning\n");
             return ret;
         }
@@ -133,6 +136,7 @@ namespace LibCyberRadio
 
         BasicIntList WbddcGroupComponent::getMembers() const
         {
+            this->ensureState();
             return _groupMembers;
         }
 
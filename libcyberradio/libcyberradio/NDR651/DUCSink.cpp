@@ -15,6 +15,7 @@
 
 #include "LibCyberRadio/NDR651/DUCSink.h"
 #include "LibCyberRadio/NDR651/TransmitPacketizer.h"
+#include "LibCyberRadio/NDR651/SampleConversion.h"
 #include <stdarg.h>
 #include <iostream>
 #include <math.h>
@@ -301,8 +302,6 @@ namespace LibCyberRadio
             // input_items = Array of complex samples.  It should have at least
             //     (noutput_items * SAMPLES_PER_FRAME) elements in it.
             int noutput_items_processed = 0;
-            int sample;
-            int sample_input_item;
             bool sending = true;
             // If the transmit packetizer is ready to receive --
             if ( (d_tx != NULL) && d_tx->isReadyToReceive() )
@@ -314,13 +313,11 @@ namespace LibCyberRadio
                         (noutput_items_processed < noutput_items) )
                 {
                     // Fill the sample buffer.  Note that I/Q data is filled in reverse order --
-                    // Q, then I.
-                    for (sample = 0; sample < SAMPLES_PER_FRAME; sample++)
-                    {
-                        sample_input_item = noutput_items_processed * SAMPLES_PER_FRAME + sample;
-                        d_sample_buffer[sample * 2] = (short)(input_items[sample_input_item].imag() * d_iq_scale_factor);
-                        d_sample_buffer[sample * 2 + 1] = (short)(input_items[sample_input_item].real() * d_iq_scale_factor);
-                    }
+                    // Q, then I.  Samples are rounded and saturated to 16 bits.
+                    convertComplexFloatToShort(
+                            input_items + noutput_items_processed * SAMPLES_PER_FRAME,
+                            d_sample_buffer, SAMPLES_PER_FRAME,
+                            d_iq_scale_factor, true);
                     // Send data
                     int samplesSent = d_tx->sendFrame(d_sample_buffer);
                     if ( samplesSent > 0 )
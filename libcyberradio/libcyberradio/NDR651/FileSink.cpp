@@ -0,0 +1,306 @@
+/***************************************************************************
+ * \file FileSink.cpp
+ *
+ * \brief NDR651 memory-mapped waveform file transmit sink.
+ *
+ * \author JVM
+ * \copyright Copyright (c) 2015-2021 CyberRadio Solutions, Inc.
+ *
+ */
+
+#include "LibCyberRadio/NDR651/FileSink.h"
+#include <algorithm>
+#include <iostream>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+// Amount of the file to prefetch at a new playback position
+#define FILESINK_READAHEAD_BYTES (64*1024*1024)
+
+namespace LibCyberRadio
+{
+    namespace NDR651
+    {
+
+        FileSink::FileSink(TXClient * txClient,
+                const std::string& filename,
+                unsigned int samplesPerFrame,
+                bool loop,
+                bool debug) :
+            Thread("FileSink", "FileSink"),
+            Debuggable(debug, "FileSink"),
+            _txClient(txClient),
+            _filename(""),
+            _samplesPerFrame(samplesPerFrame > 0 ? samplesPerFrame : SAMPLES_PER_FRAME),
+            _loop(loop),
+            _swapIQ(false),
+            _fd(-1),
+            _mapLength(0),
+            _data(NULL),
+            _numSamples(0),
+            _position(0),
+            _seekTarget(0),
+            _seekPending(false),
+            _samplesSent(0),
+            _finished(false),
+            _running(false)
+        {
+            _frameBuffer.assign(2 * _samplesPerFrame, 0);
+            if (!filename.empty())
+            {
+                this->open(filename);
+            }
+        }
+
+        FileSink::~FileSink()
+        {
+            this->stop();
+            this->close();
+        }
+
+        bool FileSink::open(const std::string& filename)
+        {
+            if (_running)
+            {
+                this->debug("[open] Cannot open a file while streaming\n");
+                return false;
+            }
+            this->close();
+            this->debug("[open] Opening %s\n", filename.c_str());
+            _fd = ::open(filename.c_str(), O_RDONLY);
+            if (_fd < 0)
+            {
+                std::cerr << "FileSink: could not open " << filename << ": " << strerror(errno) << std::endl;
+                return false;
+            }
+            struct stat st;
+            if ((fstat(_fd, &st) != 0) || (st.st_size < 4))
+            {
+                std::cerr << "FileSink: " << filename << " holds no samples" << std::endl;
+                ::close(_fd);
+                _fd = -1;
+                return false;
+            }
+            _mapLength = st.st_size;
+            void * map = mmap(NULL, _mapLength, PROT_READ, MAP_SHARED, _fd, 0);
+            if (map == MAP_FAILED)
+            {
+                std::cerr << "FileSink: could not map " << filename << ": " << strerror(errno) << std::endl;
+                ::close(_fd);
+                _fd = -1;
+                _mapLength = 0;
+                return false;
+            }
+            // Playback reads the file front to back, so ask the kernel for
+            // aggressive readahead and early reclaim of pages already sent.
+            madvise(map, _mapLength, MADV_SEQUENTIAL);
+            madvise(map, std::min(_mapLength, (size_t)FILESINK_READAHEAD_BYTES), MADV_WILLNEED);
+            _data = (const short *)map;
+            _numSamples = _mapLength / 4;
+            _filename = filename;
+            _position = 0;
+            _seekPending = false;
+            _finished = false;
+            this->debug("[open] -- %llu samples\n", _numSamples);
+            return true;
+        }
+
+        void FileSink::close()
+        {
+            if (_running)
+            {
+                this->debug("[close] Cannot close the file while streaming\n");
+                return;
+            }
+            if (_data != NULL)
+            {
+                munmap((void *)_data, _mapLength);
+                _data = NULL;
+            }
+            if (_fd >= 0)
+            {
+                ::close(_fd);
+                _fd = -1;
+            }
+            _mapLength = 0;
+            _numSamples = 0;
+            _filename = "";
+        }
+
+        void FileSink::setSwapIQ(bool swapIQ)
+        {
+            if (!_running)
+            {
+                _swapIQ = swapIQ;
+            }
+        }
+
+        bool FileSink::seek(unsigned long long sample)
+        {
+            if ((_data == NULL) || (sample >= _numSamples))
+            {
+                return false;
+            }
+            // The streaming thread owns the position; hand the new one over.
+            {
+                boost::mutex::scoped_lock lock(_wakeMutex);
+                _seekTarget = sample;
+                _seekPending = true;
+                _finished = false;
+            }
+            _wake.notify_all();
+            return true;
+        }
+
+        unsigned long long FileSink::getPosition()
+        {
+            return _seekPending ? (unsigned long long)_seekTarget : (unsigned long long)_position;
+        }
+
+        void FileSink::start()
+        {
+            if (_data == NULL)
+            {
+                std::cerr << "FileSink: no waveform file open" << std::endl;
+                return;
+            }
+            if (_txClient->isAsyncMode())
+            {
+                std::cerr << "FileSink: transmit client must be in synchronous mode" << std::endl;
+                return;
+            }
+            this->debug("[start] Streaming %s\n", _filename.c_str());
+            _txClient->start();
+            _samplesSent = 0;
+            _finished = false;
+            _running = true;
+            // Run the loop directly rather than through Thread::start(), whose
+            // wrapper resets the thread handle on exit and so cannot be joined
+            // safely from stop().
+            _isRunning = true;
+            _thisThread = boost::thread(&FileSink::run, this);
+            pthread_setname_np(_thisThread.native_handle(), this->_name.c_str());
+        }
+
+        void FileSink::stop(bool disableRF)
+        {
+            if (_running)
+            {
+                this->debug("[stop] Stopping streaming thread\n");
+                {
+                    boost::mutex::scoped_lock lock(_wakeMutex);
+                    _running = false;
+                }
+                _wake.notify_all();
+                // The client must not be stopped while the streaming thread
+                // may still be using it.
+                if (_thisThread.joinable())
+                {
+                    _thisThread.join();
+                }
+                _isRunning = false;
+                _txClient->stop(disableRF);
+            }
+        }
+
+        // Returns the next frame to send, advancing the playback position,
+        // or NULL at the end of a non-looping file.  Frames that lie wholly
+        // within the file point straight into the mapping.
+        short * FileSink::_nextFrame(void)
+        {
+            if (_seekPending.exchange(false))
+            {
+                _position = (unsigned long long)_seekTarget;
+                size_t offset = (_position * 4) & ~((size_t)sysconf(_SC_PAGESIZE) - 1);
+                madvise((void *)((const char *)_data + offset),
+                        std::min(_mapLength - offset, (size_t)FILESINK_READAHEAD_BYTES),
+                        MADV_WILLNEED);
+            }
+            unsigned long long pos = _position;
+            if (pos >= _numSamples)
+            {
+                if (!_loop)
+                {
+                    return NULL;
+                }
+                pos = 0;
+            }
+            short * frame;
+            if (pos + _samplesPerFrame <= _numSamples)
+            {
+                frame = (short *)(_data + 2 * pos);
+                pos += _samplesPerFrame;
+                if (_swapIQ)
+                {
+                    memcpy(&_frameBuffer[0], frame, 4 * _samplesPerFrame);
+                    frame = &_frameBuffer[0];
+                }
+            }
+            else
+            {
+                // The frame runs off the end of the file: wrap around if
+                // looping, otherwise pad the last frame with zeros.
+                unsigned int filled = 0;
+                while (filled < _samplesPerFrame)
+                {
+                    if (pos >= _numSamples)
+                    {
+                        if (!_loop)
+                            break;
+                        pos = 0;
+                    }
+                    unsigned int n = (unsigned int)std::min((unsigned long long)(_samplesPerFrame - filled),
+                            _numSamples - pos);
+                    memcpy(&_frameBuffer[2 * filled], _data + 2 * pos, 4 * n);
+                    filled += n;
+                    pos += n;
+                }
+                std::fill(_frameBuffer.begin() + 2 * filled, _frameBuffer.end(), 0);
+                frame = &_frameBuffer[0];
+            }
+            if (_swapIQ)
+            {
+                for (unsigned int i = 0; i < 2 * _samplesPerFrame; i += 2)
+                {
+                    std::swap(frame[i], frame[i + 1]);
+                }
+            }
+            _position = pos;
+            return frame;
+        }
+
+        void FileSink::run()
+        {
+            while (_running)
+            {
+                short * frame = this->_nextFrame();
+                if (frame == NULL)
+                {
+                    this->debug("[run] End of file\n");
+                    _finished = true;
+                    // Idle until stopped or moved by seek()
+                    boost::mutex::scoped_lock lock(_wakeMutex);
+                    while (_running && !_seekPending)
+                    {
+                        _wake.wait(lock);
+                    }
+                    continue;
+                }
+                // Wait for flow-control credit in short slices, so that
+                // stop() is never held up by a DUC that stops draining.
+                while (!_txClient->trySendFrame(frame, _samplesPerFrame))
+                {
+                    if (!_running)
+                        return;
+                    _txClient->waitToSend(_samplesPerFrame, 0.01);
+                }
+                _samplesSent += _samplesPerFrame;
+            }
+        }
+
+    } /* namespace NDR651 */
+}
@@ -1,4 +1,6 @@
 #include "LibCyberRadio/NDR651/Packetizer.h"
+#include <linux/net_tstamp.h>
+#include <cmath>
 
 namespace LibCyberRadio
 {
@@ -12,7 +14,17 @@ namespace LibCyberRadio
             samplesPerFrame(1024),
             sampleRate(calculateSampleRate(ducRateIndex)),
             txSocket(-1),
-            fracTimestampIncrement(2048)
+            timestampBaseSeconds(0),
+            timestampBaseTicks(0),
+            timestampSampleCount(0),
+            useTxTime(false),
+            txTimeOffsetNs(1000000),
+            txTimeClock(CLOCK_TAI),
+            txTimeAnchored(false),
+            txTimeBaseNs(0),
+            txTimeBaseVitaNs(0),
+            txTimeSendCount(0),
+            txTimeDropCount(0)
         {
 
             // An IO Vector is used to handle transmitting the header, payload, and footer consisely.
@@ -26,6 +38,18 @@ namespace LibCyberRadio
             this->txVec[2].iov_base = new char[sizeof(struct LibCyberRadio::NDR651::Vita49Trailer)];
             this->txVec[2].iov_len = sizeof(struct LibCyberRadio::NDR651::Vita49Trailer);
 
+            // Message header used for sendmsg() when launch times are attached
+            memset(&this->txMsg, 0, sizeof(this->txMsg));
+            memset(this->txTimeControl, 0, sizeof(this->txTimeControl));
+            this->txMsg.msg_iov = this->txVec;
+            this->txMsg.msg_iovlen = 3;
+            this->txMsg.msg_control = this->txTimeControl;
+            this->txMsg.msg_controllen = sizeof(this->txTimeControl);
+            struct cmsghdr *cmsg = CMSG_FIRSTHDR(&this->txMsg);
+            cmsg->cmsg_level = SOL_SOCKET;
+            cmsg->cmsg_type = SCM_TXTIME;
+            cmsg->cmsg_len = CMSG_LEN(sizeof(uint64_t));
+
         }
 
         // Destructor
@@ -59,7 +83,23 @@ namespace LibCyberRadio
                 // Set out txVec to point to the current samples
                 this->txVec[1].iov_base = (char *)(samples);
                 this->txVec[1].iov_len = 4*(this->samplesPerFrame);
-                int bytesSent = writev(this->txSocket, this->txVec, 3);
+                if (this->useTxTime)
+                {
+                    // Attach the launch time for this frame's VITA timestamp
+                    uint64_t txTime = this->getLaunchTime();
+                    memcpy(CMSG_DATA(CMSG_FIRSTHDR(&this->txMsg)), &txTime, sizeof(uint64_t));
+                    // Frames the qdisc dropped are reported on the error
+                    // queue; read it now and then, and whenever a send fails
+                    if ((sendmsg(this->txSocket, &this->txMsg, 0) < 0) ||
+                        ((++this->txTimeSendCount % 64) == 0))
+                    {
+                        this->txTimeDropCount += TransmitSocket::readTxTimeErrors(this->txSocket);
+                    }
+                }
+                else
+                {
+                    writev(this->txSocket, this->txVec, 3);
+                }
                 this->incrementVitaHeader();
             }
         }
@@ -70,6 +110,108 @@ namespace LibCyberRadio
 
         }
 
+        bool Packetizer::setTxTime(bool enable, clockid_t clockId, long long launchOffsetNs, bool deadlineMode)
+        {
+            if (this->txSocket < 0)
+            {
+                this->debug("Cannot set launch time before start()\n");
+                return false;
+            }
+            int rv = 0;
+            if (!enable && this->useTxTime)
+            {
+                // SO_TXTIME cannot be cleared, so start over with a new socket
+                this->txTimeDropCount += TransmitSocket::readTxTimeErrors(this->txSocket);
+                close(this->txSocket);
+                this->txSocket = -1;
+                this->initBroadcastTxSocket(this->txInterfaceName, this->txUdpPort);
+            }
+            if (enable)
+            {
+                struct sock_txtime txtime;
+                txtime.clockid = clockId;
+                txtime.flags = SOF_TXTIME_REPORT_ERRORS | (deadlineMode ? SOF_TXTIME_DEADLINE_MODE : 0);
+                rv = setsockopt(this->txSocket, SOL_SOCKET, SO_TXTIME, (const void *)&txtime, sizeof(txtime));
+                if (rv != 0)
+                {
+                    perror("");
+                    this->debug("Could not set SO_TXTIME sockopt\n");
+                }
+            }
+            this->useTxTime = enable && (rv == 0);
+            this->txTimeOffsetNs = launchOffsetNs;
+            this->txTimeClock = clockId;
+            this->txTimeAnchored = false;
+            return (rv == 0);
+        }
+
+        // Launch time for the frame about to be sent.  The VITA timestamp is
+        // radio time, not the launch-time clock, so only its distance from
+        // the first frame's timestamp is used.  The fractional timestamp
+        // counts DAC_RATE ticks.
+        uint64_t Packetizer::getLaunchTime()
+        {
+            struct LibCyberRadio::NDR651::Vita49Header *hdr = (struct LibCyberRadio::NDR651::Vita49Header *)(this->txVec[0].iov_base);
+            uint64_t vitaNs = (uint64_t)(hdr->timeSeconds) * 1000000000ULL +
+                    ((uint64_t)(hdr->timeFracSecLSB) * 1000000000ULL) / DAC_RATE;
+            if (!this->txTimeAnchored || (vitaNs < this->txTimeBaseVitaNs))
+            {
+                struct timespec ts;
+                clock_gettime(this->txTimeClock, &ts);
+                this->txTimeBaseNs = (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+                this->txTimeBaseVitaNs = vitaNs;
+                this->txTimeAnchored = true;
+            }
+            return (uint64_t)((long long)(this->txTimeBaseNs + (vitaNs - this->txTimeBaseVitaNs)) +
+                    this->txTimeOffsetNs);
+        }
+
+        unsigned long Packetizer::getTxTimeDropCount()
+        {
+            return this->txTimeDropCount;
+        }
+
+        // Stamp the next frame with an absolute UTC time.  The integer field
+        // is marked as UTC so the radio can align the frame to its PPS.
+        void Packetizer::setTimestamp(uint32_t seconds, uint32_t fracTicks)
+        {
+            struct LibCyberRadio::NDR651::Vita49Header *hdr = (struct LibCyberRadio::NDR651::Vita49Header *)(this->txVec[0].iov_base);
+            hdr->TSI = 0x1;
+            hdr->timeSeconds = seconds + (fracTicks / DAC_RATE);
+            hdr->timeFracSecMSB = 0;
+            hdr->timeFracSecLSB = fracTicks % DAC_RATE;
+            this->timestampBaseSeconds = hdr->timeSeconds;
+            this->timestampBaseTicks = hdr->timeFracSecLSB;
+            this->timestampSampleCount = 0;
+            this->txTimeAnchored = false;
+        }
+
+        void Packetizer::setTimestamp(double utcTime)
+        {
+            double seconds = floor(utcTime);
+            uint32_t fracTicks = (uint32_t)llround((utcTime - seconds) * DAC_RATE);
+            this->setTimestamp((uint32_t)seconds, fracTicks);
+        }
+
+        double Packetizer::getTimestamp()
+        {
+            struct LibCyberRadio::NDR651::Vita49Header *hdr = (struct LibCyberRadio::NDR651::Vita49Header *)(this->txVec[0].iov_base);
+            return (double)(hdr->timeSeconds) + (double)(hdr->timeFracSecLSB) / DAC_RATE;
+        }
+
+        void Packetizer::clearTimestamp()
+        {
+            struct LibCyberRadio::NDR651::Vita49Header *hdr = (struct LibCyberRadio::NDR651::Vita49Header *)(this->txVec[0].iov_base);
+            hdr->TSI = 0;
+            hdr->timeSeconds = 0;
+            hdr->timeFracSecMSB = 0;
+            hdr->timeFracSecLSB = 0;
+            this->timestampBaseSeconds = 0;
+            this->timestampBaseTicks = 0;
+            this->timestampSampleCount = 0;
+            this->txTimeAnchored = false;
+        }
+
         void Packetizer::start()
         {
             this->debug("Starting the Packetizer\n");
@@ -85,9 +227,6 @@ namespace LibCyberRadio
         /* Private */
         void Packetizer::setVitaHeader(unsigned short streamId)
         {
-            // Determine sampleCount
-            this->fracTimestampIncrement = ((unsigned long long)(DAC_RATE) / (this->sampleRate * 2)) * (this->samplesPerFrame*2);
-
             //Vita49
             struct LibCyberRadio::NDR651::Vita49Header *hdr = (struct LibCyberRadio::NDR651::Vita49Header *)(this->txVec[0].iov_base);
             struct LibCyberRadio::NDR651::Vita49Trailer *ftr = (struct LibCyberRadio::NDR651::Vita49Trailer *)(this->txVec[2].iov_base);
@@ -105,6 +244,9 @@ namespace LibCyberRadio
             hdr->timeSeconds = 0;
             hdr->timeFracSecMSB = 0;
             hdr->timeFracSecLSB = 0;
+            this->timestampBaseSeconds = 0;
+            this->timestampBaseTicks = 0;
+            this->timestampSampleCount = 0;
             ftr->frameEnd = VEND;
         }
 
@@ -114,11 +256,19 @@ namespace LibCyberRadio
             hdr->frameCount = (hdr->frameCount + 1) % 4*(this->samplesPerFrame);
             hdr->packetCount = (hdr->packetCount + 1) % 16;
 
-            if ((hdr->timeFracSecLSB + this->fracTimestampIncrement) >= DAC_RATE)
+            // The frame period is not a whole number of ticks at every rate
+            // (rate 16), so round the elapsed time rather than adding a
+            // truncated per-frame increment.
+            if (this->sampleRate == 0)
             {
-                hdr->timeSeconds++;
+                return;
             }
-            hdr->timeFracSecLSB = (hdr->timeFracSecLSB + this->fracTimestampIncrement) % DAC_RATE;
+            this->timestampSampleCount += this->samplesPerFrame;
+            unsigned long long wholeSeconds = this->timestampSampleCount / this->sampleRate;
+            unsigned long long ticks = this->timestampBaseTicks +
+                    ((this->timestampSampleCount % this->sampleRate) * DAC_RATE + this->sampleRate / 2) / this->sampleRate;
+            hdr->timeSeconds = this->timestampBaseSeconds + wholeSeconds + ticks / DAC_RATE;
+            hdr->timeFracSecLSB = ticks % DAC_RATE;
         }
 
         void Packetizer::initBroadcastTxSocket(const std::string &txInterfaceName, unsigned short port)
@@ -206,6 +356,8 @@ namespace LibCyberRadio
                     return 25000;
                 case 13:
                     return 12500;
+                case 16:
+                    return 270833;
                 default:
                     return 0;
             }
@@ -520,6 +520,19 @@ namespace LibCyberRadio
             return false;
         }
 
+        // Radio UTC time (integer seconds, updated on the radio's PPS edge),
+        // or -1 if the query fails.
+        long RadioController::getUTC()
+        {
+            long ret = -1;
+            std::string qry = "UTC?\n";
+            if (this->sendCmd(qry) && !this->rspVec.empty())
+            {
+                ret = strtol(this->rspVec.back().c_str(), NULL, 10);
+            }
+            return ret;
+        }
+
 
     }
 }
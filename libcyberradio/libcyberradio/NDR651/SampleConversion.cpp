@@ -0,0 +1,167 @@
+/***************************************************************************
+ * \file SampleConversion.cpp
+ *
+ * \brief NDR651 sample format conversion kernels.
+ *
+ * \author DA
+ * \copyright Copyright (c) 2015-2021 CyberRadio Solutions, Inc.
+ *
+ */
+
+#include "LibCyberRadio/NDR651/SampleConversion.h"
+#include <math.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define SAMPLE_CONVERSION_X86 1
+#include <immintrin.h>
+#endif
+
+namespace LibCyberRadio
+{
+    namespace NDR651
+    {
+
+        static inline short saturateSample(float value)
+        {
+            if ( value >= 32767.0f )
+                return 32767;
+            if ( value <= -32768.0f )
+                return -32768;
+            return (short)lrintf(value);
+        }
+
+        void convertComplexFloatToShortScalar(const std::complex<float>* input,
+                short* output,
+                unsigned int numSamples,
+                float scale,
+                bool swapIQ)
+        {
+            const float* in = (const float*)input;
+            int first = swapIQ ? 1 : 0;
+            int second = swapIQ ? 0 : 1;
+            for (unsigned int sample = 0; sample < numSamples; sample++)
+            {
+                output[2 * sample] = saturateSample(in[2 * sample + first] * scale);
+                output[2 * sample + 1] = saturateSample(in[2 * sample + second] * scale);
+            }
+        }
+
+#ifdef SAMPLE_CONVERSION_X86
+        // SSE2 kernel: 4 complex samples per iteration.  Clamping happens
+        // in the float domain because out-of-range float-to-int conversion
+        // yields INT_MIN regardless of sign; the pack then saturates.
+        static void convertSse2(const std::complex<float>* input,
+                short* output,
+                unsigned int numSamples,
+                float scale,
+                bool swapIQ)
+        {
+            const float* in = (const float*)input;
+            const __m128 vscale = _mm_set1_ps(scale);
+            const __m128 vmax = _mm_set1_ps(32767.0f);
+            const __m128 vmin = _mm_set1_ps(-32768.0f);
+            unsigned int sample = 0;
+            for (; sample + 4 <= numSamples; sample += 4)
+            {
+                __m128 a = _mm_loadu_ps(in + 2 * sample);
+                __m128 b = _mm_loadu_ps(in + 2 * sample + 4);
+                if ( swapIQ )
+                {
+                    a = _mm_shuffle_ps(a, a, _MM_SHUFFLE(2, 3, 0, 1));
+                    b = _mm_shuffle_ps(b, b, _MM_SHUFFLE(2, 3, 0, 1));
+                }
+                a = _mm_min_ps(_mm_max_ps(_mm_mul_ps(a, vscale), vmin), vmax);
+                b = _mm_min_ps(_mm_max_ps(_mm_mul_ps(b, vscale), vmin), vmax);
+                __m128i packed = _mm_packs_epi32(_mm_cvtps_epi32(a), _mm_cvtps_epi32(b));
+                _mm_storeu_si128((__m128i*)(output + 2 * sample), packed);
+            }
+            if ( sample < numSamples )
+                convertComplexFloatToShortScalar(input + sample, output + 2 * sample,
+                        numSamples - sample, scale, swapIQ);
+        }
+
+        // AVX2 kernel: 8 complex samples per iteration.  The 256-bit pack
+        // works per 128-bit lane, so a cross-lane permute restores order.
+        __attribute__((target("avx2")))
+        static void convertAvx2(const std::complex<float>* input,
+                short* output,
+                unsigned int numSamples,
+                float scale,
+                bool swapIQ)
+        {
+            const float* in = (const float*)input;
+            const __m256 vscale = _mm256_set1_ps(scale);
+            const __m256 vmax = _mm256_set1_ps(32767.0f);
+            const __m256 vmin = _mm256_set1_ps(-32768.0f);
+            unsigned int sample = 0;
+            for (; sample + 8 <= numSamples; sample += 8)
+            {
+                __m256 a = _mm256_loadu_ps(in + 2 * sample);
+                __m256 b = _mm256_loadu_ps(in + 2 * sample + 8);
+                if ( swapIQ )
+                {
+                    a = _mm256_permute_ps(a, _MM_SHUFFLE(2, 3, 0, 1));
+                    b = _mm256_permute_ps(b, _MM_SHUFFLE(2, 3, 0, 1));
+                }
+                a = _mm256_min_ps(_mm256_max_ps(_mm256_mul_ps(a, vscale), vmin), vmax);
+                b = _mm256_min_ps(_mm256_max_ps(_mm256_mul_ps(b, vscale), vmin), vmax);
+                __m256i packed = _mm256_packs_epi32(_mm256_cvtps_epi32(a), _mm256_cvtps_epi32(b));
+                packed = _mm256_permute4x64_epi64(packed, _MM_SHUFFLE(3, 1, 2, 0));
+                _mm256_storeu_si256((__m256i*)(output + 2 * sample), packed);
+            }
+            if ( sample < numSamples )
+                convertSse2(input + sample, output + 2 * sample,
+                        numSamples - sample, scale, swapIQ);
+        }
+#endif
+
+        typedef void (*ConversionKernel)(const std::complex<float>*, short*,
+                unsigned int, float, bool);
+
+        // Picks the fastest kernel the CPU supports.  Called once, on first use.
+        static ConversionKernel selectKernel(std::string& name)
+        {
+#ifdef SAMPLE_CONVERSION_X86
+            __builtin_cpu_init();
+            if ( __builtin_cpu_supports("avx2") )
+            {
+                name = "avx2";
+                return convertAvx2;
+            }
+            if ( __builtin_cpu_supports("sse2") )
+            {
+                name = "sse2";
+                return convertSse2;
+            }
+#endif
+            name = "scalar";
+            return convertComplexFloatToShortScalar;
+        }
+
+        static ConversionKernel getKernel(std::string* name = NULL)
+        {
+            static std::string kernelName;
+            static const ConversionKernel kernel = selectKernel(kernelName);
+            if ( name != NULL )
+                *name = kernelName;
+            return kernel;
+        }
+
+        void convertComplexFloatToShort(const std::complex<float>* input,
+                short* output,
+                unsigned int numSamples,
+                float scale,
+                bool swapIQ)
+        {
+            getKernel()(input, output, numSamples, scale, swapIQ);
+        }
+
+        std::string getSampleConversionKernel()
+        {
+            std::string name;
+            getKernel(&name);
+            return name;
+        }
+
+    } /* namespace NDR651 */
+}
@@ -0,0 +1,201 @@
+/***************************************************************************
+ * \file StatusDemux.cpp
+ *
+ * \brief NDR651 shared DUC status receiver.
+ *
+ * \author JVM
+ * \copyright Copyright (c) 2015-2021 CyberRadio Solutions, Inc.
+ *
+ */
+
+#include "LibCyberRadio/NDR651/StatusDemux.h"
+#include <boost/bind.hpp>
+#include <iostream>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+// Number of status frames read per recvmmsg() call
+#define STATUSDEMUX_BATCH 32
+// epoll_wait() timeout, so that interrupts are honored promptly
+#define STATUSDEMUX_TIMEOUT_MS 100
+
+namespace LibCyberRadio
+{
+    namespace NDR651
+    {
+
+        StatusDemux::StatusDemux(unsigned int port, bool debug) :
+            Thread("StatusDemux", "StatusDemux"),
+            Debuggable(debug, "StatusDemux"),
+            _port(port),
+            _epfd(-1),
+            _frameCount(0),
+            _unroutedCount(0)
+        {
+            _rxFrames.resize(STATUSDEMUX_BATCH);
+            _epfd = epoll_create1(0);
+            if (_epfd < 0)
+            {
+                std::cerr << "StatusDemux: epoll_create1 failed: " << strerror(errno) << std::endl;
+            }
+            else
+            {
+                this->addPort(port);
+            }
+        }
+
+        StatusDemux::~StatusDemux()
+        {
+            if (this->isRunning())
+            {
+                this->interrupt();
+                while (this->isRunning())
+                {
+                    boost::this_thread::sleep_for(boost::chrono::milliseconds(1));
+                }
+            }
+            for (std::vector<int>::iterator it = _sockets.begin(); it != _sockets.end(); it++)
+            {
+                ::close(*it);
+            }
+            if (_epfd >= 0)
+            {
+                ::close(_epfd);
+            }
+        }
+
+        int StatusDemux::_makeSocket(unsigned int port)
+        {
+            int sockfd = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK, IPPROTO_UDP);
+            if (sockfd < 0)
+            {
+                std::cerr << "StatusDemux: error opening socket" << std::endl;
+                return -1;
+            }
+            int optval = 1;
+            setsockopt(sockfd, SOL_SOCKET, SO_REUSEADDR, (const void *)&optval, sizeof(int));
+            struct sockaddr_in serveraddr;
+            memset((char *) &serveraddr, 0, sizeof(serveraddr));
+            serveraddr.sin_family = AF_INET;
+            serveraddr.sin_addr.s_addr = htonl(INADDR_ANY);
+            serveraddr.sin_port = htons((unsigned short)port);
+            if (bind(sockfd, (struct sockaddr *) &serveraddr, sizeof(serveraddr)) < 0)
+            {
+                std::cerr << "StatusDemux: error binding port " << port << std::endl;
+                ::close(sockfd);
+                return -1;
+            }
+            return sockfd;
+        }
+
+        bool StatusDemux::addPort(unsigned int port)
+        {
+            if ((_epfd < 0) || (port == 0))
+            {
+                return false;
+            }
+            int sockfd = this->_makeSocket(port);
+            if (sockfd < 0)
+            {
+                return false;
+            }
+            struct epoll_event ev;
+            memset(&ev, 0, sizeof(ev));
+            ev.events = EPOLLIN;
+            ev.data.fd = sockfd;
+            if (epoll_ctl(_epfd, EPOLL_CTL_ADD, sockfd, &ev) < 0)
+            {
+                std::cerr << "StatusDemux: epoll_ctl failed: " << strerror(errno) << std::endl;
+                ::close(sockfd);
+                return false;
+            }
+            _sockets.push_back(sockfd);
+            this->debug("[addPort] Listening on port %u\n", port);
+            return true;
+        }
+
+        void StatusDemux::addRoute(unsigned int streamId, StatusReceiver * receiver)
+        {
+            boost::mutex::scoped_lock lock(_routeMutex);
+            _routes[streamId] = boost::bind(&StatusReceiver::processStatusFrame, receiver, _1);
+            this->debug("[addRoute] Stream %u\n", streamId);
+        }
+
+        void StatusDemux::addRoute(unsigned int streamId, UdpStatusReceiver * receiver)
+        {
+            boost::mutex::scoped_lock lock(_routeMutex);
+            _routes[streamId] = boost::bind(&UdpStatusReceiver::processStatusFrame, receiver, _1);
+            this->debug("[addRoute] Stream %u\n", streamId);
+        }
+
+        void StatusDemux::removeRoute(unsigned int streamId)
+        {
+            boost::mutex::scoped_lock lock(_routeMutex);
+            _routes.erase(streamId);
+            this->debug("[removeRoute] Stream %u\n", streamId);
+        }
+
+        void StatusDemux::_route(const struct TxStatusFrame * status)
+        {
+            _frameCount++;
+            boost::mutex::scoped_lock lock(_routeMutex);
+            std::map<unsigned int, Route>::iterator it = _routes.find(status->v49.streamId);
+            if (it != _routes.end())
+            {
+                it->second(status);
+            }
+            else
+            {
+                _unroutedCount++;
+            }
+        }
+
+        void StatusDemux::run()
+        {
+            struct epoll_event events[8];
+            struct mmsghdr msgs[STATUSDEMUX_BATCH];
+            struct iovec iovecs[STATUSDEMUX_BATCH];
+            memset(msgs, 0, sizeof(msgs));
+            for (int i = 0; i < STATUSDEMUX_BATCH; i++)
+            {
+                iovecs[i].iov_base = &_rxFrames[i];
+                iovecs[i].iov_len = sizeof(struct TxStatusFrame);
+                msgs[i].msg_hdr.msg_iov = &iovecs[i];
+                msgs[i].msg_hdr.msg_iovlen = 1;
+            }
+            while (true)
+            {
+                boost::this_thread::interruption_point();
+                int numEvents = epoll_wait(_epfd, events, 8, STATUSDEMUX_TIMEOUT_MS);
+                for (int e = 0; e < numEvents; e++)
+                {
+                    // Drain the socket; it is non-blocking, so this stops
+                    // when no more frames are queued.
+                    int numMsgs;
+                    do
+                    {
+                        numMsgs = recvmmsg(events[e].data.fd, msgs, STATUSDEMUX_BATCH, 0, NULL);
+                        for (int i = 0; i < numMsgs; i++)
+                        {
+                            // Anything else on the port is not a DUCHS frame.
+                            // A longer datagram is cut to the buffer size, so
+                            // only its truncation flag tells it apart.
+                            if ((msgs[i].msg_len == sizeof(struct TxStatusFrame)) &&
+                                    !(msgs[i].msg_hdr.msg_flags & MSG_TRUNC))
+                            {
+                                this->_route(&_rxFrames[i]);
+                            }
+                        }
+                    } while (numMsgs == STATUSDEMUX_BATCH);
+                }
+            }
+        }
+
+    } /* namespace NDR651 */
+}
@@ -30,14 +30,18 @@ namespace LibCyberRadio {
             LibCyberRadio::Thread("StatusReceiver", "StatusReceiver"),
             LibCyberRadio::Debuggable(debug, "StatusReceiver"),
             _sockfd(-1),
-            _shutdown(false),
-            _651freeSpace(0), // 2^26 - 2^18
             _sendLock(false),
+            _shutdown(false),
+            _updatePE(updatePE),
             _ifname(ifname),
             _port(port),
-            _updatePE(updatePE),
+            timeoutCount(0),
+            _651freeSpace(0), // 2^26 - 2^18
             _freeSpaceMax(MAX_RADIO_BUFFSIZE - RADIO_BUFFER_RESERVE),
-            timeoutCount(0)
+            _targetOccupancy(MAX_RADIO_BUFFSIZE),
+            _bufferOccupancy(0),
+            _lastUnderrunCounter(-1),
+            _underrunCount(0)
         {
             // TODO Auto-generated constructor stub
             bzero(&_rxbuff, MAX_RX_SIZE);
@@ -152,15 +156,38 @@ namespace LibCyberRadio {
             return _freeSpaceMax;
         }
 
+        int StatusReceiver::setTargetOccupancy(int samples) {
+            boost::mutex::scoped_lock lock(this->objectAccessMutex);
+            _targetOccupancy = std::max( 0, std::min( MAX_RADIO_BUFFSIZE, samples ) );
+            return _targetOccupancy;
+        }
+
+        int StatusReceiver::getBufferOccupancy(void) {
+            boost::mutex::scoped_lock lock(this->objectAccessMutex);
+            return _bufferOccupancy;
+        }
+
+        unsigned long long StatusReceiver::getUnderrunCount(void) {
+            boost::mutex::scoped_lock lock(this->objectAccessMutex);
+            return _underrunCount;
+        }
+
+        void StatusReceiver::_updateUnderruns(int underrunCounter) {
+            boost::mutex::scoped_lock lock(this->objectAccessMutex);
+            // The first update only establishes the baseline
+            if (_lastUnderrunCounter >= 0) {
+                _underrunCount += (underrunCounter - _lastUnderrunCounter) & 0x7f;
+            }
+            _lastUnderrunCounter = underrunCounter;
+        }
+
         void StatusReceiver::run() {
             std::cout << "StatusReceiver::run() " << _651freeSpace << std::endl;
             struct timespec spec;
             struct timeval tout;
             struct sockaddr_in clientaddr; /* client addr */
             socklen_t clientlen = sizeof(clientaddr); /* byte size of client's address */
-            struct TxStatusFrame * status;
             int numBytesRx;
-            long int oldFreeSpace = 0;
             while(this->isRunning() && (!_shutdown)) {
                 tout.tv_sec = (long int) 0;
                 tout.tv_usec = (long int) 500000;
@@ -171,58 +198,15 @@ namespace LibCyberRadio {
                     numBytesRx = recvfrom(_sockfd, _rxbuff, MAX_RX_SIZE, 0, (struct sockaddr *) &clientaddr, &clientlen);
                     //std::cout << "# Bytes Rx = " << numBytesRx << std::endl;
                     if (numBytesRx==sizeof(TxStatusFrame)) {
-                        status = (struct TxStatusFrame *)_rxbuff;
-                        oldFreeSpace = _651freeSpace;
-                        if ((bool)status->status.PE||(bool)status->status.PF) {
-                            std::cout << "DUCHS FRAME (" << status->v49.streamId << "): PEF = " << status->status.PP << status->status.PE << status->status.PF;
-                            std::cout << ", Free Space = " << status->status.spaceAvailable << " samples";
-                            std::cout << std::endl;
-                        }
-                        if ( this->_setFreeSpace( status->status.spaceAvailable, (bool)status->status.PP, (bool)status->status.PE, (bool)status->status.PF ) ) {
-                            if (status->status.PE) {
-                                std::cout << "Free space = " << oldFreeSpace << "->" << _651freeSpace << "?" << status->status.spaceAvailable << " [" << _freeSpaceMax << "]";
-                                std::cout << " (" << status->status.PP << status->status.PE << status->status.PF << "), ";
-                                std::cout << "@ time = " << status->v49.timeSeconds << " " << status->v49.timeFracSecMSB << " " << status->v49.timeFracSecLSB << std::endl;
-                            }
-                        }
-                        if (status->status.emptyFlag||status->status.underrunFlag||status->status.overrunFlag||status->status.packetLossFlag) {
-                            //~ if (status->status.emptyFlag||status->status.underrunFlag||status->status.overrunFlag) {
-                            std::cerr << "<" << status->v49.streamId << "@" << status->v49.timeSeconds << "." << status->v49.timeFracSecLSB << ":";
-                            if (status->status.PP) {
-                                std::cerr << "P";
-                            }
-                            if (status->status.PE) {
-                                std::cerr << "E";
-                            }
-                            if (status->status.PF) {
-                                std::cerr << "F";
-                            }
-                            std::cerr << "(" << ( status->status.spaceAvailable-67108862 ) << ")";
-                            if (status->status.emptyFlag) {
-                                std::cerr << "_e";
-                            }
-                            if (status->status.underrunFlag) {
-                                std::cerr << "_u" << status->status.underrunCount;
-                            }
-                            if (status->status.overrunFlag) {
-                                std::cerr << "_o" << status->status.overrunCount;
-                            }
-                            if (status->status.packetLossFlag) {
-                                std::cerr << "_p" << status->status.packetLossCount;
-                            }
-                            std::cerr << "> " << std::endl;
-                        }
-                        //~ else if (status->status.PF) {
-                        //~ std::cout << "\tFree space notification = " << status->status.spaceAvailable << ", current = " << _651freeSpace;
-                        //~ std::cout << "@ time = " << status->v49.timeSeconds << " " << status->v49.timeFracSecMSB << " " << status->v49.timeFracSecLSB << std::endl;
-                        //~ }
+                        this->processStatusFrame( (struct TxStatusFrame *)_rxbuff );
                     }
                 } else {
                     timeoutCount += 1;
                     //~ this->debug("Timeout\n");
                     //~ usleep(1000);
                 }
-                this->sleep(2e-6);
+                // select() already blocks; just honor interrupts here
+                boost::this_thread::interruption_point();
             }
         }
 
@@ -235,12 +219,77 @@ namespace LibCyberRadio {
             }
         }
 
+        bool StatusReceiver::blockUntilAvailable(unsigned int numSamples, double timeout)
+        {
+            boost::mutex::scoped_lock lock(this->objectAccessMutex);
+            boost::chrono::steady_clock::time_point deadline = boost::chrono::steady_clock::now() +
+                    boost::chrono::microseconds((long long)(timeout * 1e6));
+            while (!this->okToSend(numSamples, false))
+            {
+                if (this->waitCondition.wait_until(lock, deadline) == boost::cv_status::timeout)
+                {
+                    return this->okToSend(numSamples, false);
+                }
+            }
+            return true;
+        }
+
+        void StatusReceiver::processStatusFrame(const struct TxStatusFrame * status) {
+            long int oldFreeSpace = _651freeSpace;
+            this->_updateUnderruns( status->status.underrunCount );
+            if ((bool)status->status.PE||(bool)status->status.PF) {
+                std::cout << "DUCHS FRAME (" << status->v49.streamId << "): PEF = " << status->status.PP << status->status.PE << status->status.PF;
+                std::cout << ", Free Space = " << status->status.spaceAvailable << " samples";
+                std::cout << std::endl;
+            }
+            if ( this->_setFreeSpace( status->status.spaceAvailable, (bool)status->status.PP, (bool)status->status.PE, (bool)status->status.PF ) ) {
+                if (status->status.PE) {
+                    std::cout << "Free space = " << oldFreeSpace << "->" << _651freeSpace << "?" << status->status.spaceAvailable << " [" << _freeSpaceMax << "]";
+                    std::cout << " (" << status->status.PP << status->status.PE << status->status.PF << "), ";
+                    std::cout << "@ time = " << status->v49.timeSeconds << " " << status->v49.timeFracSecMSB << " " << status->v49.timeFracSecLSB << std::endl;
+                }
+            }
+            if (status->status.emptyFlag||status->status.underrunFlag||status->status.overrunFlag||status->status.packetLossFlag) {
+                //~ if (status->status.emptyFlag||status->status.underrunFlag||status->status.overrunFlag) {
+                std::cerr << "<" << status->v49.streamId << "@" << status->v49.timeSeconds << "." << status->v49.timeFracSecLSB << ":";
+                if (status->status.PP) {
+                    std::cerr << "P";
+                }
+                if (status->status.PE) {
+                    std::cerr << "E";
+                }
+                if (status->status.PF) {
+                    std::cerr << "F";
+                }
+                std::cerr << "(" << ( status->status.spaceAvailable-67108862 ) << ")";
+                if (status->status.emptyFlag) {
+                    std::cerr << "_e";
+                }
+                if (status->status.underrunFlag) {
+                    std::cerr << "_u" << status->status.underrunCount;
+                }
+                if (status->status.overrunFlag) {
+                    std::cerr << "_o" << status->status.overrunCount;
+                }
+                if (status->status.packetLossFlag) {
+                    std::cerr << "_p" << status->status.packetLossCount;
+                }
+                std::cerr << "> " << std::endl;
+            }
+            //~ else if (status->status.PF) {
+            //~ std::cout << "\tFree space notification = " << status->status.spaceAvailable << ", current = " << _651freeSpace;
+            //~ std::cout << "@ time = " << status->v49.timeSeconds << " " << status->v49.timeFracSecMSB << " " << status->v49.timeFracSecLSB << std::endl;
+            //~ }
+        }
+
         bool StatusReceiver::_setFreeSpace(int updateFromRadio, bool flagPP, bool flagPE, bool flagPF) {
 
             boost::mutex::scoped_lock lock(this->objectAccessMutex);
             bool updated = false;
+            _bufferOccupancy = MAX_RADIO_BUFFSIZE - updateFromRadio;
             if (((!_updatePE)&&flagPP)||(_updatePE&&flagPE)) {
                 _651freeSpace = std::min( _freeSpaceMax, updateFromRadio - RADIO_BUFFER_RESERVE );
+                _651freeSpace = std::min( _651freeSpace, _targetOccupancy - _bufferOccupancy );
                 updated = true;
             }
             this->waitCondition.notify_one();
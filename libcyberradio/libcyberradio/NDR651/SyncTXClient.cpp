@@ -14,7 +14,17 @@ namespace LibCyberRadio
             hostname(hostname),
             ducGroup(1),
             rc(NULL),
-            isRunning(false)
+            isRunning(false),
+            parallelSend(true),
+            sendersRunning(false),
+            sendGeneration(0),
+            sendsOutstanding(0),
+            pendingFrames(NULL),
+            pendingSamplesPerFrame(0),
+            stallThreshold(0.001),
+            framesSent(0),
+            skewTotal(0.0),
+            skewMax(0.0)
         {
             // Put the TXClient objects in grouped mode
             for (int i = 0; i < this->txClients.size(); i++)
@@ -23,10 +33,14 @@ namespace LibCyberRadio
             }
             // Create a radio controller (sends cmds to 651)
             this->rc = new RadioController(this->hostname, 8617, debug);
+            this->sendDoneTime.resize(this->txClients.size());
+            this->clientStallCount.assign(this->txClients.size(), 0);
+            this->clientSendTime.assign(this->txClients.size(), 0.0);
         }
 
         SyncTXClient::~SyncTXClient()
         {
+            this->stopSenders();
             if (this->rc != NULL)
             {
                 delete this->rc;
@@ -79,6 +93,10 @@ namespace LibCyberRadio
                 this->txClients[i]->start();
             }
             this->waitingToEnableDUCGE = true;
+            if (this->parallelSend && (this->txClients.size() > 1))
+            {
+                this->startSenders();
+            }
         }
 
         // Stops transmission to radio
@@ -86,6 +104,8 @@ namespace LibCyberRadio
         {
             if (this->isRunning)
             {
+                // Senders must be gone before the clients they use stop
+                this->stopSenders();
                 this->rc->setDUCGE(ducGroup, false);
                 for (int i = 0; i < this->txClients.size(); i++)
                 {
@@ -154,10 +174,44 @@ namespace LibCyberRadio
             
             // -- Call send frame on each client.  This will either pre-fill
             //    the buffer if paused, or send the data if not.
-            for (int i = 0; i < this->txClients.size(); i++)
+            boost::mutex::scoped_lock lock(this->sendMutex);
+            if (this->sendersRunning)
+            {
+                // Hand the frames to the sender threads and wait until
+                // every client has sent (the per-frame barrier).
+                this->pendingFrames = frames;
+                this->pendingSamplesPerFrame = samplesPerFrame;
+                this->sendsOutstanding = this->txClients.size();
+                this->sendGeneration++;
+                this->sendCond.notify_all();
+                while (this->sendersRunning && (this->sendsOutstanding > 0))
+                {
+                    this->doneCond.wait(lock);
+                }
+                if (this->sendsOutstanding == 0)
+                {
+                    this->updateStats();
+                }
+            }
+            else
             {
-                this->txClients[i]->sendFrame(frames[i], samplesPerFrame);
+                lock.unlock();
+                for (int i = 0; i < this->txClients.size(); i++)
+                {
+                    boost::chrono::high_resolution_clock::time_point t0 =
+                            boost::chrono::high_resolution_clock::now();
+                    this->txClients[i]->sendFrame(frames[i], samplesPerFrame);
+                    boost::chrono::high_resolution_clock::time_point t1 =
+                            boost::chrono::high_resolution_clock::now();
+                    lock.lock();
+                    this->sendDoneTime[i] = t1;
+                    this->clientSendTime[i] += boost::chrono::duration<double>(t1 - t0).count();
+                    lock.unlock();
+                }
+                lock.lock();
+                this->updateStats();
             }
+            lock.unlock();
             
             // -- Proceed only if we had DUCs "in pause" waiting for pre-filling
             if (anyDucsInPause) {
@@ -205,5 +259,172 @@ namespace LibCyberRadio
             return(this->ducGroup);
         }
 
+        bool SyncTXClient::setParallelSend(bool parallel)
+        {
+            bool ret = false;
+            if (!this->isRunning)
+            {
+                this->parallelSend = parallel;
+                ret = true;
+            }
+            return ret;
+        }
+
+        bool SyncTXClient::isParallelSend()
+        {
+            return this->parallelSend;
+        }
+
+        void SyncTXClient::startSenders()
+        {
+            this->debug("[startSenders] Starting %u sender threads\n", (unsigned int)this->txClients.size());
+            {
+                boost::mutex::scoped_lock lock(this->sendMutex);
+                this->sendersRunning = true;
+                this->sendsOutstanding = 0;
+            }
+            for (unsigned int i = 0; i < this->txClients.size(); i++)
+            {
+                this->senderThreads.create_thread(boost::bind(&SyncTXClient::senderLoop, this, i));
+            }
+        }
+
+        void SyncTXClient::stopSenders()
+        {
+            {
+                boost::mutex::scoped_lock lock(this->sendMutex);
+                if (!this->sendersRunning)
+                {
+                    return;
+                }
+                this->sendersRunning = false;
+                this->sendCond.notify_all();
+                this->doneCond.notify_all();
+            }
+            // A sender may be blocked waiting on flow control; the
+            // interrupt breaks it out of that wait.
+            this->senderThreads.interrupt_all();
+            this->senderThreads.join_all();
+            this->debug("[stopSenders] Sender threads stopped\n");
+        }
+
+        void SyncTXClient::senderLoop(unsigned int client)
+        {
+            unsigned long long generation = 0;
+            short *frame = NULL;
+            unsigned int samplesPerFrame = 0;
+            try
+            {
+                while (true)
+                {
+                    {
+                        boost::mutex::scoped_lock lock(this->sendMutex);
+                        while (this->sendersRunning && (this->sendGeneration == generation))
+                        {
+                            this->sendCond.wait(lock);
+                        }
+                        if (!this->sendersRunning)
+                        {
+                            return;
+                        }
+                        generation = this->sendGeneration;
+                        frame = this->pendingFrames[client];
+                        samplesPerFrame = this->pendingSamplesPerFrame;
+                    }
+                    boost::chrono::high_resolution_clock::time_point t0 =
+                            boost::chrono::high_resolution_clock::now();
+                    this->txClients[client]->sendFrame(frame, samplesPerFrame);
+                    boost::chrono::high_resolution_clock::time_point t1 =
+                            boost::chrono::high_resolution_clock::now();
+                    {
+                        boost::mutex::scoped_lock lock(this->sendMutex);
+                        this->sendDoneTime[client] = t1;
+                        this->clientSendTime[client] += boost::chrono::duration<double>(t1 - t0).count();
+                        if (--this->sendsOutstanding == 0)
+                        {
+                            this->doneCond.notify_one();
+                        }
+                    }
+                }
+            }
+            catch (boost::thread_interrupted&)
+            {
+            }
+        }
+
+        // Called with every client's send for the current frame complete
+        void SyncTXClient::updateStats()
+        {
+            if (this->txClients.empty())
+            {
+                return;
+            }
+            unsigned int first = 0, last = 0;
+            for (unsigned int i = 1; i < this->txClients.size(); i++)
+            {
+                if (this->sendDoneTime[i] < this->sendDoneTime[first])
+                    first = i;
+                if (this->sendDoneTime[i] > this->sendDoneTime[last])
+                    last = i;
+            }
+            double skew = boost::chrono::duration<double>(this->sendDoneTime[last] - this->sendDoneTime[first]).count();
+            this->framesSent++;
+            this->skewTotal += skew;
+            if (skew > this->skewMax)
+            {
+                this->skewMax = skew;
+            }
+            if (skew > this->stallThreshold)
+            {
+                this->clientStallCount[last]++;
+            }
+        }
+
+        void SyncTXClient::setStallThreshold(double seconds)
+        {
+            boost::mutex::scoped_lock lock(this->sendMutex);
+            this->stallThreshold = seconds;
+        }
+
+        unsigned long long SyncTXClient::getFramesSent()
+        {
+            boost::mutex::scoped_lock lock(this->sendMutex);
+            return this->framesSent;
+        }
+
+        double SyncTXClient::getSkewMean()
+        {
+            boost::mutex::scoped_lock lock(this->sendMutex);
+            return (this->framesSent > 0) ? (this->skewTotal / this->framesSent) : 0.0;
+        }
+
+        double SyncTXClient::getSkewMax()
+        {
+            boost::mutex::scoped_lock lock(this->sendMutex);
+            return this->skewMax;
+        }
+
+        unsigned long long SyncTXClient::getStallCount(unsigned int client)
+        {
+            boost::mutex::scoped_lock lock(this->sendMutex);
+            return (client < this->clientStallCount.size()) ? this->clientStallCount[client] : 0;
+        }
+
+        double SyncTXClient::getSendTime(unsigned int client)
+        {
+            boost::mutex::scoped_lock lock(this->sendMutex);
+            return (client < this->clientSendTime.size()) ? this->clientSendTime[client] : 0.0;
+        }
+
+        void SyncTXClient::resetStats()
+        {
+            boost::mutex::scoped_lock lock(this->sendMutex);
+            this->framesSent = 0;
+            this->skewTotal = 0.0;
+            this->skewMax = 0.0;
+            this->clientStallCount.assign(this->txClients.size(), 0);
+            this->clientSendTime.assign(this->txClients.size(), 0.0);
+        }
+
     }
 }
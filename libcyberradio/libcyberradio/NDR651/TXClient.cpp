@@ -1,4 +1,12 @@
 #include "LibCyberRadio/NDR651/TXClient.h"
+#include "LibCyberRadio/NDR651/TransmitPacketizer.h"
+#include <boost/chrono.hpp>
+
+// Adaptive prefill tuning
+#define ADAPTIVE_MIN_MARGIN 1.5       // Target latency / required latency when no underruns occur
+#define ADAPTIVE_MAX_MARGIN 16.0      // Upper limit on underrun back-off
+#define ADAPTIVE_PEAK_HALF_LIFE 10.0  // Seconds for the producer jitter peak to decay by half
+#define ADAPTIVE_QUIET_PERIOD 30.0    // Underrun-free seconds before the margin eases back
 
 namespace LibCyberRadio
 {
@@ -25,13 +33,40 @@ namespace LibCyberRadio
             // Internals
             packetizer(NULL),
             statusRX(NULL),
+            statusDemux(NULL),
             rc(NULL),
             txSock(0),
             isGrouped(false),
             isRunning(false),
             DUCPaused(true),
             DUCReady(false),
-            prefillSampleCount(0L)
+            prefillSampleCount(0L),
+            asyncMode(false),
+            asyncQueueDepth(64),
+            asyncMaxSamplesPerFrame(SAMPLES_PER_FRAME),
+            asyncSenderCpu(-1),
+            readyQueue(NULL),
+            freeQueue(NULL),
+            senderRunning(false),
+            senderWaiting(false),
+            producerWaiting(false),
+            producersActive(0),
+            unsentFrameCount(0),
+            enqueueWaitCount(0),
+            enqueueWaitNs(0),
+            enqueueWaitMaxNs(0),
+            radioTimeOffset(0),
+            adaptiveMode(false),
+            adaptiveMinLatency(0.005),
+            adaptiveMaxLatency(0.5),
+            targetLatency(0.0),
+            producerDebt(0.0),
+            producerDebtPeak(0.0),
+            producerPeakDecay(1.0),
+            producerDecayFrameSize(0),
+            underrunMargin(ADAPTIVE_MIN_MARGIN),
+            lastUnderrunCount(0),
+            haveLastSend(false)
         {
             // Create a radio controller (sends cmds to 651)
             this->rc = new RadioController(radioHostName, 8617, debug);
@@ -39,12 +74,17 @@ namespace LibCyberRadio
 
         TXClient::~TXClient()
         {
+            this->stopSender();
             if (this->rc != NULL)
             {
                 delete this->rc;
             }
             if (this->statusRX != NULL)
             {
+                if (this->statusDemux != NULL)
+                {
+                    this->statusDemux->removeRoute(this->txUdpPort);
+                }
                 delete this->statusRX;
             }
             if (this->packetizer != NULL)
@@ -356,13 +396,33 @@ namespace LibCyberRadio
 
             // Prefill 50% of DUC buffer before enabling DUC
             this->prefillSampleCount = ((unsigned int )(0.50 * 67108860)) - ((unsigned int )(0.50 * 67108860)%4);
+            if (this->adaptiveMode)
+            {
+                // Start from the flow-control update period; the target grows
+                // from there if the producer proves bursty.
+                this->producerDebt = 0.0;
+                this->producerDebtPeak = 0.0;
+                this->underrunMargin = ADAPTIVE_MIN_MARGIN;
+                this->lastUnderrunCount = 0;
+                this->haveLastSend = false;
+                this->lastMarginChange = boost::chrono::high_resolution_clock::now();
+                this->targetLatency = std::min(this->adaptiveMaxLatency, std::max(this->adaptiveMinLatency,
+                        ADAPTIVE_MIN_MARGIN / this->updatesPerSecond));
+                long prefill = (long)(this->targetLatency * this->getDUCSampleRate());
+                this->prefillSampleCount = std::max(prefill - (prefill % 4), 4L);
+                this->debug("[start] Adaptive prefill: %ld samples (%f s)\n",
+                        this->prefillSampleCount, this->targetLatency);
+            }
 
             // Create a Packetizer (wraps samples in Vita Frames and sends them)
             this->packetizer = new Packetizer(this->txInterfaceName, this->txUdpPort, this->ducRateIndex, this->debugOn);
             this->packetizer->start(); // Inits the TX socket, prepares vita headers
 
-            // Create the status receiver for radio flow control notifications
-            this->statusRX = new StatusReceiver(this->txInterfaceName, UDP_STATUS_BASE + this->ducChannel, this->debugOn, false);
+            // Create the status receiver for radio flow control notifications.
+            // With a shared demux it opens no socket of its own.
+            this->statusRX = new StatusReceiver(this->txInterfaceName,
+                    (this->statusDemux != NULL) ? 0 : UDP_STATUS_BASE + this->ducChannel,
+                    this->debugOn, false);
             std::ostringstream statusRxName;
             statusRxName << "StatusRx" << this->txUdpPort;
             this->statusRX->setName(statusRxName.str());
@@ -404,16 +464,36 @@ namespace LibCyberRadio
                     this->tenGbeIndex,
                     this->getSourceIP(),
                     this->getSourceMac(),
-                    this->statusRX->getUdpPort()
+                    (this->statusDemux != NULL) ? this->statusDemux->getUdpPort() : this->statusRX->getUdpPort()
             );
 
             // Start listening for flow control from the radio.
-            this->statusRX->start();
+            if (this->adaptiveMode)
+            {
+                this->applyTargetLatency();
+            }
+            if (this->statusDemux != NULL)
+            {
+                this->statusDemux->addRoute(this->txUdpPort, this->statusRX);
+            }
+            else
+            {
+                this->statusRX->start();
+            }
+
+            // Start the sender thread if running asynchronously
+            if (this->asyncMode)
+            {
+                this->startSender();
+            }
             this->debug("[start] Returning");
         }
 
         void TXClient::stop(bool disableRF)
         {
+            // The sender thread uses the packetizer and status receiver,
+            // so it must be gone before either is deleted.
+            this->stopSender();
             if (this->isRunning)
             {
                 this->debug("Stopping Transmit Client\n");
@@ -434,12 +514,107 @@ namespace LibCyberRadio
             // Delete the status receiver, which will be re-init at next call to start()
             if (this->statusRX != NULL)
             {
+                if (this->statusDemux != NULL)
+                {
+                    this->statusDemux->removeRoute(this->txUdpPort);
+                }
                 delete this->statusRX;
                 this->statusRX = NULL;
             }
         }
 
+        void TXClient::setStatusDemux(StatusDemux * demux)
+        {
+            if (this->isRunning)
+            {
+                this->debug("[setStatusDemux] Cannot change status receiver while running\n");
+                return;
+            }
+            this->statusDemux = demux;
+        }
+
         void TXClient::sendFrame(short * samples, unsigned int samplesPerFrame)
+        {
+            if (this->adaptiveMode && this->isRunning)
+            {
+                this->updateAdaptiveTarget(samplesPerFrame);
+            }
+            if (this->asyncMode && this->senderRunning)
+            {
+                if (samplesPerFrame > this->asyncMaxSamplesPerFrame)
+                {
+                    this->debug("WARNING: Frame larger than async pool frame size\n");
+                    return;
+                }
+                // stopSender() frees the queues only once no producer is
+                // inside this block
+                this->producersActive++;
+                if (this->senderRunning)
+                {
+                    this->enqueueFrame(samples, samplesPerFrame);
+                }
+                this->producersActive--;
+            }
+            else
+            {
+                this->sendFrameSync(samples, samplesPerFrame);
+            }
+            if (this->adaptiveMode)
+            {
+                this->lastSendExit = boost::chrono::high_resolution_clock::now();
+            }
+        }
+
+        void TXClient::enqueueFrame(short * samples, unsigned int samplesPerFrame)
+        {
+            // Get a free frame from the pool, sleeping until the sender
+            // thread returns one if the queue is full.
+            unsigned int slot;
+            if (!this->freeQueue->pop(slot))
+            {
+                boost::chrono::high_resolution_clock::time_point waitStart =
+                        boost::chrono::high_resolution_clock::now();
+                {
+                    boost::mutex::scoped_lock lock(this->senderMutex);
+                    this->producerWaiting = true;
+                    boost::atomic_thread_fence(boost::memory_order_seq_cst);
+                    while (!this->freeQueue->pop(slot))
+                    {
+                        if (!this->senderRunning)
+                        {
+                            this->producerWaiting = false;
+                            return;
+                        }
+                        this->frameFree.wait(lock);
+                    }
+                    this->producerWaiting = false;
+                }
+                unsigned long long waitNs = boost::chrono::duration_cast<boost::chrono::nanoseconds>(
+                        boost::chrono::high_resolution_clock::now() - waitStart).count();
+                this->enqueueWaitCount++;
+                this->enqueueWaitNs += waitNs;
+                if (waitNs > this->enqueueWaitMaxNs)
+                {
+                    this->enqueueWaitMaxNs = waitNs;
+                }
+            }
+            memcpy(&this->asyncFramePool[slot * 2 * this->asyncMaxSamplesPerFrame],
+                    samples, 4 * samplesPerFrame);
+            this->asyncFrameSamples[slot] = samplesPerFrame;
+            this->readyQueue->push(slot);
+            // Pairs with the fence the sender takes before it sleeps: either
+            // it sees this frame, or this sees it waiting
+            boost::atomic_thread_fence(boost::memory_order_seq_cst);
+            if (this->senderWaiting)
+            {
+                {
+                    boost::mutex::scoped_lock lock(this->senderMutex);
+                }
+                this->frameReady.notify_one();
+            }
+        }
+
+        void TXClient::sendFrameSync(short * samples, unsigned int samplesPerFrame)
         {
 
             if (this->isRunning)
@@ -488,6 +663,476 @@ namespace LibCyberRadio
             }
         }
 
+        /********* ASYNCHRONOUS TRANSMIT **********/
+        bool TXClient::setAsyncMode(bool async, unsigned int queueDepth, int senderCpu,
+                unsigned int maxSamplesPerFrame)
+        {
+            this->debug("[setAsyncMode] Called\n");
+            this->debug("[setAsyncMode] -- async = %s, queueDepth = %u, senderCpu = %d\n",
+                    debugBool(async), queueDepth, senderCpu);
+            bool ret = false;
+            if (!this->isRunning && (queueDepth > 0) && (maxSamplesPerFrame > 0))
+            {
+                this->asyncMode = async;
+                this->asyncQueueDepth = queueDepth;
+                this->asyncSenderCpu = senderCpu;
+                this->asyncMaxSamplesPerFrame = maxSamplesPerFrame;
+                ret = true;
+            }
+            this->debug("[setAsyncMode] Returning %s\n", debugBool(ret));
+            return ret;
+        }
+
+        bool TXClient::isAsyncMode()
+        {
+            return this->asyncMode;
+        }
+
+        unsigned int TXClient::getQueueDepth()
+        {
+            return (this->readyQueue != NULL) ? this->readyQueue->read_available() : 0;
+        }
+
+        unsigned int TXClient::getQueueCapacity()
+        {
+            return this->asyncQueueDepth;
+        }
+
+        unsigned long long TXClient::getEnqueueWaitCount()
+        {
+            return this->enqueueWaitCount;
+        }
+
+        double TXClient::getEnqueueWaitTime()
+        {
+            return this->enqueueWaitNs * 1e-9;
+        }
+
+        double TXClient::getEnqueueWaitMax()
+        {
+            return this->enqueueWaitMaxNs * 1e-9;
+        }
+
+        unsigned long long TXClient::getUnsentFrameCount()
+        {
+            return this->unsentFrameCount;
+        }
+
+        void TXClient::resetQueueStats()
+        {
+            this->enqueueWaitCount = 0;
+            this->enqueueWaitNs = 0;
+            this->enqueueWaitMaxNs = 0;
+        }
+
+        void TXClient::startSender()
+        {
+            this->debug("[startSender] Starting sender thread\n");
+            // Preallocate the frame pool; every slot starts out free.
+            this->asyncFramePool.assign(this->asyncQueueDepth * 2 * this->asyncMaxSamplesPerFrame, 0);
+            this->asyncFrameSamples.assign(this->asyncQueueDepth, 0);
+            this->readyQueue = new boost::lockfree::spsc_queue<unsigned int>(this->asyncQueueDepth);
+            this->freeQueue = new boost::lockfree::spsc_queue<unsigned int>(this->asyncQueueDepth);
+            for (unsigned int slot = 0; slot < this->asyncQueueDepth; slot++)
+            {
+                this->freeQueue->push(slot);
+            }
+            this->resetQueueStats();
+            this->senderRunning = true;
+            this->senderThread = boost::thread(&TXClient::senderLoop, this);
+            std::ostringstream senderName;
+            senderName << "TXSender" << this->txUdpPort;
+            pthread_setname_np(this->senderThread.native_handle(), senderName.str().c_str());
+        }
+
+        void TXClient::stopSender()
+        {
+            if (this->senderThread.joinable())
+            {
+                this->debug("[stopSender] Stopping sender thread\n");
+                {
+                    boost::mutex::scoped_lock lock(this->senderMutex);
+                    this->senderRunning = false;
+                }
+                this->frameReady.notify_all();
+                this->frameFree.notify_all();
+                // The sender sends what is already queued before it exits;
+                // give up on the rest if flow control holds it up
+                if (!this->senderThread.try_join_for(boost::chrono::seconds(1)))
+                {
+                    this->senderThread.interrupt();
+                    this->senderThread.join();
+                }
+            }
+            this->senderRunning = false;
+            // A producer that saw the sender running may still be using the
+            // queues; with the sender gone, it cannot wait for long
+            while (this->producersActive > 0)
+            {
+                this->frameFree.notify_all();
+                boost::this_thread::yield();
+            }
+            if ((this->readyQueue != NULL) && (this->readyQueue->read_available() > 0))
+            {
+                unsigned int unsent = this->readyQueue->read_available();
+                this->unsentFrameCount += unsent;
+                std::cerr << "TXClient: " << unsent << " queued frames were not sent" << std::endl;
+            }
+            if (this->readyQueue != NULL)
+            {
+                delete this->readyQueue;
+                this->readyQueue = NULL;
+            }
+            if (this->freeQueue != NULL)
+            {
+                delete this->freeQueue;
+                this->freeQueue = NULL;
+            }
+        }
+
+        void TXClient::senderLoop()
+        {
+            if ((this->asyncSenderCpu >= 0) && !setCpuAffinity(this->asyncSenderCpu))
+            {
+                std::cerr << "TXClient: could not pin sender thread to CPU " << this->asyncSenderCpu << std::endl;
+            }
+            unsigned int slot;
+            try
+            {
+                while (true)
+                {
+                    if (!this->readyQueue->pop(slot))
+                    {
+                        // Sleep until a frame is queued; once stopped, exit
+                        // only after the queue is drained
+                        boost::mutex::scoped_lock lock(this->senderMutex);
+                        this->senderWaiting = true;
+                        boost::atomic_thread_fence(boost::memory_order_seq_cst);
+                        while (!this->readyQueue->pop(slot))
+                        {
+                            if (!this->senderRunning)
+                            {
+                                this->senderWaiting = false;
+                                return;
+                            }
+                            this->frameReady.wait(lock);
+                        }
+                        this->senderWaiting = false;
+                    }
+                    this->sendFrameSync(&this->asyncFramePool[slot * 2 * this->asyncMaxSamplesPerFrame],
+                            this->asyncFrameSamples[slot]);
+                    this->freeQueue->push(slot);
+                    boost::atomic_thread_fence(boost::memory_order_seq_cst);
+                    if (this->producerWaiting)
+                    {
+                        {
+                            boost::mutex::scoped_lock lock(this->senderMutex);
+                        }
+                        this->frameFree.notify_one();
+                    }
+                }
+            }
+            catch (boost::thread_interrupted &ex)
+            {
+            }
+        }
+
+        bool TXClient::readyToSend(unsigned int numSamples)
+        {
+            bool ret = false;
+            if (this->isRunning)
+            {
+                // Prefill frames go out without waiting on flow control
+                ret = (this->prefillSampleCount > 0) ||
+                        this->statusRX->okToSend(numSamples, false);
+            }
+            return ret;
+        }
+
+        bool TXClient::waitToSend(unsigned int numSamples, double timeout)
+        {
+            bool ret = false;
+            if (this->isRunning)
+            {
+                ret = (this->prefillSampleCount > 0) ||
+                        this->statusRX->blockUntilAvailable(numSamples, timeout);
+            }
+            return ret;
+        }
+
+        bool TXClient::trySendFrame(short * samples, unsigned int samplesPerFrame)
+        {
+            bool ret = this->readyToSend(samplesPerFrame);
+            if (ret)
+            {
+                this->sendFrameSync(samples, samplesPerFrame);
+            }
+            return ret;
+        }
+
+        /********* ADAPTIVE PREFILL **********/
+        bool TXClient::setAdaptivePrefill(bool enable, double minLatency, double maxLatency)
+        {
+            this->debug("[setAdaptivePrefill] Called\n");
+            this->debug("[setAdaptivePrefill] -- enable = %s, minLatency = %f, maxLatency = %f\n",
+                    debugBool(enable), minLatency, maxLatency);
+            bool ret = false;
+            if (!this->isRunning && (minLatency > 0) && (maxLatency >= minLatency))
+            {
+                this->adaptiveMode = enable;
+                this->adaptiveMinLatency = minLatency;
+                this->adaptiveMaxLatency = maxLatency;
+                ret = true;
+            }
+            return ret;
+        }
+
+        bool TXClient::isAdaptivePrefill()
+        {
+            return this->adaptiveMode;
+        }
+
+        double TXClient::getTargetLatency()
+        {
+            return this->targetLatency;
+        }
+
+        double TXClient::getProducerJitter()
+        {
+            return this->producerDebtPeak;
+        }
+
+        unsigned long long TXClient::getUnderrunCount()
+        {
+            return (this->statusRX != NULL) ? this->statusRX->getUnderrunCount() : 0;
+        }
+
+        // Called on entry to sendFrame().  The time since the previous call
+        // returned is the producer's own time for this frame; whatever it
+        // exceeds the frame's play-out time by has to come out of the DUC
+        // buffer.  The running total over a burst (reset as the producer
+        // catches up) is the buffer depth that burst needed.
+        void TXClient::updateAdaptiveTarget(unsigned int samplesPerFrame)
+        {
+            double rate = this->getDUCSampleRate();
+            if (rate <= 0.0)
+            {
+                return;
+            }
+            double period = samplesPerFrame / rate;
+            boost::chrono::high_resolution_clock::time_point now =
+                    boost::chrono::high_resolution_clock::now();
+            if (this->haveLastSend)
+            {
+                double gap = boost::chrono::duration<double>(now - this->lastSendExit).count();
+                this->producerDebt = std::max(0.0, this->producerDebt + gap - period);
+                if (samplesPerFrame != this->producerDecayFrameSize)
+                {
+                    this->producerPeakDecay = pow(0.5, period / ADAPTIVE_PEAK_HALF_LIFE);
+                    this->producerDecayFrameSize = samplesPerFrame;
+                }
+                this->producerDebtPeak = std::max(this->producerDebt,
+                        this->producerDebtPeak * this->producerPeakDecay);
+            }
+            this->haveLastSend = true;
+
+            // Any underrun means the target was too low: back off hard.
+            // Ease back once the stream has been clean for a while.
+            unsigned long long underruns = this->statusRX->getUnderrunCount();
+            double sinceChange = boost::chrono::duration<double>(now - this->lastMarginChange).count();
+            if (underruns > this->lastUnderrunCount)
+            {
+                this->lastUnderrunCount = underruns;
+                this->underrunMargin = std::min(ADAPTIVE_MAX_MARGIN, 2.0 * this->underrunMargin);
+                this->lastMarginChange = now;
+                this->debug("[updateAdaptiveTarget] Underrun reported, margin = %f\n", this->underrunMargin);
+            }
+            else if ((this->underrunMargin > ADAPTIVE_MIN_MARGIN) && (sinceChange > ADAPTIVE_QUIET_PERIOD))
+            {
+                this->underrunMargin = std::max(ADAPTIVE_MIN_MARGIN, 0.75 * this->underrunMargin);
+                this->lastMarginChange = now;
+            }
+
+            // Credit is only refreshed once per status update, so the buffer
+            // must also cover one update period.
+            double target = this->underrunMargin * (this->producerDebtPeak + 1.0 / this->updatesPerSecond);
+            target = std::min(this->adaptiveMaxLatency, std::max(this->adaptiveMinLatency, target));
+            if (fabs(target - this->targetLatency) > 0.05 * this->targetLatency)
+            {
+                this->targetLatency = target;
+                this->applyTargetLatency();
+            }
+        }
+
+        void TXClient::applyTargetLatency()
+        {
+            int occupancy = (int)(this->targetLatency * this->getDUCSampleRate());
+            this->statusRX->setTargetOccupancy(occupancy);
+            this->debug("[applyTargetLatency] Target latency = %f s (%d samples)\n",
+                    this->targetLatency, occupancy);
+        }
+
+        /********* TIMED BURSTS **********/
+        bool TXClient::syncToRadioTime()
+        {
+            this->debug("[syncToRadioTime] Called\n");
+            // The radio reports whole seconds, so only a whole-second offset
+            // can be resolved, and a query that straddles a second boundary
+            // on either clock can be off by one.  Accept an offset only when
+            // two consecutive queries agree.
+            long offset[2];
+            long utc = -1;
+            int matched = 0;
+            for (int attempt = 0; (attempt < 4) && (matched < 2); attempt++)
+            {
+                struct timespec before, after;
+                clock_gettime(CLOCK_REALTIME, &before);
+                utc = this->rc->getUTC();
+                clock_gettime(CLOCK_REALTIME, &after);
+                if (utc < 0)
+                {
+                    this->debug("[syncToRadioTime] UTC query failed\n");
+                    return false;
+                }
+                // Use the middle of the query round trip
+                double hostMid = 0.5 * ((before.tv_sec + after.tv_sec) +
+                        (before.tv_nsec + after.tv_nsec) * 1e-9);
+                long current = utc - (long)floor(hostMid);
+                if ((matched == 1) && (current == offset[0]))
+                {
+                    matched = 2;
+                }
+                else
+                {
+                    offset[0] = current;
+                    matched = 1;
+                }
+            }
+            if (matched < 2)
+            {
+                this->debug("[syncToRadioTime] UTC queries did not agree\n");
+                return false;
+            }
+            this->radioTimeOffset = offset[0];
+            this->debug("[syncToRadioTime] -- radio UTC = %ld, offset = %ld s\n",
+                    utc, this->radioTimeOffset);
+            return true;
+        }
+
+        double TXClient::getCurrentTime()
+        {
+            struct timespec now;
+            clock_gettime(CLOCK_REALTIME, &now);
+            return (double)(now.tv_sec + this->radioTimeOffset) + now.tv_nsec * 1e-9;
+        }
+
+        TimedBurstStatus TXClient::sendBurstAt(short * samples, unsigned int numFrames,
+                unsigned int samplesPerFrame, double startTime, double tolerance)
+        {
+            this->debug("[sendBurstAt] Called\n");
+            this->debug("[sendBurstAt] -- numFrames = %u, startTime = %f\n", numFrames, startTime);
+            TimedBurstStatus ret;
+            ret.deadlineMet = false;
+            ret.framesStaged = 0;
+            ret.framesSent = 0;
+            ret.requestedStart = startTime;
+            ret.stagedTime = 0.0;
+            ret.startedTime = 0.0;
+            ret.lateness = 0.0;
+            if (!this->isRunning || this->isGrouped || this->senderRunning)
+            {
+                this->debug("WARNING: Timed bursts need a started, ungrouped, synchronous client\n");
+                return ret;
+            }
+
+            // Hold the DUC so staged frames stay in its buffer
+            if (!this->pauseDUC(true))
+            {
+                this->debug("WARNING: Could not pause the DUC for a timed burst\n");
+                return ret;
+            }
+            this->packetizer->setTimestamp(startTime);
+            try
+            {
+                // Pre-stage without blocking on flow control, and without going
+                // through sendFrameSync(), which unpauses once prefill completes.
+                while ((ret.framesStaged < numFrames) && this->readyToSend(samplesPerFrame))
+                {
+                    this->packetizer->sendFrame(samples + 2 * samplesPerFrame * ret.framesStaged);
+                    if (this->prefillSampleCount > 0)
+                    {
+                        this->prefillSampleCount -= samplesPerFrame;
+                    }
+                    else
+                    {
+                        this->statusRX->sentNSamples(samplesPerFrame);
+                    }
+                    ret.framesStaged++;
+                }
+                ret.stagedTime = this->getCurrentTime();
+
+                // Sleep until just short of the start time, then spin
+                double remaining = startTime - this->getCurrentTime();
+                if (remaining > 0.002)
+                {
+                    boost::this_thread::sleep_for(boost::chrono::microseconds((long long)((remaining - 0.002) * 1e6)));
+                }
+                while (this->getCurrentTime() < startTime)
+                {
+                    boost::this_thread::yield();
+                }
+
+                // Release the DUC; the rest of the burst is flow controlled
+                if (!this->pauseDUC(false))
+                {
+                    // The burst never started, so streaming the rest would
+                    // only pile frames into a paused DUC
+                    this->debug("WARNING: Could not release the DUC for a timed burst\n");
+                    this->packetizer->clearTimestamp();
+                    ret.framesSent = ret.framesStaged;
+                    ret.deadlineMet = false;
+                    return ret;
+                }
+                ret.startedTime = this->getCurrentTime();
+                this->prefillSampleCount = 0;
+                this->DUCReady = true;
+                for (ret.framesSent = ret.framesStaged; ret.framesSent < numFrames; ret.framesSent++)
+                {
+                    this->sendFrameSync(samples + 2 * samplesPerFrame * ret.framesSent, samplesPerFrame);
+                }
+            }
+            catch (...)
+            {
+                // Frames sent after an aborted burst must not carry its
+                // timestamps, or be held by a paused DUC
+                this->packetizer->clearTimestamp();
+                this->pauseDUC(false);
+                throw;
+            }
+            this->packetizer->clearTimestamp();
+
+            ret.lateness = ret.startedTime - startTime;
+            ret.deadlineMet = (ret.stagedTime <= startTime) && (ret.lateness <= tolerance);
+            this->debug("[sendBurstAt] -- staged = %u, lateness = %f s, deadline %s\n",
+                    ret.framesStaged, ret.lateness, ret.deadlineMet ? "met" : "missed");
+            return ret;
+        }
+
+        long TXClient::getFreeSpace()
+        {
+            return (this->statusRX != NULL) ? this->statusRX->getFreeSpace() : 0;
+        }
+
+        double TXClient::getDUCSampleRate()
+        {
+            double ret = 0.0;
+            if (this->ducRateIndex == 16)
+                ret = 270833.0;
+            else if (this->ducRateIndex != INVALID_VALUE)
+                ret = 102.4e6 / pow(2, this->ducRateIndex);
+            return ret;
+        }
+
         bool TXClient::pauseDUC(bool paused)
         {
             this->debug("[pauseDUC] Called\n");
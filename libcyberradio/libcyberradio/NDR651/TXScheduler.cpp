@@ -0,0 +1,261 @@
+/***************************************************************************
+ * \file TXScheduler.cpp
+ *
+ * \brief NDR651 multi-DUC transmit scheduler.
+ *
+ * \author JVM
+ * \copyright Copyright (c) 2015-2021 CyberRadio Solutions, Inc.
+ *
+ */
+
+#include "LibCyberRadio/NDR651/TXScheduler.h"
+#include "LibCyberRadio/NDR651/TransmitPacketizer.h"
+#include <algorithm>
+#include <iostream>
+
+namespace LibCyberRadio
+{
+    namespace NDR651
+    {
+
+        TXScheduler::TXScheduler(std::vector<TXClient *> txClients,
+                unsigned int framesPerChannel,
+                int senderCpu,
+                unsigned int maxSamplesPerFrame,
+                bool debug,
+                unsigned int creditPollUs) :
+            Thread("TXScheduler", "TXScheduler"),
+            Debuggable(debug, "TXScheduler"),
+            _clients(txClients),
+            _framesPerChannel(framesPerChannel > 0 ? framesPerChannel : 1),
+            _senderCpu(senderCpu),
+            _maxSamplesPerFrame(maxSamplesPerFrame),
+            _creditPollUs(creditPollUs > 0 ? creditPollUs : 1),
+            _freeQueue(NULL),
+            _globalVirtualTime(0.0),
+            _running(false)
+        {
+            unsigned int numFrames = _framesPerChannel * _clients.size();
+            _framePool.assign(numFrames * 2 * _maxSamplesPerFrame, 0);
+            _frameSamples.assign(numFrames, 0);
+            _freeQueue = new boost::lockfree::queue<unsigned int>(numFrames);
+            for (unsigned int slot = 0; slot < numFrames; slot++)
+            {
+                _freeQueue->push(slot);
+            }
+            for (unsigned int i = 0; i < _clients.size(); i++)
+            {
+                _readyQueues.push_back(new boost::lockfree::spsc_queue<unsigned int>(_framesPerChannel));
+            }
+            _virtualTime.assign(_clients.size(), 0.0);
+            _sampleRate.assign(_clients.size(), 0.0);
+            _framesSent.assign(_clients.size(), 0);
+        }
+
+        TXScheduler::~TXScheduler()
+        {
+            this->stop();
+            for (unsigned int i = 0; i < _readyQueues.size(); i++)
+            {
+                delete _readyQueues[i];
+            }
+            _readyQueues.clear();
+            if (_freeQueue != NULL)
+            {
+                delete _freeQueue;
+                _freeQueue = NULL;
+            }
+        }
+
+        void TXScheduler::start()
+        {
+            this->debug("[start] Starting %u transmit clients\n", (unsigned int)_clients.size());
+            for (unsigned int i = 0; i < _clients.size(); i++)
+            {
+                _clients[i]->start();
+                _sampleRate[i] = _clients[i]->getDUCSampleRate();
+                _virtualTime[i] = 0.0;
+                _framesSent[i] = 0;
+            }
+            _globalVirtualTime = 0.0;
+            _running = true;
+            // Run the loop directly rather than through Thread::start(), whose
+            // wrapper resets the thread handle on exit and so cannot be joined
+            // safely from stop().
+            _isRunning = true;
+            _thisThread = boost::thread(&TXScheduler::run, this);
+            pthread_setname_np(_thisThread.native_handle(), this->_name.c_str());
+        }
+
+        void TXScheduler::stop(bool disableRF)
+        {
+            if (_running)
+            {
+                this->debug("[stop] Stopping sender thread\n");
+                {
+                    boost::mutex::scoped_lock lock(_wakeMutex);
+                    _running = false;
+                }
+                _frameQueued.notify_all();
+                _slotFreed.notify_all();
+                // The clients must not be stopped while the sender thread
+                // may still be using them.
+                if (_thisThread.joinable())
+                {
+                    _thisThread.join();
+                }
+                _isRunning = false;
+                for (unsigned int i = 0; i < _clients.size(); i++)
+                {
+                    _clients[i]->stop(disableRF);
+                }
+                // Return any frames left in the channel queues to the pool
+                unsigned int slot;
+                for (unsigned int i = 0; i < _readyQueues.size(); i++)
+                {
+                    while (_readyQueues[i]->pop(slot))
+                    {
+                        _freeQueue->push(slot);
+                    }
+                }
+            }
+        }
+
+        bool TXScheduler::sendFrame(unsigned int channel, short * samples,
+                unsigned int samplesPerFrame)
+        {
+            if ((channel >= _clients.size()) || (samplesPerFrame > _maxSamplesPerFrame))
+            {
+                return false;
+            }
+            unsigned int slot;
+            while (!_freeQueue->pop(slot))
+            {
+                boost::mutex::scoped_lock lock(_wakeMutex);
+                if (!_running)
+                {
+                    return false;
+                }
+                if (!_freeQueue->empty())
+                {
+                    continue;
+                }
+                _slotFreed.wait_for(lock, boost::chrono::milliseconds(10));
+            }
+            memcpy(&_framePool[slot * 2 * _maxSamplesPerFrame], samples, 4 * samplesPerFrame);
+            _frameSamples[slot] = samplesPerFrame;
+            // The pool holds framesPerChannel frames per channel, but one
+            // channel may have borrowed more than its share; wait for room.
+            while (!_readyQueues[channel]->push(slot))
+            {
+                boost::mutex::scoped_lock lock(_wakeMutex);
+                if (!_running)
+                {
+                    _freeQueue->push(slot);
+                    return false;
+                }
+                _slotFreed.wait_for(lock, boost::chrono::milliseconds(10));
+            }
+            {
+                boost::mutex::scoped_lock lock(_wakeMutex);
+            }
+            _frameQueued.notify_one();
+            return true;
+        }
+
+        unsigned int TXScheduler::getQueueDepth(unsigned int channel)
+        {
+            return (channel < _readyQueues.size()) ? _readyQueues[channel]->read_available() : 0;
+        }
+
+        unsigned long long TXScheduler::getFramesSent(unsigned int channel)
+        {
+            return (channel < _framesSent.size()) ? _framesSent[channel] : 0;
+        }
+
+        // Start-time fair queuing: each channel's virtual time advances by
+        // the duration of the samples it sends, so channels are served in
+        // proportion to their sample rates.  Channels that have been idle
+        // are brought up to the global virtual time so they cannot build
+        // up a backlog of service.
+        int TXScheduler::_selectChannel(void)
+        {
+            int best = -1;
+            double bestTime = 0.0;
+            long bestCredit = 0;
+            for (unsigned int i = 0; i < _clients.size(); i++)
+            {
+                if (_readyQueues[i]->read_available() == 0)
+                    continue;
+                unsigned int slot = _readyQueues[i]->front();
+                if (!_clients[i]->readyToSend(_frameSamples[slot]))
+                    continue;
+                double startTime = std::max(_virtualTime[i], _globalVirtualTime);
+                long credit = _clients[i]->getFreeSpace();
+                if ( (best < 0) || (startTime < bestTime) ||
+                        ((startTime == bestTime) && (credit > bestCredit)) )
+                {
+                    best = i;
+                    bestTime = startTime;
+                    bestCredit = credit;
+                }
+            }
+            return best;
+        }
+
+        bool TXScheduler::_framesQueued(void)
+        {
+            for (unsigned int i = 0; i < _readyQueues.size(); i++)
+            {
+                if (_readyQueues[i]->read_available() > 0)
+                    return true;
+            }
+            return false;
+        }
+
+        void TXScheduler::run()
+        {
+            if ((_senderCpu >= 0) && !setCpuAffinity(_senderCpu))
+            {
+                std::cerr << "TXScheduler: could not pin sender thread to CPU " << _senderCpu << std::endl;
+            }
+            unsigned int slot;
+            while (_running)
+            {
+                int channel = _selectChannel();
+                if (channel < 0)
+                {
+                    // Sleep until a producer queues a frame.  Credit arrives
+                    // from the status receivers without a notification, so
+                    // while frames are waiting on it, re-check periodically.
+                    boost::mutex::scoped_lock lock(_wakeMutex);
+                    if (!_running)
+                        break;
+                    if (_framesQueued())
+                        _frameQueued.wait_for(lock, boost::chrono::microseconds(_creditPollUs));
+                    else
+                        _frameQueued.wait(lock);
+                    continue;
+                }
+                // The frame stays queued until the client accepts it, so a
+                // send refused for lack of credit is retried, not lost
+                slot = _readyQueues[channel]->front();
+                unsigned int samples = _frameSamples[slot];
+                if (!_clients[channel]->trySendFrame(&_framePool[slot * 2 * _maxSamplesPerFrame], samples))
+                    continue;
+                _readyQueues[channel]->pop();
+                _freeQueue->push(slot);
+                {
+                    boost::mutex::scoped_lock lock(_wakeMutex);
+                }
+                _slotFreed.notify_all();
+                double startTime = std::max(_virtualTime[channel], _globalVirtualTime);
+                _globalVirtualTime = startTime;
+                _virtualTime[channel] = startTime +
+                        ((_sampleRate[channel] > 0) ? samples / _sampleRate[channel] : 0.0);
+                _framesSent[channel]++;
+            }
+        }
+
+    } /* namespace NDR651 */
+}
@@ -9,12 +9,24 @@
  */
 
 #include "LibCyberRadio/NDR651/TransmitPacketizer.h"
+#include "LibCyberRadio/NDR651/Packetizer.h"
 #include <boost/algorithm/string.hpp>
 #include <boost/tokenizer.hpp>
+#include <algorithm>
 #include <unistd.h>
+#include <sys/mman.h>
 
 #define BOOL_DEBUG(x) (x ? "true" : "false")
 
+// Latency targeting: number of achieved-latency samples kept for
+// percentiles, smoothing gain for the latency average, loop gain
+// applied to the latency error, and per-frame decay of the producer's
+// peak inter-frame gap.
+#define LATENCY_HISTORY_SIZE 4096
+#define LATENCY_AVG_GAIN 0.05
+#define LATENCY_LOOP_GAIN 0.02
+#define LATENCY_GAP_DECAY 0.999
+
 using namespace boost::algorithm;
 
 
@@ -71,6 +83,8 @@ namespace LibCyberRadio
                 bool config_tx,
                 bool debug):
             Debuggable(debug, "TransmitPacketizer"),
+            _frameCount(0),
+            _pauseCount(64),
             _radioHostName(""),
             _radioTcpPort(0),
             _ducChannel(0),
@@ -85,33 +99,61 @@ namespace LibCyberRadio
             _txAtten(0),
             _streamId(streamId),
             _config_tx(config_tx),
+            //_waiting(false),
+            _firstFrame(true),
             _txSock(NULL),
             _numSock(8),
             _fcClient(NULL),
-            _frameStart((unsigned char*)(&_frame)),
-            _frameLength(sizeof(TxFrame)),
+            _statusDemux(NULL),
+            _frame(NULL),
+            _payload(NULL),
+            _trailer(NULL),
+            _rawFrame(true),
+            _frameStart(NULL),
+            _frameLength(0),
             _samplesSent(0),
+            _timestampSeconds(0),
+            _timestampTicks(0),
+            _timestampSamples(0),
+            _useTxTime(false),
+            _txTimeClock(CLOCK_TAI),
+            _txTimeOffsetNs(1000000),
+            _txTimeDeadline(false),
+            _txTimeAnchored(false),
+            _txTimeBaseNs(0),
+            _txTimeBaseVitaNs(0),
             _sMac(""),
             _dMac(""),
             _sIp(""),
             _dIp(""),
             _sPort(0),
             _dPort(0),
-            _updatePE(false),
+            _constructing(true),
+            _running(false),
+            _samplesPerFrame(SAMPLES_PER_FRAME),
+            _duchsPeriod(10),
             _duchsPfThresh(61*(67108862/64)),
             _duchsPeThresh(58*(67108862/64)),
-            _duchsPeriod(10),
-            _samplesPerFrame(SAMPLES_PER_FRAME),
-            //_waiting(false),
-            _firstFrame(true),
-            _running(false),
-            _constructing(true),
-            _frameCount(0),
-            _pauseCount(64)
+            _updatePE(false),
+            _predictiveCredit(false),
+            _targetLatency(0.0),
+            _allowedOccupancy(0.0),
+            _latencyAvg(0.0),
+            _producerGapPeak(0.0),
+            _producerRate(0.0),
+            _haveLastSend(false),
+            _latencyIndex(0),
+            _latencyCount(0),
+            _cyclicNumFrames(0),
+            _cyclicFrameBytes(0),
+            _cyclicIndex(0),
+            _cyclicLocked(false),
+            _cyclicHeadersStale(false),
+            _cyclicRunning(false)
         {
             this->debug("construction\n");
             std::cout << "using local lib" << std::endl;
-            memset(&_frame, 0, sizeof(TxFrame));
+            _buildFrame();
             _fcClient = new FlowControlClient(ducChannel, _config_tx, 4, _debug);
             _statusRx = new UdpStatusReceiver(ifname, 65500+ducChannel, _debug, _updatePE);
 
@@ -131,6 +173,9 @@ namespace LibCyberRadio
             // TODO Auto-generated destructor stub
 
             this->debug("destruction\n");
+            clearCyclicWaveform();
+            if ( (_statusDemux != NULL) && (_statusRx != NULL) )
+                _statusDemux->removeRoute(_streamId);
             if ( _fcClient != NULL )
                 delete _fcClient;
             if ( _txSock != NULL )
@@ -187,10 +232,28 @@ namespace LibCyberRadio
                 //~ _txSock = new TransmitSocket(_ifname, _streamId);
                 for (int i=0; i<_numSock; i++) {
                     _txSockVec.push_back(new TransmitSocket(_ifname, _streamId));
+                    if ( _useTxTime )
+                        _txSockVec.back()->setTxTime(true, _txTimeClock, _txTimeDeadline);
                 }
                 std::cout << "# sockets = " << _txSockVec.size() << std::endl;
                 _currentSockIndex = 0;
                 _txSock = _txSockVec[_currentSockIndex];
+                // Frames must fit the new interface's MTU
+                unsigned int maxSamplesPerFrame = getMaxSamplesPerFrame();
+                if ( (maxSamplesPerFrame > 0) && (_samplesPerFrame > maxSamplesPerFrame) )
+                {
+                    if ( _cyclicNumFrames > 0 )
+                    {
+                        this->debug("WARNING: cyclic frames exceed the MTU of %s\n", _ifname.c_str());
+                    }
+                    else
+                    {
+                        this->debug("reducing samples per frame to %u to fit the MTU of %s\n",
+                                maxSamplesPerFrame, _ifname.c_str());
+                        _samplesPerFrame = maxSamplesPerFrame;
+                        _buildFrame();
+                    }
+                }
             }
             _tenGigIndex = tenGigIndex;
             this->debug("duc interface set ok\n");
@@ -207,6 +270,9 @@ namespace LibCyberRadio
             if (_fcClient != NULL)
             {
                 ret = _fcClient->setDucRateIndex(_ducRate, true);
+                // The drain prediction runs at the DUC sample rate
+                if ( _predictiveCredit && (_statusRx != NULL) )
+                    _statusRx->setPredictiveCredit(true, _fcClient->getDucSampleRate());
             }
             _configuring = false;
             return ret;
@@ -335,6 +401,11 @@ namespace LibCyberRadio
         {
             bool ret = true;
             _configuring = true;
+            if ( _running && (_statusDemux != NULL) && (_statusRx != NULL) )
+            {
+                _statusDemux->removeRoute(_streamId);
+                _statusDemux->addRoute(streamId, _statusRx);
+            }
             _streamId = streamId;
             setUdpHeader(_streamId, _streamId);
             setVitaHeader(_streamId);
@@ -441,8 +512,9 @@ namespace LibCyberRadio
                     setIpHeader(_sIp, _dIp);
                     setUdpHeader(_streamId, _streamId);
                 } else {
-                    _frameStart = (unsigned char*)(&_frame.v49.frameStart);
-                    _frameLength = sizeof(TxFrame)-( sizeof(ethhdr) + sizeof(iphdr) + sizeof(udphdr) );
+                    // The kernel supplies the Ethernet/IP/UDP headers.
+                    _rawFrame = false;
+                    _buildFrame();
                 }
                 setVitaHeader(_streamId);
                 this->debug("-- enabling duc\n");
@@ -467,15 +539,144 @@ namespace LibCyberRadio
             _running = true;
             //~ if ( _fcClient != NULL )
             //~ _fcClient->start();
-            _fcClient->setDucDipStatusEntry(-1, _sIp, _sMac, _statusRx->getUdpPort());
+            if ( _statusDemux != NULL )
+            {
+                // Status frames arrive through the shared demux, routed by
+                // our stream ID, so the receiver needs no socket or thread.
+                _statusRx->setStatusPort(0);
+                _statusDemux->addRoute(_streamId, _statusRx);
+                _fcClient->setDucDipStatusEntry(-1, _sIp, _sMac, _statusDemux->getUdpPort());
+            }
+            else
+            {
+                _fcClient->setDucDipStatusEntry(-1, _sIp, _sMac, _statusRx->getUdpPort());
+            }
             _statusRx->setUpdatePE(_updatePE);
+            _statusRx->setPredictiveCredit(_predictiveCredit, _fcClient->getDucSampleRate());
+            if ( _targetLatency > 0 )
+                setTargetLatency(_targetLatency);
             _fcClient->setDuchsParameters(_duchsPfThresh, _duchsPeThresh, _duchsPeriod);
-            if ( _statusRx != NULL )
+            if ( (_statusRx != NULL) && (_statusDemux == NULL) )
                 _statusRx->start();
         }
 
+        void TransmitPacketizer::setPredictiveCredit(bool enable)
+        {
+            _predictiveCredit = enable;
+            if ( _running && (_statusRx != NULL) && (_fcClient != NULL) )
+                _statusRx->setPredictiveCredit(_predictiveCredit, _fcClient->getDucSampleRate());
+        }
+
+        bool TransmitPacketizer::setTargetLatency(double seconds)
+        {
+            if ( (_statusRx == NULL) || (_fcClient == NULL) )
+                return false;
+            double fs = (double)_fcClient->getDucSampleRate();
+            _targetLatency = std::max(0.0, seconds);
+            _haveLastSend = false;
+            _producerGapPeak = 0.0;
+            if (_targetLatency > 0)
+            {
+                // Start from the occupancy that plays out in the target
+                // time; the control loop refines it as frames are sent.
+                _statusRx->setMaxFreeSpace(fs, _targetLatency);
+                _allowedOccupancy = _targetLatency * fs;
+                _latencyAvg = _targetLatency;
+                _statusRx->setTargetOccupancy((int)_allowedOccupancy);
+                this->debug("target latency = %f s (%d samples)\n", _targetLatency, (int)_allowedOccupancy);
+            }
+            else
+            {
+                _statusRx->setMaxFreeSpace(fs, (float)MAX_RADIO_BUFFSIZE / fs);
+                _statusRx->setTargetOccupancy(MAX_RADIO_BUFFSIZE);
+                _allowedOccupancy = 0.0;
+            }
+            return true;
+        }
+
+        double TransmitPacketizer::getAllowedLatency(void)
+        {
+            double fs = (_fcClient != NULL) ? (double)_fcClient->getDucSampleRate() : 0.0;
+            return (fs > 0) ? _allowedOccupancy / fs : 0.0;
+        }
+
+        double TransmitPacketizer::getLatencyPercentile(double percentile)
+        {
+            std::vector<float> history;
+            {
+                boost::mutex::scoped_lock lock(_latencyMutex);
+                history.assign(_latencyHistory.begin(), _latencyHistory.begin() + _latencyCount);
+            }
+            if (history.empty())
+                return 0.0;
+            size_t n = (size_t)(std::max(0.0, std::min(100.0, percentile)) / 100.0 * (history.size() - 1) + 0.5);
+            std::nth_element(history.begin(), history.begin() + n, history.end());
+            return history[n];
+        }
+
+        void TransmitPacketizer::resetLatencyStats(void)
+        {
+            boost::mutex::scoped_lock lock(_latencyMutex);
+            _latencyIndex = 0;
+            _latencyCount = 0;
+        }
+
+        // Called by the sending thread after each frame while a target
+        // latency is set.  The achieved latency of a frame is the time its
+        // last sample waits in the DUC buffer.
+        void TransmitPacketizer::_updateLatencyControl(void)
+        {
+            double fs = (double)_fcClient->getDucSampleRate();
+            if (fs <= 0)
+                return;
+            double latency = _statusRx->getBufferOccupancy() / fs;
+            {
+                boost::mutex::scoped_lock lock(_latencyMutex);
+                if (_latencyHistory.size() != LATENCY_HISTORY_SIZE)
+                    _latencyHistory.resize(LATENCY_HISTORY_SIZE);
+                _latencyHistory[_latencyIndex] = (float)latency;
+                _latencyIndex = (_latencyIndex + 1) % LATENCY_HISTORY_SIZE;
+                _latencyCount = std::min(_latencyCount + 1, (unsigned int)LATENCY_HISTORY_SIZE);
+            }
+            // Producer rate and worst recent gap between frames
+            boost::chrono::steady_clock::time_point now = boost::chrono::steady_clock::now();
+            if (_haveLastSend)
+            {
+                double gap = boost::chrono::duration<double>(now - _lastSendTime).count();
+                _producerGapPeak = std::max(gap, _producerGapPeak * LATENCY_GAP_DECAY);
+                if (gap > 0)
+                    _producerRate += LATENCY_AVG_GAIN * (_samplesPerFrame / gap - _producerRate);
+            }
+            _lastSendTime = now;
+            _haveLastSend = true;
+            // Steer the allowed occupancy so the achieved latency settles on
+            // the target.  Only raise it while the buffer is actually held
+            // at the limit; a producer slower than the DUC cannot fill it.
+            _latencyAvg += LATENCY_AVG_GAIN * (latency - _latencyAvg);
+            double error = _targetLatency - _latencyAvg;
+            if ( (error < 0) || (latency * fs >= 0.9 * _allowedOccupancy) )
+                _allowedOccupancy += LATENCY_LOOP_GAIN * error * fs;
+            // The buffer must cover the producer's worst recent gap, or the
+            // DUC underruns; beyond that, the target is not reachable.
+            double floor = _producerGapPeak * fs + 2.0 * _samplesPerFrame;
+            _allowedOccupancy = std::max(floor, std::min(2.0 * _targetLatency * fs,
+                    std::min((double)(MAX_RADIO_BUFFSIZE - RADIO_BUFFER_RESERVE), _allowedOccupancy)));
+            _statusRx->setTargetOccupancy((int)_allowedOccupancy);
+        }
+
+        void TransmitPacketizer::setStatusDemux(StatusDemux * demux)
+        {
+            if ( _running )
+            {
+                this->debug("cannot change status receiver while running\n");
+                return;
+            }
+            _statusDemux = demux;
+        }
+
         void TransmitPacketizer::stop()
         {
+            stopCyclicTransmit();
             std::cerr << "Stopping flow control threads.\n";
             this->setDuchsParameters(0, 0, 0, false);
             if ( _fcClient != NULL ) {
@@ -489,6 +690,8 @@ namespace LibCyberRadio
                 _fcClient = NULL;
             }
             if ( _statusRx != NULL ){
+                if ( _statusDemux != NULL )
+                    _statusDemux->removeRoute(_streamId);
                 std::cerr << "_statusRx->interrupt()\n";
                 _statusRx->interrupt();
                 std::cerr << "delete _statusRx\n";
@@ -505,24 +708,29 @@ namespace LibCyberRadio
             // failed to make our control objects!
             if ( (_txSock != NULL) && (_fcClient != NULL) && (_statusRx != NULL) )
             {
-                while (!_statusRx->okToSend(SAMPLES_PER_FRAME,false))
+                if (!_statusRx->blockUntilAvailable(_samplesPerFrame))
                 {
-                    usleep(1000);
+                    return _samplesSent;
                 }
-                memcpy(&_frame.payload.samples, samples, 4*SAMPLES_PER_FRAME);
-                if (_txSock->sendFrame(_frameStart, _frameLength))
                 {
-                    _samplesSent = SAMPLES_PER_FRAME;
-                    _incrementVitaHeader();
-                    if (_firstFrame) {
-                        this->debug("1st frame sent!\n");
-                        _firstFrame = false;
-                    }
+                    boost::mutex::scoped_lock lock(_sendMutex);
+                    memcpy(_payload, samples, 4*_samplesPerFrame);
+                    if (_sendCurrentFrame(_frameStart))
+                    {
+                        _samplesSent = _samplesPerFrame;
+                        _incrementVitaHeader();
+                        if (_firstFrame) {
+                            this->debug("1st frame sent!\n");
+                            _firstFrame = false;
+                        }
 
+                    }
                 }
                 _currentSockIndex = (_currentSockIndex+1)%_txSockVec.size();
                 _txSock = _txSockVec[_currentSockIndex];
                 _statusRx->sentNSamples(_samplesSent);
+                if ( (_targetLatency > 0) && (_samplesSent > 0) )
+                    _updateLatencyControl();
                 //~ _frameCount += 1;
                 //~ if (_frameCount==_pauseCount) {
                 //~ std::cout << "UNPAUSING\n";
@@ -547,6 +755,7 @@ namespace LibCyberRadio
         bool TransmitPacketizer::setEthernetHeader(const std::string& sourceMac,
                 const std::string& destMac)
         {
+            boost::mutex::scoped_lock lock(_sendMutex);
             std::vector<std::string> macVec;
             int ind = 0;
 
@@ -557,7 +766,7 @@ namespace LibCyberRadio
             for (std::vector<std::string>::iterator i=macVec.begin(); i!=macVec.end(); i++) {
                 unsigned char val = strtol((*i).c_str(), NULL, 16);
                 //std::cout << "  " << (*i) << " (" << (int)val << ")";
-                _frame.eth.h_dest[ind++] = val;
+                _frame->eth.h_dest[ind++] = val;
             }
             //std::cout << std::endl;
 
@@ -568,11 +777,12 @@ namespace LibCyberRadio
             for (std::vector<std::string>::iterator i=macVec.begin(); i!=macVec.end(); i++) {
                 unsigned char val = strtol((*i).c_str(), NULL, 16);
                 //std::cout << "  " << (*i) << " (" << (int)val << ")";
-                _frame.eth.h_source[ind++] = val;
+                _frame->eth.h_source[ind++] = val;
             }
             //std::cout << std::endl;
 
-            _frame.eth.h_proto = htons(ETH_P_IP);
+            _frame->eth.h_proto = htons(ETH_P_IP);
+            _cyclicHeadersStale = true;
 
             return true;
         }
@@ -580,22 +790,23 @@ namespace LibCyberRadio
         bool TransmitPacketizer::setIpHeader(const std::string& sourceIp,
                 const std::string& destIp)
         {
-            _frame.ip.version = 4;
-            _frame.ip.ihl = sizeof(iphdr)/4;
-            //_frame.ip.frag_off = htons(0x4000);
-            _frame.ip.protocol = 17;
-            _frame.ip.tot_len = htons(sizeof(TxFrame)-sizeof(ethhdr));
-            _frame.ip.ttl = 255;
+            boost::mutex::scoped_lock lock(_sendMutex);
+            _frame->ip.version = 4;
+            _frame->ip.ihl = sizeof(iphdr)/4;
+            //_frame->ip.frag_off = htons(0x4000);
+            _frame->ip.protocol = 17;
+            _frame->ip.tot_len = htons(_frameBuffer.size()-sizeof(ethhdr));
+            _frame->ip.ttl = 255;
 
             // Destination IP address
-            inet_pton(AF_INET, destIp.c_str(), &(_frame.ip.daddr));
+            inet_pton(AF_INET, destIp.c_str(), &(_frame->ip.daddr));
 
             // Source IP address
-            inet_pton(AF_INET, sourceIp.c_str(), &(_frame.ip.saddr));
+            inet_pton(AF_INET, sourceIp.c_str(), &(_frame->ip.saddr));
 
             // IP Header checksum
-            _frame.ip.check = 0;
-            _frame.ip.check = compute_checksum((unsigned short*)&(_frame.ip), _frame.ip.ihl<<2);
+            _updateIpChecksum();
+            _cyclicHeadersStale = true;
 
             return true;
         }
@@ -603,45 +814,372 @@ namespace LibCyberRadio
         bool TransmitPacketizer::setUdpHeader(unsigned short sourcePort,
                 unsigned short destPort)
         {
-            _frame.udp.source = htons(sourcePort);
-            _frame.udp.dest = htons(destPort);
-            _frame.udp.len = htons(sizeof(TxFrame)-sizeof(ethhdr)-sizeof(iphdr));
+            boost::mutex::scoped_lock lock(_sendMutex);
+            _frame->udp.source = htons(sourcePort);
+            _frame->udp.dest = htons(destPort);
+            _frame->udp.len = htons(_frameBuffer.size()-sizeof(ethhdr)-sizeof(iphdr));
+            _cyclicHeadersStale = true;
             return true;
         }
 
         bool TransmitPacketizer::setVitaHeader(unsigned int streamId)
         {
+            boost::mutex::scoped_lock lock(_sendMutex);
             //Vita49
-            _frame.v49.frameStart = VRLP;
-            //~ _frame.v49.frameSize = SAMPLES_PER_FRAME+10;
-            _frame.v49.frameSize = _samplesPerFrame+10;
-            _frame.v49.streamId = streamId;
-            _frame.v49.packetType = 0x1;
-            _frame.v49.TSF = 0x1;
-            _frame.v49.TSF = 0x1;
-            _frame.v49.T = 0;
-            _frame.v49.C = 1;
-            _frame.v49.classId1 = 0x00fffffa;
-            _frame.v49.classId2 = 0x00130000;
-            //~ _frame.v49.packetSize = SAMPLES_PER_FRAME+7;
-            _frame.v49.packetSize = _samplesPerFrame+7;
-            _frame.vend.frameEnd = VEND;
+            _frame->v49.frameStart = VRLP;
+            //~ _frame->v49.frameSize = SAMPLES_PER_FRAME+10;
+            _frame->v49.frameSize = _samplesPerFrame+10;
+            _frame->v49.streamId = streamId;
+            _frame->v49.packetType = 0x1;
+            _frame->v49.TSF = 0x1;
+            _frame->v49.TSF = 0x1;
+            _frame->v49.T = 0;
+            _frame->v49.C = 1;
+            _frame->v49.classId1 = 0x00fffffa;
+            _frame->v49.classId2 = 0x00130000;
+            //~ _frame->v49.packetSize = SAMPLES_PER_FRAME+7;
+            _frame->v49.packetSize = _samplesPerFrame+7;
+            _trailer->frameEnd = VEND;
+            _cyclicHeadersStale = true;
+            return true;
+        }
+
+        bool TransmitPacketizer::setSamplesPerFrame(unsigned int samplesPerFrame)
+        {
+            if ( (samplesPerFrame == 0) || (samplesPerFrame > MAX_SAMPLES_PER_FRAME) )
+            {
+                this->debug("invalid samples per frame = %u\n", samplesPerFrame);
+                return false;
+            }
+            if ( _cyclicNumFrames > 0 )
+            {
+                this->debug("cannot change frame size with a cyclic waveform registered\n");
+                return false;
+            }
+            unsigned int maxSamplesPerFrame = getMaxSamplesPerFrame();
+            if ( (maxSamplesPerFrame > 0) && (samplesPerFrame > maxSamplesPerFrame) )
+            {
+                this->debug("samples per frame = %u exceeds the interface MTU (max %u)\n",
+                        samplesPerFrame, maxSamplesPerFrame);
+                return false;
+            }
+            _configuring = true;
+            this->debug("setting samples per frame = %u\n", samplesPerFrame);
+            _samplesPerFrame = samplesPerFrame;
+            _buildFrame();
+            _configuring = false;
+            return true;
+        }
+
+        unsigned int TransmitPacketizer::getMaxSamplesPerFrame(void)
+        {
+            unsigned int ret = 0;
+            int mtu = (_txSock != NULL) ? _txSock->getMtu() : 0;
+            int overhead = sizeof(iphdr) + sizeof(udphdr) +
+                    sizeof(Vita49Header) + sizeof(Vita49Trailer);
+            if ( mtu > overhead )
+            {
+                ret = std::min( (unsigned int)((mtu - overhead) / 4),
+                        (unsigned int)MAX_SAMPLES_PER_FRAME );
+            }
+            return ret;
+        }
+
+        bool TransmitPacketizer::setSamplesPerFrameFromMtu(void)
+        {
+            return setSamplesPerFrame(getMaxSamplesPerFrame());
+        }
+
+        // (Re)sizes the frame buffer for the current samples per frame,
+        // then fixes up every length field and the IP checksum.  Header
+        // contents already in the buffer are preserved.
+        void TransmitPacketizer::_buildFrame(void)
+        {
+            boost::mutex::scoped_lock lock(_sendMutex);
+            size_t payloadBytes = 4*_samplesPerFrame;
+            size_t frameBytes = sizeof(TxFrameHeader) + payloadBytes + sizeof(Vita49Trailer);
+            _frameBuffer.resize(frameBytes, 0);
+            _frame = (struct TxFrameHeader *)(&_frameBuffer[0]);
+            _payload = (short *)(&_frameBuffer[sizeof(TxFrameHeader)]);
+            _trailer = (struct Vita49Trailer *)(&_frameBuffer[sizeof(TxFrameHeader) + payloadBytes]);
+            _trailer->frameEnd = VEND;
+            _frame->v49.frameSize = _samplesPerFrame+10;
+            _frame->v49.packetSize = _samplesPerFrame+7;
+            _frame->udp.len = htons(frameBytes-sizeof(ethhdr)-sizeof(iphdr));
+            _frame->ip.tot_len = htons(frameBytes-sizeof(ethhdr));
+            if ( _frame->ip.version == 4 )
+            {
+                _updateIpChecksum();
+            }
+            if ( _rawFrame )
+            {
+                _frameStart = &_frameBuffer[0];
+                _frameLength = frameBytes;
+            }
+            else
+            {
+                _frameStart = (unsigned char*)(&_frame->v49.frameStart);
+                _frameLength = frameBytes - ( sizeof(ethhdr) + sizeof(iphdr) + sizeof(udphdr) );
+            }
+        }
+
+        // The IP header is a packed member of the frame header, so it is
+        // checksummed from an aligned copy.
+        void TransmitPacketizer::_updateIpChecksum(void)
+        {
+            struct iphdr ipHeader = _frame->ip;
+            ipHeader.check = 0;
+            _frame->ip.check = compute_checksum((unsigned short*)&ipHeader, ipHeader.ihl<<2);
+        }
+
+        bool TransmitPacketizer::setCyclicWaveform(const short * samples, unsigned int numSamples)
+        {
+            if ( (samples == NULL) || (numSamples == 0) || (numSamples % _samplesPerFrame != 0) )
+            {
+                this->debug("cyclic waveform must be a whole number of %u-sample frames\n", _samplesPerFrame);
+                return false;
+            }
+            clearCyclicWaveform();
+            // Taken after clearCyclicWaveform(), which waits for the cyclic
+            // thread to finish sending; a header change made while the
+            // frames are copied must not be lost when the flag is cleared
+            boost::mutex::scoped_lock lock(_sendMutex);
+            _cyclicNumFrames = numSamples / _samplesPerFrame;
+            _cyclicFrameBytes = _frameBuffer.size();
+            _cyclicFrames.resize(_cyclicNumFrames * _cyclicFrameBytes);
+            for (unsigned int i = 0; i < _cyclicNumFrames; i++)
+            {
+                unsigned char * frame = &_cyclicFrames[i * _cyclicFrameBytes];
+                memcpy(frame, &_frameBuffer[0], _cyclicFrameBytes);
+                memcpy(frame + sizeof(TxFrameHeader),
+                        samples + 2 * i * _samplesPerFrame, 4 * _samplesPerFrame);
+            }
+            // Keep the frames resident; failure (e.g. RLIMIT_MEMLOCK) is not fatal.
+            _cyclicLocked = (mlock(&_cyclicFrames[0], _cyclicFrames.size()) == 0);
+            if ( !_cyclicLocked )
+            {
+                this->debug("could not lock cyclic waveform memory\n");
+            }
+            _cyclicIndex = 0;
+            _cyclicHeadersStale = false;
+            this->debug("registered cyclic waveform: %u frames\n", _cyclicNumFrames);
             return true;
         }
 
-        //~ unsigned int TransmitPacketizer::setSamplesPerFrame(unsigned int samplesPerFrame) {
-        //~ _samplesPerFrame = samplesPerFrame;
-        //~ _frame.v49.packetSize = _samplesPerFrame+7;
-        //~ _frame.v49.frameSize = _samplesPerFrame+10;
-        //~ }
+        void TransmitPacketizer::clearCyclicWaveform(void)
+        {
+            stopCyclicTransmit();
+            if ( _cyclicLocked )
+            {
+                munlock(&_cyclicFrames[0], _cyclicFrames.size());
+                _cyclicLocked = false;
+            }
+            std::vector<unsigned char>().swap(_cyclicFrames);
+            _cyclicNumFrames = 0;
+            _cyclicFrameBytes = 0;
+            _cyclicIndex = 0;
+        }
+
+        unsigned int TransmitPacketizer::sendCyclicFrame(void)
+        {
+            _samplesSent = 0;
+            if ( (_cyclicNumFrames > 0) && (_txSock != NULL) && (_fcClient != NULL) && (_statusRx != NULL) )
+            {
+                if (!_statusRx->blockUntilAvailable(_samplesPerFrame))
+                {
+                    return _samplesSent;
+                }
+                {
+                    boost::mutex::scoped_lock lock(_sendMutex);
+                    if ( _cyclicHeadersStale )
+                    {
+                        _refreshCyclicHeaders();
+                    }
+                    unsigned char * frame = &_cyclicFrames[_cyclicIndex * _cyclicFrameBytes];
+                    struct TxFrameHeader * hdr = (struct TxFrameHeader *)frame;
+                    // Only the counters and timestamp change from frame to frame
+                    hdr->v49.frameCount = _frame->v49.frameCount;
+                    hdr->v49.packetCount = _frame->v49.packetCount;
+                    hdr->v49.TSI = _frame->v49.TSI;
+                    hdr->v49.timeSeconds = _frame->v49.timeSeconds;
+                    hdr->v49.timeFracSecLSB = _frame->v49.timeFracSecLSB;
+                    if (_sendCurrentFrame(frame + (_frameStart - &_frameBuffer[0])))
+                    {
+                        _samplesSent = _samplesPerFrame;
+                        _incrementVitaHeader();
+                        _cyclicIndex = (_cyclicIndex + 1) % _cyclicNumFrames;
+                    }
+                }
+                _currentSockIndex = (_currentSockIndex+1)%_txSockVec.size();
+                _txSock = _txSockVec[_currentSockIndex];
+                _statusRx->sentNSamples(_samplesSent);
+                if ( (_targetLatency > 0) && (_samplesSent > 0) )
+                    _updateLatencyControl();
+            }
+            return _samplesSent;
+        }
+
+        bool TransmitPacketizer::startCyclicTransmit(int cpu)
+        {
+            if ( (_cyclicNumFrames == 0) || !_running )
+            {
+                this->debug("cyclic transmit needs a registered waveform and a started packetizer\n");
+                return false;
+            }
+            if ( !_cyclicRunning )
+            {
+                _cyclicRunning = true;
+                _cyclicThread = boost::thread(&TransmitPacketizer::_cyclicLoop, this, cpu);
+            }
+            return true;
+        }
+
+        void TransmitPacketizer::stopCyclicTransmit(void)
+        {
+            if ( _cyclicRunning )
+            {
+                _cyclicRunning = false;
+                _cyclicThread.join();
+            }
+        }
+
+        // Header fields other than the per-frame counters changed (stream
+        // ID, addresses, ...); copy the new header into every cyclic frame.
+        void TransmitPacketizer::_refreshCyclicHeaders(void)
+        {
+            for (unsigned int i = 0; i < _cyclicNumFrames; i++)
+            {
+                memcpy(&_cyclicFrames[i * _cyclicFrameBytes], _frame, sizeof(TxFrameHeader));
+            }
+            _cyclicHeadersStale = false;
+        }
+
+        void TransmitPacketizer::_cyclicLoop(int cpu)
+        {
+            if ( (cpu >= 0) && !setCpuAffinity(cpu) )
+            {
+                std::cerr << "TransmitPacketizer: could not pin cyclic transmit thread to CPU " << cpu << std::endl;
+            }
+            while (_cyclicRunning)
+            {
+                // Wait for credit with a timeout here so stopCyclicTransmit()
+                // is not held up by the flow-control wait in sendCyclicFrame().
+                if (!_statusRx->blockUntilAvailable(_samplesPerFrame, 0.01))
+                {
+                    continue;
+                }
+                sendCyclicFrame();
+            }
+        }
+
+        // Sends a frame carrying the current header, with a launch time if
+        // launch-time scheduling is on.  Called with the send mutex held.
+        bool TransmitPacketizer::_sendCurrentFrame(unsigned char * frame)
+        {
+            if ( _useTxTime )
+                return _txSock->sendFrame(frame, _frameLength, _getLaunchTime());
+            return _txSock->sendFrame(frame, _frameLength);
+        }
+
+        // Launch time for the frame about to be sent.  The VITA timestamp is
+        // radio time, not the launch-time clock, so only its distance from
+        // the first frame's timestamp is used.
+        uint64_t TransmitPacketizer::_getLaunchTime(void)
+        {
+            struct timespec ts;
+            clock_gettime(_txTimeClock, &ts);
+            uint64_t now = (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+            if ( _frame->v49.TSI == 0 )
+                return (uint64_t)((long long)now + _txTimeOffsetNs);
+            uint64_t vitaNs = (uint64_t)(_frame->v49.timeSeconds) * 1000000000ULL +
+                    ((uint64_t)(_frame->v49.timeFracSecLSB) * 1000000000ULL) / DAC_RATE;
+            if ( !_txTimeAnchored || (vitaNs < _txTimeBaseVitaNs) )
+            {
+                _txTimeBaseNs = now;
+                _txTimeBaseVitaNs = vitaNs;
+                _txTimeAnchored = true;
+            }
+            return (uint64_t)((long long)(_txTimeBaseNs + (vitaNs - _txTimeBaseVitaNs)) +
+                    _txTimeOffsetNs);
+        }
+
+        bool TransmitPacketizer::setTxTime(bool enable, clockid_t clockId,
+                long long launchOffsetNs, bool deadlineMode)
+        {
+            boost::mutex::scoped_lock lock(_sendMutex);
+            bool ret = true;
+            for (std::vector<TransmitSocket *>::iterator it = _txSockVec.begin();
+                    it != _txSockVec.end(); it++)
+            {
+                ret = (*it)->setTxTime(enable, clockId, deadlineMode) && ret;
+            }
+            _useTxTime = enable && ret && !_txSockVec.empty();
+            _txTimeClock = clockId;
+            _txTimeOffsetNs = launchOffsetNs;
+            _txTimeDeadline = deadlineMode;
+            _txTimeAnchored = false;
+            this->debug("launch-time scheduling %s\n", _useTxTime ? "on" : "off");
+            return ret;
+        }
+
+        unsigned long TransmitPacketizer::getTxTimeDropCount(void)
+        {
+            unsigned long ret = 0;
+            for (std::vector<TransmitSocket *>::iterator it = _txSockVec.begin();
+                    it != _txSockVec.end(); it++)
+            {
+                ret += (*it)->getTxTimeDropCount();
+            }
+            return ret;
+        }
 
         void TransmitPacketizer::_incrementVitaHeader()
         {
-            //if (_debug && (_frame.v49.frameCount==0)) {
+            //if (_debug && (_frame->v49.frameCount==0)) {
             //std::cout << "Frame 0 " << std::endl;
             //}
-            _frame.v49.frameCount = (_frame.v49.frameCount + 1) % 4096;
-            _frame.v49.packetCount = (_frame.v49.packetCount + 1) % 16;
+            _frame->v49.frameCount = (_frame->v49.frameCount + 1) % 4096;
+            _frame->v49.packetCount = (_frame->v49.packetCount + 1) % 16;
+            if ( _frame->v49.TSI != 0 )
+            {
+                // Timestamp of the next frame, from the samples sent since the
+                // timestamp was set.  Rate 16 is not a whole number of DAC
+                // ticks per sample, so round rather than accumulating a
+                // truncated per-frame increment.
+                _timestampSamples += _samplesPerFrame;
+                unsigned long long rate = (_ducRate == 16) ? 270833ULL : ((unsigned long long)DAC_RATE >> _ducRate);
+                unsigned long long ticks = _timestampTicks +
+                        ((_timestampSamples % rate) * DAC_RATE + rate / 2) / rate;
+                _frame->v49.timeSeconds = _timestampSeconds + _timestampSamples / rate + ticks / DAC_RATE;
+                _frame->v49.timeFracSecLSB = ticks % DAC_RATE;
+            }
+        }
+
+        void TransmitPacketizer::setTimestamp(unsigned int seconds, unsigned int fracTicks)
+        {
+            boost::mutex::scoped_lock lock(_sendMutex);
+            _frame->v49.TSI = 0x1;
+            _frame->v49.timeSeconds = seconds + fracTicks / DAC_RATE;
+            _frame->v49.timeFracSecMSB = 0;
+            _frame->v49.timeFracSecLSB = fracTicks % DAC_RATE;
+            _timestampSeconds = _frame->v49.timeSeconds;
+            _timestampTicks = _frame->v49.timeFracSecLSB;
+            _timestampSamples = 0;
+            _txTimeAnchored = false;
+            _cyclicHeadersStale = true;
+        }
+
+        void TransmitPacketizer::clearTimestamp(void)
+        {
+            boost::mutex::scoped_lock lock(_sendMutex);
+            _frame->v49.TSI = 0;
+            _frame->v49.timeSeconds = 0;
+            _frame->v49.timeFracSecMSB = 0;
+            _frame->v49.timeFracSecLSB = 0;
+            _timestampSeconds = 0;
+            _timestampTicks = 0;
+            _timestampSamples = 0;
+            _cyclicHeadersStale = true;
         }
 
     } /* namespace NDR651 */
@@ -15,6 +15,8 @@
 #include <netinet/udp.h>
 #include <arpa/inet.h>
 #include <linux/filter.h>
+#include <linux/net_tstamp.h>
+#include <linux/errqueue.h>
 #include "LibCyberRadio/NDR651/TransmitSocket.h"
 #include <netpacket/packet.h>
 #include <net/ethernet.h>
@@ -33,13 +35,16 @@ namespace LibCyberRadio
     {
 
         TransmitSocket::TransmitSocket(const std::string& ifname, unsigned int sport) :
+            _ifname(ifname),
+            _isRaw(geteuid()==0),
             _isBroadcast(true),
             _txBytes(0),
             _sendCount(0),
             _byteCount(0),
-            _isRaw(geteuid()==0),
-            _ifname(ifname),
-            _sport(sport)
+            _sport(sport),
+            _useTxTime(false),
+            _txTimeClock(CLOCK_TAI),
+            _txTimeDropCount(0)
         {
             // TODO Auto-generated constructor stub
             //_ifname = ifname;
@@ -211,6 +216,16 @@ namespace LibCyberRadio
             return std::string(addr);
         }
 
+        int TransmitSocket::getMtu() {
+            struct ifreq ifr;
+            memset(&ifr, 0x00, sizeof(ifr));
+            strncpy(ifr.ifr_name, _ifname.c_str(), IFNAMSIZ-1);
+            if (ioctl(_sockfd, SIOCGIFMTU, &ifr) < 0) {
+                return 0;
+            }
+            return ifr.ifr_mtu;
+        }
+
         bool TransmitSocket::sendFrame(unsigned char * frame, const int & frameLen) {
             _txMutex.lock();
             _txBytes = send(_sockfd, frame, frameLen, 0);
@@ -220,5 +235,121 @@ namespace LibCyberRadio
             return (_txBytes>0);
         }
 
+        bool TransmitSocket::sendFrame(unsigned char * frame, const int & frameLen,
+                uint64_t txTimeNs) {
+            if (!_useTxTime) {
+                return sendFrame(frame, frameLen);
+            }
+            char control[CMSG_SPACE(sizeof(uint64_t))];
+            struct iovec iov;
+            struct msghdr msg;
+            struct cmsghdr * cmsg;
+            iov.iov_base = frame;
+            iov.iov_len = frameLen;
+            memset(&msg, 0, sizeof(msg));
+            memset(control, 0, sizeof(control));
+            msg.msg_iov = &iov;
+            msg.msg_iovlen = 1;
+            msg.msg_control = control;
+            msg.msg_controllen = sizeof(control);
+            cmsg = CMSG_FIRSTHDR(&msg);
+            cmsg->cmsg_level = SOL_SOCKET;
+            cmsg->cmsg_type = SCM_TXTIME;
+            cmsg->cmsg_len = CMSG_LEN(sizeof(uint64_t));
+            memcpy(CMSG_DATA(cmsg), &txTimeNs, sizeof(uint64_t));
+            _txMutex.lock();
+            _txBytes = sendmsg(_sockfd, &msg, 0);
+            // Frames the qdisc dropped are reported on the error queue;
+            // read it now and then, and whenever a send fails
+            if ((_txBytes <= 0) || ((_sendCount % 64) == 0)) {
+                _txTimeDropCount += readTxTimeErrors(_sockfd);
+            }
+            _txMutex.unlock();
+            _sendCount ++;
+            _byteCount += _txBytes;
+            return (_txBytes>0);
+        }
+
+        bool TransmitSocket::setTxTime(bool enable, clockid_t clockId,
+                bool deadlineMode) {
+            struct sock_txtime txtime;
+            int rv = 0;
+            memset(&txtime, 0, sizeof(txtime));
+            if (!enable && _useTxTime) {
+                // SO_TXTIME cannot be cleared, so start over with a new socket
+                _txMutex.lock();
+                _txTimeDropCount += readTxTimeErrors(_sockfd);
+                close(_sockfd);
+                rv = _makeSocket() ? 0 : -1;
+                _txMutex.unlock();
+            }
+            if (enable) {
+                txtime.clockid = clockId;
+                txtime.flags = SOF_TXTIME_REPORT_ERRORS;
+                if (deadlineMode) {
+                    txtime.flags |= SOF_TXTIME_DEADLINE_MODE;
+                }
+                rv = setsockopt(_sockfd, SOL_SOCKET, SO_TXTIME,
+                        (const void *)&txtime, sizeof(txtime));
+                if (rv != 0) {
+                    perror("setsockopt SO_TXTIME");
+                }
+            }
+            _useTxTime = enable && (rv == 0);
+            _txTimeClock = clockId;
+            return (rv == 0);
+        }
+
+        uint64_t TransmitSocket::getTxTimeNow(void) {
+            struct timespec ts;
+            clock_gettime(_txTimeClock, &ts);
+            return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+        }
+
+        unsigned long TransmitSocket::getTxTimeDropCount(void) {
+            _txMutex.lock();
+            if (_useTxTime) {
+                _txTimeDropCount += readTxTimeErrors(_sockfd);
+            }
+            unsigned long ret = _txTimeDropCount;
+            _txMutex.unlock();
+            return ret;
+        }
+
+        unsigned int TransmitSocket::readTxTimeErrors(int sockfd) {
+            unsigned int dropped = 0;
+            char control[256];
+            char data[64];
+            struct iovec iov;
+            struct msghdr msg;
+            struct cmsghdr * cmsg;
+            while (true) {
+                iov.iov_base = data;
+                iov.iov_len = sizeof(data);
+                memset(&msg, 0, sizeof(msg));
+                msg.msg_iov = &iov;
+                msg.msg_iovlen = 1;
+                msg.msg_control = control;
+                msg.msg_controllen = sizeof(control);
+                if (recvmsg(sockfd, &msg, MSG_ERRQUEUE | MSG_DONTWAIT) < 0) {
+                    break;
+                }
+                for (cmsg = CMSG_FIRSTHDR(&msg); cmsg != NULL; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+                    // UDP sockets report on IP_RECVERR, raw sockets on
+                    // PACKET_TX_TIMESTAMP
+                    if (!((cmsg->cmsg_level == SOL_IP && cmsg->cmsg_type == IP_RECVERR) ||
+                          (cmsg->cmsg_level == SOL_PACKET && cmsg->cmsg_type == PACKET_TX_TIMESTAMP))) {
+                        continue;
+                    }
+                    struct sock_extended_err * serr =
+                            (struct sock_extended_err *)CMSG_DATA(cmsg);
+                    if (serr->ee_origin == SO_EE_ORIGIN_TXTIME) {
+                        dropped ++;
+                    }
+                }
+            }
+            return dropped;
+        }
+
     } /* namespace NDR651 */
 }
@@ -20,6 +20,10 @@
 #include <algorithm>    // std::min
 #include <iostream>
 
+// Gain applied to each prediction error when adjusting the margin
+#define PREDICTION_MARGIN_GAIN 0.125
+// Shortest wait between predicted-credit checks in blockUntilAvailable()
+#define PREDICTION_MIN_WAIT_US 50
 
 namespace LibCyberRadio {
 
@@ -30,13 +34,23 @@ namespace LibCyberRadio {
             LibCyberRadio::Debuggable(debug, "UdpStatusReceiver"),
             _sockfd(-1),
             _shutdown(false),
-            _651freeSpace(0), // 2^26 - 2^18
-            _sendLock(false),
+            _updatePE(updatePE),
             _ifname(ifname),
             _port(port),
-            _updatePE(updatePE),
+            timeoutCount(0),
+            _651freeSpace(0), // 2^26 - 2^18
             _freeSpaceMax(MAX_RADIO_BUFFSIZE - RADIO_BUFFER_RESERVE),
-            timeoutCount(0)
+            _predictive(false),
+            _drainRate(0.0),
+            _haveUpdate(false),
+            _drainHeadroom(0),
+            _drainCredited(0),
+            _sentSinceUpdate(0),
+            _lastReported(0),
+            _updateTimeNs(0),
+            _targetOccupancy(MAX_RADIO_BUFFSIZE),
+            _predictionError(0),
+            _predictionMargin(0.0)
         {
             // TODO Auto-generated constructor stub
             bzero(&_rxbuff, MAX_RX_SIZE);
@@ -51,6 +65,7 @@ namespace LibCyberRadio {
                 this->interrupt();
             }
             _shutdown = true;
+            _fcCondition.notify_all();
             this->_fcMutex.lock();
             this->_selMutex.lock();
             if (_sockfd>=0) {
@@ -58,6 +73,8 @@ namespace LibCyberRadio {
                 //TODO: Close the socket...
                 //  this interferes with the select statement in run(), so care must be taken.
             }
+            this->_selMutex.unlock();
+            this->_fcMutex.unlock();
             this->debug("Goodbye!\n");
         }
 
@@ -153,21 +170,17 @@ namespace LibCyberRadio {
         int UdpStatusReceiver::setMaxFreeSpace(float fs, float maxLatency) {
             int maxSamplesLatency = (int)std::floor(maxLatency*fs);
             int maxSamplesLog2;
-            _fcMutex.lock();
             _freeSpaceMax = std::min( MAX_RADIO_BUFFSIZE-RADIO_BUFFER_RESERVE, maxSamplesLatency );
-            _fcMutex.unlock();
             return _freeSpaceMax;
         }
 
         void UdpStatusReceiver::run() {
-            std::cout << "UdpStatusReceiver::run() " << _651freeSpace << std::endl;
+            std::cout << "UdpStatusReceiver::run() " << _651freeSpace.load() << std::endl;
             struct timespec spec;
             struct timeval tout;
             struct sockaddr_in clientaddr; /* client addr */
             socklen_t clientlen = sizeof(clientaddr); /* byte size of client's address */
-            struct TxStatusFrame * status;
             int numBytesRx;
-            long int oldFreeSpace = 0;
             while(this->isRunning() && (!_shutdown)) {
                 tout.tv_sec = (long int) 0;
                 tout.tv_usec = (long int) 500000;
@@ -180,51 +193,7 @@ namespace LibCyberRadio {
                     _selMutex.unlock();
                     //std::cout << "# Bytes Rx = " << numBytesRx << std::endl;
                     if (numBytesRx==sizeof(TxStatusFrame)) {
-                        status = (struct TxStatusFrame *)_rxbuff;
-                        oldFreeSpace = _651freeSpace;
-                        if ((bool)status->status.PE||(bool)status->status.PF) {
-                            std::cout << "DUCHS FRAME: PEF = " << status->status.PP << status->status.PE << status->status.PF;
-                            std::cout << ", Free Space = " << status->status.spaceAvailable << " samples";
-                            std::cout << std::endl;
-                        }
-                        if ( this->_setFreeSpace( status->status.spaceAvailable, (bool)status->status.PP, (bool)status->status.PE, (bool)status->status.PF ) ) {
-                            if (status->status.PE) {
-                                std::cout << "Free space = " << oldFreeSpace << "->" << _651freeSpace << "?" << status->status.spaceAvailable << " [" << _freeSpaceMax << "]";
-                                std::cout << " (" << status->status.PP << status->status.PE << status->status.PF << "), ";
-                                std::cout << "@ time = " << status->v49.timeSeconds << " " << status->v49.timeFracSecMSB << " " << status->v49.timeFracSecLSB << std::endl;
-                            }
-                        }
-                        if (status->status.emptyFlag||status->status.underrunFlag||status->status.overrunFlag||status->status.packetLossFlag) {
-                            //~ if (status->status.emptyFlag||status->status.underrunFlag||status->status.overrunFlag) {
-                            std::cerr << "<" << status->v49.streamId << "@" << status->v49.timeSeconds << "." << status->v49.timeFracSecLSB << ":";
-                            if (status->status.PP) {
-                                std::cerr << "P";
-                            }
-                            if (status->status.PE) {
-                                std::cerr << "E";
-                            }
-                            if (status->status.PF) {
-                                std::cerr << "F";
-                            }
-                            std::cerr << "(" << ( status->status.spaceAvailable-67108862 ) << ")";
-                            if (status->status.emptyFlag) {
-                                std::cerr << "_e";
-                            }
-                            if (status->status.underrunFlag) {
-                                std::cerr << "_u" << status->status.underrunCount;
-                            }
-                            if (status->status.overrunFlag) {
-                                std::cerr << "_o" << status->status.overrunCount;
-                            }
-                            if (status->status.packetLossFlag) {
-                                std::cerr << "_p" << status->status.packetLossCount;
-                            }
-                            std::cerr << "> " << std::endl;
-                        }
-                        //~ else if (status->status.PF) {
-                        //~ std::cout << "\tFree space notification = " << status->status.spaceAvailable << ", current = " << _651freeSpace;
-                        //~ std::cout << "@ time = " << status->v49.timeSeconds << " " << status->v49.timeFracSecMSB << " " << status->v49.timeFracSecLSB << std::endl;
-                        //~ }
+                        this->processStatusFrame( (struct TxStatusFrame *)_rxbuff );
                     }
                 } else {
                     _selMutex.unlock();
@@ -232,45 +201,225 @@ namespace LibCyberRadio {
                     //~ this->debug("Timeout\n");
                     //~ usleep(1000);
                 }
-                this->sleep(2e-6);
+                // select() already blocks; just honor interrupts here
+                boost::this_thread::interruption_point();
                 //~ _selMutex.unlock();
             }
         }
 
+        void UdpStatusReceiver::processStatusFrame(const struct TxStatusFrame * status) {
+            long int oldFreeSpace = _651freeSpace;
+            if ((bool)status->status.PE||(bool)status->status.PF) {
+                std::cout << "DUCHS FRAME: PEF = " << status->status.PP << status->status.PE << status->status.PF;
+                std::cout << ", Free Space = " << status->status.spaceAvailable << " samples";
+                std::cout << std::endl;
+            }
+            if ( this->_setFreeSpace( status->status.spaceAvailable, (bool)status->status.PP, (bool)status->status.PE, (bool)status->status.PF ) ) {
+                if (status->status.PE) {
+                    std::cout << "Free space = " << oldFreeSpace << "->" << _651freeSpace.load() << "?" << status->status.spaceAvailable << " [" << _freeSpaceMax.load() << "]";
+                    std::cout << " (" << status->status.PP << status->status.PE << status->status.PF << "), ";
+                    std::cout << "@ time = " << status->v49.timeSeconds << " " << status->v49.timeFracSecMSB << " " << status->v49.timeFracSecLSB << std::endl;
+                }
+            }
+            if (status->status.emptyFlag||status->status.underrunFlag||status->status.overrunFlag||status->status.packetLossFlag) {
+                //~ if (status->status.emptyFlag||status->status.underrunFlag||status->status.overrunFlag) {
+                std::cerr << "<" << status->v49.streamId << "@" << status->v49.timeSeconds << "." << status->v49.timeFracSecLSB << ":";
+                if (status->status.PP) {
+                    std::cerr << "P";
+                }
+                if (status->status.PE) {
+                    std::cerr << "E";
+                }
+                if (status->status.PF) {
+                    std::cerr << "F";
+                }
+                std::cerr << "(" << ( status->status.spaceAvailable-67108862 ) << ")";
+                if (status->status.emptyFlag) {
+                    std::cerr << "_e";
+                }
+                if (status->status.underrunFlag) {
+                    std::cerr << "_u" << status->status.underrunCount;
+                }
+                if (status->status.overrunFlag) {
+                    std::cerr << "_o" << status->status.overrunCount;
+                }
+                if (status->status.packetLossFlag) {
+                    std::cerr << "_p" << status->status.packetLossCount;
+                }
+                std::cerr << "> " << std::endl;
+            }
+            //~ else if (status->status.PF) {
+            //~ std::cout << "\tFree space notification = " << status->status.spaceAvailable << ", current = " << _651freeSpace;
+            //~ std::cout << "@ time = " << status->v49.timeSeconds << " " << status->v49.timeFracSecMSB << " " << status->v49.timeFracSecLSB << std::endl;
+            //~ }
+        }
+
         bool UdpStatusReceiver::_setFreeSpace(int updateFromRadio, bool flagPP, bool flagPE, bool flagPF) {
             bool updated = false;
-            _fcMutex.lock();
             if (((!_updatePE)&&flagPP)||(_updatePE&&flagPE)) {
-                _651freeSpace = std::min( _freeSpaceMax, updateFromRadio - RADIO_BUFFER_RESERVE );
+                long int credit = std::min( (int)_freeSpaceMax, updateFromRadio - RADIO_BUFFER_RESERVE );
+                // Never allow more than the target occupancy to be buffered
+                credit = std::min( credit, (long int)_targetOccupancy - (MAX_RADIO_BUFFSIZE - updateFromRadio) );
+                boost::mutex::scoped_lock lock(_predictMutex);
+                if (_predictive && _haveUpdate) {
+                    // Score the prediction against the radio's figure and
+                    // steer the margin toward the observed overestimate.
+                    this->_creditDrainLocked();
+                    _predictionError = _651freeSpace.load() - credit;
+                    _predictionMargin = std::max( 0.0, _predictionMargin + PREDICTION_MARGIN_GAIN*_predictionError );
+                }
+                _651freeSpace.store(credit);
+                // The DUC cannot drain more than it holds, and the credit
+                // may not grow past the configured maximum.
+                _drainHeadroom = std::max( 0L, std::min( (long int)MAX_RADIO_BUFFSIZE - updateFromRadio,
+                        (long int)_freeSpaceMax - credit ) );
+                _drainCredited = 0;
+                _sentSinceUpdate = 0;
+                _lastReported = updateFromRadio;
+                _updateTimeNs = boost::chrono::duration_cast<boost::chrono::nanoseconds>(
+                        boost::chrono::steady_clock::now().time_since_epoch()).count();
+                _haveUpdate = true;
                 updated = true;
             }
-            _fcMutex.unlock();
+            if (updated) {
+                // Taking the mutex orders the store before any waiter's
+                // predicate check, so a wakeup cannot be lost.
+                _fcMutex.lock();
+                _fcMutex.unlock();
+                _fcCondition.notify_all();
+            }
             return updated;
         }
 
+        double UdpStatusReceiver::_secondsSinceUpdate(void) {
+            long long nowNs = boost::chrono::duration_cast<boost::chrono::nanoseconds>(
+                    boost::chrono::steady_clock::now().time_since_epoch()).count();
+            return (nowNs - _updateTimeNs.load()) * 1e-9;
+        }
+
+        int UdpStatusReceiver::setTargetOccupancy(int samples) {
+            _targetOccupancy = std::max( 0, std::min( MAX_RADIO_BUFFSIZE, samples ) );
+            return _targetOccupancy;
+        }
+
+        long int UdpStatusReceiver::getBufferOccupancy(void) {
+            if (!_haveUpdate) {
+                return 0;
+            }
+            // What the radio held at the last status frame, plus what has
+            // been sent since, less what the DUC has played out since.
+            double occupancy = (double)(MAX_RADIO_BUFFSIZE - _lastReported.load()) + _sentSinceUpdate.load();
+            occupancy -= _drainRate * this->_secondsSinceUpdate();
+            return (long int)std::max( 0.0, std::min( (double)MAX_RADIO_BUFFSIZE, occupancy ) );
+        }
+
+        void UdpStatusReceiver::setPredictiveCredit(bool enable, double sampleRate) {
+            boost::mutex::scoped_lock lock(_predictMutex);
+            _drainRate = sampleRate;
+            _predictive = enable && (sampleRate > 0);
+            // Scoring starts over at the next status frame
+            _predictionError = 0;
+            _predictionMargin = 0.0;
+        }
+
+        void UdpStatusReceiver::_creditDrain(void) {
+            // Another thread already crediting the drain will do it for us
+            if (_predictive && _predictMutex.try_lock()) {
+                this->_creditDrainLocked();
+                _predictMutex.unlock();
+            }
+        }
+
+        void UdpStatusReceiver::_creditDrainLocked(void) {
+            if (!_haveUpdate) {
+                return;
+            }
+            long int drained = (long int)(_drainRate*this->_secondsSinceUpdate() - _predictionMargin);
+            // Samples sent since the update refill what the DUC can drain
+            drained = std::min( drained, _drainHeadroom + _sentSinceUpdate.load() );
+            if (drained > _drainCredited) {
+                _651freeSpace.fetch_add(drained - _drainCredited);
+                _drainCredited = drained;
+            }
+        }
+
+        bool UdpStatusReceiver::blockUntilAvailable(long int numSamples, double timeout) {
+            this->_creditDrain();
+            if (_651freeSpace.load() >= numSamples) {
+                return true;
+            }
+            boost::mutex::scoped_lock lock(_fcMutex);
+            bool forever = (timeout < 0);
+            boost::chrono::steady_clock::time_point deadline = boost::chrono::steady_clock::now() +
+                    boost::chrono::microseconds(forever ? 0 : (long long)(timeout * 1e6));
+            while (!_shutdown) {
+                this->_creditDrain();
+                long int shortfall = numSamples - _651freeSpace.load();
+                if (shortfall <= 0) {
+                    break;
+                }
+                boost::chrono::steady_clock::time_point now = boost::chrono::steady_clock::now();
+                if (!forever && (now >= deadline)) {
+                    break;
+                }
+                if (_predictive && _haveUpdate) {
+                    // No status frame may come in time; look again once the
+                    // predicted drain should have covered the shortfall.
+                    boost::chrono::steady_clock::time_point wake = now + boost::chrono::microseconds(
+                            std::max( (long long)PREDICTION_MIN_WAIT_US, (long long)(shortfall * 1e6 / _drainRate) ));
+                    if (!forever) {
+                        wake = std::min(wake, deadline);
+                    }
+                    _fcCondition.wait_until(lock, wake);
+                } else if (forever) {
+                    _fcCondition.wait(lock);
+                } else {
+                    _fcCondition.wait_until(lock, deadline);
+                }
+            }
+            return (_651freeSpace >= numSamples);
+        }
+
         bool UdpStatusReceiver::okToSend(long int numSamples, bool lockIfOk) {
-            _fcMutex.lock();
-            bool ok = _651freeSpace>=numSamples;
-            if (!(ok&&lockIfOk)) {
-                _fcMutex.unlock();
-            } else {
-                _sendLock = true;
+            this->_creditDrain();
+            long int credit = _651freeSpace.load();
+            if (!lockIfOk) {
+                return credit>=numSamples;
+            }
+            // Take the credit now so no other sender can claim it
+            while (credit>=numSamples) {
+                if (_651freeSpace.compare_exchange_weak(credit, credit-numSamples)) {
+                    _threadReservation() += numSamples;
+                    return true;
+                }
             }
-            return ok;
+            return false;
         }
 
         long int UdpStatusReceiver::getFreeSpace(void) {
-            boost::mutex::scoped_lock lock(_fcMutex);
-            return _651freeSpace;
+            this->_creditDrain();
+            return _651freeSpace.load();
         }
 
-        bool UdpStatusReceiver::sentNSamples(long int samplesSent) {
-            if (!_sendLock) {
-                _fcMutex.lock();
+        // Reservations are kept per thread, so concurrent senders cannot
+        // settle each other's, and per receiver, so a thread sending to
+        // several DUCs keeps them apart.
+        long int& UdpStatusReceiver::_threadReservation(void) {
+            if (_reservedSamples.get() == NULL) {
+                _reservedSamples.reset(new long int(0));
             }
-            _651freeSpace -= samplesSent;
-            _fcMutex.unlock();
-            return _651freeSpace>0;
+            return *_reservedSamples;
+        }
+
+        bool UdpStatusReceiver::sentNSamples(long int samplesSent) {
+            // Anything reserved by okToSend() was already taken; only the
+            // difference from what was actually sent remains to settle.
+            long int& reservation = _threadReservation();
+            long int reserved = reservation;
+            reservation = 0;
+            _sentSinceUpdate.fetch_add(samplesSent);
+            long int remaining = _651freeSpace.fetch_sub(samplesSent-reserved) - (samplesSent-reserved);
+            return remaining>0;
         }
 
     } /* namespace NDR651 */